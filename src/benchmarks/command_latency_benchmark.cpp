@@ -0,0 +1,315 @@
+#include "mavsdk.h"
+#include "plugin_impl_base.h"
+#include "mavlink_commands.h"
+#include "global_include.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Sends 100 commands at once over UDP to a fake vehicle which acks commands
+// to its autopilot after 10 ms and commands to its camera after 300 ms, and
+// reports how long each command took until its result callback.
+//
+// Once every command uses a different id, so they can all be in flight at the
+// same time, and once the commands to each component use the same id, so they
+// have to go one after the other.
+
+using namespace mavsdk;
+
+namespace {
+
+const int mavsdk_port = 14620;
+const unsigned num_commands = 100;
+const unsigned camera_every = 10;
+const auto autopilot_delay = std::chrono::milliseconds(10);
+const auto camera_delay = std::chrono::milliseconds(300);
+
+typedef std::chrono::steady_clock Clock;
+
+// Acks every COMMAND_LONG it receives after a delay depending on the
+// component which was addressed.
+class FakeVehicle {
+public:
+    FakeVehicle() = default;
+    ~FakeVehicle() { stop(); }
+
+    // delete copy and move constructors and assign operators
+    FakeVehicle(FakeVehicle const&) = delete; // Copy construct
+    FakeVehicle(FakeVehicle&&) = delete; // Move construct
+    FakeVehicle& operator=(FakeVehicle const&) = delete; // Copy assign
+    FakeVehicle& operator=(FakeVehicle&&) = delete; // Move assign
+
+    bool start()
+    {
+        _socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (_socket_fd < 0) {
+            return false;
+        }
+
+        _remote_addr.sin_family = AF_INET;
+        _remote_addr.sin_port = htons(mavsdk_port);
+        inet_pton(AF_INET, "127.0.0.1", &_remote_addr.sin_addr);
+
+        _thread = std::thread(&FakeVehicle::run, this);
+        return true;
+    }
+
+    void stop()
+    {
+        _should_exit = true;
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+        if (_socket_fd >= 0) {
+            close(_socket_fd);
+            _socket_fd = -1;
+        }
+    }
+
+private:
+    struct PendingAck {
+        Clock::time_point due;
+        uint16_t command;
+        uint8_t component_id;
+        uint8_t target_system;
+        uint8_t target_component;
+    };
+
+    void run()
+    {
+        auto next_heartbeat = Clock::now();
+
+        while (!_should_exit) {
+            const auto now = Clock::now();
+            if (now >= next_heartbeat) {
+                send_heartbeat(MAV_COMP_ID_AUTOPILOT1);
+                send_heartbeat(MAV_COMP_ID_CAMERA);
+                next_heartbeat = now + std::chrono::milliseconds(100);
+            }
+
+            send_due_acks(now);
+
+            pollfd fds[1] = {{_socket_fd, POLLIN, 0}};
+            if (poll(fds, 1, 1) > 0) {
+                receive();
+            }
+        }
+    }
+
+    void receive()
+    {
+        uint8_t buffer[2048];
+        const auto recv_len = recv(_socket_fd, buffer, sizeof(buffer), 0);
+        if (recv_len <= 0) {
+            return;
+        }
+
+        for (ssize_t i = 0; i < recv_len; ++i) {
+            mavlink_message_t message;
+            if (!mavlink_parse_char(MAVLINK_COMM_1, buffer[i], &message, &_status)) {
+                continue;
+            }
+            if (message.msgid != MAVLINK_MSG_ID_COMMAND_LONG) {
+                continue;
+            }
+
+            mavlink_command_long_t command_long;
+            mavlink_msg_command_long_decode(&message, &command_long);
+
+            const uint8_t component_id = (command_long.target_component == MAV_COMP_ID_CAMERA) ?
+                                             MAV_COMP_ID_CAMERA :
+                                             MAV_COMP_ID_AUTOPILOT1;
+            const auto delay =
+                (component_id == MAV_COMP_ID_CAMERA) ? camera_delay : autopilot_delay;
+
+            _pending_acks.push_back(PendingAck{Clock::now() + delay,
+                                               command_long.command,
+                                               component_id,
+                                               message.sysid,
+                                               message.compid});
+        }
+    }
+
+    void send_due_acks(Clock::time_point now)
+    {
+        for (auto it = _pending_acks.begin(); it != _pending_acks.end(); /* manual */) {
+            if (it->due > now) {
+                ++it;
+                continue;
+            }
+            mavlink_message_t message;
+            mavlink_msg_command_ack_pack(
+                1,
+                it->component_id,
+                &message,
+                it->command,
+                MAV_RESULT_ACCEPTED,
+                0,
+                0,
+                it->target_system,
+                it->target_component);
+            send(message);
+            it = _pending_acks.erase(it);
+        }
+    }
+
+    void send_heartbeat(uint8_t component_id)
+    {
+        mavlink_message_t message;
+        mavlink_msg_heartbeat_pack(
+            1,
+            component_id,
+            &message,
+            (component_id == MAV_COMP_ID_CAMERA) ? MAV_TYPE_CAMERA : MAV_TYPE_QUADROTOR,
+            MAV_AUTOPILOT_PX4,
+            0,
+            0,
+            MAV_STATE_STANDBY);
+        send(message);
+    }
+
+    void send(const mavlink_message_t& message)
+    {
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t len = mavlink_msg_to_send_buffer(buffer, &message);
+        sendto(
+            _socket_fd,
+            buffer,
+            len,
+            0,
+            reinterpret_cast<const sockaddr*>(&_remote_addr),
+            sizeof(_remote_addr));
+    }
+
+    int _socket_fd{-1};
+    sockaddr_in _remote_addr{};
+    mavlink_status_t _status{};
+    std::vector<PendingAck> _pending_acks{};
+    std::atomic<bool> _should_exit{false};
+    std::thread _thread{};
+};
+
+// Gives the benchmark access to the system's commands like a plugin.
+class CommandSender : public PluginImplBase {
+public:
+    explicit CommandSender(System& system) : PluginImplBase(system)
+    {
+        _parent->register_plugin(this);
+    }
+    ~CommandSender() { _parent->unregister_plugin(this); }
+
+    void init() override {}
+    void deinit() override {}
+    void enable() override {}
+    void disable() override {}
+
+    void send(MAVLinkCommands::CommandLong& command, SystemImpl::command_result_callback_t callback)
+    {
+        _parent->send_command_async(command, callback);
+    }
+};
+
+void print_latencies(const char* name, std::vector<double>& latencies_ms, double total_ms)
+{
+    std::sort(latencies_ms.begin(), latencies_ms.end());
+    double sum = 0.0;
+    for (double latency : latencies_ms) {
+        sum += latency;
+    }
+    printf(
+        "%-22s mean %7.1f ms, p50 %7.1f ms, p99 %7.1f ms, all done after %7.1f ms\n",
+        name,
+        sum / static_cast<double>(latencies_ms.size()),
+        latencies_ms[latencies_ms.size() / 2],
+        latencies_ms[latencies_ms.size() * 99 / 100],
+        total_ms);
+}
+
+void run(const char* name, CommandSender& sender, bool distinct_ids)
+{
+    std::mutex mutex;
+    std::vector<double> autopilot_latencies_ms;
+    std::vector<double> camera_latencies_ms;
+    std::atomic<unsigned> num_failed{0};
+    std::atomic<unsigned> num_done{0};
+
+    const auto start = Clock::now();
+
+    for (unsigned i = 0; i < num_commands; ++i) {
+        const bool to_camera = (i % camera_every == 0);
+
+        MAVLinkCommands::CommandLong command{};
+        command.target_system_id = 1;
+        command.target_component_id = to_camera ? MAV_COMP_ID_CAMERA : MAV_COMP_ID_AUTOPILOT1;
+        if (distinct_ids) {
+            command.command = static_cast<uint16_t>(MAV_CMD_USER_1 + i);
+        } else {
+            command.command = to_camera ? MAV_CMD_USER_2 : MAV_CMD_USER_1;
+        }
+
+        const auto queued = Clock::now();
+        sender.send(command, [&, to_camera, queued](MAVLinkCommands::Result result, float) {
+            const double latency_ms =
+                std::chrono::duration<double, std::milli>(Clock::now() - queued).count();
+            if (result != MAVLinkCommands::Result::SUCCESS) {
+                ++num_failed;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                (to_camera ? camera_latencies_ms : autopilot_latencies_ms).push_back(latency_ms);
+            }
+            ++num_done;
+        });
+    }
+
+    while (num_done < num_commands) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const double total_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    printf("%s (%u failed):\n", name, num_failed.load());
+    print_latencies("  autopilot commands", autopilot_latencies_ms, total_ms);
+    print_latencies("  camera commands", camera_latencies_ms, total_ms);
+}
+
+} // namespace
+
+int main()
+{
+    Mavsdk mavsdk;
+    if (mavsdk.add_udp_connection(mavsdk_port) != ConnectionResult::SUCCESS) {
+        printf("Could not add UDP connection\n");
+        return 1;
+    }
+
+    FakeVehicle vehicle;
+    if (!vehicle.start()) {
+        printf("Could not start fake vehicle\n");
+        return 1;
+    }
+
+    for (unsigned i = 0; i < 100 && !mavsdk.is_connected(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (!mavsdk.is_connected()) {
+        printf("Fake vehicle not discovered\n");
+        return 1;
+    }
+
+    CommandSender sender(mavsdk.system());
+
+    run("different command ids", sender, true);
+    run("same command id", sender, false);
+
+    return 0;
+}
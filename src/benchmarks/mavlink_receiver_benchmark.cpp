@@ -0,0 +1,111 @@
+#include "mavlink_receiver.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Compares MAVLinkReceiver against feeding every byte to mavlink_parse_char
+// on a stream of typical telemetry, packed into datagrams like a UDP link.
+
+using namespace mavsdk;
+
+namespace {
+
+const unsigned num_frames = 20000;
+const unsigned datagram_size = 1400;
+const unsigned num_rounds = 20;
+
+std::vector<std::vector<uint8_t>> make_datagrams(uint8_t channel)
+{
+    std::vector<std::vector<uint8_t>> datagrams(1);
+
+    for (unsigned i = 0; i < num_frames; ++i) {
+        mavlink_message_t message;
+        switch (i % 3) {
+            case 0:
+                mavlink_msg_heartbeat_pack_chan(1, 1, channel, &message, 2, 12, 0, 0, 4);
+                break;
+            case 1:
+                mavlink_msg_attitude_pack_chan(
+                    1, 1, channel, &message, i, 0.1f, 0.2f, 0.3f, 0.01f, 0.02f, 0.03f);
+                break;
+            default:
+                mavlink_msg_global_position_int_pack_chan(
+                    1, 1, channel, &message, i, 473977418, 85455939, 488000, 10000, 1, 2, 3, 90);
+                break;
+        }
+
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t len = mavlink_msg_to_send_buffer(buffer, &message);
+
+        if (datagrams.back().size() + len > datagram_size) {
+            datagrams.emplace_back();
+        }
+        datagrams.back().insert(datagrams.back().end(), buffer, buffer + len);
+    }
+    return datagrams;
+}
+
+void print_result(
+    const char* name, double seconds, unsigned long long num_bytes, unsigned long long num_messages)
+{
+    printf(
+        "%-22s %8.1f MB/s %10.0f msgs/s\n",
+        name,
+        static_cast<double>(num_bytes) / seconds / 1e6,
+        static_cast<double>(num_messages) / seconds);
+}
+
+} // namespace
+
+int main()
+{
+    const uint8_t channel = MAVLINK_COMM_0;
+
+    auto datagrams = make_datagrams(channel);
+
+    unsigned long long num_bytes = 0;
+    for (const auto& datagram : datagrams) {
+        num_bytes += datagram.size();
+    }
+    num_bytes *= num_rounds;
+
+    {
+        mavlink_message_t message;
+        mavlink_status_t status;
+        unsigned long long num_messages = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned round = 0; round < num_rounds; ++round) {
+            for (const auto& datagram : datagrams) {
+                for (auto byte : datagram) {
+                    if (mavlink_parse_char(channel, byte, &message, &status) == 1) {
+                        ++num_messages;
+                    }
+                }
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        print_result("mavlink_parse_char", elapsed.count(), num_bytes, num_messages);
+    }
+
+    {
+        MAVLinkReceiver receiver;
+        unsigned long long num_messages = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned round = 0; round < num_rounds; ++round) {
+            for (auto& datagram : datagrams) {
+                receiver.set_new_datagram(
+                    reinterpret_cast<char*>(datagram.data()),
+                    static_cast<unsigned>(datagram.size()));
+                while (receiver.parse_message()) {
+                    ++num_messages;
+                }
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        print_result("MAVLinkReceiver", elapsed.count(), num_bytes, num_messages);
+    }
+
+    return 0;
+}
@@ -0,0 +1,293 @@
+#include "mavsdk.h"
+#include "plugin_impl_base.h"
+#include "mavlink_parameters.h"
+#include "global_include.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Sets 300 params on a fake vehicle which echoes each PARAM_SET after a
+// round trip of 20 ms and ignores every 50th PARAM_SET it receives, and
+// reports how long it took one by one and in batches with different windows.
+
+using namespace mavsdk;
+
+namespace {
+
+const int mavsdk_port = 14621;
+const unsigned num_params = 300;
+const unsigned drop_every = 50;
+const auto round_trip = std::chrono::milliseconds(20);
+
+typedef std::chrono::steady_clock Clock;
+
+// Echoes every PARAM_SET it receives with a PARAM_VALUE after a delay.
+class FakeVehicle {
+public:
+    FakeVehicle() = default;
+    ~FakeVehicle() { stop(); }
+
+    // delete copy and move constructors and assign operators
+    FakeVehicle(FakeVehicle const&) = delete; // Copy construct
+    FakeVehicle(FakeVehicle&&) = delete; // Move construct
+    FakeVehicle& operator=(FakeVehicle const&) = delete; // Copy assign
+    FakeVehicle& operator=(FakeVehicle&&) = delete; // Move assign
+
+    bool start()
+    {
+        _socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (_socket_fd < 0) {
+            return false;
+        }
+
+        _remote_addr.sin_family = AF_INET;
+        _remote_addr.sin_port = htons(mavsdk_port);
+        inet_pton(AF_INET, "127.0.0.1", &_remote_addr.sin_addr);
+
+        _thread = std::thread(&FakeVehicle::run, this);
+        return true;
+    }
+
+    void stop()
+    {
+        _should_exit = true;
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+        if (_socket_fd >= 0) {
+            close(_socket_fd);
+            _socket_fd = -1;
+        }
+    }
+
+    unsigned num_sets_received() const { return _num_sets_received; }
+
+private:
+    struct PendingEcho {
+        Clock::time_point due;
+        mavlink_param_set_t param_set;
+    };
+
+    void run()
+    {
+        auto next_heartbeat = Clock::now();
+
+        while (!_should_exit) {
+            const auto now = Clock::now();
+            if (now >= next_heartbeat) {
+                send_heartbeat();
+                next_heartbeat = now + std::chrono::milliseconds(100);
+            }
+
+            send_due_echos(now);
+
+            pollfd fds[1] = {{_socket_fd, POLLIN, 0}};
+            if (poll(fds, 1, 1) > 0) {
+                receive();
+            }
+        }
+    }
+
+    void receive()
+    {
+        uint8_t buffer[2048];
+        const auto recv_len = recv(_socket_fd, buffer, sizeof(buffer), 0);
+        if (recv_len <= 0) {
+            return;
+        }
+
+        for (ssize_t i = 0; i < recv_len; ++i) {
+            mavlink_message_t message;
+            if (!mavlink_parse_char(MAVLINK_COMM_1, buffer[i], &message, &_status)) {
+                continue;
+            }
+            if (message.msgid != MAVLINK_MSG_ID_PARAM_SET) {
+                continue;
+            }
+
+            if (++_num_sets_received % drop_every == 0) {
+                // Lost on the way.
+                continue;
+            }
+
+            PendingEcho echo{Clock::now() + round_trip, {}};
+            mavlink_msg_param_set_decode(&message, &echo.param_set);
+            _pending_echos.push_back(echo);
+        }
+    }
+
+    void send_due_echos(Clock::time_point now)
+    {
+        for (auto it = _pending_echos.begin(); it != _pending_echos.end(); /* manual */) {
+            if (it->due > now) {
+                ++it;
+                continue;
+            }
+            mavlink_message_t message;
+            mavlink_msg_param_value_pack(
+                1,
+                MAV_COMP_ID_AUTOPILOT1,
+                &message,
+                it->param_set.param_id,
+                it->param_set.param_value,
+                it->param_set.param_type,
+                num_params,
+                UINT16_MAX);
+            send(message);
+            it = _pending_echos.erase(it);
+        }
+    }
+
+    void send_heartbeat()
+    {
+        mavlink_message_t message;
+        mavlink_msg_heartbeat_pack(
+            1,
+            MAV_COMP_ID_AUTOPILOT1,
+            &message,
+            MAV_TYPE_QUADROTOR,
+            MAV_AUTOPILOT_PX4,
+            0,
+            0,
+            MAV_STATE_STANDBY);
+        send(message);
+    }
+
+    void send(const mavlink_message_t& message)
+    {
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t len = mavlink_msg_to_send_buffer(buffer, &message);
+        sendto(
+            _socket_fd,
+            buffer,
+            len,
+            0,
+            reinterpret_cast<const sockaddr*>(&_remote_addr),
+            sizeof(_remote_addr));
+    }
+
+    int _socket_fd{-1};
+    sockaddr_in _remote_addr{};
+    mavlink_status_t _status{};
+    std::vector<PendingEcho> _pending_echos{};
+    std::atomic<unsigned> _num_sets_received{0};
+    std::atomic<bool> _should_exit{false};
+    std::thread _thread{};
+};
+
+// Gives the benchmark access to the system's params like a plugin.
+class ParamSetter : public PluginImplBase {
+public:
+    explicit ParamSetter(System& system) : PluginImplBase(system)
+    {
+        _parent->register_plugin(this);
+    }
+    ~ParamSetter() { _parent->unregister_plugin(this); }
+
+    void init() override {}
+    void deinit() override {}
+    void enable() override {}
+    void disable() override {}
+
+    MAVLinkParameters::Result set_param(const std::string& name, int32_t value)
+    {
+        return _parent->set_param_int(name, value);
+    }
+
+    std::map<std::string, MAVLinkParameters::Result> set_params(
+        const std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>>& params,
+        unsigned window)
+    {
+        return _parent->set_params(params, window);
+    }
+};
+
+std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> make_params(int32_t offset)
+{
+    std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> params;
+    for (unsigned i = 0; i < num_params; ++i) {
+        MAVLinkParameters::ParamValue value;
+        value.set_int32(offset + int32_t(i));
+        params.push_back(std::make_pair("PARAM_" + std::to_string(i), value));
+    }
+    return params;
+}
+
+void print_result(const char* name, Clock::time_point start, unsigned num_failed)
+{
+    const double total_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    printf(
+        "%-18s %8.1f ms total, %6.2f ms per param (%u failed)\n",
+        name,
+        total_ms,
+        total_ms / num_params,
+        num_failed);
+}
+
+} // namespace
+
+int main()
+{
+    Mavsdk mavsdk;
+    if (mavsdk.add_udp_connection(mavsdk_port) != ConnectionResult::SUCCESS) {
+        printf("Could not add UDP connection\n");
+        return 1;
+    }
+
+    FakeVehicle vehicle;
+    if (!vehicle.start()) {
+        printf("Could not start fake vehicle\n");
+        return 1;
+    }
+
+    for (unsigned i = 0; i < 100 && !mavsdk.is_connected(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (!mavsdk.is_connected()) {
+        printf("Fake vehicle not discovered\n");
+        return 1;
+    }
+
+    ParamSetter setter(mavsdk.system());
+
+    {
+        const auto params = make_params(0);
+        unsigned num_failed = 0;
+        const auto start = Clock::now();
+        for (const auto& param : params) {
+            if (setter.set_param(param.first, param.second.get_int32()) !=
+                MAVLinkParameters::Result::SUCCESS) {
+                ++num_failed;
+            }
+        }
+        print_result("one by one", start, num_failed);
+    }
+
+    for (unsigned window : {1u, 10u, 50u}) {
+        const auto params = make_params(int32_t(window));
+        const auto start = Clock::now();
+        unsigned num_failed = 0;
+        for (const auto& result : setter.set_params(params, window)) {
+            if (result.second != MAVLinkParameters::Result::SUCCESS) {
+                ++num_failed;
+            }
+        }
+        const std::string name = "window " + std::to_string(window);
+        print_result(name.c_str(), start, num_failed);
+    }
+
+    printf("%u PARAM_SETs received by the vehicle in total\n", vehicle.num_sets_received());
+
+    return 0;
+}
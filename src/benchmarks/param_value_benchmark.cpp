@@ -0,0 +1,97 @@
+#include "mavlink_parameters.h"
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+// Measures the operations CameraDefinition does most with params: copying
+// maps of them around, comparing them and parsing them from XML strings.
+
+using namespace mavsdk;
+
+namespace {
+
+typedef MAVLinkParameters::ParamValue ParamValue;
+
+const size_t num_params = 1000;
+const size_t rounds = 1000;
+
+template<typename F> void run(const char* name, size_t ops_per_round, F f)
+{
+    size_t result = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rounds; ++i) {
+        result += f();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Print the result so that the loop is not optimized away.
+    printf(
+        "%-24s %8.1f ns/op (%zu)\n",
+        name,
+        elapsed.count() * 1e9 / static_cast<double>(rounds * ops_per_round),
+        result);
+}
+
+} // namespace
+
+int main()
+{
+    const char* types[] = {"uint8", "int16", "uint32", "int32", "float", "double"};
+    const char* values[] = {"1", "-2", "3", "-4", "0.5", "0.25"};
+    const size_t num_types = sizeof(types) / sizeof(types[0]);
+
+    std::vector<ParamValue> params(num_params);
+    std::map<std::string, ParamValue> settings;
+    for (size_t i = 0; i < num_params; ++i) {
+        params[i].set_from_xml(types[i % num_types], values[i % num_types]);
+        settings["SETTING_" + std::to_string(i)] = params[i];
+    }
+
+    run("copy vector", num_params, [&params]() {
+        std::vector<ParamValue> copy(params);
+        return copy.size();
+    });
+
+    run("copy map", num_params, [&settings]() {
+        std::map<std::string, ParamValue> copy(settings);
+        return copy.size();
+    });
+
+    run("compare", num_params, [&params]() {
+        size_t num_equal = 0;
+        for (size_t i = 0; i + num_types < num_params; ++i) {
+            num_equal += (params[i] == params[i + num_types]) ? 1 : 0;
+        }
+        return num_equal;
+    });
+
+    run("compare to string", num_params, [&params, &values]() {
+        size_t num_equal = 0;
+        for (size_t i = 0; i < num_params; ++i) {
+            num_equal += (params[i] == std::string(values[i % num_types])) ? 1 : 0;
+        }
+        return num_equal;
+    });
+
+    run("parse from xml", num_params, [&types, &values]() {
+        size_t num_ok = 0;
+        ParamValue value;
+        for (size_t i = 0; i < num_params; ++i) {
+            num_ok += value.set_from_xml(types[i % num_types], values[i % num_types]) ? 1 : 0;
+        }
+        return num_ok;
+    });
+
+    run("check type", num_params, [&params]() {
+        size_t num_float = 0;
+        for (const auto& param : params) {
+            num_float += param.is_float() ? 1 : 0;
+        }
+        return num_float;
+    });
+
+    return 0;
+}
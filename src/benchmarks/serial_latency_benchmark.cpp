@@ -0,0 +1,135 @@
+#include "serial_connection.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fcntl.h>
+#include <mutex>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+// Writes heartbeats one at a time into a pseudo terminal and reports how long
+// it takes until the serial connection on the other end has parsed each one,
+// once with the default blocking reads and once in low latency mode.
+//
+// A pseudo terminal has no driver latency of its own, so this only shows what
+// the reading side adds. On a USB-serial adapter ASYNC_LOW_LATENCY also cuts
+// the batching of the driver.
+
+using namespace mavsdk;
+
+namespace {
+
+const unsigned num_messages = 1000;
+
+typedef std::chrono::steady_clock Clock;
+
+class Receiver {
+public:
+    Receiver() = default;
+
+    void on_message(mavlink_message_t&)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _received = Clock::now();
+            ++_num_received;
+        }
+        _cv.notify_one();
+    }
+
+    // Returns how long it took from sent until received, or a negative value
+    // if the message never arrived.
+    double wait_for(unsigned num_received, Clock::time_point sent)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_cv.wait_for(lock, std::chrono::seconds(2), [this, num_received]() {
+                return _num_received >= num_received;
+            })) {
+            return -1.0;
+        }
+        return std::chrono::duration<double, std::micro>(_received - sent).count();
+    }
+
+private:
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    Clock::time_point _received{};
+    unsigned _num_received{0};
+};
+
+void run(const char* name, bool low_latency)
+{
+    const int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_fd < 0 || grantpt(master_fd) != 0 || unlockpt(master_fd) != 0) {
+        printf("Could not open pseudo terminal\n");
+        return;
+    }
+
+    Receiver receiver;
+    SerialConnection connection(
+        [&receiver](mavlink_message_t& message) { receiver.on_message(message); },
+        ptsname(master_fd),
+        921600,
+        low_latency);
+    if (connection.start() != ConnectionResult::SUCCESS) {
+        printf("Could not start serial connection\n");
+        close(master_fd);
+        return;
+    }
+
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(1, 1, &message, MAV_TYPE_QUADROTOR, 0, 0, 0, 0);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    std::vector<double> latencies_us;
+    unsigned num_lost = 0;
+    for (unsigned i = 0; i < num_messages; ++i) {
+        const auto sent = Clock::now();
+        if (write(master_fd, buffer, len) != len) {
+            ++num_lost;
+            continue;
+        }
+        const double latency_us = receiver.wait_for(i + 1 - num_lost, sent);
+        if (latency_us < 0.0) {
+            ++num_lost;
+            continue;
+        }
+        latencies_us.push_back(latency_us);
+    }
+
+    connection.stop();
+    close(master_fd);
+
+    if (latencies_us.empty()) {
+        printf("%-12s nothing received\n", name);
+        return;
+    }
+
+    std::sort(latencies_us.begin(), latencies_us.end());
+    double sum = 0.0;
+    for (double latency : latencies_us) {
+        sum += latency;
+    }
+    printf(
+        "%-12s mean %7.1f us, p50 %7.1f us, p99 %7.1f us, max %7.1f us (%u lost)\n",
+        name,
+        sum / static_cast<double>(latencies_us.size()),
+        latencies_us[latencies_us.size() / 2],
+        latencies_us[latencies_us.size() * 99 / 100],
+        latencies_us.back(),
+        num_lost);
+}
+
+} // namespace
+
+int main()
+{
+    run("default", false);
+    run("low latency", true);
+
+    return 0;
+}
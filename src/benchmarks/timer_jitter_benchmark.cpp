@@ -0,0 +1,130 @@
+#include "call_every_handler.h"
+#include "timeout_handler.h"
+#include "global_include.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Simulates the system thread on FakeTime with a 50 Hz call_every (e.g. for
+// offboard setpoints) and a stream of command timeouts, once polling every
+// 10 ms as the system thread used to and once sleeping until the next
+// deadline. Reports how late callbacks were called and how often the thread
+// had to wake up.
+
+using namespace mavsdk;
+
+namespace {
+
+const double simulated_s = 60.0;
+const float setpoint_interval_s = 0.02f;
+const double command_timeout_s = 0.5;
+
+struct Lateness {
+    std::vector<double> samples_ms{};
+
+    void add(dl_time_t expected, dl_time_t actual)
+    {
+        samples_ms.push_back(std::chrono::duration<double, std::milli>(actual - expected).count());
+    }
+
+    void print(const char* name)
+    {
+        std::sort(samples_ms.begin(), samples_ms.end());
+        double sum = 0.0;
+        for (double sample : samples_ms) {
+            sum += sample;
+        }
+        printf(
+            "  %-10s %6zu calls, late by mean %6.3f ms, p99 %6.3f ms, max %6.3f ms\n",
+            name,
+            samples_ms.size(),
+            sum / static_cast<double>(samples_ms.size()),
+            samples_ms[samples_ms.size() * 99 / 100],
+            samples_ms.back());
+    }
+};
+
+enum class Strategy { Polling, NextDeadline };
+
+void run(const char* name, Strategy strategy)
+{
+    FakeTime time;
+    CallEveryHandler call_every_handler(time);
+    TimeoutHandler timeout_handler(time);
+
+    Lateness setpoint_lateness;
+    Lateness timeout_lateness;
+
+    const dl_time_t start = time.steady_time();
+
+    unsigned num_setpoints = 0;
+    call_every_handler.add(
+        [&]() {
+            ++num_setpoints;
+            dl_time_t expected = start;
+            time.shift_steady_time_by(expected, num_setpoints * double(setpoint_interval_s));
+            setpoint_lateness.add(expected, time.steady_time());
+        },
+        setpoint_interval_s,
+        nullptr);
+
+    // Commands are sent at random times and never acked, so they all time out.
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> command_gap_ms(50, 300);
+    dl_time_t next_command = start;
+    dl_time_t end = start;
+    time.shift_steady_time_by(end, simulated_s);
+
+    unsigned num_wakeups = 0;
+
+    while (time.steady_time() < end) {
+        ++num_wakeups;
+
+        if (time.steady_time() >= next_command) {
+            const dl_time_t expected = time.steady_time_in_future(command_timeout_s);
+            timeout_handler.add(
+                [&, expected]() { timeout_lateness.add(expected, time.steady_time()); },
+                command_timeout_s,
+                nullptr);
+            time.shift_steady_time_by(next_command, command_gap_ms(rng) / 1e3);
+        }
+
+        call_every_handler.run_once();
+        timeout_handler.run_once();
+
+        if (strategy == Strategy::Polling) {
+            time.sleep_for(std::chrono::milliseconds(10));
+        } else {
+            dl_time_t next_deadline = next_command;
+            dl_time_t deadline{};
+            if (call_every_handler.next_deadline(deadline)) {
+                next_deadline = std::min(next_deadline, deadline);
+            }
+            if (timeout_handler.next_deadline(deadline)) {
+                next_deadline = std::min(next_deadline, deadline);
+            }
+            // FakeTime adds some overhead to every sleep, similar to the
+            // wake-up latency of a real thread.
+            time.sleep_for(std::max(
+                std::chrono::nanoseconds(0),
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    next_deadline - time.steady_time())));
+        }
+    }
+
+    printf("%s: %u wake-ups in %.0f s\n", name, num_wakeups, simulated_s);
+    setpoint_lateness.print("call_every");
+    timeout_lateness.print("timeout");
+}
+
+} // namespace
+
+int main()
+{
+    run("polling every 10 ms", Strategy::Polling);
+    run("sleeping until next deadline", Strategy::NextDeadline);
+
+    return 0;
+}
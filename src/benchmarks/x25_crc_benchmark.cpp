@@ -0,0 +1,75 @@
+#include "x25_crc.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Compares the table-driven X.25 CRC with the stock MAVLink crc_accumulate
+// for frame sized buffers and for a large one.
+
+using namespace mavsdk;
+
+namespace {
+
+// As in mavlink/checksum.h.
+inline void stock_crc_accumulate(uint8_t data, uint16_t* crcAccum)
+{
+    uint8_t tmp;
+    tmp = data ^ static_cast<uint8_t>(*crcAccum & 0xff);
+    tmp ^= static_cast<uint8_t>(tmp << 4);
+    *crcAccum = static_cast<uint16_t>((*crcAccum >> 8) ^ (tmp << 8) ^ (tmp << 3) ^ (tmp >> 4));
+}
+
+const size_t total_bytes = 200 * 1000 * 1000;
+
+template<typename F> void run(const char* name, size_t len, const std::vector<uint8_t>& data, F f)
+{
+    const size_t rounds = total_bytes / len;
+    uint16_t result = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rounds; ++i) {
+        result ^= f(data.data(), len);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Print the result so that the loop is not optimized away.
+    printf(
+        "%-16s %6zu bytes: %8.1f MB/s (0x%04x)\n",
+        name,
+        len,
+        static_cast<double>(rounds * len) / elapsed.count() / 1e6,
+        result);
+}
+
+} // namespace
+
+int main()
+{
+    std::vector<uint8_t> data(64 * 1024);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+
+    // Heartbeat, typical telemetry, maximum frame, bulk.
+    for (size_t len : {17, 40, 280, 64 * 1024}) {
+        run("stock", len, data, [](const uint8_t* buf, size_t buf_len) {
+            uint16_t crc = X25Crc::INIT;
+            for (size_t i = 0; i < buf_len; ++i) {
+                stock_crc_accumulate(buf[i], &crc);
+            }
+            return crc;
+        });
+        run("table byte-wise", len, data, [](const uint8_t* buf, size_t buf_len) {
+            X25Crc crc;
+            for (size_t i = 0; i < buf_len; ++i) {
+                crc.add(buf[i]);
+            }
+            return crc.get();
+        });
+        run("slice-by-8", len, data, [](const uint8_t* buf, size_t buf_len) {
+            return X25Crc::calculate(buf, buf_len);
+        });
+    }
+
+    return 0;
+}
@@ -16,6 +16,7 @@ target_link_libraries(unit_tests_runner
     mavsdk_mission
     mavsdk_camera
     mavsdk_calibration
+    mavsdk_mavlink_ftp
     CURL::libcurl
     gtest
     gtest_main
@@ -1,4 +1,6 @@
 #include "call_every_handler.h"
+#include <utility>
+#include <vector>
 
 namespace mavsdk {
 
@@ -8,16 +10,17 @@ CallEveryHandler::~CallEveryHandler() {}
 
 void CallEveryHandler::add(std::function<void()> callback, float interval_s, void** cookie)
 {
-    auto new_entry = std::make_shared<Entry>();
-    new_entry->callback = callback;
-    new_entry->last_time = _time.steady_time();
-    new_entry->interval_s = interval_s;
+    Entry new_entry{};
+    new_entry.callback = callback;
+    new_entry.last_time = _time.steady_time();
+    new_entry.interval_s = interval_s;
 
-    void* new_cookie = static_cast<void*>(new_entry.get());
+    void* new_cookie = nullptr;
 
     {
         std::lock_guard<std::mutex> lock(_entries_mutex);
-        _entries.insert(std::pair<void*, std::shared_ptr<Entry>>(new_cookie, new_entry));
+        new_cookie = reinterpret_cast<void*>(++_last_cookie);
+        _entries.push(new_cookie, deadline_of(new_entry), new_entry);
     }
 
     if (cookie != nullptr) {
@@ -29,9 +32,10 @@ void CallEveryHandler::change(float interval_s, const void* cookie)
 {
     std::lock_guard<std::mutex> lock(_entries_mutex);
 
-    auto it = _entries.find(const_cast<void*>(cookie));
-    if (it != _entries.end()) {
-        it->second->interval_s = interval_s;
+    auto entry = _entries.find(cookie);
+    if (entry != nullptr) {
+        entry->interval_s = interval_s;
+        _entries.reschedule(cookie, deadline_of(*entry));
     }
 }
 
@@ -39,9 +43,10 @@ void CallEveryHandler::reset(const void* cookie)
 {
     std::lock_guard<std::mutex> lock(_entries_mutex);
 
-    auto it = _entries.find(const_cast<void*>(cookie));
-    if (it != _entries.end()) {
-        it->second->last_time = _time.steady_time();
+    auto entry = _entries.find(cookie);
+    if (entry != nullptr) {
+        entry->last_time = _time.steady_time();
+        _entries.reschedule(cookie, deadline_of(*entry));
     }
 }
 
@@ -49,40 +54,59 @@ void CallEveryHandler::remove(const void* cookie)
 {
     std::lock_guard<std::mutex> lock(_entries_mutex);
 
-    auto it = _entries.find(const_cast<void*>(cookie));
-    if (it != _entries.end()) {
-        _entries.erase(const_cast<void*>(cookie));
-        _iterator_invalidated = true;
-    }
+    _entries.remove(cookie);
 }
 
 void CallEveryHandler::run_once()
 {
-    _entries_mutex.lock();
+    std::unique_lock<std::mutex> lock(_entries_mutex);
 
-    for (auto it = _entries.begin(); it != _entries.end(); ++it) {
-        if (_time.elapsed_since_s(it->second->last_time) > double(it->second->interval_s)) {
-            _time.shift_steady_time_by(it->second->last_time, double(it->second->interval_s));
+    const dl_time_t now = _time.steady_time();
 
-            if (it->second->callback) {
-                // Get a copy for the callback because we unlock.
-                std::function<void()> callback = it->second->callback;
+    // Take out everything that is due and put it back with its next deadline
+    // right away. This way every entry is called at most once per run, even
+    // if it has fallen behind by more than one interval.
+    std::vector<std::pair<const void*, Entry>> due_entries;
+    while (!_entries.empty() && _entries.top_deadline() <= now) {
+        due_entries.emplace_back(_entries.top_key(), _entries.top_value());
+        _entries.pop();
+    }
 
-                // Unlock while we callback because it might in turn want to add timeouts.
-                _entries_mutex.unlock();
-                callback();
-                _entries_mutex.lock();
-            }
-        }
+    for (auto& due_entry : due_entries) {
+        Entry& entry = due_entry.second;
+        _time.shift_steady_time_by(entry.last_time, double(entry.interval_s));
+        _entries.push(due_entry.first, deadline_of(entry), entry);
+    }
 
-        // We leave the loop.
-        // FIXME: there should be a nicer way to do this.
-        if (_iterator_invalidated) {
-            _iterator_invalidated = false;
-            break;
+    for (const auto& due_entry : due_entries) {
+        // One of the previous callbacks might have removed it.
+        if (!_entries.contains(due_entry.first) || !due_entry.second.callback) {
+            continue;
         }
+
+        // Unlock while we callback because it might in turn want to add timeouts.
+        lock.unlock();
+        due_entry.second.callback();
+        lock.lock();
+    }
+}
+
+bool CallEveryHandler::next_deadline(dl_time_t& deadline)
+{
+    std::lock_guard<std::mutex> lock(_entries_mutex);
+
+    if (_entries.empty()) {
+        return false;
     }
-    _entries_mutex.unlock();
+    deadline = _entries.top_deadline();
+    return true;
+}
+
+dl_time_t CallEveryHandler::deadline_of(const Entry& entry)
+{
+    dl_time_t deadline = entry.last_time;
+    _time.shift_steady_time_by(deadline, double(entry.interval_s));
+    return deadline;
 }
 
 } // namespace mavsdk
@@ -1,9 +1,9 @@
 #pragma once
 
 #include <mutex>
-#include <memory>
+#include <cstdint>
 #include <functional>
-#include <map>
+#include "deadline_heap.h"
 #include "global_include.h"
 
 namespace mavsdk {
@@ -26,6 +26,10 @@ public:
 
     void run_once();
 
+    // Earliest time at which run_once has something to do, returns false
+    // if there are no entries.
+    bool next_deadline(dl_time_t& deadline);
+
 private:
     struct Entry {
         std::function<void()> callback{nullptr};
@@ -33,9 +37,13 @@ private:
         float interval_s{0.0f};
     };
 
-    std::map<void*, std::shared_ptr<Entry>> _entries{};
+    dl_time_t deadline_of(const Entry& entry);
+
+    DeadlineHeap<Entry> _entries{};
     std::mutex _entries_mutex{};
-    bool _iterator_invalidated{false};
+
+    // Cookies are never reused, see TimeoutHandler.
+    uintptr_t _last_cookie{0};
 
     Time& _time;
 };
@@ -130,3 +130,59 @@ TEST(CallEveryHandler, Reset)
     }
     EXPECT_EQ(num_called, 1);
 }
+
+TEST(CallEveryHandler, NextDeadline)
+{
+    Time time{};
+    CallEveryHandler ceh(time);
+
+    dl_time_t deadline{};
+    EXPECT_FALSE(ceh.next_deadline(deadline));
+
+    void* cookie = nullptr;
+    ceh.add([]() {}, 0.1f, &cookie);
+    const dl_time_t start = time.steady_time();
+
+    ASSERT_TRUE(ceh.next_deadline(deadline));
+    EXPECT_EQ(deadline, start + std::chrono::milliseconds(100));
+
+    // After being called, the next deadline is one interval later, not one
+    // interval after the call.
+    time.sleep_for(std::chrono::milliseconds(120));
+    ceh.run_once();
+    ASSERT_TRUE(ceh.next_deadline(deadline));
+    EXPECT_EQ(deadline, start + std::chrono::milliseconds(200));
+
+    ceh.change(0.5f, cookie);
+    ASSERT_TRUE(ceh.next_deadline(deadline));
+    EXPECT_EQ(deadline, start + std::chrono::milliseconds(600));
+
+    ceh.remove(cookie);
+    EXPECT_FALSE(ceh.next_deadline(deadline));
+}
+
+TEST(CallEveryHandler, RemovedByOtherCallback)
+{
+    Time time{};
+    CallEveryHandler ceh(time);
+
+    int num_called1 = 0;
+    int num_called2 = 0;
+
+    void* cookie1 = nullptr;
+    void* cookie2 = nullptr;
+    ceh.add(
+        [&ceh, &num_called1, &cookie2]() {
+            ++num_called1;
+            ceh.remove(cookie2);
+        },
+        0.1f,
+        &cookie1);
+    ceh.add([&num_called2]() { ++num_called2; }, 0.1f, &cookie2);
+
+    time.sleep_for(std::chrono::milliseconds(150));
+    ceh.run_once();
+
+    EXPECT_EQ(num_called1, 1);
+    EXPECT_EQ(num_called2, 0);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace mavsdk {
+
+// A move-only void() callable, like std::function<void()> but with a larger
+// inline buffer.
+//
+// Callables of up to `capacity` bytes (e.g. a lambda capturing a
+// std::function and a telemetry struct) are stored in place and never
+// allocate. Larger ones are moved to the heap.
+class CallbackTask {
+public:
+    static constexpr size_t capacity = 96;
+
+    CallbackTask() = default;
+    ~CallbackTask() { reset(); }
+
+    CallbackTask(CallbackTask&& other) : CallbackTask() { other.move_to(*this); }
+
+    CallbackTask& operator=(CallbackTask&& other)
+    {
+        if (this != &other) {
+            reset();
+            other.move_to(*this);
+        }
+        return *this;
+    }
+
+    // Non-copyable
+    CallbackTask(const CallbackTask&) = delete;
+    const CallbackTask& operator=(const CallbackTask&) = delete;
+
+    template<typename F> void emplace(F&& func)
+    {
+        typedef typename std::decay<F>::type Callable;
+        reset();
+        emplace_impl<Callable>(
+            std::forward<F>(func), std::integral_constant<bool, fits<Callable>()>());
+    }
+
+    void operator()() { _handler(Op::Invoke, *this, nullptr); }
+
+    void reset()
+    {
+        if (_handler != nullptr) {
+            _handler(Op::Destroy, *this, nullptr);
+            _handler = nullptr;
+        }
+    }
+
+    explicit operator bool() const { return _handler != nullptr; }
+
+    template<typename Callable> static constexpr bool fits()
+    {
+        return sizeof(Callable) <= capacity && alignof(Callable) <= alignof(Storage);
+    }
+
+private:
+    enum class Op { Invoke, MoveTo, Destroy };
+
+    typedef void (*handler_t)(Op op, CallbackTask& self, CallbackTask* other);
+    typedef typename std::aligned_storage<capacity, alignof(std::max_align_t)>::type Storage;
+
+    template<typename Callable> struct InlineHandler {
+        static void handle(Op op, CallbackTask& self, CallbackTask* other)
+        {
+            Callable* callable = reinterpret_cast<Callable*>(&self._storage);
+            switch (op) {
+                case Op::Invoke:
+                    (*callable)();
+                    break;
+                case Op::MoveTo:
+                    new (&other->_storage) Callable(std::move(*callable));
+                    callable->~Callable();
+                    break;
+                case Op::Destroy:
+                    callable->~Callable();
+                    break;
+            }
+        }
+    };
+
+    template<typename Callable> struct HeapHandler {
+        static void handle(Op op, CallbackTask& self, CallbackTask* other)
+        {
+            Callable*& callable = *reinterpret_cast<Callable**>(&self._storage);
+            switch (op) {
+                case Op::Invoke:
+                    (*callable)();
+                    break;
+                case Op::MoveTo:
+                    *reinterpret_cast<Callable**>(&other->_storage) = callable;
+                    break;
+                case Op::Destroy:
+                    delete callable;
+                    break;
+            }
+        }
+    };
+
+    template<typename Callable, typename F> void emplace_impl(F&& func, std::true_type)
+    {
+        new (&_storage) Callable(std::forward<F>(func));
+        _handler = &InlineHandler<Callable>::handle;
+    }
+
+    template<typename Callable, typename F> void emplace_impl(F&& func, std::false_type)
+    {
+        *reinterpret_cast<Callable**>(&_storage) = new Callable(std::forward<F>(func));
+        _handler = &HeapHandler<Callable>::handle;
+    }
+
+    void move_to(CallbackTask& other)
+    {
+        if (_handler != nullptr) {
+            _handler(Op::MoveTo, *this, &other);
+            other._handler = _handler;
+            _handler = nullptr;
+        }
+    }
+
+    Storage _storage{};
+    handler_t _handler{nullptr};
+};
+
+} // namespace mavsdk
@@ -45,6 +45,7 @@ bool CliArg::find_protocol(std::string& rest)
 {
     const std::string udp = "udp";
     const std::string tcp = "tcp";
+    const std::string tcp_server = "tcpin";
     const std::string serial = "serial";
     const std::string delimiter = "://";
 
@@ -56,6 +57,10 @@ bool CliArg::find_protocol(std::string& rest)
         _protocol = Protocol::TCP;
         rest.erase(0, tcp.length() + delimiter.length());
         return true;
+    } else if (rest.find(tcp_server + delimiter) == 0) {
+        _protocol = Protocol::TCP_SERVER;
+        rest.erase(0, tcp_server.length() + delimiter.length());
+        return true;
     } else if (rest.find(serial + delimiter) == 0) {
         _protocol = Protocol::SERIAL;
         rest.erase(0, serial.length() + delimiter.length());
@@ -69,7 +74,8 @@ bool CliArg::find_protocol(std::string& rest)
 bool CliArg::find_path(std::string& rest)
 {
     if (rest.length() == 0) {
-        if (_protocol == Protocol::UDP || _protocol == Protocol::TCP) {
+        if (_protocol == Protocol::UDP || _protocol == Protocol::TCP ||
+            _protocol == Protocol::TCP_SERVER) {
             // We have to use the default path
             return true;
         } else {
@@ -6,7 +6,7 @@ namespace mavsdk {
 
 class CliArg {
 public:
-    enum class Protocol { NONE, UDP, TCP, SERIAL };
+    enum class Protocol { NONE, UDP, TCP, TCP_SERVER, SERIAL };
 
     bool parse(const std::string& uri);
 
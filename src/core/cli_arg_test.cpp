@@ -113,6 +113,29 @@ TEST(CliArg, TCPConnections)
     EXPECT_FALSE(ca.parse("tcp://127.0.0.1:-5"));
 }
 
+TEST(CliArg, TCPServerConnections)
+{
+    CliArg ca;
+
+    EXPECT_TRUE(ca.parse("tcpin://"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::TCP_SERVER);
+    EXPECT_STREQ(ca.get_path().c_str(), "");
+    EXPECT_EQ(0, ca.get_port());
+
+    EXPECT_TRUE(ca.parse("tcpin://0.0.0.0:5760"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::TCP_SERVER);
+    EXPECT_STREQ(ca.get_path().c_str(), "0.0.0.0");
+    EXPECT_EQ(5760, ca.get_port());
+
+    EXPECT_TRUE(ca.parse("tcpin://:8"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::TCP_SERVER);
+    EXPECT_STREQ(ca.get_path().c_str(), "");
+    EXPECT_EQ(8, ca.get_port());
+
+    EXPECT_FALSE(ca.parse("tcpin:/0.0.0.0:99"));
+    EXPECT_FALSE(ca.parse("tcpin://0.0.0.0:100000"));
+}
+
 TEST(CliArg, SerialConnections)
 {
     CliArg ca;
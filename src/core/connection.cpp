@@ -1,13 +1,16 @@
 #include "connection.h"
 #include "mavsdk_impl.h"
-#include "mavlink_channels.h"
 #include "global_include.h"
 
 namespace mavsdk {
 
 Connection::Connection(receiver_callback_t receiver_callback) :
     _receiver_callback(receiver_callback),
-    _mavlink_receiver()
+    _mavlink_receiver(),
+    _send_queue([this](
+                    const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len) {
+        return (frame != nullptr) ? send_frame(message, frame, frame_len) : send_message(message);
+    })
 {}
 
 Connection::~Connection()
@@ -17,30 +20,63 @@ Connection::~Connection()
     _receiver_callback = {};
 }
 
-bool Connection::start_mavlink_receiver()
+void Connection::start_mavlink_receiver()
 {
-    uint8_t channel;
-    if (!MAVLinkChannels::Instance().checkout_free_channel(channel)) {
+    _mavlink_receiver.reset(new MAVLinkReceiver());
+    _mavlink_receiver->set_traffic_counters(&_traffic_counters);
+}
+
+void Connection::stop_mavlink_receiver()
+{
+    _mavlink_receiver.reset();
+}
+
+bool Connection::queue_message(
+    const mavlink_message_t& message, SendQueue::sent_callback_t sent_callback)
+{
+    if (!_send_queue.is_running()) {
+        if (!send_message(message)) {
+            return false;
+        }
+        if (sent_callback) {
+            sent_callback(true);
+        }
+        return true;
+    }
+    return _send_queue.push(message, sent_callback);
+}
+
+bool Connection::queue_forwarded(
+    const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len)
+{
+    if (!_send_queue.is_running()) {
         return false;
     }
+    return _send_queue.push_forwarded(
+        message, std::make_shared<const std::vector<uint8_t>>(frame, frame + frame_len));
+}
 
-    _mavlink_receiver.reset(new MAVLinkReceiver(channel));
-    return true;
+void Connection::start_send_queue()
+{
+    _send_queue.start();
 }
 
-void Connection::stop_mavlink_receiver()
+void Connection::stop_send_queue()
 {
-    if (_mavlink_receiver) {
-        uint8_t used_channel = _mavlink_receiver->get_channel();
-        // Destroy receiver before giving the channel back.
-        _mavlink_receiver.reset();
-        MAVLinkChannels::Instance().checkin_used_channel(used_channel);
-    }
+    _send_queue.stop();
 }
 
-void Connection::receive_message(mavlink_message_t& message)
+void Connection::receive_message(MAVLinkReceiver& receiver)
 {
-    _receiver_callback(message);
+    // Forwarded first, so it is not delayed by our own processing.
+    if (_forward_callback) {
+        _forward_callback(
+            *this,
+            receiver.get_last_message(),
+            receiver.get_last_frame(),
+            receiver.get_last_frame_len());
+    }
+    _receiver_callback(receiver.get_last_message());
 }
 
 } // namespace mavsdk
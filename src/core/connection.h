@@ -2,6 +2,11 @@
 
 #include "mavsdk.h"
 #include "mavlink_receiver.h"
+#include "io_reactor.h"
+#include "latency_tracer.h"
+#include "send_queue.h"
+#include "traffic_counters.h"
+#include <array>
 #include <memory>
 
 namespace mavsdk {
@@ -9,6 +14,12 @@ namespace mavsdk {
 class Connection {
 public:
     typedef std::function<void(mavlink_message_t& message)> receiver_callback_t;
+    typedef std::function<void(
+        Connection& from,
+        const mavlink_message_t& message,
+        const uint8_t* frame,
+        unsigned frame_len)>
+        forward_callback_t;
 
     Connection(receiver_callback_t receiver_callback);
     virtual ~Connection();
@@ -18,17 +29,65 @@ public:
 
     virtual bool send_message(const mavlink_message_t& message) = 0;
 
+    // Sends a message which is already serialized, e.g. one received on
+    // another connection, without serializing it again.
+    virtual bool
+    send_frame(const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len) = 0;
+
+    // Hands the message to the send queue without blocking, or sends it
+    // right away if the connection is not started. Returns false if it was
+    // refused, otherwise sent_callback gets the result later, see
+    // SendQueue::push.
+    bool queue_message(
+        const mavlink_message_t& message, SendQueue::sent_callback_t sent_callback = nullptr);
+
+    // Queues a message received on another connection to be sent as it was
+    // received, see SendQueue::push_forwarded. Nothing is forwarded while
+    // the connection is not started.
+    bool
+    queue_forwarded(const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len);
+
+    // See SendQueue::set_rate_limit, 0 for no limit.
+    void set_send_rate_limit(double bytes_per_s) { _send_queue.set_rate_limit(bytes_per_s); }
+
+    std::array<SendQueue::Stats, SendQueue::num_priorities> send_queue_stats() const
+    {
+        return _send_queue.stats();
+    }
+
+    TrafficStats traffic_stats() const { return _traffic_counters.stats(); }
+
+    // Service this connection from a shared I/O reactor instead of its own
+    // receive thread. This needs to be set before start().
+    void set_io_reactor(std::shared_ptr<IoReactor> io_reactor) { _io_reactor = io_reactor; }
+
+    // Every message received is handed to this callback as received, before
+    // it is processed. This needs to be set before start().
+    void set_forward_callback(forward_callback_t callback) { _forward_callback = callback; }
+    bool is_forwarding() const { return bool(_forward_callback); }
+
     // Non-copyable
     Connection(const Connection&) = delete;
     const Connection& operator=(const Connection&) = delete;
 
 protected:
-    bool start_mavlink_receiver();
+    void start_mavlink_receiver();
     void stop_mavlink_receiver();
-    void receive_message(mavlink_message_t& message);
+    // Hands on the message the receiver has just parsed.
+    void receive_message(MAVLinkReceiver& receiver);
+
+    // The send queue calls send_message() and send_frame() from its own
+    // thread, so it needs to be stopped before the port is closed.
+    void start_send_queue();
+    void stop_send_queue();
 
     receiver_callback_t _receiver_callback{};
+    forward_callback_t _forward_callback{};
+    // Declared before the receivers, which count into it.
+    TrafficCounters _traffic_counters{};
     std::unique_ptr<MAVLinkReceiver> _mavlink_receiver;
+    std::shared_ptr<IoReactor> _io_reactor{};
+    SendQueue _send_queue;
 
     // void received_mavlink_message(mavlink_message_t &);
 };
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "global_include.h"
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+// Min-heap of values ordered by deadline.
+//
+// Besides taking the value with the earliest deadline, values can be looked
+// up, rescheduled and removed by their key. All of these are O(log n) which
+// means the owner does not have to scan all entries to find out what is due
+// or how long it can sleep.
+//
+// This class is not thread-safe, the owner needs to lock.
+template<typename T> class DeadlineHeap {
+public:
+    DeadlineHeap() = default;
+    ~DeadlineHeap() = default;
+
+    bool empty() const { return _nodes.empty(); }
+    size_t size() const { return _nodes.size(); }
+
+    bool contains(const void* key) const { return _positions.find(key) != _positions.end(); }
+
+    // The key must not be in the heap yet.
+    void push(const void* key, dl_time_t deadline, T value)
+    {
+        _nodes.push_back(Node{deadline, key, std::move(value)});
+        _positions[key] = _nodes.size() - 1;
+        sift_up(_nodes.size() - 1);
+    }
+
+    // Returns nullptr if the key is not in the heap.
+    T* find(const void* key)
+    {
+        auto it = _positions.find(key);
+        if (it == _positions.end()) {
+            return nullptr;
+        }
+        return &_nodes[it->second].value;
+    }
+
+    bool reschedule(const void* key, dl_time_t deadline)
+    {
+        auto it = _positions.find(key);
+        if (it == _positions.end()) {
+            return false;
+        }
+        _nodes[it->second].deadline = deadline;
+        restore(it->second);
+        return true;
+    }
+
+    bool remove(const void* key)
+    {
+        auto it = _positions.find(key);
+        if (it == _positions.end()) {
+            return false;
+        }
+
+        const size_t pos = it->second;
+        _positions.erase(it);
+
+        const size_t last = _nodes.size() - 1;
+        if (pos != last) {
+            _nodes[pos] = std::move(_nodes[last]);
+            _positions[_nodes[pos].key] = pos;
+            _nodes.pop_back();
+            restore(pos);
+        } else {
+            _nodes.pop_back();
+        }
+        return true;
+    }
+
+    // The following are only valid if the heap is not empty.
+    const dl_time_t& top_deadline() const { return _nodes.front().deadline; }
+    const void* top_key() const { return _nodes.front().key; }
+    T& top_value() { return _nodes.front().value; }
+    void pop() { remove(top_key()); }
+
+    // Non-copyable
+    DeadlineHeap(const DeadlineHeap&) = delete;
+    const DeadlineHeap& operator=(const DeadlineHeap&) = delete;
+
+private:
+    struct Node {
+        dl_time_t deadline;
+        const void* key;
+        T value;
+    };
+
+    void restore(size_t pos)
+    {
+        if (pos > 0 && _nodes[pos].deadline < _nodes[parent(pos)].deadline) {
+            sift_up(pos);
+        } else {
+            sift_down(pos);
+        }
+    }
+
+    void sift_up(size_t pos)
+    {
+        while (pos > 0 && _nodes[pos].deadline < _nodes[parent(pos)].deadline) {
+            swap_nodes(pos, parent(pos));
+            pos = parent(pos);
+        }
+    }
+
+    void sift_down(size_t pos)
+    {
+        while (true) {
+            const size_t left = 2 * pos + 1;
+            const size_t right = left + 1;
+            size_t smallest = pos;
+
+            if (left < _nodes.size() && _nodes[left].deadline < _nodes[smallest].deadline) {
+                smallest = left;
+            }
+            if (right < _nodes.size() && _nodes[right].deadline < _nodes[smallest].deadline) {
+                smallest = right;
+            }
+            if (smallest == pos) {
+                return;
+            }
+            swap_nodes(pos, smallest);
+            pos = smallest;
+        }
+    }
+
+    void swap_nodes(size_t a, size_t b)
+    {
+        std::swap(_nodes[a], _nodes[b]);
+        _positions[_nodes[a].key] = a;
+        _positions[_nodes[b].key] = b;
+    }
+
+    static size_t parent(size_t pos) { return (pos - 1) / 2; }
+
+    std::vector<Node> _nodes{};
+    std::unordered_map<const void*, size_t> _positions{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,118 @@
+#include "deadline_heap.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+
+using namespace mavsdk;
+
+namespace {
+
+dl_time_t at_ms(int ms)
+{
+    return dl_time_t() + std::chrono::milliseconds(ms);
+}
+
+const void* key_of(uintptr_t i)
+{
+    return reinterpret_cast<const void*>(i);
+}
+
+} // namespace
+
+TEST(DeadlineHeap, PopsInOrderOfDeadline)
+{
+    DeadlineHeap<int> heap;
+    EXPECT_TRUE(heap.empty());
+
+    heap.push(key_of(1), at_ms(30), 3);
+    heap.push(key_of(2), at_ms(10), 1);
+    heap.push(key_of(3), at_ms(20), 2);
+    EXPECT_EQ(heap.size(), 3);
+
+    for (int expected = 1; expected <= 3; ++expected) {
+        ASSERT_FALSE(heap.empty());
+        EXPECT_EQ(heap.top_value(), expected);
+        EXPECT_EQ(heap.top_deadline(), at_ms(expected * 10));
+        heap.pop();
+    }
+    EXPECT_TRUE(heap.empty());
+}
+
+TEST(DeadlineHeap, RescheduleAndRemoveByKey)
+{
+    DeadlineHeap<int> heap;
+    heap.push(key_of(1), at_ms(10), 1);
+    heap.push(key_of(2), at_ms(20), 2);
+    heap.push(key_of(3), at_ms(30), 3);
+
+    EXPECT_TRUE(heap.reschedule(key_of(1), at_ms(40)));
+    EXPECT_EQ(heap.top_key(), key_of(2));
+
+    EXPECT_TRUE(heap.remove(key_of(2)));
+    EXPECT_FALSE(heap.remove(key_of(2)));
+    EXPECT_FALSE(heap.contains(key_of(2)));
+    EXPECT_EQ(heap.find(key_of(2)), nullptr);
+    EXPECT_EQ(heap.top_key(), key_of(3));
+
+    ASSERT_NE(heap.find(key_of(1)), nullptr);
+    *heap.find(key_of(1)) = 42;
+    EXPECT_TRUE(heap.reschedule(key_of(1), at_ms(5)));
+    EXPECT_EQ(heap.top_value(), 42);
+
+    EXPECT_FALSE(heap.reschedule(key_of(4), at_ms(5)));
+}
+
+TEST(DeadlineHeap, SameAsSortedReference)
+{
+    DeadlineHeap<uintptr_t> heap;
+    std::map<uintptr_t, int> reference;
+    std::mt19937 rng(1);
+
+    for (unsigned i = 0; i < 20000; ++i) {
+        const uintptr_t key = std::uniform_int_distribution<uintptr_t>(1, 200)(rng);
+        const int deadline_ms = std::uniform_int_distribution<int>(0, 100000)(rng);
+
+        switch (std::uniform_int_distribution<int>(0, 3)(rng)) {
+            case 0:
+                if (!heap.contains(key_of(key))) {
+                    heap.push(key_of(key), at_ms(deadline_ms), key);
+                    reference[key] = deadline_ms;
+                }
+                break;
+            case 1:
+                EXPECT_EQ(
+                    heap.reschedule(key_of(key), at_ms(deadline_ms)), reference.count(key) > 0);
+                if (reference.count(key) > 0) {
+                    reference[key] = deadline_ms;
+                }
+                break;
+            case 2:
+                EXPECT_EQ(heap.remove(key_of(key)), reference.erase(key) > 0);
+                break;
+            default:
+                if (!heap.empty()) {
+                    // With equal deadlines any of them can come first, so
+                    // just check that the popped one was due first.
+                    const uintptr_t popped_key = heap.top_value();
+                    for (const auto& item : reference) {
+                        EXPECT_LE(reference[popped_key], item.second);
+                    }
+                    heap.pop();
+                    reference.erase(popped_key);
+                }
+                break;
+        }
+
+        ASSERT_EQ(heap.size(), reference.size());
+        if (!heap.empty()) {
+            int earliest_ms = 100001;
+            for (const auto& item : reference) {
+                earliest_ms = std::min(earliest_ms, item.second);
+            }
+            ASSERT_EQ(heap.top_deadline(), at_ms(earliest_ms));
+            ASSERT_EQ(reference[heap.top_value()], earliest_ms);
+        }
+    }
+}
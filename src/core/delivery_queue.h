@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "thread_pool.h"
+
+namespace mavsdk {
+
+// Policy and counters of a DeliveryQueue which don't depend on the type of
+// the updates.
+class DeliveryQueueBase {
+public:
+    enum class Policy {
+        ALL, // Deliver every update.
+        LATEST, // Only keep the newest update which has not been delivered yet.
+        LAST_N // Keep the newest `depth` updates which have not been delivered yet.
+    };
+
+    struct Stats {
+        size_t queue_depth;
+        uint64_t num_delivered;
+        uint64_t num_dropped;
+    };
+
+    virtual ~DeliveryQueueBase() = default;
+
+    virtual void set_policy(Policy policy, size_t depth) = 0;
+    virtual Stats stats() const = 0;
+};
+
+// Delivers updates of a subscription to its callback on the callback threads.
+//
+// Updates are delivered one at a time and in order: there is at most one task
+// in the thread pool per subscription and it delivers a single update before
+// queueing itself again if there is more. A slow subscriber therefore can't
+// fill up the thread pool, and with Policy::LATEST it always gets the newest
+// value.
+template<typename T> class DeliveryQueue : public DeliveryQueueBase {
+public:
+    typedef std::function<void(T)> callback_t;
+
+    DeliveryQueue() : _state(std::make_shared<State>()) {}
+    ~DeliveryQueue() = default;
+
+    // delete copy and move constructors and assign operators
+    DeliveryQueue(DeliveryQueue const&) = delete; // Copy construct
+    DeliveryQueue(DeliveryQueue&&) = delete; // Move construct
+    DeliveryQueue& operator=(DeliveryQueue const&) = delete; // Copy assign
+    DeliveryQueue& operator=(DeliveryQueue&&) = delete; // Move assign
+
+    // Setting an empty callback unsubscribes and drops what is pending.
+    void set_callback(callback_t callback)
+    {
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        if (callback) {
+            _state->callback = std::make_shared<const callback_t>(std::move(callback));
+        } else {
+            _state->callback.reset();
+            _state->pending.clear();
+        }
+    }
+
+    bool is_subscribed() const
+    {
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        return _state->callback != nullptr;
+    }
+
+    void set_policy(Policy policy, size_t depth) override
+    {
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        _state->policy = policy;
+        _state->depth = (depth > 0) ? depth : 1;
+        _state->drop_excess();
+    }
+
+    Stats stats() const override
+    {
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        return Stats{_state->pending.size(), _state->num_delivered, _state->num_dropped};
+    }
+
+    // Parent needs to provide call_user_callback(), e.g. SystemImpl, or be a
+    // ThreadPool.
+    template<typename Parent> void deliver(Parent& parent, T value)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_state->mutex);
+            if (!_state->callback) {
+                return;
+            }
+            _state->pending.push_back(std::move(value));
+            _state->drop_excess();
+
+            if (_state->scheduled) {
+                return;
+            }
+            _state->scheduled = true;
+        }
+
+        std::shared_ptr<State> state = _state;
+        schedule(parent, [&parent, state]() { deliver_next(parent, state); });
+    }
+
+private:
+    struct State {
+        mutable std::mutex mutex{};
+        std::shared_ptr<const callback_t> callback{};
+        Policy policy{Policy::ALL};
+        size_t depth{1};
+        std::deque<T> pending{};
+        bool scheduled{false};
+        uint64_t num_delivered{0};
+        uint64_t num_dropped{0};
+
+        void drop_excess()
+        {
+            if (policy == Policy::ALL) {
+                return;
+            }
+            const size_t max_pending = (policy == Policy::LATEST) ? 1 : depth;
+            while (pending.size() > max_pending) {
+                pending.pop_front();
+                ++num_dropped;
+            }
+        }
+    };
+
+    template<typename Parent>
+    static void deliver_next(Parent& parent, const std::shared_ptr<State>& state)
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        if (state->pending.empty() || !state->callback) {
+            state->scheduled = false;
+            return;
+        }
+
+        T value(std::move(state->pending.front()));
+        state->pending.pop_front();
+        std::shared_ptr<const callback_t> callback = state->callback;
+        lock.unlock();
+
+        (*callback)(std::move(value));
+
+        lock.lock();
+        ++state->num_delivered;
+        if (state->pending.empty()) {
+            state->scheduled = false;
+            return;
+        }
+        lock.unlock();
+
+        // Go to the back of the queue instead of looping here, so other
+        // subscriptions get their turn.
+        schedule(parent, [&parent, state]() { deliver_next(parent, state); });
+    }
+
+    template<typename Parent, typename F> static void schedule(Parent& parent, F&& func)
+    {
+        parent.call_user_callback(std::forward<F>(func));
+    }
+
+    template<typename F> static void schedule(ThreadPool& thread_pool, F&& func)
+    {
+        thread_pool.enqueue(std::forward<F>(func));
+    }
+
+    std::shared_ptr<State> _state;
+};
+
+} // namespace mavsdk
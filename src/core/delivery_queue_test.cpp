@@ -0,0 +1,195 @@
+#include "delivery_queue.h"
+#include "thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// Collects the tasks instead of running them, so tests can decide when the
+// callback threads get to run.
+struct FakeParent {
+    std::vector<std::function<void()>> tasks{};
+
+    template<typename F> void call_user_callback(F&& func) { tasks.push_back(func); }
+
+    size_t run_all()
+    {
+        size_t num_run = 0;
+        while (!tasks.empty()) {
+            auto task = tasks.front();
+            tasks.erase(tasks.begin());
+            task();
+            ++num_run;
+        }
+        return num_run;
+    }
+};
+
+struct PoolParent {
+    ThreadPool pool{3};
+
+    template<typename F> void call_user_callback(F&& func) { pool.enqueue(std::forward<F>(func)); }
+};
+
+} // namespace
+
+TEST(DeliveryQueue, NothingWithoutSubscriber)
+{
+    FakeParent parent;
+    DeliveryQueue<int> queue;
+
+    EXPECT_FALSE(queue.is_subscribed());
+    queue.deliver(parent, 1);
+    EXPECT_TRUE(parent.tasks.empty());
+}
+
+TEST(DeliveryQueue, AllDeliversEverythingInOrder)
+{
+    FakeParent parent;
+    DeliveryQueue<int> queue;
+
+    std::vector<int> received;
+    queue.set_callback([&received](int value) { received.push_back(value); });
+    EXPECT_TRUE(queue.is_subscribed());
+
+    for (int i = 0; i < 5; ++i) {
+        queue.deliver(parent, i);
+    }
+    // Only one task is queued at a time.
+    EXPECT_EQ(parent.tasks.size(), 1u);
+    EXPECT_EQ(queue.stats().queue_depth, 5u);
+
+    EXPECT_EQ(parent.run_all(), 5u);
+    EXPECT_EQ(received, (std::vector<int>{0, 1, 2, 3, 4}));
+
+    const auto stats = queue.stats();
+    EXPECT_EQ(stats.queue_depth, 0u);
+    EXPECT_EQ(stats.num_delivered, 5u);
+    EXPECT_EQ(stats.num_dropped, 0u);
+}
+
+TEST(DeliveryQueue, LatestConflates)
+{
+    FakeParent parent;
+    DeliveryQueue<int> queue;
+    queue.set_policy(DeliveryQueueBase::Policy::LATEST, 0);
+
+    std::vector<int> received;
+    queue.set_callback([&received](int value) { received.push_back(value); });
+
+    for (int i = 0; i < 10; ++i) {
+        queue.deliver(parent, i);
+    }
+    EXPECT_EQ(parent.tasks.size(), 1u);
+    EXPECT_EQ(queue.stats().queue_depth, 1u);
+
+    parent.run_all();
+    EXPECT_EQ(received, (std::vector<int>{9}));
+
+    const auto stats = queue.stats();
+    EXPECT_EQ(stats.num_delivered, 1u);
+    EXPECT_EQ(stats.num_dropped, 9u);
+
+    queue.deliver(parent, 10);
+    parent.run_all();
+    EXPECT_EQ(received, (std::vector<int>{9, 10}));
+}
+
+TEST(DeliveryQueue, LastNKeepsNewest)
+{
+    FakeParent parent;
+    DeliveryQueue<int> queue;
+    queue.set_policy(DeliveryQueueBase::Policy::LAST_N, 3);
+
+    std::vector<int> received;
+    queue.set_callback([&received](int value) { received.push_back(value); });
+
+    for (int i = 0; i < 10; ++i) {
+        queue.deliver(parent, i);
+    }
+    parent.run_all();
+    EXPECT_EQ(received, (std::vector<int>{7, 8, 9}));
+    EXPECT_EQ(queue.stats().num_dropped, 7u);
+}
+
+TEST(DeliveryQueue, PolicyChangeTrimsPending)
+{
+    FakeParent parent;
+    DeliveryQueue<int> queue;
+
+    std::vector<int> received;
+    queue.set_callback([&received](int value) { received.push_back(value); });
+
+    for (int i = 0; i < 4; ++i) {
+        queue.deliver(parent, i);
+    }
+    queue.set_policy(DeliveryQueueBase::Policy::LATEST, 1);
+    parent.run_all();
+    EXPECT_EQ(received, (std::vector<int>{3}));
+    EXPECT_EQ(queue.stats().num_dropped, 3u);
+}
+
+TEST(DeliveryQueue, UnsubscribeDropsPending)
+{
+    FakeParent parent;
+    DeliveryQueue<int> queue;
+
+    unsigned num_called = 0;
+    queue.set_callback([&num_called](int) { ++num_called; });
+
+    queue.deliver(parent, 1);
+    queue.deliver(parent, 2);
+    queue.set_callback(nullptr);
+    parent.run_all();
+    EXPECT_EQ(num_called, 0u);
+
+    // Subscribing again works after the stale task has finished.
+    queue.set_callback([&num_called](int) { ++num_called; });
+    queue.deliver(parent, 3);
+    parent.run_all();
+    EXPECT_EQ(num_called, 1u);
+}
+
+TEST(DeliveryQueue, SlowSubscriberGetsNewestOnThreadPool)
+{
+    PoolParent parent;
+    parent.pool.start();
+
+    DeliveryQueue<int> queue;
+    queue.set_policy(DeliveryQueueBase::Policy::LATEST, 1);
+
+    std::atomic<int> last_received{-1};
+    std::atomic<unsigned> num_concurrent{0};
+    std::atomic<bool> overlapped{false};
+    queue.set_callback([&](int value) {
+        if (num_concurrent.fetch_add(1) != 0) {
+            overlapped = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        last_received = value;
+        num_concurrent.fetch_sub(1);
+    });
+
+    const int num_updates = 200;
+    for (int i = 0; i < num_updates; ++i) {
+        queue.deliver(parent, i);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    for (int i = 0; i < 100 && last_received != num_updates - 1; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    parent.pool.stop();
+
+    EXPECT_EQ(last_received, num_updates - 1);
+    EXPECT_FALSE(overlapped);
+
+    const auto stats = queue.stats();
+    EXPECT_EQ(stats.num_delivered + stats.num_dropped, static_cast<uint64_t>(num_updates));
+    EXPECT_GT(stats.num_dropped, 0u);
+}
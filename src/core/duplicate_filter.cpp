@@ -0,0 +1,112 @@
+#include "duplicate_filter.h"
+
+namespace mavsdk {
+
+constexpr unsigned DuplicateFilter::window_size;
+constexpr unsigned DuplicateFilter::max_links;
+
+DuplicateFilter::Component::Component(uint8_t sequence) : newest(sequence), entries() {}
+
+DuplicateFilter::DuplicateFilter() : _components(new std::atomic<Component*>[256 * 256]()) {}
+
+DuplicateFilter::~DuplicateFilter()
+{
+    for (unsigned i = 0; i < 256 * 256; ++i) {
+        delete _components[i].load();
+    }
+}
+
+unsigned DuplicateFilter::add_link()
+{
+    return _num_links++;
+}
+
+bool DuplicateFilter::accept(const mavlink_message_t& message, unsigned link_id)
+{
+    // Without redundant links there can't be any duplicates.
+    if (_num_links.load(std::memory_order_relaxed) < 2) {
+        return true;
+    }
+
+    if (link_id >= max_links) {
+        return true;
+    }
+
+    Component& sender = component(message.sysid, message.compid, message.seq);
+    const uint32_t sequence = advance(sender, message.seq);
+
+    const uint64_t link = link_id + 1;
+    const uint64_t entry = (uint64_t((sequence >> 8) & 0xffff) << 48) |
+                           (uint64_t(message.ck[1]) << 40) | (uint64_t(message.ck[0]) << 32) |
+                           (uint64_t(message.msgid & 0xffffff) << 8) | link;
+
+    std::atomic<uint64_t>& stored = sender.entries[message.seq];
+    uint64_t current = stored.load(std::memory_order_relaxed);
+    while (true) {
+        const uint64_t first_link = current & 0xff;
+        if (first_link != 0 && first_link != link && (current >> 8) == (entry >> 8)) {
+            ++_link_counters[link_id].num_duplicates;
+            return false;
+        }
+        // The same link delivering it again means the sender repeated
+        // itself, which is not for us to drop.
+        if (current == entry ||
+            stored.compare_exchange_weak(current, entry, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    ++_link_counters[link_id].num_first;
+    return true;
+}
+
+std::vector<DuplicateFilter::LinkStats> DuplicateFilter::link_stats() const
+{
+    const unsigned num_links = _num_links.load();
+
+    std::vector<LinkStats> result(num_links);
+    for (unsigned i = 0; i < num_links && i < max_links; ++i) {
+        result[i].num_first = _link_counters[i].num_first.load(std::memory_order_relaxed);
+        result[i].num_duplicates =
+            _link_counters[i].num_duplicates.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+DuplicateFilter::Component&
+DuplicateFilter::component(uint8_t system_id, uint8_t component_id, uint8_t sequence)
+{
+    std::atomic<Component*>& slot = _components[(unsigned(system_id) << 8) | component_id];
+
+    Component* existing = slot.load(std::memory_order_acquire);
+    if (existing != nullptr) {
+        return *existing;
+    }
+
+    // Another link might deliver the first message at the same time, then
+    // the component it created is used.
+    Component* created = new Component(sequence);
+    if (slot.compare_exchange_strong(existing, created, std::memory_order_acq_rel)) {
+        return *created;
+    }
+    delete created;
+    return *existing;
+}
+
+uint32_t DuplicateFilter::advance(Component& component, uint8_t sequence)
+{
+    uint32_t newest = component.newest.load(std::memory_order_relaxed);
+    while (true) {
+        const uint8_t ahead = static_cast<uint8_t>(sequence - static_cast<uint8_t>(newest));
+        if (ahead == 0 || ahead > window_size) {
+            const uint8_t behind = static_cast<uint8_t>(static_cast<uint8_t>(newest) - sequence);
+            return newest - behind;
+        }
+        if (component.newest.compare_exchange_weak(
+                newest, newest + ahead, std::memory_order_relaxed)) {
+            return newest + ahead;
+        }
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mavsdk {
+
+// Drops messages which arrive a second time over a redundant link, e.g. when
+// a vehicle is connected through a telemetry radio and LTE at the same time.
+//
+// For every component one entry per sequence number is kept, with the
+// message id and checksum of the message and the link which delivered it
+// first. A message is a duplicate if another link delivered one with the
+// same sequence number, message id and checksum within the last 128
+// sequence numbers. Up to 128 ahead of the newest counts as new. A different
+// message with a sequence number seen already, e.g. after the sender
+// restarted, is let through.
+//
+// Nothing is locked: the components are kept in a fixed table indexed by
+// system and component id, and every entry is a single atomic. As long as
+// there is only one link, nothing is checked at all.
+class DuplicateFilter {
+public:
+    struct LinkStats {
+        // Messages this link delivered before any other link did.
+        uint64_t num_first{0};
+        // Messages dropped because another link had delivered them already.
+        uint64_t num_duplicates{0};
+    };
+
+    DuplicateFilter();
+    ~DuplicateFilter();
+
+    // delete copy and move constructors and assign operators
+    DuplicateFilter(DuplicateFilter const&) = delete; // Copy construct
+    DuplicateFilter(DuplicateFilter&&) = delete; // Move construct
+    DuplicateFilter& operator=(DuplicateFilter const&) = delete; // Copy assign
+    DuplicateFilter& operator=(DuplicateFilter&&) = delete; // Move assign
+
+    // Returns the id to pass to accept() for messages from the new link.
+    unsigned add_link();
+
+    // Returns false if the message is a duplicate and should be dropped.
+    bool accept(const mavlink_message_t& message, unsigned link_id);
+
+    // Only counted while there is more than one link.
+    std::vector<LinkStats> link_stats() const;
+
+private:
+    static constexpr unsigned window_size = 128;
+    // Only these fit into an entry, any further links are let through.
+    static constexpr unsigned max_links = 255;
+
+    struct Component {
+        explicit Component(uint8_t sequence);
+
+        // The newest sequence number, counting on past 255 so that every
+        // round of the sequence gets its own value.
+        std::atomic<uint32_t> newest;
+        // Per sequence number: the round in the upper 16 bits, then the
+        // checksum, the message id and the link id + 1 in the lowest byte.
+        // 0 if nothing has been received.
+        std::array<std::atomic<uint64_t>, 256> entries;
+    };
+
+    struct LinkCounters {
+        std::atomic<uint64_t> num_first{0};
+        std::atomic<uint64_t> num_duplicates{0};
+    };
+
+    Component& component(uint8_t system_id, uint8_t component_id, uint8_t sequence);
+    static uint32_t advance(Component& component, uint8_t sequence);
+
+    std::atomic<unsigned> _num_links{0};
+
+    // Indexed by system id << 8 | component id, allocated when first seen.
+    std::unique_ptr<std::atomic<Component*>[]> _components;
+    std::array<LinkCounters, max_links> _link_counters{};
+};
+
+} // namespace mavsdk
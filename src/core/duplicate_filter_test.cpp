@@ -0,0 +1,133 @@
+#include "duplicate_filter.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t message_with(
+    uint8_t system_id,
+    uint8_t component_id,
+    uint8_t sequence,
+    uint32_t message_id = MAVLINK_MSG_ID_HEARTBEAT,
+    uint16_t checksum = 0)
+{
+    mavlink_message_t message{};
+    message.sysid = system_id;
+    message.compid = component_id;
+    message.seq = sequence;
+    message.msgid = message_id;
+    message.ck[0] = static_cast<uint8_t>(checksum & 0xff);
+    message.ck[1] = static_cast<uint8_t>(checksum >> 8);
+    return message;
+}
+
+} // namespace
+
+TEST(DuplicateFilter, AcceptsEverythingWithOneLink)
+{
+    DuplicateFilter filter;
+    const unsigned link = filter.add_link();
+
+    for (unsigned i = 0; i < 3; ++i) {
+        EXPECT_TRUE(filter.accept(message_with(1, 1, 42), link));
+    }
+}
+
+TEST(DuplicateFilter, DropsWhatAnotherLinkDeliveredAlready)
+{
+    DuplicateFilter filter;
+    const unsigned radio = filter.add_link();
+    const unsigned lte = filter.add_link();
+
+    for (unsigned i = 0; i < 1000; ++i) {
+        const uint8_t sequence = static_cast<uint8_t>(i);
+        // The radio is a few messages ahead of LTE.
+        EXPECT_TRUE(filter.accept(message_with(1, 1, sequence), radio));
+        if (i >= 5) {
+            EXPECT_FALSE(filter.accept(message_with(1, 1, uint8_t(sequence - 5)), lte));
+        }
+    }
+
+    // Other components have their own sequence.
+    EXPECT_TRUE(filter.accept(message_with(1, 100, 3), lte));
+    EXPECT_FALSE(filter.accept(message_with(1, 100, 3), radio));
+
+    const auto stats = filter.link_stats();
+    ASSERT_EQ(stats.size(), 2u);
+    EXPECT_EQ(stats[radio].num_first, 1000u);
+    EXPECT_EQ(stats[radio].num_duplicates, 1u);
+    EXPECT_EQ(stats[lte].num_first, 1u);
+    EXPECT_EQ(stats[lte].num_duplicates, 995u);
+}
+
+TEST(DuplicateFilter, AcceptsWhatOnlyOneLinkDelivered)
+{
+    DuplicateFilter filter;
+    const unsigned radio = filter.add_link();
+    const unsigned lte = filter.add_link();
+
+    // The radio loses every other message.
+    for (unsigned i = 0; i < 300; ++i) {
+        const uint8_t sequence = static_cast<uint8_t>(i);
+        EXPECT_TRUE(filter.accept(message_with(1, 1, sequence), lte));
+        if (i % 2 == 0) {
+            EXPECT_FALSE(filter.accept(message_with(1, 1, sequence), radio));
+        }
+    }
+
+    // Late, out of order, but new.
+    EXPECT_TRUE(filter.accept(message_with(2, 1, 10), radio));
+    EXPECT_TRUE(filter.accept(message_with(2, 1, 9), lte));
+    EXPECT_FALSE(filter.accept(message_with(2, 1, 9), radio));
+}
+
+TEST(DuplicateFilter, StartsOverWhenSenderRestarts)
+{
+    DuplicateFilter filter;
+    const unsigned radio = filter.add_link();
+    const unsigned lte = filter.add_link();
+
+    for (uint8_t sequence = 0; sequence < 20; ++sequence) {
+        EXPECT_TRUE(filter.accept(message_with(1, 1, sequence), radio));
+    }
+
+    // The vehicle rebooted and counts from 0 again, over one link only.
+    for (uint8_t sequence = 0; sequence < 20; ++sequence) {
+        EXPECT_TRUE(filter.accept(message_with(1, 1, sequence), radio));
+    }
+    EXPECT_FALSE(filter.accept(message_with(1, 1, 19), lte));
+}
+
+TEST(DuplicateFilter, DropsOnlyTheSameMessage)
+{
+    DuplicateFilter filter;
+    const unsigned radio = filter.add_link();
+    const unsigned lte = filter.add_link();
+
+    EXPECT_TRUE(filter.accept(message_with(1, 1, 7, MAVLINK_MSG_ID_HEARTBEAT, 0x1234), radio));
+
+    // Same sequence number, but another message.
+    EXPECT_TRUE(filter.accept(message_with(1, 1, 7, MAVLINK_MSG_ID_ATTITUDE, 0x1234), lte));
+    EXPECT_TRUE(filter.accept(message_with(1, 1, 7, MAVLINK_MSG_ID_ATTITUDE, 0x4321), radio));
+
+    // The copy of the last one.
+    EXPECT_FALSE(filter.accept(message_with(1, 1, 7, MAVLINK_MSG_ID_ATTITUDE, 0x4321), lte));
+}
+
+TEST(DuplicateFilter, TakesJumpOf128AsNew)
+{
+    DuplicateFilter filter;
+    const unsigned radio = filter.add_link();
+    const unsigned lte = filter.add_link();
+
+    // One round over the radio, and the start of the next.
+    for (unsigned i = 0; i <= 256; ++i) {
+        EXPECT_TRUE(filter.accept(message_with(1, 1, static_cast<uint8_t>(i)), radio));
+    }
+
+    // 128 ahead is new, even though the radio delivered the same message
+    // with this sequence number in the previous round.
+    EXPECT_TRUE(filter.accept(message_with(1, 1, 128), lte));
+    EXPECT_FALSE(filter.accept(message_with(1, 1, 128), radio));
+}
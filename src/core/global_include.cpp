@@ -36,12 +36,19 @@ double Time::elapsed_since_s(const dl_time_t& since)
 dl_time_t Time::steady_time_in_future(double duration_s)
 {
     auto now = steady_time();
-    return now + std::chrono::milliseconds(int64_t(duration_s * 1e3));
+    return now + to_microseconds(duration_s);
 }
 
 void Time::shift_steady_time_by(dl_time_t& time, double offset_s)
 {
-    time += std::chrono::milliseconds(int64_t(offset_s * 1e3));
+    time += to_microseconds(offset_s);
+}
+
+std::chrono::microseconds Time::to_microseconds(double duration_s)
+{
+    // Round instead of truncating to whole milliseconds, otherwise e.g. an
+    // interval of 0.02f (which is slightly less than 0.02) ends up as 19 ms.
+    return std::chrono::microseconds(static_cast<int64_t>(std::round(duration_s * 1e6)));
 }
 
 void Time::sleep_for(std::chrono::hours h)
@@ -43,6 +43,9 @@ public:
     virtual void sleep_for(std::chrono::milliseconds ms);
     virtual void sleep_for(std::chrono::microseconds us);
     virtual void sleep_for(std::chrono::nanoseconds ns);
+
+private:
+    static std::chrono::microseconds to_microseconds(double duration_s);
 };
 
 class FakeTime : public Time {
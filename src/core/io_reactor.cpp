@@ -0,0 +1,263 @@
+#include "io_reactor.h"
+#include "global_include.h"
+#include "log.h"
+
+#if defined(LINUX)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+#endif
+
+namespace mavsdk {
+
+IoReactor::IoReactor(unsigned num_threads) : _num_threads(num_threads) {}
+
+IoReactor::~IoReactor()
+{
+    stop();
+}
+
+bool IoReactor::start()
+{
+#if defined(LINUX)
+    if (_running) {
+        return true;
+    }
+
+    if (_num_threads == 0) {
+        LogErr() << "I/O reactor needs at least one thread";
+        return false;
+    }
+
+    _should_exit = false;
+
+    for (unsigned i = 0; i < _num_threads; ++i) {
+        Loop loop{};
+        loop.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (loop.epoll_fd < 0) {
+            LogErr() << "epoll_create1 failed: " << strerror(errno);
+            stop();
+            return false;
+        }
+
+        loop.wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (loop.wakeup_fd < 0) {
+            LogErr() << "eventfd failed: " << strerror(errno);
+            close(loop.epoll_fd);
+            stop();
+            return false;
+        }
+
+        struct epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.fd = loop.wakeup_fd;
+        if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, loop.wakeup_fd, &event) != 0) {
+            LogErr() << "epoll_ctl failed: " << strerror(errno);
+            close(loop.wakeup_fd);
+            close(loop.epoll_fd);
+            stop();
+            return false;
+        }
+
+        _loops.push_back(loop);
+    }
+
+    for (unsigned i = 0; i < _loops.size(); ++i) {
+        _loops[i].thread = new std::thread(&IoReactor::run_loop, this, i);
+    }
+
+    _running = true;
+    return true;
+#else
+    LogErr() << "I/O reactor is not supported on this platform";
+    return false;
+#endif
+}
+
+void IoReactor::stop()
+{
+#if defined(LINUX)
+    _running = false;
+    _should_exit = true;
+
+    for (auto& loop : _loops) {
+        if (loop.wakeup_fd >= 0) {
+            const uint64_t one = 1;
+            if (write(loop.wakeup_fd, &one, sizeof(one)) != sizeof(one)) {
+                LogErr() << "Could not wake up I/O reactor loop";
+            }
+        }
+    }
+
+    for (auto& loop : _loops) {
+        if (loop.thread) {
+            loop.thread->join();
+            delete loop.thread;
+            loop.thread = nullptr;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_handlers_mutex);
+    for (auto& loop : _loops) {
+        close(loop.wakeup_fd);
+        close(loop.epoll_fd);
+    }
+    _loops.clear();
+    _handlers.clear();
+#endif
+}
+
+bool IoReactor::add(int fd, readable_callback_t callback)
+{
+#if defined(LINUX)
+    if (!_running) {
+        LogErr() << "I/O reactor not running";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_handlers_mutex);
+
+    if (_handlers.find(fd) != _handlers.end()) {
+        LogErr() << "fd " << fd << " already added to I/O reactor";
+        return false;
+    }
+
+    auto handler = std::make_shared<Handler>();
+    handler->callback = callback;
+    handler->loop_index = _next_loop_index;
+    _next_loop_index = (_next_loop_index + 1) % _loops.size();
+
+    struct epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(_loops[handler->loop_index].epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        LogErr() << "epoll_ctl add failed: " << strerror(errno);
+        return false;
+    }
+
+    _handlers[fd] = handler;
+    return true;
+#else
+    UNUSED(fd);
+    UNUSED(callback);
+    return false;
+#endif
+}
+
+void IoReactor::remove(int fd)
+{
+#if defined(LINUX)
+    std::unique_lock<std::mutex> lock(_handlers_mutex);
+
+    auto it = _handlers.find(fd);
+    if (it == _handlers.end()) {
+        return;
+    }
+
+    auto handler = it->second;
+    _handlers.erase(it);
+
+    if (!_loops.empty()) {
+        // This can fail if the fd has already been closed, in which case the
+        // kernel has dropped it from the epoll set anyway.
+        epoll_ctl(_loops[handler->loop_index].epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+
+    // Calling remove from within the callback must not wait for itself.
+    if (handler->running_thread_id == std::this_thread::get_id()) {
+        return;
+    }
+
+    while (handler->running) {
+        _handler_done_cv.wait(lock);
+    }
+#else
+    UNUSED(fd);
+#endif
+}
+
+void IoReactor::run_loop(unsigned loop_index)
+{
+#if defined(LINUX)
+    const int epoll_fd = _loops[loop_index].epoll_fd;
+    const int wakeup_fd = _loops[loop_index].wakeup_fd;
+
+    constexpr int max_events = 32;
+    struct epoll_event events[max_events];
+
+    while (!_should_exit) {
+        const int num_events = epoll_wait(epoll_fd, events, max_events, -1);
+
+        if (num_events < 0) {
+            if (errno != EINTR) {
+                LogErr() << "epoll_wait failed: " << strerror(errno);
+            }
+            continue;
+        }
+
+        for (int i = 0; i < num_events && !_should_exit; ++i) {
+            if (events[i].data.fd == wakeup_fd) {
+                // Drain the counter, we only care about being woken up.
+                uint64_t value;
+                const auto ret = read(wakeup_fd, &value, sizeof(value));
+                UNUSED(ret);
+                continue;
+            }
+            dispatch(events[i].data.fd);
+        }
+    }
+#else
+    UNUSED(loop_index);
+#endif
+}
+
+void IoReactor::dispatch(int fd)
+{
+    std::shared_ptr<Handler> handler;
+    {
+        std::lock_guard<std::mutex> lock(_handlers_mutex);
+        auto it = _handlers.find(fd);
+        if (it == _handlers.end()) {
+            // Removed after the event was reported.
+            return;
+        }
+        handler = it->second;
+        handler->running = true;
+        handler->running_thread_id = std::this_thread::get_id();
+    }
+
+    if (handler->callback) {
+        handler->callback();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_handlers_mutex);
+        handler->running = false;
+        handler->running_thread_id = std::thread::id();
+    }
+    _handler_done_cv.notify_all();
+}
+
+bool IoReactor::set_non_blocking(int fd)
+{
+#if defined(LINUX)
+    const int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1) {
+        LogErr() << "fcntl get failed: " << strerror(errno);
+        return false;
+    }
+    if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        LogErr() << "fcntl set failed: " << strerror(errno);
+        return false;
+    }
+    return true;
+#else
+    UNUSED(fd);
+    return false;
+#endif
+}
+
+} // namespace mavsdk
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mavsdk {
+
+// The I/O reactor services the file descriptors of many connections from a
+// small, fixed number of threads instead of one blocking receive thread per
+// connection.
+//
+// Each reactor thread runs its own epoll loop and new file descriptors are
+// spread across the loops round robin. File descriptors can be added and
+// removed while the loops are running.
+//
+// The reactor is only available on Linux. Elsewhere start() fails and the
+// connections keep using their own receive threads.
+class IoReactor {
+public:
+    typedef std::function<void()> readable_callback_t;
+
+    explicit IoReactor(unsigned num_threads);
+    ~IoReactor();
+
+    // delete copy and move constructors and assign operators
+    IoReactor(IoReactor const&) = delete; // Copy construct
+    IoReactor(IoReactor&&) = delete; // Move construct
+    IoReactor& operator=(IoReactor const&) = delete; // Copy assign
+    IoReactor& operator=(IoReactor&&) = delete; // Move assign
+
+    bool start();
+    void stop();
+
+    bool is_running() const { return _running; }
+    unsigned num_threads() const { return _num_threads; }
+
+    /**
+     * Register a file descriptor with one of the reactor loops.
+     *
+     * The callback is called on the reactor thread whenever the file
+     * descriptor is readable (or has an error pending). The file descriptor
+     * needs to be non-blocking and the callback should read until it would
+     * block.
+     *
+     * @param fd: the file descriptor to watch
+     * @param callback: the function to call when fd is readable
+     * @return true if the file descriptor was added.
+     */
+    bool add(int fd, readable_callback_t callback);
+
+    /**
+     * Unregister a file descriptor.
+     *
+     * Once this returns the callback is not running and won't be called
+     * again. If called from within the callback itself, it returns right away
+     * and the callback just won't be called again.
+     *
+     * @param fd: the file descriptor to remove
+     */
+    void remove(int fd);
+
+    // Helper to put a socket or tty into non-blocking mode before adding it.
+    static bool set_non_blocking(int fd);
+
+private:
+    struct Handler {
+        readable_callback_t callback{nullptr};
+        unsigned loop_index{0};
+        bool running{false};
+        std::thread::id running_thread_id{};
+    };
+
+    struct Loop {
+        int epoll_fd{-1};
+        int wakeup_fd{-1};
+        std::thread* thread{nullptr};
+    };
+
+    void run_loop(unsigned loop_index);
+    void dispatch(int fd);
+
+    const unsigned _num_threads;
+    std::vector<Loop> _loops{};
+
+    std::mutex _handlers_mutex{};
+    std::condition_variable _handler_done_cv{};
+    std::map<int, std::shared_ptr<Handler>> _handlers{};
+    unsigned _next_loop_index{0};
+
+    std::atomic<bool> _should_exit{false};
+    std::atomic<bool> _running{false};
+};
+
+} // namespace mavsdk
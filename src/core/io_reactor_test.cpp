@@ -0,0 +1,152 @@
+#include "io_reactor.h"
+#include "global_include.h"
+#include <gtest/gtest.h>
+#include <atomic>
+
+#if defined(LINUX)
+#include <unistd.h>
+
+using namespace mavsdk;
+
+// We don't use fake time for this because the reactor threads actually need to run.
+static Time our_time;
+
+class PipeFixture {
+public:
+    PipeFixture()
+    {
+        int fds[2];
+        EXPECT_EQ(pipe(fds), 0);
+        read_fd = fds[0];
+        write_fd = fds[1];
+        EXPECT_TRUE(IoReactor::set_non_blocking(read_fd));
+    }
+
+    ~PipeFixture()
+    {
+        close(read_fd);
+        close(write_fd);
+    }
+
+    void write_byte() { EXPECT_EQ(write(write_fd, "x", 1), 1); }
+
+    unsigned drain()
+    {
+        unsigned num_read = 0;
+        char buffer[64];
+        ssize_t ret;
+        while ((ret = read(read_fd, buffer, sizeof(buffer))) > 0) {
+            num_read += unsigned(ret);
+        }
+        return num_read;
+    }
+
+    int read_fd{-1};
+    int write_fd{-1};
+};
+
+TEST(IoReactor, CallbackWhenReadable)
+{
+    IoReactor reactor(1);
+    ASSERT_TRUE(reactor.start());
+
+    PipeFixture pipe_fixture;
+    std::atomic<unsigned> bytes_received{0};
+
+    ASSERT_TRUE(reactor.add(pipe_fixture.read_fd, [&pipe_fixture, &bytes_received]() {
+        bytes_received += pipe_fixture.drain();
+    }));
+
+    pipe_fixture.write_byte();
+    pipe_fixture.write_byte();
+    our_time.sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(bytes_received, 2);
+
+    reactor.remove(pipe_fixture.read_fd);
+    reactor.stop();
+}
+
+TEST(IoReactor, NoCallbackAfterRemove)
+{
+    IoReactor reactor(1);
+    ASSERT_TRUE(reactor.start());
+
+    PipeFixture pipe_fixture;
+    std::atomic<unsigned> calls{0};
+
+    ASSERT_TRUE(reactor.add(pipe_fixture.read_fd, [&pipe_fixture, &calls]() {
+        pipe_fixture.drain();
+        ++calls;
+    }));
+
+    pipe_fixture.write_byte();
+    our_time.sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(calls, 1);
+
+    reactor.remove(pipe_fixture.read_fd);
+
+    pipe_fixture.write_byte();
+    our_time.sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(IoReactor, RemoveFromWithinCallback)
+{
+    IoReactor reactor(1);
+    ASSERT_TRUE(reactor.start());
+
+    PipeFixture pipe_fixture;
+    std::atomic<unsigned> calls{0};
+
+    ASSERT_TRUE(reactor.add(pipe_fixture.read_fd, [&reactor, &pipe_fixture, &calls]() {
+        // This must not deadlock.
+        reactor.remove(pipe_fixture.read_fd);
+        ++calls;
+    }));
+
+    // We don't drain, so a level triggered loop would keep calling us.
+    pipe_fixture.write_byte();
+    our_time.sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(IoReactor, ManyFdsOnMultipleThreads)
+{
+    IoReactor reactor(3);
+    ASSERT_TRUE(reactor.start());
+
+    const unsigned num_pipes = 20;
+    PipeFixture pipe_fixtures[num_pipes];
+    std::atomic<unsigned> bytes_received{0};
+
+    for (unsigned i = 0; i < num_pipes; ++i) {
+        auto& pipe_fixture = pipe_fixtures[i];
+        ASSERT_TRUE(reactor.add(pipe_fixture.read_fd, [&pipe_fixture, &bytes_received]() {
+            bytes_received += pipe_fixture.drain();
+        }));
+    }
+
+    for (unsigned i = 0; i < num_pipes; ++i) {
+        pipe_fixtures[i].write_byte();
+    }
+    our_time.sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(bytes_received, num_pipes);
+
+    // Add and remove while the loops keep running.
+    for (unsigned i = 0; i < num_pipes; i += 2) {
+        reactor.remove(pipe_fixtures[i].read_fd);
+    }
+    for (unsigned i = 0; i < num_pipes; ++i) {
+        pipe_fixtures[i].write_byte();
+    }
+    our_time.sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(bytes_received, num_pipes + num_pipes / 2);
+}
+
+TEST(IoReactor, AddFailsWhenNotRunning)
+{
+    IoReactor reactor(1);
+    PipeFixture pipe_fixture;
+    EXPECT_FALSE(reactor.add(pipe_fixture.read_fd, []() {}));
+}
+#endif
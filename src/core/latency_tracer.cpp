@@ -0,0 +1,143 @@
+#include "latency_tracer.h"
+#include <chrono>
+
+namespace mavsdk {
+
+std::atomic<unsigned> LatencyTracer::_num_enabled{0};
+thread_local int64_t LatencyTracer::_receive_time_ns = 0;
+thread_local const LatencyTracer::Trace* LatencyTracer::_current = nullptr;
+
+void LatencyHistogram::record(int64_t latency_ns)
+{
+    // The kernel's and our clock might disagree by a little.
+    const uint64_t ns = (latency_ns > 0 ? static_cast<uint64_t>(latency_ns) : 0);
+    ++_buckets[index_of(ns / 1000)];
+    ++_count;
+    if (ns > _max_ns) {
+        _max_ns = ns;
+    }
+}
+
+double LatencyHistogram::percentile_s(double p) const
+{
+    if (_count == 0) {
+        return 0.0;
+    }
+
+    const double rank = p / 100.0 * static_cast<double>(_count);
+    uint64_t num_below = 0;
+    for (unsigned i = 0; i < num_buckets; ++i) {
+        num_below += _buckets[i];
+        if (num_below > 0 && static_cast<double>(num_below) >= rank) {
+            const double lower_s = static_cast<double>(lower_bound_us(i)) * 1e-6;
+            const double upper_s = static_cast<double>(lower_bound_us(i + 1)) * 1e-6;
+            const double middle_s = (lower_s + upper_s) / 2.0;
+            return (middle_s < max_s() ? middle_s : max_s());
+        }
+    }
+    return max_s();
+}
+
+unsigned LatencyHistogram::index_of(uint64_t latency_us)
+{
+    if (latency_us < sub_buckets) {
+        return static_cast<unsigned>(latency_us);
+    }
+
+    unsigned exponent = 0;
+    while ((latency_us >> (exponent + 1)) != 0) {
+        ++exponent;
+    }
+    // The 3 bits after the highest one give the bucket within the power of 2.
+    const unsigned sub_bucket = static_cast<unsigned>(latency_us >> (exponent - 3)) & 7;
+    const unsigned index = (exponent - 2) * sub_buckets + sub_bucket;
+    return (index < num_buckets ? index : num_buckets - 1);
+}
+
+uint64_t LatencyHistogram::lower_bound_us(unsigned index)
+{
+    if (index < sub_buckets) {
+        return index;
+    }
+    const unsigned exponent = index / sub_buckets + 2;
+    const uint64_t sub_bucket = index % sub_buckets;
+    return (sub_buckets + sub_bucket) << (exponent - 3);
+}
+
+LatencyTracer::~LatencyTracer()
+{
+    set_enabled(false);
+}
+
+void LatencyTracer::set_enabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (enabled == _enabled) {
+        return;
+    }
+
+    if (enabled) {
+        _latencies.clear();
+        ++_num_enabled;
+    } else {
+        --_num_enabled;
+    }
+    _enabled = enabled;
+}
+
+std::vector<LatencyTracer::MessageLatencies> LatencyTracer::latencies() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<MessageLatencies> result;
+    result.reserve(_latencies.size());
+    for (const auto& it : _latencies) {
+        result.push_back(it.second);
+    }
+    return result;
+}
+
+int64_t LatencyTracer::now_ns()
+{
+    // The same clock as the kernel's SO_TIMESTAMPNS.
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+void LatencyTracer::Dispatch::begin(LatencyTracer& tracer, const mavlink_message_t& message)
+{
+    _trace.tracer = &tracer;
+    _trace.message_id = message.msgid;
+    // Connections which were not stamping yet when tracing was enabled.
+    _trace.receive_time_ns = (_receive_time_ns != 0 ? _receive_time_ns : now_ns());
+
+    tracer.record(_trace, Stage::Dispatched);
+    _current = &_trace;
+}
+
+void LatencyTracer::record(const Trace& trace, Stage stage)
+{
+    const int64_t latency_ns = now_ns() - trace.receive_time_ns;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_enabled) {
+        return;
+    }
+
+    MessageLatencies& latencies = _latencies[trace.message_id];
+    latencies.message_id = trace.message_id;
+    switch (stage) {
+        case Stage::Dispatched:
+            latencies.dispatched.record(latency_ns);
+            break;
+        case Stage::CallbackQueued:
+            latencies.callback_queued.record(latency_ns);
+            break;
+        case Stage::CallbackStarted:
+            latencies.callback_started.record(latency_ns);
+            break;
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+// Histogram of latencies with a fixed relative resolution: below 8 us every
+// microsecond has its own bucket, above that every power of two is split
+// into 8 buckets, up to about 12 days.
+class LatencyHistogram {
+public:
+    void record(int64_t latency_ns);
+
+    uint64_t count() const { return _count; }
+    // Middle of the bucket the percentile falls into, p from 0 to 100.
+    double percentile_s(double p) const;
+    double max_s() const { return static_cast<double>(_max_ns) * 1e-9; }
+
+private:
+    static constexpr unsigned sub_buckets = 8;
+    static constexpr unsigned num_buckets = 40 * sub_buckets;
+
+    static unsigned index_of(uint64_t latency_us);
+    static uint64_t lower_bound_us(unsigned index);
+
+    std::array<uint64_t, num_buckets> _buckets{};
+    uint64_t _count{0};
+    uint64_t _max_ns{0};
+};
+
+// Traces how long it takes from a message arriving until the user callback
+// it leads to starts, split up into the stages on the way.
+//
+// Connections stamp every datagram when it is received, using the kernel's
+// timestamp (SO_TIMESTAMPNS) where available. SystemImpl starts a trace for
+// each message it dispatches, which stays current on the receiving thread
+// while the handlers run. Callbacks queued by call_user_callback() during
+// that time take the trace along and record when they were queued and when
+// they start. All latencies are measured from the receive time and collected
+// in histograms per message ID.
+//
+// When tracing is off, the only cost is checking an atomic flag per datagram
+// and message, and a thread-local pointer per callback.
+class LatencyTracer {
+public:
+    struct MessageLatencies {
+        uint32_t message_id{0};
+        LatencyHistogram dispatched{};
+        LatencyHistogram callback_queued{};
+        LatencyHistogram callback_started{};
+    };
+
+    LatencyTracer() = default;
+    ~LatencyTracer();
+
+    // delete copy and move constructors and assign operators
+    LatencyTracer(LatencyTracer const&) = delete; // Copy construct
+    LatencyTracer(LatencyTracer&&) = delete; // Move construct
+    LatencyTracer& operator=(LatencyTracer const&) = delete; // Copy assign
+    LatencyTracer& operator=(LatencyTracer&&) = delete; // Move assign
+
+    // Enabling starts over with empty histograms.
+    void set_enabled(bool enabled);
+    bool is_enabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    std::vector<MessageLatencies> latencies() const;
+
+    // Whether any tracer is enabled, so connections need to stamp datagrams.
+    static bool is_tracing() { return _num_enabled.load(std::memory_order_relaxed) > 0; }
+
+    // Sets the receive time of what is parsed next on this thread, 0 for now.
+    static void stamp_receive_time(int64_t time_ns = 0)
+    {
+        if (is_tracing()) {
+            _receive_time_ns = (time_ns != 0 ? time_ns : now_ns());
+        }
+    }
+
+    static int64_t now_ns();
+
+    enum class Stage { Dispatched, CallbackQueued, CallbackStarted };
+
+    struct Trace {
+        LatencyTracer* tracer{nullptr};
+        uint32_t message_id{0};
+        int64_t receive_time_ns{0};
+    };
+
+    // Keeps a message's trace current on this thread while it is dispatched.
+    class Dispatch {
+    public:
+        Dispatch(LatencyTracer& tracer, const mavlink_message_t& message)
+        {
+            if (tracer.is_enabled()) {
+                begin(tracer, message);
+            }
+        }
+        ~Dispatch()
+        {
+            if (_current == &_trace) {
+                _current = nullptr;
+            }
+        }
+
+        // delete copy and move constructors and assign operators
+        Dispatch(Dispatch const&) = delete; // Copy construct
+        Dispatch(Dispatch&&) = delete; // Move construct
+        Dispatch& operator=(Dispatch const&) = delete; // Copy assign
+        Dispatch& operator=(Dispatch&&) = delete; // Move assign
+
+    private:
+        void begin(LatencyTracer& tracer, const mavlink_message_t& message);
+
+        Trace _trace{};
+    };
+
+    static bool is_dispatching() { return _current != nullptr; }
+
+    // Wraps a callback queued while a message is dispatched, to record when
+    // it was queued and when it started.
+    template<typename F> class Traced {
+    public:
+        explicit Traced(F&& func) : _func(std::forward<F>(func)), _trace(*_current)
+        {
+            _trace.tracer->record(_trace, Stage::CallbackQueued);
+        }
+
+        void operator()()
+        {
+            _trace.tracer->record(_trace, Stage::CallbackStarted);
+            _func();
+        }
+
+    private:
+        typename std::decay<F>::type _func;
+        Trace _trace;
+    };
+
+private:
+    void record(const Trace& trace, Stage stage);
+
+    std::atomic<bool> _enabled{false};
+
+    mutable std::mutex _mutex{};
+    std::map<uint32_t, MessageLatencies> _latencies{};
+
+    static std::atomic<unsigned> _num_enabled;
+    static thread_local int64_t _receive_time_ns;
+    static thread_local const Trace* _current;
+};
+
+} // namespace mavsdk
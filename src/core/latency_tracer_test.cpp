@@ -0,0 +1,98 @@
+#include "latency_tracer.h"
+#include "thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t heartbeat()
+{
+    mavlink_message_t message{};
+    mavlink_msg_heartbeat_pack(1, 1, &message, 0, 0, 0, 0, 0);
+    return message;
+}
+
+} // namespace
+
+TEST(LatencyHistogram, Percentiles)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile_s(50.0), 0.0);
+
+    for (int64_t us = 1; us <= 1000; ++us) {
+        histogram.record(us * 1000);
+    }
+
+    EXPECT_EQ(histogram.count(), 1000u);
+    EXPECT_DOUBLE_EQ(histogram.max_s(), 1e-3);
+    // Buckets are an eighth of a power of two wide.
+    EXPECT_NEAR(histogram.percentile_s(50.0), 500e-6, 500e-6 / 8);
+    EXPECT_NEAR(histogram.percentile_s(90.0), 900e-6, 900e-6 / 8);
+    EXPECT_NEAR(histogram.percentile_s(99.0), 990e-6, 990e-6 / 8);
+    EXPECT_LE(histogram.percentile_s(100.0), histogram.max_s());
+
+    // Small values are exact, negative ones count as 0.
+    LatencyHistogram small;
+    small.record(-5000);
+    small.record(3000);
+    EXPECT_DOUBLE_EQ(small.percentile_s(50.0), 0.5e-6);
+    EXPECT_DOUBLE_EQ(small.percentile_s(100.0), 3e-6);
+}
+
+TEST(LatencyTracer, DoesNothingWhenDisabled)
+{
+    LatencyTracer tracer;
+    EXPECT_FALSE(LatencyTracer::is_tracing());
+
+    {
+        LatencyTracer::Dispatch dispatch(tracer, heartbeat());
+        EXPECT_FALSE(LatencyTracer::is_dispatching());
+    }
+    EXPECT_TRUE(tracer.latencies().empty());
+}
+
+TEST(LatencyTracer, TracesFromReceiveToCallback)
+{
+    LatencyTracer tracer;
+    tracer.set_enabled(true);
+    EXPECT_TRUE(LatencyTracer::is_tracing());
+
+    ThreadPool thread_pool(1);
+    ASSERT_TRUE(thread_pool.start());
+
+    std::atomic<bool> called{false};
+    LatencyTracer::stamp_receive_time(LatencyTracer::now_ns() - 2000000);
+    {
+        LatencyTracer::Dispatch dispatch(tracer, heartbeat());
+        ASSERT_TRUE(LatencyTracer::is_dispatching());
+
+        auto callback = [&called]() { called = true; };
+        thread_pool.enqueue(LatencyTracer::Traced<decltype(callback)>(std::move(callback)));
+    }
+    EXPECT_FALSE(LatencyTracer::is_dispatching());
+
+    for (unsigned i = 0; i < 100 && !called; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(called);
+    thread_pool.stop();
+
+    const auto latencies = tracer.latencies();
+    ASSERT_EQ(latencies.size(), 1u);
+    EXPECT_EQ(latencies[0].message_id, uint32_t(MAVLINK_MSG_ID_HEARTBEAT));
+    EXPECT_EQ(latencies[0].dispatched.count(), 1u);
+    EXPECT_EQ(latencies[0].callback_queued.count(), 1u);
+    EXPECT_EQ(latencies[0].callback_started.count(), 1u);
+    EXPECT_GE(latencies[0].dispatched.max_s(), 2e-3);
+    EXPECT_GE(latencies[0].callback_started.max_s(), latencies[0].callback_queued.max_s());
+
+    // Starts over when enabled again.
+    tracer.set_enabled(false);
+    EXPECT_FALSE(LatencyTracer::is_tracing());
+    tracer.set_enabled(true);
+    EXPECT_TRUE(tracer.latencies().empty());
+}
@@ -1,5 +1,11 @@
 #include "log.h"
 #include "global_include.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <mutex>
 
 #if defined(WINDOWS)
 #include "Windows.h"
@@ -70,4 +76,205 @@ void set_color(Color color)
 #endif
 }
 
+namespace {
+
+// Writes log messages on a background thread.
+//
+// Messages are queued in the lock-free ring of a ThreadPool with a single
+// worker, so they are written in order and a thread logging only pays for
+// formatting its message, never for the terminal or the user callback.
+class Logger {
+public:
+    static Logger& instance()
+    {
+        // Never destroyed because the destructors of other static objects
+        // might still log. At exit we flush and write synchronously instead.
+        static Logger* logger = new Logger();
+        return *logger;
+    }
+
+    // delete copy and move constructors and assign operators
+    Logger(Logger const&) = delete; // Copy construct
+    Logger(Logger&&) = delete; // Move construct
+    Logger& operator=(Logger const&) = delete; // Copy assign
+    Logger& operator=(Logger&&) = delete; // Move assign
+
+    void write(log::Level level, const char* filename, int filenumber, std::string message)
+    {
+        Record record{level, filename, filenumber, time(nullptr), std::move(message)};
+        if (_async) {
+            _pool.enqueue(OutputTask{this, std::move(record)});
+        } else {
+            output(record);
+        }
+    }
+
+    void set_callback(const log::Callback& callback)
+    {
+        std::lock_guard<std::mutex> lock(_callback_mutex);
+        if (callback) {
+            _callback = std::make_shared<const log::Callback>(callback);
+        } else {
+            _callback.reset();
+        }
+    }
+
+    void flush()
+    {
+        // Waiting for ourselves would never return.
+        if (!_async || _in_output) {
+            return;
+        }
+
+        std::promise<void> prom;
+        auto fut = prom.get_future();
+        _pool.enqueue([&prom]() { prom.set_value(); });
+        fut.wait();
+    }
+
+private:
+    struct Record {
+        log::Level level;
+        const char* filename;
+        int filenumber;
+        time_t time;
+        std::string message;
+    };
+
+    // Moves the record into the pool instead of copying it like a lambda
+    // capture would in C++11.
+    struct OutputTask {
+        Logger* logger;
+        Record record;
+        void operator()() { logger->output(record); }
+    };
+
+    Logger()
+    {
+        _pool.start();
+        std::atexit(&Logger::at_exit);
+    }
+
+    static void at_exit()
+    {
+        Logger& logger = instance();
+        logger.flush();
+        logger._async = false;
+        logger._pool.stop();
+    }
+
+    void output(const Record& record)
+    {
+        _in_output = true;
+
+        std::shared_ptr<const log::Callback> callback;
+        {
+            std::lock_guard<std::mutex> lock(_callback_mutex);
+            callback = _callback;
+        }
+
+        if (!callback ||
+            !(*callback)(record.level, record.message, record.filename, record.filenumber)) {
+            print(record);
+        }
+
+        _in_output = false;
+    }
+
+    static void print(const Record& record)
+    {
+#if ANDROID
+        switch (record.level) {
+            case log::Level::Debug:
+                __android_log_print(ANDROID_LOG_DEBUG, "Mavsdk", "%s", record.message.c_str());
+                break;
+            case log::Level::Info:
+                __android_log_print(ANDROID_LOG_INFO, "Mavsdk", "%s", record.message.c_str());
+                break;
+            case log::Level::Warn:
+                __android_log_print(ANDROID_LOG_WARN, "Mavsdk", "%s", record.message.c_str());
+                break;
+            case log::Level::Err:
+                __android_log_print(ANDROID_LOG_ERROR, "Mavsdk", "%s", record.message.c_str());
+                break;
+        }
+#else
+        switch (record.level) {
+            case log::Level::Debug:
+                set_color(Color::GREEN);
+                break;
+            case log::Level::Info:
+                set_color(Color::BLUE);
+                break;
+            case log::Level::Warn:
+                set_color(Color::YELLOW);
+                break;
+            case log::Level::Err:
+                set_color(Color::RED);
+                break;
+        }
+
+        // Time output taken from:
+        // https://stackoverflow.com/questions/16357999#answer-16358264
+        struct tm* timeinfo = localtime(&record.time);
+        char time_buffer[10]{}; // We need 8 characters + \0
+        strftime(time_buffer, sizeof(time_buffer), "%I:%M:%S", timeinfo);
+        std::cout << "[" << time_buffer;
+
+        switch (record.level) {
+            case log::Level::Debug:
+                std::cout << "|Debug] ";
+                break;
+            case log::Level::Info:
+                std::cout << "|Info ] ";
+                break;
+            case log::Level::Warn:
+                std::cout << "|Warn ] ";
+                break;
+            case log::Level::Err:
+                std::cout << "|Error] ";
+                break;
+        }
+
+        set_color(Color::RESET);
+
+        std::cout << record.message;
+        std::cout << " (" << record.filename << ":" << std::dec << record.filenumber << ")";
+
+        std::cout << std::endl;
+#endif
+    }
+
+    ThreadPool _pool{1, 1024};
+    std::atomic<bool> _async{true};
+
+    std::mutex _callback_mutex{};
+    std::shared_ptr<const log::Callback> _callback{};
+
+    static thread_local bool _in_output;
+};
+
+thread_local bool Logger::_in_output = false;
+
+} // namespace
+
+void log_message(log::Level level, const char* filename, int filenumber, std::string message)
+{
+    Logger::instance().write(level, filename, filenumber, std::move(message));
+}
+
+namespace log {
+
+void subscribe(const Callback& callback)
+{
+    Logger::instance().set_callback(callback);
+}
+
+void flush()
+{
+    Logger::instance().flush();
+}
+
+} // namespace log
+
 } // namespace mavsdk
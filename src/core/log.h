@@ -1,6 +1,8 @@
 #pragma once
 
 #include <sstream>
+#include <string>
+#include "log_callback.h"
 
 #if defined(ANDROID)
 #include <android/log.h>
@@ -17,9 +19,30 @@
 #define __FILENAME__ __FILE__
 #endif
 
+// Log statements below this level are compiled out, including the
+// evaluation of their arguments: 0 debug, 1 info, 2 warn, 3 error.
+#ifndef MAVSDK_LOG_LEVEL_MIN
+#define MAVSDK_LOG_LEVEL_MIN 0
+#endif
+
+#if MAVSDK_LOG_LEVEL_MIN > 0
+#define LogDebug() while (false) LogDebugDetailed(__FILENAME__, __LINE__)
+#else
 #define LogDebug() LogDebugDetailed(__FILENAME__, __LINE__)
+#endif
+
+#if MAVSDK_LOG_LEVEL_MIN > 1
+#define LogInfo() while (false) LogInfoDetailed(__FILENAME__, __LINE__)
+#else
 #define LogInfo() LogInfoDetailed(__FILENAME__, __LINE__)
+#endif
+
+#if MAVSDK_LOG_LEVEL_MIN > 2
+#define LogWarn() while (false) LogWarnDetailed(__FILENAME__, __LINE__)
+#else
 #define LogWarn() LogWarnDetailed(__FILENAME__, __LINE__)
+#endif
+
 #define LogErr() LogErrDetailed(__FILENAME__, __LINE__)
 
 namespace mavsdk {
@@ -28,6 +51,10 @@ enum class Color { RED, GREEN, YELLOW, BLUE, GRAY, RESET };
 
 void set_color(Color color);
 
+// Hands a finished message to the log sink. The sink writes it on a
+// background thread, so logging doesn't block on the terminal.
+void log_message(log::Level level, const char* filename, int filenumber, std::string message);
+
 class LogDetailed {
 public:
     LogDetailed(const char* filename, int filenumber) :
@@ -44,79 +71,14 @@ public:
 
     virtual ~LogDetailed()
     {
-#if ANDROID
-        switch (_log_level) {
-            case LogLevel::Debug:
-                __android_log_print(ANDROID_LOG_DEBUG, "Mavsdk", "%s", _s.str().c_str());
-                break;
-            case LogLevel::Info:
-                __android_log_print(ANDROID_LOG_INFO, "Mavsdk", "%s", _s.str().c_str());
-                break;
-            case LogLevel::Warn:
-                __android_log_print(ANDROID_LOG_WARN, "Mavsdk", "%s", _s.str().c_str());
-                break;
-            case LogLevel::Err:
-                __android_log_print(ANDROID_LOG_ERROR, "Mavsdk", "%s", _s.str().c_str());
-                break;
-        }
-        // Unused:
-        (void)_caller_filename;
-        (void)_caller_filenumber;
-#else
-
-        switch (_log_level) {
-            case LogLevel::Debug:
-                set_color(Color::GREEN);
-                break;
-            case LogLevel::Info:
-                set_color(Color::BLUE);
-                break;
-            case LogLevel::Warn:
-                set_color(Color::YELLOW);
-                break;
-            case LogLevel::Err:
-                set_color(Color::RED);
-                break;
-        }
-
-        // Time output taken from:
-        // https://stackoverflow.com/questions/16357999#answer-16358264
-        time_t rawtime;
-        time(&rawtime);
-        struct tm* timeinfo = localtime(&rawtime);
-        char time_buffer[10]{}; // We need 8 characters + \0
-        strftime(time_buffer, sizeof(time_buffer), "%I:%M:%S", timeinfo);
-        std::cout << "[" << time_buffer;
-
-        switch (_log_level) {
-            case LogLevel::Debug:
-                std::cout << "|Debug] ";
-                break;
-            case LogLevel::Info:
-                std::cout << "|Info ] ";
-                break;
-            case LogLevel::Warn:
-                std::cout << "|Warn ] ";
-                break;
-            case LogLevel::Err:
-                std::cout << "|Error] ";
-                break;
-        }
-
-        set_color(Color::RESET);
-
-        std::cout << _s.str();
-        std::cout << " (" << _caller_filename << ":" << std::dec << _caller_filenumber << ")";
-
-        std::cout << std::endl;
-#endif
+        log_message(_log_level, _caller_filename, _caller_filenumber, _s.str());
     }
 
     LogDetailed(const mavsdk::LogDetailed&) = delete;
     void operator=(const mavsdk::LogDetailed&) = delete;
 
 protected:
-    enum LogLevel { Debug, Info, Warn, Err } _log_level = LogLevel::Debug;
+    log::Level _log_level = log::Level::Debug;
 
 private:
     std::stringstream _s;
@@ -128,7 +90,7 @@ class LogDebugDetailed : public LogDetailed {
 public:
     LogDebugDetailed(const char* filename, int filenumber) : LogDetailed(filename, filenumber)
     {
-        _log_level = LogLevel::Debug;
+        _log_level = log::Level::Debug;
     }
 };
 
@@ -136,7 +98,7 @@ class LogInfoDetailed : public LogDetailed {
 public:
     LogInfoDetailed(const char* filename, int filenumber) : LogDetailed(filename, filenumber)
     {
-        _log_level = LogLevel::Info;
+        _log_level = log::Level::Info;
     }
 };
 
@@ -144,7 +106,7 @@ class LogWarnDetailed : public LogDetailed {
 public:
     LogWarnDetailed(const char* filename, int filenumber) : LogDetailed(filename, filenumber)
     {
-        _log_level = LogLevel::Warn;
+        _log_level = log::Level::Warn;
     }
 };
 
@@ -152,7 +114,7 @@ class LogErrDetailed : public LogDetailed {
 public:
     LogErrDetailed(const char* filename, int filenumber) : LogDetailed(filename, filenumber)
     {
-        _log_level = LogLevel::Err;
+        _log_level = log::Level::Err;
     }
 };
 
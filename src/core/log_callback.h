@@ -0,0 +1,49 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+namespace mavsdk {
+namespace log {
+
+/**
+ * @brief Log levels.
+ */
+enum class Level : int {
+    Debug = 0, /**< @brief Debug messages. */
+    Info = 1, /**< @brief Informational messages. */
+    Warn = 2, /**< @brief Warnings. */
+    Err = 3 /**< @brief Errors. */
+};
+
+/**
+ * @brief Callback type for log messages.
+ *
+ * The message is passed as it was logged, without time stamp, level or color.
+ *
+ * @return true to drop the message, false to also print it as usual.
+ */
+typedef std::function<bool(
+    Level level, const std::string& message, const std::string& file, int line)>
+    Callback;
+
+/**
+ * @brief Route all log messages to a callback, e.g. into an application's own logger.
+ *
+ * The callback is called in order on a background thread which writes the log, so it doesn't
+ * slow down the threads logging. Pass nullptr to unsubscribe.
+ *
+ * Messages below the minimum level MAVSDK was compiled with (`MAVSDK_LOG_LEVEL_MIN`) are
+ * never created and therefore don't arrive here either.
+ *
+ * @param callback Callback to call for each message.
+ */
+void subscribe(const Callback& callback);
+
+/**
+ * @brief Block until all messages logged so far are written.
+ */
+void flush();
+
+} // namespace log
+} // namespace mavsdk
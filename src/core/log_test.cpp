@@ -0,0 +1,124 @@
+// Compile debug and info statements out in this file only.
+#define MAVSDK_LOG_LEVEL_MIN 2
+
+#include "log.h"
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+struct Message {
+    log::Level level;
+    std::string message;
+    std::string file;
+    int line;
+};
+
+int count_evaluation(int& counter)
+{
+    return ++counter;
+}
+
+} // namespace
+
+TEST(Log, CallbackGetsMessage)
+{
+    std::vector<Message> messages;
+    log::subscribe([&messages](
+                       log::Level level,
+                       const std::string& message,
+                       const std::string& file,
+                       int line) {
+        messages.push_back(Message{level, message, file, line});
+        return true;
+    });
+
+    const int line = __LINE__ + 1;
+    LogWarn() << "Something " << 42;
+    log::flush();
+
+    log::subscribe(nullptr);
+
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0].level, log::Level::Warn);
+    EXPECT_EQ(messages[0].message, "Something 42");
+    EXPECT_EQ(messages[0].file, "log_test.cpp");
+    EXPECT_EQ(messages[0].line, line);
+}
+
+TEST(Log, CallbackCanDropMessage)
+{
+    log::subscribe([](log::Level, const std::string&, const std::string&, int) { return true; });
+
+    testing::internal::CaptureStdout();
+    LogErr() << "Dropped";
+    log::flush();
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "");
+
+    log::subscribe([](log::Level, const std::string&, const std::string&, int) { return false; });
+
+    testing::internal::CaptureStdout();
+    LogErr() << "Printed";
+    log::flush();
+    EXPECT_NE(testing::internal::GetCapturedStdout().find("Printed"), std::string::npos);
+
+    log::subscribe(nullptr);
+}
+
+TEST(Log, KeepsOrderOfEachThread)
+{
+    std::mutex mutex;
+    std::vector<std::string> messages;
+    log::subscribe([&](log::Level, const std::string& message, const std::string&, int) {
+        std::lock_guard<std::mutex> lock(mutex);
+        messages.push_back(message);
+        return true;
+    });
+
+    const int num_threads = 4;
+    const int num_messages = 1000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([i]() {
+            for (int j = 0; j < num_messages; ++j) {
+                LogWarn() << i << " " << j;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    log::flush();
+    log::subscribe(nullptr);
+
+    ASSERT_EQ(messages.size(), size_t(num_threads * num_messages));
+
+    std::vector<int> next(num_threads, 0);
+    for (const auto& message : messages) {
+        const int thread = std::stoi(message.substr(0, message.find(' ')));
+        const int number = std::stoi(message.substr(message.find(' ') + 1));
+        EXPECT_EQ(number, next[thread]);
+        next[thread] = number + 1;
+    }
+}
+
+TEST(Log, BelowMinimumLevelIsCompiledOut)
+{
+    int counter = 0;
+
+    LogDebug() << count_evaluation(counter);
+    LogInfo() << count_evaluation(counter);
+    EXPECT_EQ(counter, 0);
+
+    log::subscribe([](log::Level, const std::string&, const std::string&, int) { return true; });
+    LogWarn() << count_evaluation(counter);
+    LogErr() << count_evaluation(counter);
+    EXPECT_EQ(counter, 2);
+    log::flush();
+    log::subscribe(nullptr);
+}
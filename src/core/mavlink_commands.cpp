@@ -5,14 +5,10 @@
 
 namespace mavsdk {
 
-// TODO: Currently the mavlink command handling is made in a way to only
-//       process one command at any time. Therefore, the work state is global
-//       for this whole class.
-//       The limitation is made because:
-//       - We are not sure what exactly will happen if the commands are sent in parallel
-//         and what kind of edge cases we might run into.
-//       - The queue used does not support going through and checking each and every
-//         item yet.
+// Several commands can be in flight at the same time, e.g. a slow camera
+// command does not hold up commands to the autopilot. Only commands with
+// the same identifier (command id and target component) are sent one after
+// the other because their acks could not be told apart.
 
 MAVLinkCommands::MAVLinkCommands(SystemImpl& parent) : _parent(parent)
 {
@@ -67,7 +63,9 @@ MAVLinkCommands::Result MAVLinkCommands::send_command(const MAVLinkCommands::Com
 }
 
 void MAVLinkCommands::queue_command_async(
-    const CommandInt& command, command_result_callback_t callback)
+    const CommandInt& command,
+    command_result_callback_t callback,
+    command_progress_callback_t progress_callback)
 {
     // LogDebug() << "Command " << (int)(command.command) << " to send to "
     //  << (int)(command.target_system_id)<< ", " << (int)(command.target_component_id;
@@ -92,12 +90,19 @@ void MAVLinkCommands::queue_command_async(
         command.params.z);
 
     new_work.callback = callback;
-    new_work.mavlink_command = command.command;
-    _work_queue.push_back(new_work);
+    if (progress_callback) {
+        new_work.progress_callback = progress_callback;
+        new_work.strand = std::make_shared<Strand>();
+    }
+    new_work.identifier.command = command.command;
+    new_work.identifier.target_component_id = command.target_component_id;
+    queue_work(new_work);
 }
 
 void MAVLinkCommands::queue_command_async(
-    const CommandLong& command, command_result_callback_t callback)
+    const CommandLong& command,
+    command_result_callback_t callback,
+    command_progress_callback_t progress_callback)
 {
     // LogDebug() << "Command " << (int)(command.command) << " to send to "
     //  << (int)(command.target_system_id)<< ", " << (int)(command.target_component_id;
@@ -120,8 +125,59 @@ void MAVLinkCommands::queue_command_async(
         command.params.param7);
 
     new_work.callback = callback;
-    new_work.mavlink_command = command.command;
-    _work_queue.push_back(new_work);
+    if (progress_callback) {
+        new_work.progress_callback = progress_callback;
+        new_work.strand = std::make_shared<Strand>();
+    }
+    new_work.identifier.command = command.command;
+    new_work.identifier.target_component_id = command.target_component_id;
+    queue_work(new_work);
+}
+
+void MAVLinkCommands::queue_work(Work& work)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        work.id = ++_last_id;
+        _queued.push_back(work);
+    }
+    _parent.wake_up_system_thread();
+}
+
+MAVLinkCommands::Work* MAVLinkCommands::find_in_flight(uint16_t command, uint8_t component_id)
+{
+    Identifier identifier{};
+    identifier.command = command;
+    identifier.target_component_id = component_id;
+
+    auto it = _in_flight.find(identifier.key());
+    if (it != _in_flight.end()) {
+        return &it->second;
+    }
+
+    // A command sent to all components is acked by whichever component
+    // handles it.
+    identifier.target_component_id = MAV_COMP_ID_ALL;
+    it = _in_flight.find(identifier.key());
+    if (it != _in_flight.end()) {
+        return &it->second;
+    }
+
+    // Some components ack on behalf of others, e.g. a companion computer for
+    // its camera. As long as only one command with this id is in flight, the
+    // ack can only be meant for that one.
+    Work* match = nullptr;
+    for (auto& entry : _in_flight) {
+        if (entry.second.identifier.command != command) {
+            continue;
+        }
+        if (match != nullptr) {
+            return nullptr;
+        }
+        match = &entry.second;
+    }
+
+    return match;
 }
 
 void MAVLinkCommands::receive_command_ack(mavlink_message_t message)
@@ -131,155 +187,216 @@ void MAVLinkCommands::receive_command_ack(mavlink_message_t message)
 
     // LogDebug() << "We got an ack: " << command_ack.command;
 
-    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
+    std::lock_guard<std::mutex> lock(_mutex);
 
-    if (!work) {
+    Work* work = find_in_flight(command_ack.command, message.compid);
+    if (work == nullptr) {
+        LogWarn() << "Command ack " << int(command_ack.command) << " from component "
+                  << int(message.compid) << " not matching any command in flight";
         return;
     }
 
-    if (work->mavlink_command != command_ack.command) {
-        // If the command does not match with our current command, ignore it.
-        LogWarn() << "Command ack " << int(command_ack.command)
-                  << " not matching our current command: " << work->mavlink_command;
-        return;
-    }
+    Result result = Result::UNKNOWN_ERROR;
 
     switch (command_ack.result) {
         case MAV_RESULT_ACCEPTED:
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            work_queue_guard.pop_front();
-            call_callback(work->callback, Result::SUCCESS, 1.0f);
+            result = Result::SUCCESS;
             break;
 
         case MAV_RESULT_DENIED:
-            LogWarn() << "command denied (" << work->mavlink_command << ").";
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            work_queue_guard.pop_front();
-            call_callback(work->callback, Result::COMMAND_DENIED, NAN);
+            LogWarn() << "command denied (" << work->identifier.command << ").";
+            result = Result::COMMAND_DENIED;
             break;
 
         case MAV_RESULT_UNSUPPORTED:
-            LogWarn() << "command unsupported (" << work->mavlink_command << ").";
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            work_queue_guard.pop_front();
-            call_callback(work->callback, Result::COMMAND_DENIED, NAN);
+            LogWarn() << "command unsupported (" << work->identifier.command << ").";
+            result = Result::COMMAND_DENIED;
             break;
 
         case MAV_RESULT_TEMPORARILY_REJECTED:
-            LogWarn() << "command temporarily rejected (" << work->mavlink_command << ").";
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            work_queue_guard.pop_front();
-            call_callback(work->callback, Result::COMMAND_DENIED, NAN);
+            LogWarn() << "command temporarily rejected (" << work->identifier.command << ").";
+            result = Result::COMMAND_DENIED;
             break;
 
         case MAV_RESULT_FAILED:
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            work_queue_guard.pop_front();
-            call_callback(work->callback, Result::COMMAND_DENIED, NAN);
+            result = Result::COMMAND_DENIED;
             break;
 
         case MAV_RESULT_IN_PROGRESS:
             if (static_cast<int>(command_ack.progress) != 255) {
                 LogInfo() << "progress: " << static_cast<int>(command_ack.progress) << " % ("
-                          << work->mavlink_command << ").";
+                          << work->identifier.command << ").";
             }
             // If we get a progress update, we can raise the timeout
             // to something higher because we know the initial command
             // has arrived. A possible timeout for this case is the initial
             // timeout * the possible retries because this should match the
             // case where there is no progress update and we keep trying.
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            _parent.register_timeout_handler(
-                std::bind(&MAVLinkCommands::receive_timeout, this),
-                work->retries_to_do * work->timeout_s,
-                &_timeout_cookie);
-            // FIXME: We can only call callbacks with promises once, so let's not do it
-            //        on IN_PROGRESS.
-            // call_callback(work->callback, Result::IN_PROGRESS, command_ack.progress /
-            //               100.0f);
-            break;
+            _parent.unregister_timeout_handler(work->timeout_cookie);
+            register_timeout(*work, work->retries_to_do * work->timeout_s);
+            // The result callback is only called once, with the final result,
+            // so progress goes to its own callback.
+            call_progress_callback(
+                *work,
+                (static_cast<int>(command_ack.progress) != 255) ?
+                    static_cast<float>(command_ack.progress) / 100.0f :
+                    NAN);
+            return;
 
         default:
             LogWarn() << "Received unknown ack.";
-            break;
+            return;
     }
+
+    _parent.unregister_timeout_handler(work->timeout_cookie);
+    call_callback(*work, result, (result == Result::SUCCESS) ? 1.0f : NAN);
+    _in_flight.erase(work->identifier.key());
+
+    // A command with the same identifier might be waiting.
+    _parent.wake_up_system_thread();
 }
 
-void MAVLinkCommands::receive_timeout()
+void MAVLinkCommands::receive_timeout(Identifier identifier, uint64_t id)
 {
-    // If we're not waiting, we ignore this.
-    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
+    std::lock_guard<std::mutex> lock(_mutex);
 
-    if (!work) {
-        LogErr() << "Received timeout without item in queue.";
+    auto it = _in_flight.find(identifier.key());
+    if (it == _in_flight.end() || it->second.id != id) {
+        // It has been acked in the meantime.
         return;
     }
+    Work& work = it->second;
 
-    if (work->retries_to_do > 0) {
+    if (work.retries_to_do > 0) {
         // We're not sure the command arrived, let's retransmit.
-        LogWarn() << "sending again, retries to do: " << work->retries_to_do << "  ("
-                  << work->mavlink_command << ").";
-        if (!_parent.send_message(work->mavlink_message)) {
-            LogErr() << "connection send error in retransmit (" << work->mavlink_command << ").";
-            work_queue_guard.pop_front();
-            call_callback(work->callback, Result::CONNECTION_ERROR, NAN);
-
-        } else {
-            --work->retries_to_do;
-            _parent.register_timeout_handler(
-                std::bind(&MAVLinkCommands::receive_timeout, this),
-                work->timeout_s,
-                &_timeout_cookie);
-        }
+        LogWarn() << "sending again, retries to do: " << work.retries_to_do << "  ("
+                  << work.identifier.command << ").";
+        --work.retries_to_do;
+        send(work);
+        register_timeout(work, work.timeout_s);
 
     } else {
         // We have tried retransmitting, giving up now.
-        LogErr() << "Retrying failed (" << work->mavlink_command << ")";
+        LogErr() << "Retrying failed (" << work.identifier.command << ")";
+
+        call_callback(work, Result::TIMEOUT, NAN);
+        _in_flight.erase(it);
+        _parent.wake_up_system_thread();
+    }
+}
 
-        work_queue_guard.pop_front();
+void MAVLinkCommands::register_timeout(Work& work, double timeout_s)
+{
+    _parent.register_timeout_handler(
+        std::bind(&MAVLinkCommands::receive_timeout, this, work.identifier, work.id),
+        timeout_s,
+        &work.timeout_cookie);
+}
 
-        call_callback(work->callback, Result::TIMEOUT, NAN);
+void MAVLinkCommands::send(const Work& work)
+{
+    // Sending only queues the message. If it can't be sent on any connection
+    // we hear about it later, possibly from another thread or from within
+    // send_message() while _mutex is still held.
+    SendFailure failure{};
+    failure.key = work.identifier.key();
+    failure.id = work.id;
+    failure.retries_to_do = work.retries_to_do;
+
+    mavlink_message_t message = work.mavlink_message;
+    const bool queued = _parent.send_message(message, [this, failure](bool sent) {
+        if (!sent) {
+            receive_send_failure(failure);
+        }
+    });
+    if (!queued) {
+        LogWarn() << "command not queued on every connection (" << work.identifier.command
+                  << ")";
     }
 }
 
-void MAVLinkCommands::do_work()
+void MAVLinkCommands::receive_send_failure(SendFailure failure)
 {
-    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
+    {
+        std::lock_guard<std::mutex> lock(_send_failures_mutex);
+        _send_failures.push_back(failure);
+    }
+    _parent.wake_up_system_thread();
+}
 
-    if (!work) {
-        // Nothing to do.
-        return;
+void MAVLinkCommands::handle_send_failures()
+{
+    std::vector<SendFailure> send_failures;
+    {
+        std::lock_guard<std::mutex> lock(_send_failures_mutex);
+        send_failures.swap(_send_failures);
     }
 
-    if (!work->already_sent) {
-        // LogDebug() << "sending it the first time (" << work->mavlink_command << ")";
-        if (!_parent.send_message(work->mavlink_message)) {
-            LogErr() << "connection send error (" << work->mavlink_command << ")";
-            work_queue_guard.pop_front();
-            call_callback(work->callback, Result::CONNECTION_ERROR, NAN);
-        } else {
-            work->already_sent = true;
-            _parent.register_timeout_handler(
-                std::bind(&MAVLinkCommands::receive_timeout, this),
-                work->timeout_s,
-                &_timeout_cookie);
+    for (const auto& failure : send_failures) {
+        auto it = _in_flight.find(failure.key);
+        // Unless it has been acked or sent again in the meantime.
+        if (it == _in_flight.end() || it->second.id != failure.id ||
+            it->second.retries_to_do != failure.retries_to_do) {
+            continue;
         }
+
+        LogErr() << "connection send error (" << it->second.identifier.command << ")";
+        _parent.unregister_timeout_handler(it->second.timeout_cookie);
+        call_callback(it->second, Result::CONNECTION_ERROR, NAN);
+        _in_flight.erase(it);
     }
 }
 
-void MAVLinkCommands::call_callback(
-    const command_result_callback_t& callback, Result result, float progress)
+void MAVLinkCommands::do_work()
 {
-    if (!callback) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    handle_send_failures();
+
+    // Send everything that does not have to wait for a command with the same
+    // identifier. The queue is walked in order, so these still go out in the
+    // order they were queued.
+    for (auto it = _queued.begin(); it != _queued.end(); /* manual incrementation */) {
+        const uint32_t key = it->identifier.key();
+        if (_in_flight.find(key) != _in_flight.end()) {
+            ++it;
+            continue;
+        }
+
+        // LogDebug() << "sending it the first time (" << it->identifier.command << ")";
+        Work& work = _in_flight.emplace(key, *it).first->second;
+        send(work);
+        register_timeout(work, work.timeout_s);
+        it = _queued.erase(it);
+    }
+}
+
+void MAVLinkCommands::call_callback(const Work& work, Result result, float progress)
+{
+    if (!work.callback) {
         return;
     }
 
     // It seems that we need to queue the callback on the thread pool otherwise
     // we lock ourselves out when we send a command in the callback receiving a command result.
-    _parent.call_user_callback([callback, result, progress]() { callback(result, progress); });
+    const auto callback = work.callback;
+    if (work.strand) {
+        _parent.call_user_callback(
+            *work.strand, [callback, result, progress]() { callback(result, progress); });
+    } else {
+        _parent.call_user_callback([callback, result, progress]() { callback(result, progress); });
+    }
+}
+
+void MAVLinkCommands::call_progress_callback(const Work& work, float progress)
+{
+    if (!work.progress_callback) {
+        return;
+    }
+
+    const auto progress_callback = work.progress_callback;
+    _parent.call_user_callback(
+        *work.strand, [progress_callback, progress]() { progress_callback(progress); });
 }
 
 } // namespace mavsdk
@@ -1,15 +1,19 @@
 #pragma once
 
 #include "mavlink_include.h"
-#include "locked_queue.h"
 #include <cstdint>
+#include <deque>
 #include <string>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace mavsdk {
 
 class SystemImpl;
+class Strand;
 
 class MAVLinkCommands {
 public:
@@ -19,7 +23,7 @@ public:
     enum class Result {
         SUCCESS = 0,
         NO_SYSTEM,
-        CONNECTION_ERROR,
+        CONNECTION_ERROR, // Could not be sent on any connection.
         BUSY,
         COMMAND_DENIED,
         TIMEOUT,
@@ -28,6 +32,9 @@ public:
     };
 
     typedef std::function<void(Result, float)> command_result_callback_t;
+    // Called for every IN_PROGRESS ack with the progress from 0 to 1, or NAN
+    // if the component does not report how far it is.
+    typedef std::function<void(float)> command_progress_callback_t;
 
     struct CommandInt {
         uint8_t target_system_id{0};
@@ -93,8 +100,16 @@ public:
     Result send_command(const CommandInt& command);
     Result send_command(const CommandLong& command);
 
-    void queue_command_async(const CommandInt& command, command_result_callback_t callback);
-    void queue_command_async(const CommandLong& command, command_result_callback_t callback);
+    // The result callback is called once with the final result. Progress
+    // updates go to progress_callback before that, in order.
+    void queue_command_async(
+        const CommandInt& command,
+        command_result_callback_t callback,
+        command_progress_callback_t progress_callback = nullptr);
+    void queue_command_async(
+        const CommandLong& command,
+        command_result_callback_t callback,
+        command_progress_callback_t progress_callback = nullptr);
 
     void do_work();
 
@@ -105,24 +120,61 @@ public:
     const MAVLinkCommands& operator=(const MAVLinkCommands&) = delete;
 
 private:
+    // Acks only carry the command id and come from the component that was
+    // addressed, so that is what identifies a command in flight.
+    struct Identifier {
+        uint16_t command{0};
+        uint8_t target_component_id{0};
+
+        uint32_t key() const { return (uint32_t(command) << 8) | target_component_id; }
+    };
+
     struct Work {
         int retries_to_do{3};
         double timeout_s{0.5};
-        uint16_t mavlink_command{0};
-        bool already_sent{false};
+        Identifier identifier{};
+        uint64_t id{0};
         mavlink_message_t mavlink_message{};
         command_result_callback_t callback{};
+        command_progress_callback_t progress_callback{};
+        // Only set with a progress callback, so that progress updates cannot
+        // overtake each other or the result.
+        std::shared_ptr<Strand> strand{};
+        void* timeout_cookie{nullptr};
+    };
+
+    // A message of the work in flight which could not be sent. The number
+    // of retries tells which transmission it was.
+    struct SendFailure {
+        uint32_t key{0};
+        uint64_t id{0};
+        int retries_to_do{0};
     };
 
+    void queue_work(Work& work);
+    void send(const Work& work);
+    void receive_send_failure(SendFailure failure);
+    void handle_send_failures();
     void receive_command_ack(mavlink_message_t message);
-    void receive_timeout();
+    void receive_timeout(Identifier identifier, uint64_t id);
+    void register_timeout(Work& work, double timeout_s);
+    Work* find_in_flight(uint16_t command, uint8_t component_id);
 
-    void call_callback(const command_result_callback_t& callback, Result result, float progress);
+    void call_callback(const Work& work, Result result, float progress);
+    void call_progress_callback(const Work& work, float progress);
 
     SystemImpl& _parent;
-    LockedQueue<Work> _work_queue{};
 
-    void* _timeout_cookie = nullptr;
+    std::mutex _mutex{};
+    // Commands which have not been sent yet. A command waits here while
+    // another one with the same identifier is in flight.
+    std::deque<Work> _queued{};
+    std::unordered_map<uint32_t, Work> _in_flight{};
+    uint64_t _last_id{0};
+
+    // Reported by the send queues and handled in do_work().
+    std::mutex _send_failures_mutex{};
+    std::vector<SendFailure> _send_failures{};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,105 @@
+#include "mavlink_commands.h"
+#include "mavsdk.h"
+#include "mocks/fake_vehicle.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+
+#if defined(LINUX)
+
+using namespace mavsdk;
+using mavsdk::testing::FakeVehicle;
+using mavsdk::testing::SystemImplAccess;
+
+namespace {
+
+typedef MAVLinkCommands::Result Result;
+
+struct Outcome {
+    Result result;
+    std::vector<float> progress;
+};
+
+} // namespace
+
+class MAVLinkCommandsTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(
+            _mavsdk.add_tcp_connection("127.0.0.1", _vehicle.port()), ConnectionResult::SUCCESS);
+        for (unsigned i = 0; i < 500 && !_mavsdk.is_connected(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ASSERT_TRUE(_mavsdk.is_connected());
+    }
+
+    // Sends the command and collects the progress reported until the result.
+    Outcome send(MAVLinkCommands::CommandLong& command)
+    {
+        auto progress = std::make_shared<std::vector<float>>();
+        auto prom = std::make_shared<std::promise<Outcome>>();
+        auto fut = prom->get_future();
+
+        SystemImplAccess sender(_mavsdk.system());
+        sender.system_impl().send_command_async(
+            command,
+            [prom, progress](Result result, float) {
+                prom->set_value(Outcome{result, *progress});
+            },
+            [progress](float value) { progress->push_back(value); });
+
+        if (fut.wait_for(std::chrono::seconds(1)) != std::future_status::ready) {
+            ADD_FAILURE() << "No result for command " << command.command;
+            return Outcome{Result::UNKNOWN_ERROR, {}};
+        }
+        return fut.get();
+    }
+
+    FakeVehicle _vehicle{};
+    Mavsdk _mavsdk{};
+};
+
+TEST_F(MAVLinkCommandsTest, ReportsProgressBeforeResult)
+{
+    _vehicle.set_command_handler([](FakeVehicle& vehicle, const mavlink_command_long_t& command) {
+        vehicle.send_ack(command.command, MAV_RESULT_IN_PROGRESS, 25);
+        // 255 means the progress is not known.
+        vehicle.send_ack(command.command, MAV_RESULT_IN_PROGRESS, 255);
+        vehicle.send_ack(command.command, MAV_RESULT_IN_PROGRESS, 75);
+        vehicle.send_ack(command.command, MAV_RESULT_ACCEPTED);
+    });
+
+    MAVLinkCommands::CommandLong command{};
+    command.command = MAV_CMD_PREFLIGHT_CALIBRATION;
+    command.target_component_id = MAV_COMP_ID_AUTOPILOT1;
+
+    const auto outcome = send(command);
+    EXPECT_EQ(outcome.result, Result::SUCCESS);
+    ASSERT_EQ(outcome.progress.size(), 3u);
+    EXPECT_FLOAT_EQ(outcome.progress[0], 0.25f);
+    EXPECT_TRUE(std::isnan(outcome.progress[1]));
+    EXPECT_FLOAT_EQ(outcome.progress[2], 0.75f);
+}
+
+TEST_F(MAVLinkCommandsTest, AcceptsAckFromOtherComponent)
+{
+    // E.g. a companion computer acking for the camera attached to it.
+    _vehicle.set_command_handler([](FakeVehicle& vehicle, const mavlink_command_long_t& command) {
+        vehicle.send_ack(command.command, MAV_RESULT_ACCEPTED, 0, MAV_COMP_ID_CAMERA);
+    });
+
+    MAVLinkCommands::CommandLong command{};
+    command.command = MAV_CMD_IMAGE_START_CAPTURE;
+    command.target_component_id = MAV_COMP_ID_AUTOPILOT1;
+
+    const auto outcome = send(command);
+    EXPECT_EQ(outcome.result, Result::SUCCESS);
+    EXPECT_TRUE(outcome.progress.empty());
+}
+
+#endif
@@ -4,4 +4,16 @@
 #pragma GCC system_header
 #endif
 
+#include "x25_crc.h"
+
+// Have the MAVLink headers use the table-driven CRC when packing and parsing
+// messages. This only works if they have not been included already.
+#if !defined(MAVLINK_STX) && !defined(HAVE_CRC_ACCUMULATE)
+#define HAVE_CRC_ACCUMULATE
+static inline void crc_accumulate(uint8_t data, uint16_t* crcAccum)
+{
+    *crcAccum = mavsdk::X25Crc::accumulate(*crcAccum, data);
+}
+#endif
+
 #include "mavlink/v2.0/common/mavlink.h"
@@ -0,0 +1,83 @@
+#include "mavlink_message_handler_table.h"
+#include "log.h"
+
+namespace mavsdk {
+
+void MAVLinkMessageHandlerTable::register_handler(
+    uint16_t msg_id, callback_t callback, const void* cookie)
+{
+    std::lock_guard<std::mutex> lock(_write_mutex);
+
+    auto new_table = std::make_shared<Table>(*std::atomic_load(&_table));
+
+    Entry entry{callback, cookie, std::make_shared<std::atomic<bool>>(true)};
+    (*new_table)[msg_id].push_back(entry);
+
+    std::atomic_store(&_table, std::shared_ptr<const Table>(std::move(new_table)));
+}
+
+void MAVLinkMessageHandlerTable::unregister_handler(uint16_t msg_id, const void* cookie)
+{
+    remove_if([msg_id, cookie](uint32_t entry_msg_id, const Entry& entry) {
+        return entry_msg_id == msg_id && entry.cookie == cookie;
+    });
+}
+
+void MAVLinkMessageHandlerTable::unregister_all(const void* cookie)
+{
+    remove_if([cookie](uint32_t, const Entry& entry) { return entry.cookie == cookie; });
+}
+
+template<typename Predicate> void MAVLinkMessageHandlerTable::remove_if(Predicate should_remove)
+{
+    std::lock_guard<std::mutex> lock(_write_mutex);
+
+    auto new_table = std::make_shared<Table>(*std::atomic_load(&_table));
+
+    for (auto table_it = new_table->begin(); table_it != new_table->end(); /* no ++it */) {
+        auto& entries = table_it->second;
+        for (auto it = entries.begin(); it != entries.end(); /* no ++it */) {
+            if (should_remove(table_it->first, *it)) {
+                // Snapshots that are being dispatched right now still
+                // contain the entry, make sure they skip it.
+                *it->active = false;
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (entries.empty()) {
+            table_it = new_table->erase(table_it);
+        } else {
+            ++table_it;
+        }
+    }
+
+    std::atomic_store(&_table, std::shared_ptr<const Table>(std::move(new_table)));
+}
+
+bool MAVLinkMessageHandlerTable::dispatch(const mavlink_message_t& message) const
+{
+    // Holding on to the snapshot keeps it alive even if it is replaced by a
+    // handler or another thread in the meantime.
+    const auto table = std::atomic_load(&_table);
+
+    const auto it = table->find(message.msgid);
+    if (it == table->end()) {
+        return false;
+    }
+
+    for (const auto& entry : it->second) {
+        if (*entry.active) {
+#if MESSAGE_DEBUGGING == 1
+            LogDebug() << "Forwarding msg " << int(message.msgid) << " to "
+                       << size_t(entry.cookie);
+#endif
+            entry.callback(message);
+        }
+    }
+    return true;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mavsdk {
+
+// Maps incoming messages to the handlers registered for their message id.
+//
+// The table is copy-on-write: registering or unregistering builds a new
+// table under a mutex and publishes it atomically. Dispatching only takes a
+// snapshot of the current table and does not lock, so handlers can register
+// and unregister (even from within a handler) while messages are dispatched,
+// and every handler in the snapshot is called exactly once.
+class MAVLinkMessageHandlerTable {
+public:
+    typedef std::function<void(const mavlink_message_t&)> callback_t;
+
+    MAVLinkMessageHandlerTable() = default;
+    ~MAVLinkMessageHandlerTable() = default;
+
+    void register_handler(uint16_t msg_id, callback_t callback, const void* cookie);
+    void unregister_handler(uint16_t msg_id, const void* cookie);
+    void unregister_all(const void* cookie);
+
+    /**
+     * Call all handlers registered for the message id of message.
+     *
+     * A handler that is unregistered while the message is being dispatched
+     * is not called anymore unless it is already running.
+     *
+     * @return true if there was at least one handler for the message id.
+     */
+    bool dispatch(const mavlink_message_t& message) const;
+
+    // Non-copyable
+    MAVLinkMessageHandlerTable(const MAVLinkMessageHandlerTable&) = delete;
+    const MAVLinkMessageHandlerTable& operator=(const MAVLinkMessageHandlerTable&) = delete;
+
+private:
+    struct Entry {
+        callback_t callback;
+        const void* cookie; // This is the identification to unregister.
+        // Shared between all snapshots containing this entry, cleared on
+        // unregister so that older snapshots skip it.
+        std::shared_ptr<std::atomic<bool>> active;
+    };
+
+    typedef std::unordered_map<uint32_t, std::vector<Entry>> Table;
+
+    template<typename Predicate> void remove_if(Predicate should_remove);
+
+    // Writers serialize on this mutex, readers only use the atomic
+    // shared_ptr operations on _table.
+    std::mutex _write_mutex{};
+    std::shared_ptr<const Table> _table{std::make_shared<const Table>()};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,121 @@
+#include "mavlink_message_handler_table.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t make_message(uint32_t msg_id)
+{
+    mavlink_message_t message{};
+    message.msgid = msg_id;
+    return message;
+}
+
+} // namespace
+
+TEST(MAVLinkMessageHandlerTable, CallsHandlersOfMessageIdOnce)
+{
+    MAVLinkMessageHandlerTable table;
+    int heartbeats = 0;
+    int attitudes = 0;
+    const int cookie1 = 0;
+    const int cookie2 = 0;
+
+    table.register_handler(
+        MAVLINK_MSG_ID_HEARTBEAT, [&](const mavlink_message_t&) { ++heartbeats; }, &cookie1);
+    table.register_handler(
+        MAVLINK_MSG_ID_HEARTBEAT, [&](const mavlink_message_t&) { ++heartbeats; }, &cookie2);
+    table.register_handler(
+        MAVLINK_MSG_ID_ATTITUDE, [&](const mavlink_message_t&) { ++attitudes; }, &cookie1);
+
+    EXPECT_TRUE(table.dispatch(make_message(MAVLINK_MSG_ID_HEARTBEAT)));
+    EXPECT_EQ(heartbeats, 2);
+    EXPECT_EQ(attitudes, 0);
+
+    EXPECT_FALSE(table.dispatch(make_message(MAVLINK_MSG_ID_COMMAND_LONG)));
+
+    table.unregister_handler(MAVLINK_MSG_ID_HEARTBEAT, &cookie1);
+    EXPECT_TRUE(table.dispatch(make_message(MAVLINK_MSG_ID_HEARTBEAT)));
+    EXPECT_EQ(heartbeats, 3);
+
+    table.unregister_all(&cookie2);
+    EXPECT_FALSE(table.dispatch(make_message(MAVLINK_MSG_ID_HEARTBEAT)));
+    EXPECT_TRUE(table.dispatch(make_message(MAVLINK_MSG_ID_ATTITUDE)));
+    EXPECT_EQ(attitudes, 1);
+}
+
+TEST(MAVLinkMessageHandlerTable, ChangesFromWithinHandler)
+{
+    MAVLinkMessageHandlerTable table;
+    int first_calls = 0;
+    int second_calls = 0;
+    int added_calls = 0;
+    const int cookie1 = 0;
+    const int cookie2 = 0;
+    const int cookie3 = 0;
+
+    // The first handler removes the second one and adds another one.
+    table.register_handler(
+        MAVLINK_MSG_ID_HEARTBEAT,
+        [&](const mavlink_message_t&) {
+            ++first_calls;
+            table.unregister_all(&cookie2);
+            table.register_handler(
+                MAVLINK_MSG_ID_HEARTBEAT,
+                [&](const mavlink_message_t&) { ++added_calls; },
+                &cookie3);
+        },
+        &cookie1);
+    table.register_handler(
+        MAVLINK_MSG_ID_HEARTBEAT, [&](const mavlink_message_t&) { ++second_calls; }, &cookie2);
+
+    table.dispatch(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    EXPECT_EQ(first_calls, 1);
+    // Removed before it was its turn.
+    EXPECT_EQ(second_calls, 0);
+    // Added during dispatch, so only called for the next message.
+    EXPECT_EQ(added_calls, 0);
+
+    table.unregister_all(&cookie1);
+    table.dispatch(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    EXPECT_EQ(first_calls, 1);
+    EXPECT_EQ(added_calls, 1);
+}
+
+TEST(MAVLinkMessageHandlerTable, RegisterWhileDispatching)
+{
+    MAVLinkMessageHandlerTable table;
+    std::atomic<unsigned> calls{0};
+    const int cookie = 0;
+
+    table.register_handler(
+        MAVLINK_MSG_ID_HEARTBEAT, [&](const mavlink_message_t&) { ++calls; }, &cookie);
+
+    std::atomic<bool> should_exit{false};
+    std::thread writer([&]() {
+        std::vector<int> cookies(100);
+        while (!should_exit) {
+            for (auto& other_cookie : cookies) {
+                table.register_handler(
+                    MAVLINK_MSG_ID_ATTITUDE, [](const mavlink_message_t&) {}, &other_cookie);
+            }
+            for (auto& other_cookie : cookies) {
+                table.unregister_all(&other_cookie);
+            }
+        }
+    });
+
+    const unsigned num_messages = 100000;
+    for (unsigned i = 0; i < num_messages; ++i) {
+        table.dispatch(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    }
+
+    should_exit = true;
+    writer.join();
+
+    EXPECT_EQ(calls, num_messages);
+}
@@ -1,10 +1,27 @@
 #include "mavlink_parameters.h"
 #include "system_impl.h"
+#include <cstdio>
 #include <cstring>
 #include <future>
 
 namespace mavsdk {
 
+namespace {
+
+// PX4 answers with a hash of the param set for this name, so we know whether
+// the params on disk are still valid without downloading them all.
+const char* const hash_check_name = "_HASH_CHECK";
+
+const double get_all_timeout_s = 1.0;
+const double missing_timeout_s = 0.5;
+const unsigned get_all_max_retries = 5;
+const size_t missing_max_per_round = 32;
+
+const double batch_timeout_s = 0.5;
+const unsigned batch_max_retries = 3;
+
+} // namespace
+
 MAVLinkParameters::MAVLinkParameters(SystemImpl& parent) : _parent(parent)
 {
     _parent.register_mavlink_message_handler(
@@ -25,6 +42,8 @@ MAVLinkParameters::MAVLinkParameters(SystemImpl& parent) : _parent(parent)
 
 MAVLinkParameters::~MAVLinkParameters()
 {
+    _parent.unregister_timeout_handler(_get_all_timeout_cookie);
+    _parent.unregister_timeout_handler(_batch_timeout_cookie);
     _parent.unregister_all_mavlink_message_handlers(this);
 }
 
@@ -58,6 +77,7 @@ void MAVLinkParameters::set_param_async(
     new_work.cookie = cookie;
 
     _work_queue.push_back(new_work);
+    _parent.wake_up_system_thread();
 }
 
 MAVLinkParameters::Result
@@ -100,6 +120,7 @@ void MAVLinkParameters::get_param_async(
     new_work.cookie = cookie;
 
     _work_queue.push_back(new_work);
+    _parent.wake_up_system_thread();
 }
 
 std::pair<MAVLinkParameters::Result, MAVLinkParameters::ParamValue>
@@ -133,6 +154,500 @@ void MAVLinkParameters::cancel_all_param(const void* cookie)
     }
 }
 
+void MAVLinkParameters::get_all_params_async(get_all_params_callback_t callback)
+{
+    std::unique_lock<std::mutex> lock(_all_params_mutex);
+
+    if (_download_state == DownloadState::Idle && _cache.is_complete()) {
+        auto params = cached_params();
+        lock.unlock();
+        if (callback) {
+            callback(Result::SUCCESS, params);
+        }
+        return;
+    }
+
+    _get_all_params_callbacks.push_back(callback);
+
+    if (_download_state != DownloadState::Idle) {
+        // Already on it, the callback will be called with everyone else's.
+        return;
+    }
+
+    if (!_cache_directory.empty() && _parent.get_uuid() != 0) {
+        request_hash_check();
+    } else {
+        request_list();
+    }
+}
+
+std::pair<MAVLinkParameters::Result, std::map<std::string, MAVLinkParameters::ParamValue>>
+MAVLinkParameters::get_all_params()
+{
+    auto prom = std::promise<std::pair<Result, std::map<std::string, ParamValue>>>();
+    auto res = prom.get_future();
+
+    get_all_params_async([&prom](Result result, std::map<std::string, ParamValue> params) {
+        prom.set_value(std::make_pair<>(result, params));
+    });
+
+    return res.get();
+}
+
+void MAVLinkParameters::set_cache_directory(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_all_params_mutex);
+    _cache_directory = path;
+}
+
+void MAVLinkParameters::request_hash_check()
+{
+    char param_id[PARAM_ID_LEN + 1] = {};
+    STRNCPY(param_id, hash_check_name, sizeof(param_id) - 1);
+
+    mavlink_message_t message{};
+    mavlink_msg_param_request_read_pack(
+        _parent.get_own_system_id(),
+        _parent.get_own_component_id(),
+        &message,
+        _parent.get_system_id(),
+        _parent.get_autopilot_id(),
+        param_id,
+        -1);
+
+    if (!_parent.send_message(message)) {
+        // Let the download report the error.
+        request_list();
+        return;
+    }
+
+    _download_state = DownloadState::CheckingHash;
+    _parent.register_timeout_handler(
+        std::bind(&MAVLinkParameters::receive_get_all_timeout, this),
+        get_all_timeout_s,
+        &_get_all_timeout_cookie);
+}
+
+void MAVLinkParameters::request_list()
+{
+    mavlink_message_t message{};
+    mavlink_msg_param_request_list_pack(
+        _parent.get_own_system_id(),
+        _parent.get_own_component_id(),
+        &message,
+        _parent.get_system_id(),
+        _parent.get_autopilot_id());
+
+    _download_state = DownloadState::Downloading;
+
+    if (!_parent.send_message(message)) {
+        LogErr() << "Error: Send message failed";
+        // Called with the lock held, so we can't finish right here.
+        _parent.register_timeout_handler(
+            std::bind(&MAVLinkParameters::finish_get_all, this, Result::CONNECTION_ERROR),
+            0.0,
+            &_get_all_timeout_cookie);
+        return;
+    }
+
+    _parent.register_timeout_handler(
+        std::bind(&MAVLinkParameters::receive_get_all_timeout, this),
+        get_all_timeout_s,
+        &_get_all_timeout_cookie);
+}
+
+void MAVLinkParameters::request_missing()
+{
+    for (const auto index : _cache.missing_indices(missing_max_per_round)) {
+        mavlink_message_t message{};
+        const char param_id[PARAM_ID_LEN + 1] = {};
+        mavlink_msg_param_request_read_pack(
+            _parent.get_own_system_id(),
+            _parent.get_own_component_id(),
+            &message,
+            _parent.get_system_id(),
+            _parent.get_autopilot_id(),
+            param_id,
+            static_cast<int16_t>(index));
+
+        if (!_parent.send_message(message)) {
+            LogErr() << "Error: Send message failed";
+            break;
+        }
+    }
+
+    _parent.register_timeout_handler(
+        std::bind(&MAVLinkParameters::receive_get_all_timeout, this),
+        missing_timeout_s,
+        &_get_all_timeout_cookie);
+}
+
+void MAVLinkParameters::receive_get_all_timeout()
+{
+    std::unique_lock<std::mutex> lock(_all_params_mutex);
+
+    switch (_download_state) {
+        case DownloadState::Idle:
+            return;
+
+        case DownloadState::CheckingHash:
+            // The autopilot doesn't know _HASH_CHECK, so download everything.
+            request_list();
+            return;
+
+        case DownloadState::Downloading:
+            break;
+    }
+
+    if (_cache.num_received() > _num_received_before_timeout) {
+        _get_all_retries = 0;
+    } else if (++_get_all_retries > get_all_max_retries) {
+        LogErr() << "Error: get all params timeout, got " << _cache.num_received() << " of "
+                 << _cache.count();
+        lock.unlock();
+        finish_get_all(Result::TIMEOUT);
+        return;
+    }
+    _num_received_before_timeout = _cache.num_received();
+
+    if (_cache.count() == 0) {
+        // Not even the first param arrived, ask for the list again.
+        request_list();
+    } else {
+        LogDebug() << "Requesting missing params, got " << _cache.num_received() << " of "
+                   << _cache.count();
+        request_missing();
+    }
+}
+
+void MAVLinkParameters::finish_get_all(Result result)
+{
+    std::unique_lock<std::mutex> lock(_all_params_mutex);
+
+    _parent.unregister_timeout_handler(_get_all_timeout_cookie);
+    _download_state = DownloadState::Idle;
+    _get_all_retries = 0;
+    _num_received_before_timeout = 0;
+
+    if (result == Result::SUCCESS && _have_hash && !_cache_directory.empty()) {
+        _cache.save(cache_path(_hash));
+    }
+
+    std::vector<get_all_params_callback_t> callbacks;
+    callbacks.swap(_get_all_params_callbacks);
+    auto params = cached_params();
+    lock.unlock();
+
+    for (const auto& callback : callbacks) {
+        if (callback) {
+            callback(result, params);
+        }
+    }
+}
+
+void MAVLinkParameters::update_cache(
+    const mavlink_message_t& message, const mavlink_param_value_t& param_value)
+{
+    // Only the params of the autopilot are cached.
+    if (message.compid != _parent.get_autopilot_id()) {
+        return;
+    }
+
+    const std::string name = extract_safe_param_id(param_value.param_id);
+    bool finished = false;
+
+    {
+        std::lock_guard<std::mutex> lock(_all_params_mutex);
+
+        if (name == hash_check_name) {
+            uint32_t hash;
+            memcpy(&hash, &param_value.param_value, sizeof(hash));
+            const bool hash_changed = !_have_hash || hash != _hash;
+            _have_hash = true;
+            _hash = hash;
+
+            if (_download_state == DownloadState::CheckingHash) {
+                _parent.unregister_timeout_handler(_get_all_timeout_cookie);
+                if (_cache.load(cache_path(hash))) {
+                    LogDebug() << "Using " << _cache.count() << " params from "
+                               << cache_path(hash);
+                    finished = true;
+                } else {
+                    request_list();
+                }
+            } else if (_download_state == DownloadState::Idle && _cache.is_complete()) {
+                // PX4 also sends the hash at the end of the list.
+                if (hash_changed && !_cache_directory.empty()) {
+                    _cache.save(cache_path(hash));
+                }
+            }
+        } else {
+            const auto update = _cache.update(
+                param_value.param_index,
+                param_value.param_count,
+                name,
+                param_value.param_value,
+                param_value.param_type);
+
+            if (_download_state == DownloadState::Downloading) {
+                if (_cache.is_complete()) {
+                    finished = true;
+                } else {
+                    _parent.refresh_timeout_handler(_get_all_timeout_cookie);
+                }
+            } else if (update == ParamCache::Update::CHANGED && _have_hash) {
+                // The copy on disk is outdated and we don't know the new hash.
+                if (!_cache_directory.empty()) {
+                    std::remove(cache_path(_hash).c_str());
+                }
+                _have_hash = false;
+            }
+        }
+    }
+
+    if (finished) {
+        finish_get_all(Result::SUCCESS);
+    }
+}
+
+std::string MAVLinkParameters::cache_path(uint32_t hash) const
+{
+    if (_cache_directory.empty()) {
+        return std::string();
+    }
+    return _cache_directory + "/" + ParamCache::filename(_parent.get_uuid(), hash);
+}
+
+std::map<std::string, MAVLinkParameters::ParamValue> MAVLinkParameters::cached_params() const
+{
+    std::map<std::string, ParamValue> params;
+    for (const auto& entry : _cache.entries()) {
+        mavlink_param_value_t param_value{};
+        param_value.param_value = entry.value;
+        param_value.param_type = entry.type;
+        params[entry.name].set_from_mavlink_param_value(param_value);
+    }
+    return params;
+}
+
+void MAVLinkParameters::set_params_async(
+    const std::vector<std::pair<std::string, ParamValue>>& params,
+    set_params_callback_t callback,
+    unsigned window)
+{
+    Batch batch{};
+    batch.window = (window > 0) ? window : 1;
+    batch.callback = callback;
+
+    for (const auto& param : params) {
+        auto it = batch.indices.find(param.first);
+        if (it != batch.indices.end()) {
+            // The last value of a param wins.
+            batch.items[it->second].value = param.second;
+            continue;
+        }
+
+        BatchItem item{};
+        item.name = param.first;
+        item.value = param.second;
+
+        if (item.name.size() > PARAM_ID_LEN) {
+            LogErr() << "Error: param name too long";
+            item.state = BatchItem::State::Done;
+            item.result = Result::PARAM_NAME_TOO_LONG;
+            ++batch.num_done;
+        } else {
+            batch.to_send.push_back(batch.items.size());
+        }
+
+        batch.indices[item.name] = batch.items.size();
+        batch.items.push_back(item);
+    }
+
+    std::unique_lock<std::mutex> lock(_batches_mutex);
+    batch.id = ++_last_batch_id;
+    _batches.push_back(std::move(batch));
+    if (_batches.size() == 1) {
+        start_batch(lock);
+    }
+}
+
+std::map<std::string, MAVLinkParameters::Result> MAVLinkParameters::set_params(
+    const std::vector<std::pair<std::string, ParamValue>>& params, unsigned window)
+{
+    auto prom = std::promise<std::map<std::string, Result>>();
+    auto res = prom.get_future();
+
+    set_params_async(
+        params,
+        [&prom](std::map<std::string, Result> results) { prom.set_value(results); },
+        window);
+
+    return res.get();
+}
+
+void MAVLinkParameters::start_batch(std::unique_lock<std::mutex>& lock)
+{
+    if (_batches.empty()) {
+        return;
+    }
+
+    Batch& batch = _batches.front();
+    if (send_batch_items(batch)) {
+        _parent.register_timeout_handler(
+            std::bind(&MAVLinkParameters::receive_batch_timeout, this, batch.id),
+            batch_timeout_s,
+            &_batch_timeout_cookie);
+    } else {
+        // Nothing to wait for, e.g. all names were too long.
+        finish_batch(lock);
+    }
+}
+
+void MAVLinkParameters::finish_batch(std::unique_lock<std::mutex>& lock)
+{
+    _parent.unregister_timeout_handler(_batch_timeout_cookie);
+
+    Batch batch = std::move(_batches.front());
+    _batches.pop_front();
+
+    std::map<std::string, Result> results;
+    for (const auto& item : batch.items) {
+        results[item.name] = item.result;
+    }
+
+    // Get the next batch going first, the callback might take a while.
+    start_batch(lock);
+
+    lock.unlock();
+    if (batch.callback) {
+        batch.callback(results);
+    }
+    lock.lock();
+}
+
+bool MAVLinkParameters::send_batch_items(Batch& batch)
+{
+    while (batch.num_in_flight < batch.window && !batch.to_send.empty()) {
+        BatchItem& item = batch.items[batch.to_send.front()];
+        batch.to_send.pop_front();
+
+        if (item.state == BatchItem::State::Done) {
+            // The echo came in after we gave up on it once.
+            continue;
+        }
+
+        char param_id[PARAM_ID_LEN + 1] = {};
+        STRNCPY(param_id, item.name.c_str(), sizeof(param_id) - 1);
+
+        mavlink_message_t message{};
+        mavlink_msg_param_set_pack(
+            _parent.get_own_system_id(),
+            _parent.get_own_component_id(),
+            &message,
+            _parent.get_system_id(),
+            _parent.get_autopilot_id(),
+            param_id,
+            item.value.get_4_float_bytes(),
+            item.value.get_mav_param_type());
+
+        if (!_parent.send_message(message)) {
+            LogErr() << "Error: Send message failed";
+            item.state = BatchItem::State::Done;
+            item.result = Result::CONNECTION_ERROR;
+            ++batch.num_done;
+            continue;
+        }
+
+        item.state = BatchItem::State::InFlight;
+        ++batch.num_in_flight;
+    }
+
+    return batch.num_done < batch.items.size();
+}
+
+void MAVLinkParameters::process_batch_param_value(
+    const std::string& name, const ParamValue& value)
+{
+    std::unique_lock<std::mutex> lock(_batches_mutex);
+
+    if (_batches.empty()) {
+        return;
+    }
+
+    Batch& batch = _batches.front();
+    auto it = batch.indices.find(name);
+    if (it == batch.indices.end()) {
+        return;
+    }
+
+    BatchItem& item = batch.items[it->second];
+    if (item.state == BatchItem::State::Done) {
+        return;
+    }
+    // A PARAM_VALUE for a param we haven't sent yet can't be our echo, it is
+    // e.g. broadcast, part of a download or the reply to someone else.
+    if (item.state == BatchItem::State::Queued && item.retries_done == 0) {
+        return;
+    }
+    if (item.state == BatchItem::State::InFlight) {
+        --batch.num_in_flight;
+    }
+    // A param which is queued again is skipped when its turn comes.
+    item.state = BatchItem::State::Done;
+    item.result = value.is_same_type(item.value) ? Result::SUCCESS : Result::WRONG_TYPE;
+    ++batch.num_done;
+
+    // Fill the window right away instead of waiting for the system thread.
+    if (send_batch_items(batch)) {
+        _parent.refresh_timeout_handler(_batch_timeout_cookie);
+        return;
+    }
+
+    finish_batch(lock);
+}
+
+void MAVLinkParameters::receive_batch_timeout(uint64_t batch_id)
+{
+    std::unique_lock<std::mutex> lock(_batches_mutex);
+
+    if (_batches.empty() || _batches.front().id != batch_id) {
+        // The batch finished while the timeout was on its way.
+        return;
+    }
+
+    // Everything still in flight got lost, retry only those.
+    Batch& batch = _batches.front();
+    for (size_t i = 0; i < batch.items.size(); ++i) {
+        BatchItem& item = batch.items[i];
+        if (item.state != BatchItem::State::InFlight) {
+            continue;
+        }
+        --batch.num_in_flight;
+
+        if (item.retries_done < batch_max_retries) {
+            ++item.retries_done;
+            item.state = BatchItem::State::Queued;
+            batch.to_send.push_back(i);
+        } else {
+            LogErr() << "Error: set param timeout: " << item.name;
+            item.state = BatchItem::State::Done;
+            item.result = Result::TIMEOUT;
+            ++batch.num_done;
+        }
+    }
+
+    if (send_batch_items(batch)) {
+        _parent.register_timeout_handler(
+            std::bind(&MAVLinkParameters::receive_batch_timeout, this, batch_id),
+            batch_timeout_s,
+            &_batch_timeout_cookie);
+        return;
+    }
+
+    finish_batch(lock);
+}
+
 void MAVLinkParameters::do_work()
 {
     LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
@@ -186,6 +701,7 @@ void MAVLinkParameters::do_work()
                     work->set_param_callback(MAVLinkParameters::Result::CONNECTION_ERROR);
                 }
                 work_queue_guard.pop_front();
+                _parent.wake_up_system_thread();
                 return;
             }
 
@@ -236,6 +752,7 @@ void MAVLinkParameters::do_work()
                         MAVLinkParameters::Result::CONNECTION_ERROR, empty_param);
                 }
                 work_queue_guard.pop_front();
+                _parent.wake_up_system_thread();
                 return;
             }
 
@@ -256,6 +773,14 @@ void MAVLinkParameters::process_param_value(const mavlink_message_t& message)
     mavlink_param_value_t param_value;
     mavlink_msg_param_value_decode(&message, &param_value);
 
+    update_cache(message, param_value);
+
+    if (message.compid == _parent.get_autopilot_id()) {
+        ParamValue value;
+        value.set_from_mavlink_param_value(param_value);
+        process_batch_param_value(extract_safe_param_id(param_value.param_id), value);
+    }
+
     // LogDebug() << "getting param value: " << extract_safe_param_id(param_value.param_id);
 
     LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
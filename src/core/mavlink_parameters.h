@@ -4,12 +4,18 @@
 #include "global_include.h"
 #include "mavlink_include.h"
 #include "locked_queue.h"
-#include "any.h"
+#include "param_cache.h"
 #include <cstdint>
 #include <string>
 #include <functional>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace mavsdk {
 
@@ -20,21 +26,19 @@ public:
     explicit MAVLinkParameters(SystemImpl& parent);
     ~MAVLinkParameters();
 
+    // Holds a param of any of the MAVLink param types.
+    //
+    // The value is stored in place in a union together with a tag for its
+    // type, so copying and comparing params neither allocates nor needs RTTI.
     class ParamValue {
     public:
         typedef char custom_type_t[128];
 
-        ParamValue() {}
+        ParamValue() = default;
+        ~ParamValue() = default;
 
-        ParamValue(ParamValue& rhs) { _value = rhs._value; }
-
-        ParamValue(const ParamValue& rhs) { _value = rhs._value; }
-
-        ParamValue& operator=(ParamValue rhs)
-        {
-            _value = rhs._value;
-            return *this;
-        }
+        ParamValue(const ParamValue& rhs) = default;
+        ParamValue& operator=(const ParamValue& rhs) = default;
 
         void set_from_mavlink_param_value(mavlink_param_value_t mavlink_value)
         {
@@ -44,12 +48,10 @@ public:
                 case MAV_PARAM_TYPE_INT32: {
                     int32_t temp;
                     memcpy(&temp, &mavlink_value.param_value, sizeof(temp));
-                    _value = temp;
+                    set(temp);
                 } break;
                 case MAV_PARAM_TYPE_REAL32:
-                    float temp;
-                    memcpy(&temp, &mavlink_value.param_value, sizeof(temp));
-                    _value = temp;
+                    set(mavlink_value.param_value);
                     break;
                 default:
                     // This would be worrying
@@ -61,61 +63,40 @@ public:
         void set_from_mavlink_param_ext_value(mavlink_param_ext_value_t mavlink_ext_value)
         {
             switch (mavlink_ext_value.param_type) {
-                case MAV_PARAM_EXT_TYPE_UINT8: {
-                    uint8_t temp;
-                    memcpy(&temp, &mavlink_ext_value.param_value[0], sizeof(temp));
-                    _value = temp;
-                } break;
-                case MAV_PARAM_EXT_TYPE_INT8: {
-                    int8_t temp;
-                    memcpy(&temp, &mavlink_ext_value.param_value[0], sizeof(temp));
-                    _value = temp;
-                } break;
-                case MAV_PARAM_EXT_TYPE_UINT16: {
-                    uint16_t temp;
-                    memcpy(&temp, &mavlink_ext_value.param_value[0], sizeof(temp));
-                    _value = temp;
-                } break;
-                case MAV_PARAM_EXT_TYPE_INT16: {
-                    int16_t temp;
-                    memcpy(&temp, &mavlink_ext_value.param_value[0], sizeof(temp));
-                    _value = temp;
-                } break;
-                case MAV_PARAM_EXT_TYPE_UINT32: {
-                    uint32_t temp;
-                    memcpy(&temp, &mavlink_ext_value.param_value[0], sizeof(temp));
-                    _value = temp;
-                } break;
-                case MAV_PARAM_EXT_TYPE_INT32: {
-                    int32_t temp;
-                    memcpy(&temp, &mavlink_ext_value.param_value[0], sizeof(temp));
-                    _value = temp;
-                } break;
-                case MAV_PARAM_EXT_TYPE_UINT64: {
-                    uint64_t temp;
-                    memcpy(&temp, &mavlink_ext_value.param_value[0], sizeof(temp));
-                    _value = temp;
-                } break;
-                case MAV_PARAM_EXT_TYPE_INT64: {
-                    int64_t temp;
-                    memcpy(&temp, &mavlink_ext_value.param_value[0], sizeof(temp));
-                    _value = temp;
-                } break;
-                case MAV_PARAM_EXT_TYPE_REAL32: {
-                    float temp;
-                    memcpy(&temp, &mavlink_ext_value.param_value[0], sizeof(temp));
-                    _value = temp;
-                } break;
-                case MAV_PARAM_EXT_TYPE_REAL64: {
-                    double temp;
-                    memcpy(&temp, &mavlink_ext_value.param_value[0], sizeof(temp));
-                    _value = temp;
-                } break;
-                case MAV_PARAM_EXT_TYPE_CUSTOM: {
-                    custom_type_t temp;
-                    memcpy(&temp, &mavlink_ext_value.param_value[0], sizeof(temp));
-                    _value = temp;
-                } break;
+                case MAV_PARAM_EXT_TYPE_UINT8:
+                    set_from_bytes<uint8_t>(mavlink_ext_value.param_value);
+                    break;
+                case MAV_PARAM_EXT_TYPE_INT8:
+                    set_from_bytes<int8_t>(mavlink_ext_value.param_value);
+                    break;
+                case MAV_PARAM_EXT_TYPE_UINT16:
+                    set_from_bytes<uint16_t>(mavlink_ext_value.param_value);
+                    break;
+                case MAV_PARAM_EXT_TYPE_INT16:
+                    set_from_bytes<int16_t>(mavlink_ext_value.param_value);
+                    break;
+                case MAV_PARAM_EXT_TYPE_UINT32:
+                    set_from_bytes<uint32_t>(mavlink_ext_value.param_value);
+                    break;
+                case MAV_PARAM_EXT_TYPE_INT32:
+                    set_from_bytes<int32_t>(mavlink_ext_value.param_value);
+                    break;
+                case MAV_PARAM_EXT_TYPE_UINT64:
+                    set_from_bytes<uint64_t>(mavlink_ext_value.param_value);
+                    break;
+                case MAV_PARAM_EXT_TYPE_INT64:
+                    set_from_bytes<int64_t>(mavlink_ext_value.param_value);
+                    break;
+                case MAV_PARAM_EXT_TYPE_REAL32:
+                    set_from_bytes<float>(mavlink_ext_value.param_value);
+                    break;
+                case MAV_PARAM_EXT_TYPE_REAL64:
+                    set_from_bytes<double>(mavlink_ext_value.param_value);
+                    break;
+                case MAV_PARAM_EXT_TYPE_CUSTOM:
+                    memcpy(_value.custom, mavlink_ext_value.param_value, sizeof(custom_type_t));
+                    _type = Type::CUSTOM;
+                    break;
                 default:
                     // This would be worrying
                     LogErr() << "Error: unknown mavlink ext param type";
@@ -126,66 +107,16 @@ public:
 
         bool set_from_xml(const std::string& type_str, const std::string& value_str)
         {
-            if (strcmp(type_str.c_str(), "uint8") == 0) {
-                uint8_t temp = std::stoi(value_str.c_str());
-                _value = temp;
-            } else if (strcmp(type_str.c_str(), "int8") == 0) {
-                int8_t temp = std::stoi(value_str.c_str());
-                _value = temp;
-            } else if (strcmp(type_str.c_str(), "uint16") == 0) {
-                uint16_t temp = std::stoi(value_str.c_str());
-                _value = temp;
-            } else if (strcmp(type_str.c_str(), "int16") == 0) {
-                int16_t temp = std::stoi(value_str.c_str());
-                _value = temp;
-            } else if (strcmp(type_str.c_str(), "uint32") == 0) {
-                uint32_t temp = std::stoi(value_str.c_str());
-                _value = temp;
-            } else if (strcmp(type_str.c_str(), "int32") == 0) {
-                int32_t temp = std::stoi(value_str.c_str());
-                _value = temp;
-            } else if (strcmp(type_str.c_str(), "uint64") == 0) {
-                uint64_t temp = std::stoll(value_str.c_str());
-                _value = temp;
-            } else if (strcmp(type_str.c_str(), "uint64") == 0) {
-                int64_t temp = std::stoll(value_str.c_str());
-                _value = temp;
-            } else if (strcmp(type_str.c_str(), "float") == 0) {
-                float temp = std::stof(value_str.c_str());
-                _value = temp;
-            } else if (strcmp(type_str.c_str(), "double") == 0) {
-                double temp = std::stod(value_str.c_str());
-                _value = temp;
-            } else {
+            if (!set_empty_type(type_str)) {
                 LogErr() << "Unknown type: " << type_str;
                 return false;
             }
-            return true;
+            return set_as_same_type(value_str);
         }
 
         bool set_empty_type_from_xml(const std::string& type_str)
         {
-            if (strcmp(type_str.c_str(), "uint8") == 0) {
-                _value = uint8_t(0);
-            } else if (strcmp(type_str.c_str(), "int8") == 0) {
-                _value = int8_t(0);
-            } else if (strcmp(type_str.c_str(), "uint16") == 0) {
-                _value = uint16_t(0);
-            } else if (strcmp(type_str.c_str(), "int16") == 0) {
-                _value = int16_t(0);
-            } else if (strcmp(type_str.c_str(), "uint32") == 0) {
-                _value = uint32_t(0);
-            } else if (strcmp(type_str.c_str(), "int32") == 0) {
-                _value = int32_t(0);
-            } else if (strcmp(type_str.c_str(), "uint64") == 0) {
-                _value = uint64_t(0);
-            } else if (strcmp(type_str.c_str(), "uint64") == 0) {
-                _value = int64_t(0);
-            } else if (strcmp(type_str.c_str(), "float") == 0) {
-                _value = 0.0f;
-            } else if (strcmp(type_str.c_str(), "double") == 0) {
-                _value = 0.0;
-            } else {
+            if (!set_empty_type(type_str)) {
                 LogErr() << "Unknown type: " << type_str;
                 return false;
             }
@@ -194,214 +125,208 @@ public:
 
         MAV_PARAM_TYPE get_mav_param_type() const
         {
-            if (_value.is<float>()) {
-                return MAV_PARAM_TYPE_REAL32;
-            } else if (_value.is<int32_t>()) {
-                return MAV_PARAM_TYPE_INT32;
-            } else {
-                LogErr() << "Unknown param type sent";
-                return MAV_PARAM_TYPE_REAL32;
+            switch (_type) {
+                case Type::FLOAT:
+                    return MAV_PARAM_TYPE_REAL32;
+                case Type::INT32:
+                    return MAV_PARAM_TYPE_INT32;
+                default:
+                    LogErr() << "Unknown param type sent";
+                    return MAV_PARAM_TYPE_REAL32;
             }
         }
 
         MAV_PARAM_EXT_TYPE get_mav_param_ext_type() const
         {
-            if (_value.is<uint8_t>()) {
-                return MAV_PARAM_EXT_TYPE_UINT8;
-            } else if (_value.is<int8_t>()) {
-                return MAV_PARAM_EXT_TYPE_INT8;
-            } else if (_value.is<uint16_t>()) {
-                return MAV_PARAM_EXT_TYPE_UINT16;
-            } else if (_value.is<int16_t>()) {
-                return MAV_PARAM_EXT_TYPE_INT16;
-            } else if (_value.is<uint32_t>()) {
-                return MAV_PARAM_EXT_TYPE_UINT32;
-            } else if (_value.is<int32_t>()) {
-                return MAV_PARAM_EXT_TYPE_INT32;
-            } else if (_value.is<uint64_t>()) {
-                return MAV_PARAM_EXT_TYPE_UINT64;
-            } else if (_value.is<int64_t>()) {
-                return MAV_PARAM_EXT_TYPE_INT64;
-            } else if (_value.is<float>()) {
-                return MAV_PARAM_EXT_TYPE_REAL32;
-            } else if (_value.is<double>()) {
-                return MAV_PARAM_EXT_TYPE_REAL64;
-            } else if (_value.is<custom_type_t>()) {
-                return MAV_PARAM_EXT_TYPE_CUSTOM;
-            } else {
-                LogErr() << "Unknown data type for param.";
-                assert(false);
-                return MAV_PARAM_EXT_TYPE_INT32;
+            switch (_type) {
+                case Type::UINT8:
+                    return MAV_PARAM_EXT_TYPE_UINT8;
+                case Type::INT8:
+                    return MAV_PARAM_EXT_TYPE_INT8;
+                case Type::UINT16:
+                    return MAV_PARAM_EXT_TYPE_UINT16;
+                case Type::INT16:
+                    return MAV_PARAM_EXT_TYPE_INT16;
+                case Type::UINT32:
+                    return MAV_PARAM_EXT_TYPE_UINT32;
+                case Type::INT32:
+                    return MAV_PARAM_EXT_TYPE_INT32;
+                case Type::UINT64:
+                    return MAV_PARAM_EXT_TYPE_UINT64;
+                case Type::INT64:
+                    return MAV_PARAM_EXT_TYPE_INT64;
+                case Type::FLOAT:
+                    return MAV_PARAM_EXT_TYPE_REAL32;
+                case Type::DOUBLE:
+                    return MAV_PARAM_EXT_TYPE_REAL64;
+                case Type::CUSTOM:
+                    return MAV_PARAM_EXT_TYPE_CUSTOM;
+                case Type::NONE:
+                    break;
             }
+            LogErr() << "Unknown data type for param.";
+            assert(false);
+            return MAV_PARAM_EXT_TYPE_INT32;
         }
 
         bool set_as_same_type(const std::string& value_str)
         {
-            if (_value.is<uint8_t>()) {
-                _value = uint8_t(std::stoi(value_str.c_str()));
-            } else if (_value.is<int8_t>()) {
-                _value = int8_t(std::stoi(value_str.c_str()));
-            } else if (_value.is<uint16_t>()) {
-                _value = uint16_t(std::stoi(value_str.c_str()));
-            } else if (_value.is<int16_t>()) {
-                _value = int16_t(std::stoi(value_str.c_str()));
-            } else if (_value.is<uint32_t>()) {
-                _value = uint32_t(std::stoi(value_str.c_str()));
-            } else if (_value.is<int32_t>()) {
-                _value = int32_t(std::stoi(value_str.c_str()));
-            } else if (_value.is<uint64_t>()) {
-                _value = uint64_t(std::stoll(value_str.c_str()));
-            } else if (_value.is<int64_t>()) {
-                _value = int64_t(std::stoll(value_str.c_str()));
-            } else if (_value.is<float>()) {
-                _value = float(std::stof(value_str.c_str()));
-            } else if (_value.is<double>()) {
-                _value = double(std::stod(value_str.c_str()));
-            } else {
-                LogErr() << "Unknown type";
-                return false;
+            switch (_type) {
+                case Type::UINT8:
+                    set(uint8_t(std::stoi(value_str.c_str())));
+                    return true;
+                case Type::INT8:
+                    set(int8_t(std::stoi(value_str.c_str())));
+                    return true;
+                case Type::UINT16:
+                    set(uint16_t(std::stoi(value_str.c_str())));
+                    return true;
+                case Type::INT16:
+                    set(int16_t(std::stoi(value_str.c_str())));
+                    return true;
+                case Type::UINT32:
+                    set(uint32_t(std::stoi(value_str.c_str())));
+                    return true;
+                case Type::INT32:
+                    set(int32_t(std::stoi(value_str.c_str())));
+                    return true;
+                case Type::UINT64:
+                    set(uint64_t(std::stoll(value_str.c_str())));
+                    return true;
+                case Type::INT64:
+                    set(int64_t(std::stoll(value_str.c_str())));
+                    return true;
+                case Type::FLOAT:
+                    set(float(std::stof(value_str.c_str())));
+                    return true;
+                case Type::DOUBLE:
+                    set(double(std::stod(value_str.c_str())));
+                    return true;
+                case Type::CUSTOM:
+                // FALLTHROUGH
+                case Type::NONE:
+                    break;
             }
-            return true;
+            LogErr() << "Unknown type";
+            return false;
         }
 
         float get_4_float_bytes() const
         {
-            if (_value.is<float>()) {
-                return _value.as<float>();
+            if (_type == Type::FLOAT) {
+                return _value.float_value;
             } else {
-                return *(reinterpret_cast<const float*>(&_value.as<int32_t>()));
+                // The int32 bytes are sent as they are.
+                const int32_t temp = as<int32_t>();
+                float result;
+                memcpy(&result, &temp, sizeof(result));
+                return result;
             }
         }
 
         void get_128_bytes(char* bytes) const
         {
-            if (_value.is<uint8_t>()) {
-                memcpy(bytes, &_value.as<uint8_t>(), sizeof(uint8_t));
-            } else if (_value.is<int8_t>()) {
-                memcpy(bytes, &_value.as<int8_t>(), sizeof(int8_t));
-            } else if (_value.is<uint16_t>()) {
-                memcpy(bytes, &_value.as<uint16_t>(), sizeof(uint16_t));
-            } else if (_value.is<int16_t>()) {
-                memcpy(bytes, &_value.as<int16_t>(), sizeof(int16_t));
-            } else if (_value.is<uint32_t>()) {
-                memcpy(bytes, &_value.as<uint32_t>(), sizeof(uint32_t));
-            } else if (_value.is<int32_t>()) {
-                memcpy(bytes, &_value.as<int32_t>(), sizeof(int32_t));
-            } else if (_value.is<uint64_t>()) {
-                memcpy(bytes, &_value.as<uint64_t>(), sizeof(uint64_t));
-            } else if (_value.is<int64_t>()) {
-                memcpy(bytes, &_value.as<int64_t>(), sizeof(int64_t));
-            } else if (_value.is<float>()) {
-                memcpy(bytes, &_value.as<float>(), sizeof(float));
-            } else if (_value.is<double>()) {
-                memcpy(bytes, &_value.as<double>(), sizeof(double));
-            } else if (_value.is<custom_type_t>()) {
-                memcpy(bytes, &_value.as<custom_type_t>(), sizeof(custom_type_t));
-            } else {
+            const size_t size = value_size();
+            if (size == 0) {
                 LogErr() << "Unknown data type for param.";
                 assert(false);
+                return;
             }
+            memcpy(bytes, &_value, size);
         }
 
         std::string get_string() const
         {
-            if (_value.is<uint8_t>()) {
-                return std::to_string(_value.as<uint8_t>());
-            } else if (_value.is<int8_t>()) {
-                return std::to_string(_value.as<int8_t>());
-            } else if (_value.is<uint16_t>()) {
-                return std::to_string(_value.as<uint16_t>());
-            } else if (_value.is<int16_t>()) {
-                return std::to_string(_value.as<int16_t>());
-            } else if (_value.is<uint32_t>()) {
-                return std::to_string(_value.as<uint32_t>());
-            } else if (_value.is<int32_t>()) {
-                return std::to_string(_value.as<int32_t>());
-            } else if (_value.is<uint64_t>()) {
-                return std::to_string(_value.as<uint64_t>());
-            } else if (_value.is<int64_t>()) {
-                return std::to_string(_value.as<int64_t>());
-            } else if (_value.is<float>()) {
-                return std::to_string(_value.as<float>());
-            } else if (_value.is<double>()) {
-                return std::to_string(_value.as<double>());
-            } else if (_value.is<custom_type_t>()) {
-                return std::string("(custom type)");
-            } else {
-                LogErr() << "Unknown data type for param.";
-                assert(false);
-                return std::string("(unknown)");
+            switch (_type) {
+                case Type::UINT8:
+                    return std::to_string(_value.uint8_value);
+                case Type::INT8:
+                    return std::to_string(_value.int8_value);
+                case Type::UINT16:
+                    return std::to_string(_value.uint16_value);
+                case Type::INT16:
+                    return std::to_string(_value.int16_value);
+                case Type::UINT32:
+                    return std::to_string(_value.uint32_value);
+                case Type::INT32:
+                    return std::to_string(_value.int32_value);
+                case Type::UINT64:
+                    return std::to_string(_value.uint64_value);
+                case Type::INT64:
+                    return std::to_string(_value.int64_value);
+                case Type::FLOAT:
+                    return std::to_string(_value.float_value);
+                case Type::DOUBLE:
+                    return std::to_string(_value.double_value);
+                case Type::CUSTOM:
+                    return std::string("(custom type)");
+                case Type::NONE:
+                    break;
             }
+            LogErr() << "Unknown data type for param.";
+            assert(false);
+            return std::string("(unknown)");
         }
-        float get_float() const { return float(_value); }
 
-        double get_double() const { return double(_value); }
+        float get_float() const { return as<float>(); }
 
-        int8_t get_int8() const { return int8_t(_value); }
+        double get_double() const { return as<double>(); }
 
-        uint8_t get_uint8() const { return uint8_t(_value); }
+        int8_t get_int8() const { return as<int8_t>(); }
 
-        int16_t get_int16() const { return int16_t(_value); }
+        uint8_t get_uint8() const { return as<uint8_t>(); }
 
-        uint16_t get_uint16() const { return uint16_t(_value); }
+        int16_t get_int16() const { return as<int16_t>(); }
 
-        int32_t get_int32() const { return int32_t(_value); }
+        uint16_t get_uint16() const { return as<uint16_t>(); }
 
-        uint32_t get_uint32() const { return uint32_t(_value); }
+        int32_t get_int32() const { return as<int32_t>(); }
 
-        void set_float(float value) { _value = value; }
+        uint32_t get_uint32() const { return as<uint32_t>(); }
 
-        void set_double(double value) { _value = value; }
+        void set_float(float value) { set(value); }
 
-        void set_int8(int8_t value) { _value = value; }
+        void set_double(double value) { set(value); }
 
-        void set_uint8(uint8_t value) { _value = value; }
+        void set_int8(int8_t value) { set(value); }
 
-        void set_int16(int16_t value) { _value = value; }
+        void set_uint8(uint8_t value) { set(value); }
 
-        void set_uint16(uint16_t value) { _value = value; }
+        void set_int16(int16_t value) { set(value); }
 
-        void set_int32(int32_t value) { _value = value; }
+        void set_uint16(uint16_t value) { set(value); }
 
-        void set_uint32(uint32_t value) { _value = value; }
+        void set_int32(int32_t value) { set(value); }
 
-        void set_int64(int64_t value) { _value = value; }
+        void set_uint32(uint32_t value) { set(value); }
 
-        void set_uint64(uint64_t value) { _value = value; }
+        void set_int64(int64_t value) { set(value); }
 
-        bool is_uint8() const { return (_value.is<uint8_t>()); }
+        void set_uint64(uint64_t value) { set(value); }
 
-        bool is_int8() const { return (_value.is<int8_t>()); }
+        bool is_uint8() const { return _type == Type::UINT8; }
 
-        bool is_uint16() const { return (_value.is<uint16_t>()); }
+        bool is_int8() const { return _type == Type::INT8; }
 
-        bool is_int16() const { return (_value.is<int16_t>()); }
+        bool is_uint16() const { return _type == Type::UINT16; }
 
-        bool is_uint32() const { return (_value.is<uint32_t>()); }
+        bool is_int16() const { return _type == Type::INT16; }
 
-        bool is_int32() const { return (_value.is<int32_t>()); }
+        bool is_uint32() const { return _type == Type::UINT32; }
 
-        bool is_uint64() const { return (_value.is<uint64_t>()); }
+        bool is_int32() const { return _type == Type::INT32; }
 
-        bool is_int64() const { return (_value.is<int64_t>()); }
+        bool is_uint64() const { return _type == Type::UINT64; }
 
-        bool is_float() const { return (_value.is<float>()); }
+        bool is_int64() const { return _type == Type::INT64; }
 
-        bool is_double() const { return (_value.is<double>()); }
+        bool is_float() const { return _type == Type::FLOAT; }
+
+        bool is_double() const { return _type == Type::DOUBLE; }
 
         bool is_same_type(const ParamValue& rhs) const
         {
-            if ((_value.is<uint8_t>() && rhs._value.is<uint8_t>()) ||
-                (_value.is<int8_t>() && rhs._value.is<int8_t>()) ||
-                (_value.is<uint16_t>() && rhs._value.is<uint16_t>()) ||
-                (_value.is<int16_t>() && rhs._value.is<int16_t>()) ||
-                (_value.is<uint32_t>() && rhs._value.is<uint32_t>()) ||
-                (_value.is<int32_t>() && rhs._value.is<int32_t>()) ||
-                (_value.is<uint64_t>() && rhs._value.is<uint64_t>()) ||
-                (_value.is<int64_t>() && rhs._value.is<int64_t>()) ||
-                (_value.is<float>() && rhs._value.is<float>()) ||
-                (_value.is<double>() && rhs._value.is<double>()) ||
-                (_value.is<custom_type_t>() && rhs._value.is<custom_type_t>())) {
+            if (_type != Type::NONE && _type == rhs._type) {
                 return true;
             } else {
                 LogWarn() << "Comparison type mismatch between " << typestr() << " and "
@@ -410,172 +335,243 @@ public:
             }
         }
 
-        bool operator==(const ParamValue& rhs) const
+        bool operator==(const ParamValue& rhs) const { return compare<std::equal_to>(rhs); }
+
+        bool operator<(const ParamValue& rhs) const { return compare<std::less>(rhs); }
+
+        bool operator>(const ParamValue& rhs) const { return compare<std::greater>(rhs); }
+
+        bool operator==(const std::string& value_str) const
         {
-            if (!is_same_type(rhs)) {
-                LogWarn() << "Trying to compare different types.";
-                return false;
-            }
-            if (_value.is<uint8_t>()) {
-                return _value.as<uint8_t>() == rhs._value.as<uint8_t>();
-            } else if (_value.is<int8_t>()) {
-                return _value.as<int8_t>() == rhs._value.as<int8_t>();
-            } else if (_value.is<uint16_t>()) {
-                return _value.as<uint16_t>() == rhs._value.as<uint16_t>();
-            } else if (_value.is<int16_t>()) {
-                return _value.as<int16_t>() == rhs._value.as<int16_t>();
-            } else if (_value.is<uint32_t>()) {
-                return _value.as<uint32_t>() == rhs._value.as<uint32_t>();
-            } else if (_value.is<int32_t>()) {
-                return _value.as<int32_t>() == rhs._value.as<int32_t>();
-            } else if (_value.is<uint64_t>()) {
-                return _value.as<uint64_t>() == rhs._value.as<uint64_t>();
-            } else if (_value.is<int64_t>()) {
-                return _value.as<int64_t>() == rhs._value.as<int64_t>();
-            } else if (_value.is<float>()) {
-                return _value.as<float>() == rhs._value.as<float>();
-            } else if (_value.is<double>()) {
-                return _value.as<double>() == rhs._value.as<double>();
-            } else if (_value.is<custom_type_t>()) {
-                LogErr() << "Comparing custom_type not supported.";
-                return false;
-            } else {
-                LogErr() << "Comparing unknown types";
-                return false;
+            // LogDebug() << "Compare " << typestr() << " and " << rhs.typestr();
+            switch (_type) {
+                case Type::UINT8:
+                    return _value.uint8_value == std::stoi(value_str.c_str());
+                case Type::INT8:
+                    return _value.int8_value == std::stoi(value_str.c_str());
+                case Type::UINT16:
+                    return _value.uint16_value == std::stoi(value_str.c_str());
+                case Type::INT16:
+                    return _value.int16_value == std::stoi(value_str.c_str());
+                case Type::UINT32:
+                    return _value.uint32_value == std::stoul(value_str.c_str());
+                case Type::INT32:
+                    return _value.int32_value == std::stol(value_str.c_str());
+                case Type::UINT64:
+                    return _value.uint64_value == std::stoull(value_str.c_str());
+                case Type::INT64:
+                    return _value.int64_value == std::stoll(value_str.c_str());
+                case Type::FLOAT:
+                    return _value.float_value == std::stof(value_str.c_str());
+                case Type::DOUBLE:
+                    return _value.double_value == std::stod(value_str.c_str());
+                case Type::CUSTOM:
+                // FALLTHROUGH
+                case Type::NONE:
+                    break;
             }
+            return false;
         }
 
-        bool operator<(const ParamValue& rhs) const
+        std::string typestr() const
         {
-            if (!is_same_type(rhs)) {
-                LogWarn() << "Trying to compare different types.";
-                return false;
-            }
-            if (_value.is<uint8_t>()) {
-                return _value.as<uint8_t>() < rhs._value.as<uint8_t>();
-            } else if (_value.is<int8_t>()) {
-                return _value.as<int8_t>() < rhs._value.as<int8_t>();
-            } else if (_value.is<uint16_t>()) {
-                return _value.as<uint16_t>() < rhs._value.as<uint16_t>();
-            } else if (_value.is<int16_t>()) {
-                return _value.as<int16_t>() < rhs._value.as<int16_t>();
-            } else if (_value.is<uint32_t>()) {
-                return _value.as<uint32_t>() < rhs._value.as<uint32_t>();
-            } else if (_value.is<int32_t>()) {
-                return _value.as<int32_t>() < rhs._value.as<int32_t>();
-            } else if (_value.is<uint64_t>()) {
-                return _value.as<uint64_t>() < rhs._value.as<uint64_t>();
-            } else if (_value.is<int64_t>()) {
-                return _value.as<int64_t>() < rhs._value.as<int64_t>();
-            } else if (_value.is<float>()) {
-                return _value.as<float>() < rhs._value.as<float>();
-            } else if (_value.is<double>()) {
-                return _value.as<double>() < rhs._value.as<double>();
-            } else if (_value.is<custom_type_t>()) {
-                LogErr() << "Comparing custom_type not supported.";
-                return false;
-            } else {
-                LogErr() << "Comparing unknown types";
-                return false;
+            switch (_type) {
+                case Type::UINT8:
+                    return "uint8_t";
+                case Type::INT8:
+                    return "int8_t";
+                case Type::UINT16:
+                    return "uint16_t";
+                case Type::INT16:
+                    return "int16_t";
+                case Type::UINT32:
+                    return "uint32_t";
+                case Type::INT32:
+                    return "int32_t";
+                case Type::UINT64:
+                    return "uint64_t";
+                case Type::INT64:
+                    return "int64_t";
+                case Type::FLOAT:
+                    return "float";
+                case Type::DOUBLE:
+                    return "double";
+                case Type::CUSTOM:
+                // FIXME: not clear how to handle this
+                // FALLTHROUGH
+                case Type::NONE:
+                    break;
             }
+            return "unknown";
         }
 
-        bool operator>(const ParamValue& rhs) const
+    private:
+        enum class Type : uint8_t {
+            NONE,
+            UINT8,
+            INT8,
+            UINT16,
+            INT16,
+            UINT32,
+            INT32,
+            UINT64,
+            INT64,
+            FLOAT,
+            DOUBLE,
+            CUSTOM
+        };
+
+        union Value {
+            uint8_t uint8_value;
+            int8_t int8_value;
+            uint16_t uint16_value;
+            int16_t int16_value;
+            uint32_t uint32_value;
+            int32_t int32_value;
+            uint64_t uint64_value;
+            int64_t int64_value;
+            float float_value;
+            double double_value;
+            custom_type_t custom;
+        };
+
+        // Overloads to map a C++ type to its tag, C++11 doesn't allow to
+        // specialize a member template instead.
+        static constexpr Type type_of(const uint8_t*) { return Type::UINT8; }
+        static constexpr Type type_of(const int8_t*) { return Type::INT8; }
+        static constexpr Type type_of(const uint16_t*) { return Type::UINT16; }
+        static constexpr Type type_of(const int16_t*) { return Type::INT16; }
+        static constexpr Type type_of(const uint32_t*) { return Type::UINT32; }
+        static constexpr Type type_of(const int32_t*) { return Type::INT32; }
+        static constexpr Type type_of(const uint64_t*) { return Type::UINT64; }
+        static constexpr Type type_of(const int64_t*) { return Type::INT64; }
+        static constexpr Type type_of(const float*) { return Type::FLOAT; }
+        static constexpr Type type_of(const double*) { return Type::DOUBLE; }
+
+        template<typename T> void set(T value)
         {
-            if (!is_same_type(rhs)) {
-                LogWarn() << "Trying to compare different types.";
-                return false;
+            // All members of the union start at its beginning.
+            memcpy(&_value, &value, sizeof(T));
+            _type = type_of(static_cast<const T*>(nullptr));
+        }
+
+        template<typename T> void set_from_bytes(const char* bytes)
+        {
+            T temp;
+            memcpy(&temp, bytes, sizeof(temp));
+            set(temp);
+        }
+
+        template<typename T> T as() const
+        {
+            if (_type != type_of(static_cast<const T*>(nullptr))) {
+                // We don't have exceptions, so we abort like a bad_cast would.
+                LogErr() << "Need to abort because of a bad_cast";
+                abort();
             }
-            if (_value.is<uint8_t>()) {
-                return _value.as<uint8_t>() > rhs._value.as<uint8_t>();
-            } else if (_value.is<int8_t>()) {
-                return _value.as<int8_t>() > rhs._value.as<int8_t>();
-            } else if (_value.is<uint16_t>()) {
-                return _value.as<uint16_t>() > rhs._value.as<uint16_t>();
-            } else if (_value.is<int16_t>()) {
-                return _value.as<int16_t>() > rhs._value.as<int16_t>();
-            } else if (_value.is<uint32_t>()) {
-                return _value.as<uint32_t>() > rhs._value.as<uint32_t>();
-            } else if (_value.is<int32_t>()) {
-                return _value.as<int32_t>() > rhs._value.as<int32_t>();
-            } else if (_value.is<uint64_t>()) {
-                return _value.as<uint64_t>() > rhs._value.as<uint64_t>();
-            } else if (_value.is<int64_t>()) {
-                return _value.as<int64_t>() > rhs._value.as<int64_t>();
-            } else if (_value.is<float>()) {
-                return _value.as<float>() > rhs._value.as<float>();
-            } else if (_value.is<double>()) {
-                return _value.as<double>() > rhs._value.as<double>();
-            } else if (_value.is<custom_type_t>()) {
-                LogErr() << "Comparing custom_type not supported.";
-                return false;
+            T value;
+            memcpy(&value, &_value, sizeof(T));
+            return value;
+        }
+
+        bool set_empty_type(const std::string& type_str)
+        {
+            if (type_str == "uint8") {
+                set(uint8_t(0));
+            } else if (type_str == "int8") {
+                set(int8_t(0));
+            } else if (type_str == "uint16") {
+                set(uint16_t(0));
+            } else if (type_str == "int16") {
+                set(int16_t(0));
+            } else if (type_str == "uint32") {
+                set(uint32_t(0));
+            } else if (type_str == "int32") {
+                set(int32_t(0));
+            } else if (type_str == "uint64") {
+                set(uint64_t(0));
+            } else if (type_str == "int64") {
+                set(int64_t(0));
+            } else if (type_str == "float") {
+                set(0.0f);
+            } else if (type_str == "double") {
+                set(0.0);
             } else {
-                LogErr() << "Comparing unknown types";
                 return false;
             }
+            return true;
         }
 
-        bool operator==(const std::string& value_str) const
+        size_t value_size() const
         {
-            // LogDebug() << "Compare " << typestr() << " and " << rhs.typestr();
-            if (_value.is<uint8_t>()) {
-                return _value.as<uint8_t>() == std::stoi(value_str.c_str());
-            } else if (_value.is<int8_t>()) {
-                return _value.as<int8_t>() == std::stoi(value_str.c_str());
-            } else if (_value.is<uint16_t>()) {
-                return _value.as<uint16_t>() == std::stoi(value_str.c_str());
-            } else if (_value.is<int16_t>()) {
-                return _value.as<int16_t>() == std::stoi(value_str.c_str());
-            } else if (_value.is<uint32_t>()) {
-                return _value.as<uint32_t>() == std::stoul(value_str.c_str());
-            } else if (_value.is<int32_t>()) {
-                return _value.as<int32_t>() == std::stol(value_str.c_str());
-            } else if (_value.is<uint64_t>()) {
-                return _value.as<uint64_t>() == std::stoull(value_str.c_str());
-            } else if (_value.is<int64_t>()) {
-                return _value.as<int64_t>() == std::stoll(value_str.c_str());
-            } else if (_value.is<float>()) {
-                return _value.as<float>() == std::stof(value_str.c_str());
-            } else if (_value.is<double>()) {
-                return _value.as<double>() == std::stod(value_str.c_str());
-            } else {
-                // This also covers custom_type_t
-                return false;
+            switch (_type) {
+                case Type::UINT8:
+                // FALLTHROUGH
+                case Type::INT8:
+                    return 1;
+                case Type::UINT16:
+                // FALLTHROUGH
+                case Type::INT16:
+                    return 2;
+                case Type::UINT32:
+                // FALLTHROUGH
+                case Type::INT32:
+                // FALLTHROUGH
+                case Type::FLOAT:
+                    return 4;
+                case Type::UINT64:
+                // FALLTHROUGH
+                case Type::INT64:
+                // FALLTHROUGH
+                case Type::DOUBLE:
+                    return 8;
+                case Type::CUSTOM:
+                    return sizeof(custom_type_t);
+                case Type::NONE:
+                    break;
             }
+            return 0;
         }
 
-        std::string typestr() const
+        template<template<typename> class Op> bool compare(const ParamValue& rhs) const
         {
-            if (_value.is<uint8_t>()) {
-                return "uint8_t";
-            } else if (_value.is<int8_t>()) {
-                return "int8_t";
-            } else if (_value.is<uint16_t>()) {
-                return "uint16_t";
-            } else if (_value.is<int16_t>()) {
-                return "int16_t";
-            } else if (_value.is<uint32_t>()) {
-                return "uint32_t";
-            } else if (_value.is<int32_t>()) {
-                return "int32_t";
-            } else if (_value.is<uint64_t>()) {
-                return "uint64_t";
-            } else if (_value.is<int64_t>()) {
-                return "int64_t";
-            } else if (_value.is<float>()) {
-                return "float";
-            } else if (_value.is<double>()) {
-                return "double";
-            } else if (_value.is<custom_type_t>()) {
-                // FIXME: not clear how to handle this
-                return "unknown";
+            if (!is_same_type(rhs)) {
+                LogWarn() << "Trying to compare different types.";
+                return false;
             }
-            // FIXME: Added to fix CI error (control reading end of non-void function)
-            return "unknown";
+            switch (_type) {
+                case Type::UINT8:
+                    return Op<uint8_t>()(_value.uint8_value, rhs._value.uint8_value);
+                case Type::INT8:
+                    return Op<int8_t>()(_value.int8_value, rhs._value.int8_value);
+                case Type::UINT16:
+                    return Op<uint16_t>()(_value.uint16_value, rhs._value.uint16_value);
+                case Type::INT16:
+                    return Op<int16_t>()(_value.int16_value, rhs._value.int16_value);
+                case Type::UINT32:
+                    return Op<uint32_t>()(_value.uint32_value, rhs._value.uint32_value);
+                case Type::INT32:
+                    return Op<int32_t>()(_value.int32_value, rhs._value.int32_value);
+                case Type::UINT64:
+                    return Op<uint64_t>()(_value.uint64_value, rhs._value.uint64_value);
+                case Type::INT64:
+                    return Op<int64_t>()(_value.int64_value, rhs._value.int64_value);
+                case Type::FLOAT:
+                    return Op<float>()(_value.float_value, rhs._value.float_value);
+                case Type::DOUBLE:
+                    return Op<double>()(_value.double_value, rhs._value.double_value);
+                case Type::CUSTOM:
+                    LogErr() << "Comparing custom_type not supported.";
+                    return false;
+                case Type::NONE:
+                    break;
+            }
+            LogErr() << "Comparing unknown types";
+            return false;
         }
 
-    private:
-        Any _value{};
+        Type _type{Type::NONE};
+        Value _value{};
     };
 
     enum class Result { SUCCESS, TIMEOUT, CONNECTION_ERROR, WRONG_TYPE, PARAM_NAME_TOO_LONG };
@@ -603,6 +599,30 @@ public:
 
     void cancel_all_param(const void* cookie);
 
+    // Downloads all params of the autopilot with PARAM_REQUEST_LIST, or
+    // answers from the cache if it is complete already. The cache is kept
+    // current by any PARAM_VALUE the autopilot sends.
+    typedef std::function<void(Result, std::map<std::string, ParamValue>)>
+        get_all_params_callback_t;
+    void get_all_params_async(get_all_params_callback_t callback);
+    std::pair<Result, std::map<std::string, ParamValue>> get_all_params();
+
+    // Directory to keep a copy of the params of each system in between
+    // sessions. Empty (the default) disables the on-disk cache.
+    void set_cache_directory(const std::string& path);
+
+    // Sets many params of the autopilot, keeping up to `window` PARAM_SETs in
+    // flight instead of waiting for each echo before sending the next one.
+    // Params which are not echoed in time are sent again, the callback gets
+    // the result of each param by name.
+    typedef std::function<void(std::map<std::string, Result>)> set_params_callback_t;
+    void set_params_async(
+        const std::vector<std::pair<std::string, ParamValue>>& params,
+        set_params_callback_t callback,
+        unsigned window = 10);
+    std::map<std::string, Result>
+    set_params(const std::vector<std::pair<std::string, ParamValue>>& params, unsigned window = 10);
+
     void do_work();
 
     friend std::ostream& operator<<(std::ostream&, const ParamValue&);
@@ -617,6 +637,22 @@ private:
     void process_param_ext_ack(const mavlink_message_t& message);
     void receive_timeout();
 
+    void update_cache(const mavlink_message_t& message, const mavlink_param_value_t& param_value);
+    void request_hash_check();
+    void request_list();
+    void request_missing();
+    void receive_get_all_timeout();
+    void finish_get_all(Result result);
+    std::string cache_path(uint32_t hash) const;
+    std::map<std::string, ParamValue> cached_params() const;
+
+    struct Batch;
+    void process_batch_param_value(const std::string& name, const ParamValue& value);
+    void receive_batch_timeout(uint64_t batch_id);
+    bool send_batch_items(Batch& batch);
+    void start_batch(std::unique_lock<std::mutex>& lock);
+    void finish_batch(std::unique_lock<std::mutex>& lock);
+
     static std::string extract_safe_param_id(const char param_id[]);
 
     SystemImpl& _parent;
@@ -640,6 +676,44 @@ private:
 
     void* _timeout_cookie = nullptr;
 
+    // State of the full download, everything below is protected by the mutex.
+    enum class DownloadState { Idle, CheckingHash, Downloading };
+
+    mutable std::mutex _all_params_mutex{};
+    ParamCache _cache{};
+    DownloadState _download_state{DownloadState::Idle};
+    std::vector<get_all_params_callback_t> _get_all_params_callbacks{};
+    void* _get_all_timeout_cookie{nullptr};
+    unsigned _get_all_retries{0};
+    size_t _num_received_before_timeout{0};
+    std::string _cache_directory{};
+    // Hash of the param set as reported by the autopilot in _HASH_CHECK.
+    bool _have_hash{false};
+    uint32_t _hash{0};
+
+    // Batches of params to set, the front one is in progress.
+    struct BatchItem {
+        enum class State { Queued, InFlight, Done } state{State::Queued};
+        std::string name{};
+        ParamValue value{};
+        Result result{Result::TIMEOUT};
+        unsigned retries_done{0};
+    };
+    struct Batch {
+        uint64_t id{0};
+        std::vector<BatchItem> items{};
+        std::unordered_map<std::string, size_t> indices{};
+        std::deque<size_t> to_send{};
+        size_t num_in_flight{0};
+        size_t num_done{0};
+        unsigned window{1};
+        set_params_callback_t callback{};
+    };
+    std::mutex _batches_mutex{};
+    std::deque<Batch> _batches{};
+    uint64_t _last_batch_id{0};
+    void* _batch_timeout_cookie{nullptr};
+
     // dl_time_t _last_request_time = {};
 };
 
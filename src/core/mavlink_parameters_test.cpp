@@ -0,0 +1,249 @@
+#include "mavlink_parameters.h"
+#include "mavsdk.h"
+#include "mocks/fake_vehicle.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+
+using namespace mavsdk;
+
+typedef MAVLinkParameters::ParamValue ParamValue;
+
+TEST(ParamValue, SetAndGet)
+{
+    ParamValue value;
+    value.set_int32(-42);
+    EXPECT_TRUE(value.is_int32());
+    EXPECT_FALSE(value.is_uint32());
+    EXPECT_FALSE(value.is_float());
+    EXPECT_EQ(value.get_int32(), -42);
+    EXPECT_EQ(value.typestr(), "int32_t");
+
+    value.set_float(0.5f);
+    EXPECT_TRUE(value.is_float());
+    EXPECT_FALSE(value.is_int32());
+    EXPECT_EQ(value.get_float(), 0.5f);
+    EXPECT_EQ(value.typestr(), "float");
+
+    value.set_uint64(1234567890123ULL);
+    EXPECT_TRUE(value.is_uint64());
+    EXPECT_EQ(value.get_string(), "1234567890123");
+}
+
+TEST(ParamValue, EmptyHasNoType)
+{
+    ParamValue value;
+    EXPECT_FALSE(value.is_int32());
+    EXPECT_FALSE(value.is_float());
+    EXPECT_EQ(value.typestr(), "unknown");
+
+    ParamValue other;
+    EXPECT_FALSE(value.is_same_type(other));
+}
+
+TEST(ParamValue, CopiesAreIndependent)
+{
+    ParamValue value;
+    value.set_uint16(7);
+
+    ParamValue copy(value);
+    value.set_uint16(8);
+    EXPECT_EQ(copy.get_uint16(), 7);
+
+    ParamValue assigned;
+    assigned = value;
+    value.set_double(1.0);
+    EXPECT_TRUE(assigned.is_uint16());
+    EXPECT_EQ(assigned.get_uint16(), 8);
+}
+
+TEST(ParamValue, Compares)
+{
+    ParamValue one;
+    one.set_int8(1);
+    ParamValue two;
+    two.set_int8(2);
+
+    EXPECT_TRUE(one < two);
+    EXPECT_TRUE(two > one);
+    EXPECT_FALSE(one == two);
+    two.set_int8(1);
+    EXPECT_TRUE(one == two);
+
+    // Different types are never equal.
+    ParamValue other_type;
+    other_type.set_int16(1);
+    EXPECT_FALSE(one.is_same_type(other_type));
+    EXPECT_FALSE(one == other_type);
+    EXPECT_FALSE(one < other_type);
+
+    EXPECT_TRUE(one == std::string("1"));
+    EXPECT_FALSE(one == std::string("2"));
+}
+
+TEST(ParamValue, FromXml)
+{
+    ParamValue value;
+    EXPECT_TRUE(value.set_from_xml("uint8", "200"));
+    EXPECT_TRUE(value.is_uint8());
+    EXPECT_EQ(value.get_uint8(), 200);
+
+    EXPECT_TRUE(value.set_from_xml("int64", "-5"));
+    EXPECT_TRUE(value.is_int64());
+    EXPECT_EQ(value.get_string(), "-5");
+
+    EXPECT_TRUE(value.set_from_xml("double", "0.25"));
+    EXPECT_EQ(value.get_double(), 0.25);
+
+    EXPECT_FALSE(value.set_from_xml("string", "abc"));
+
+    EXPECT_TRUE(value.set_empty_type_from_xml("uint32"));
+    EXPECT_TRUE(value.is_uint32());
+    EXPECT_TRUE(value.set_as_same_type("3"));
+    EXPECT_EQ(value.get_uint32(), 3u);
+}
+
+TEST(ParamValue, FromMavlink)
+{
+    mavlink_param_value_t param_value{};
+    param_value.param_type = MAV_PARAM_TYPE_REAL32;
+    param_value.param_value = 1.5f;
+
+    ParamValue value;
+    value.set_from_mavlink_param_value(param_value);
+    EXPECT_TRUE(value.is_float());
+    EXPECT_EQ(value.get_float(), 1.5f);
+    EXPECT_EQ(value.get_mav_param_type(), MAV_PARAM_TYPE_REAL32);
+    EXPECT_EQ(value.get_4_float_bytes(), 1.5f);
+
+    const int32_t int_value = 123456;
+    param_value.param_type = MAV_PARAM_TYPE_INT32;
+    memcpy(&param_value.param_value, &int_value, sizeof(int_value));
+    value.set_from_mavlink_param_value(param_value);
+    EXPECT_TRUE(value.is_int32());
+    EXPECT_EQ(value.get_int32(), int_value);
+
+    // The int bytes go out unchanged.
+    const float bytes = value.get_4_float_bytes();
+    EXPECT_EQ(memcmp(&bytes, &int_value, sizeof(bytes)), 0);
+}
+
+TEST(ParamValue, FromMavlinkExt)
+{
+    mavlink_param_ext_value_t param_ext_value{};
+    param_ext_value.param_type = MAV_PARAM_EXT_TYPE_UINT16;
+    const uint16_t uint16_value = 4242;
+    memcpy(param_ext_value.param_value, &uint16_value, sizeof(uint16_value));
+
+    ParamValue value;
+    value.set_from_mavlink_param_ext_value(param_ext_value);
+    EXPECT_TRUE(value.is_uint16());
+    EXPECT_EQ(value.get_uint16(), uint16_value);
+    EXPECT_EQ(value.get_mav_param_ext_type(), MAV_PARAM_EXT_TYPE_UINT16);
+
+    char bytes[128] = {};
+    value.get_128_bytes(bytes);
+    EXPECT_EQ(memcmp(bytes, &uint16_value, sizeof(uint16_value)), 0);
+
+    param_ext_value.param_type = MAV_PARAM_EXT_TYPE_CUSTOM;
+    memset(param_ext_value.param_value, 'x', sizeof(param_ext_value.param_value));
+    value.set_from_mavlink_param_ext_value(param_ext_value);
+    EXPECT_EQ(value.get_mav_param_ext_type(), MAV_PARAM_EXT_TYPE_CUSTOM);
+    EXPECT_EQ(value.get_string(), "(custom type)");
+
+    value.get_128_bytes(bytes);
+    EXPECT_EQ(memcmp(bytes, param_ext_value.param_value, sizeof(bytes)), 0);
+}
+
+TEST(ParamValue, WorksInMaps)
+{
+    std::map<std::string, ParamValue> settings;
+    for (int i = 0; i < 100; ++i) {
+        ParamValue value;
+        value.set_int32(i);
+        settings[std::to_string(i)] = value;
+    }
+
+    auto copy = settings;
+    EXPECT_EQ(copy["42"].get_int32(), 42);
+    EXPECT_TRUE(copy["42"] == settings["42"]);
+}
+
+#if defined(LINUX)
+
+TEST(MAVLinkParameters, IgnoresValuesOfParamsNotSentYet)
+{
+    mavsdk::testing::FakeVehicle vehicle;
+    std::mutex mutex;
+    std::vector<std::string> received;
+
+    vehicle.set_message_handler([&mutex, &received](
+                                    mavsdk::testing::FakeVehicle& fake_vehicle,
+                                    const mavlink_message_t& message) {
+        if (message.msgid != MAVLINK_MSG_ID_PARAM_SET) {
+            return;
+        }
+        mavlink_param_set_t param_set;
+        mavlink_msg_param_set_decode(&message, &param_set);
+        const std::string name(param_set.param_id, strnlen(param_set.param_id, 16));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            received.push_back(name);
+        }
+
+        mavlink_message_t reply;
+        if (name == "FIRST") {
+            // Broadcast while SECOND still waits for its turn, with the
+            // value it had before.
+            mavlink_msg_param_value_pack_chan(
+                mavsdk::testing::FakeVehicle::system_id,
+                MAV_COMP_ID_AUTOPILOT1,
+                mavsdk::testing::FakeVehicle::channel,
+                &reply,
+                "SECOND",
+                0.0f,
+                MAV_PARAM_TYPE_REAL32,
+                2,
+                1);
+            fake_vehicle.send(reply);
+        }
+        mavlink_msg_param_value_pack_chan(
+            mavsdk::testing::FakeVehicle::system_id,
+            MAV_COMP_ID_AUTOPILOT1,
+            mavsdk::testing::FakeVehicle::channel,
+            &reply,
+            param_set.param_id,
+            param_set.param_value,
+            param_set.param_type,
+            2,
+            name == "FIRST" ? 0 : 1);
+        fake_vehicle.send(reply);
+    });
+
+    Mavsdk mavsdk;
+    ASSERT_EQ(mavsdk.add_tcp_connection("127.0.0.1", vehicle.port()), ConnectionResult::SUCCESS);
+    for (unsigned i = 0; i < 500 && !mavsdk.is_connected(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(mavsdk.is_connected());
+
+    ParamValue value;
+    value.set_float(1.0f);
+    mavsdk::testing::SystemImplAccess access(mavsdk.system());
+    // One at a time, so that SECOND is still queued when FIRST is echoed.
+    const auto results =
+        access.system_impl().set_params({{"FIRST", value}, {"SECOND", value}}, 1);
+
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results.at("FIRST"), MAVLinkParameters::Result::SUCCESS);
+    EXPECT_EQ(results.at("SECOND"), MAVLinkParameters::Result::SUCCESS);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(
+        std::set<std::string>(received.begin(), received.end()),
+        std::set<std::string>({"FIRST", "SECOND"}));
+}
+
+#endif
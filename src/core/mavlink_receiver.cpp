@@ -1,47 +1,70 @@
 #include "mavlink_receiver.h"
 #include "global_include.h"
-
-#if DROP_DEBUG == 1
-#include <iomanip>
-#endif
+#include "x25_crc.h"
+#include <cstring>
 
 namespace mavsdk {
 
-MAVLinkReceiver::MAVLinkReceiver(uint8_t channel) :
-    _channel(channel)
-#if DROP_DEBUG == 1
-    ,
-    _last_time()
-#endif
-{}
+MAVLinkReceiver::MAVLinkReceiver() {}
 
 void MAVLinkReceiver::set_new_datagram(char* datagram, unsigned datagram_len)
 {
     _datagram = datagram;
     _datagram_len = datagram_len;
 
-#if DROP_DEBUG == 1
-    _bytes_received += _datagram_len;
-#endif
+    if (_traffic_counters) {
+        _traffic_counters->add_bytes_received(datagram_len);
+    }
 }
 
 bool MAVLinkReceiver::parse_message()
 {
     // Note that one datagram can contain multiple mavlink messages.
-    for (unsigned i = 0; i < _datagram_len; ++i) {
-        if (mavlink_parse_char(_channel, _datagram[i], &_last_message, &_status) == 1) {
-            // Move the pointer to the datagram forward by the amount parsed.
-            _datagram += (i + 1);
-            // And decrease the length, so we don't overshoot in the next round.
-            _datagram_len -= (i + 1);
-
-#if DROP_DEBUG == 1
-            debug_drop_rate();
-#endif
+    //
+    // Whenever the parser is between frames we look for the next start marker
+    // and, if the whole frame is in this datagram, take it in one go. Frames
+    // split across datagrams, or anything unusual like bad CRCs, signed frames
+    // and invalid headers, go through the byte-wise parser, so
+    // that the message and status accounting is the same as it always was.
+    while (_datagram_len > 0) {
+        if (parser_idle()) {
+            const unsigned skipped = find_start_marker();
+            if (skipped > 0) {
+                // Bytes in between frames don't change the parser state, only
+                // the status bookkeeping. The first one reports a pending parse
+                // error, any after that leave the same state behind, so there
+                // is no need to feed the parser more than two of them.
+                for (unsigned i = 0; i < skipped && i < 2; ++i) {
+                    parse_char(static_cast<uint8_t>(_datagram[i]));
+                }
+                consume(skipped);
+                if (_traffic_counters) {
+                    _traffic_counters->add_parse_error();
+                }
+                continue;
+            }
 
-            // We have parsed one message, let's return so it can be handled.
-            return true;
+            if (parse_contiguous_frame() == FastParseResult::MESSAGE) {
+                if (_traffic_counters) {
+                    _traffic_counters->add_message_received(_last_message, 0);
+                }
+                // We have parsed one message, let's return so it can be handled.
+                return true;
+            }
         }
+
+        // Feed the parser until it is in between frames again.
+        do {
+            const bool found = parse_char(static_cast<uint8_t>(_datagram[0]));
+            consume(1);
+
+            if (found) {
+                if (_traffic_counters) {
+                    _traffic_counters->add_message_received(_last_message, 0);
+                }
+                return true;
+            }
+        } while (_datagram_len > 0 && !parser_idle());
     }
 
     // No (more) messages, let's give up.
@@ -50,79 +73,195 @@ bool MAVLinkReceiver::parse_message()
     return false;
 }
 
-#if DROP_DEBUG == 1
-void MAVLinkReceiver::debug_drop_rate()
+bool MAVLinkReceiver::parse_char(uint8_t c)
 {
-    if (_last_message.msgid == MAVLINK_MSG_ID_SYS_STATUS) {
-        const unsigned msg_len = (_last_message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES);
-
-        _bytes_received -= msg_len;
-
-        mavlink_sys_status_t sys_status;
-        mavlink_msg_sys_status_decode(&_last_message, &sys_status);
-
-        if (!_first) {
-            LogDebug() << "-------------------------------------------------------------------"
-                       << "-----------";
-
-            if (_bytes_received <= sys_status.errors_comm &&
-                sys_status.errors_count2 <= sys_status.errors_comm) {
-                _bytes_sent_overall += sys_status.errors_comm;
-                //_bytes_at_gimbal_overall += sys_status.errors_count1;
-                _bytes_at_camera_overall += sys_status.errors_count2;
-                _bytes_at_sdk_overall += _bytes_received;
-
-                _time_elapsed += elapsed_since_s(_last_time);
-
-                print_line(
-                    "FMU   ",
-                    sys_status.errors_comm,
-                    sys_status.errors_comm,
-                    _bytes_sent_overall,
-                    _bytes_sent_overall);
-                // print_line("Gimbal", sys_status.errors_count1, sys_status.errors_comm,
-                //           _bytes_at_gimbal_overall, _bytes_sent_overall);
-                print_line(
-                    "Camera",
-                    sys_status.errors_count2,
-                    sys_status.errors_comm,
-                    _bytes_at_camera_overall,
-                    _bytes_sent_overall);
-                print_line(
-                    "SDK   ",
-                    _bytes_received,
-                    sys_status.errors_comm,
-                    _bytes_at_sdk_overall,
-                    _bytes_sent_overall);
-
-            } else {
-                LogDebug() << "Missed SYS_STATUS";
-            }
-        }
-        _first = false;
+    if (parser_idle()) {
+        _frame_len = 0;
+    }
+    if (_frame_len < sizeof(_frame)) {
+        _frame[_frame_len++] = c;
+    }
 
-        _last_time = steady_time();
+    // This does what mavlink_parse_char does, just on our own state.
+    const uint8_t result =
+        mavlink_frame_char_buffer(&_rx_message, &_rx_status, c, &_last_message, &_status);
 
-        // Reset afterwards:
-        _bytes_received = msg_len;
+    if (result == MAVLINK_FRAMING_BAD_CRC || result == MAVLINK_FRAMING_BAD_SIGNATURE) {
+        // Count it as parse error and start over, possibly right at this byte.
+        _rx_status.parse_error++;
+        if (_traffic_counters) {
+            _traffic_counters->add_crc_error();
+        }
+        _rx_status.msg_received = MAVLINK_FRAMING_INCOMPLETE;
+        _rx_status.parse_state = MAVLINK_PARSE_STATE_IDLE;
+        if (c == MAVLINK_STX) {
+            _rx_status.parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+            _rx_message.len = 0;
+            _rx_message.checksum = X25Crc::INIT;
+            _frame[0] = c;
+            _frame_len = 1;
+        }
+        return false;
+    }
+
+    if (result != MAVLINK_FRAMING_OK) {
+        return false;
     }
+
+    _last_frame = _frame;
+    _last_frame_len = _frame_len;
+    return true;
 }
 
-void MAVLinkReceiver::print_line(
-    const char* index,
-    unsigned count,
-    unsigned count_total,
-    unsigned overall_bytes,
-    unsigned overall_bytes_total)
+bool MAVLinkReceiver::parser_idle()
 {
-    LogDebug() << "count " << index << ": " << std::setw(6) << count << ", loss: " << std::setw(6)
-               << count_total - count << ",  " << std::setw(6) << std::setprecision(2) << std::fixed
-               << 100.0 * float(count) / float(count_total) << " %, overall: " << std::setw(6)
-               << std::setprecision(2) << std::fixed
-               << (100.0 * double(overall_bytes) / double(overall_bytes_total)) << " %, "
-               << std::setw(6) << std::setprecision(2) << std::fixed
-               << (double(overall_bytes) / _time_elapsed / 1024.0) << " KiB/s";
+    const auto parse_state = _rx_status.parse_state;
+    return parse_state == MAVLINK_PARSE_STATE_IDLE || parse_state == MAVLINK_PARSE_STATE_UNINIT;
 }
+
+unsigned MAVLinkReceiver::find_start_marker()
+{
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(_datagram);
+    unsigned i = 0;
+
+    // Check 8 bytes at a time for either start marker, the usual trick to
+    // find a zero byte after xor-ing with the marker pattern.
+    static constexpr uint64_t ones = 0x0101010101010101ULL;
+    static constexpr uint64_t highs = 0x8080808080808080ULL;
+    static constexpr uint64_t stx_v2 = ones * MAVLINK_STX;
+    static constexpr uint64_t stx_v1 = ones * MAVLINK_STX_MAVLINK1;
+
+    for (; i + sizeof(uint64_t) <= _datagram_len; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, &data[i], sizeof(word));
+        const uint64_t v2 = word ^ stx_v2;
+        const uint64_t v1 = word ^ stx_v1;
+        if ((((v2 - ones) & ~v2) | ((v1 - ones) & ~v1)) & highs) {
+            break;
+        }
+    }
+
+    for (; i < _datagram_len; ++i) {
+        if (data[i] == MAVLINK_STX || data[i] == MAVLINK_STX_MAVLINK1) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+MAVLinkReceiver::FastParseResult MAVLinkReceiver::parse_contiguous_frame()
+{
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(_datagram);
+    const bool mavlink1 = (data[0] == MAVLINK_STX_MAVLINK1);
+    const unsigned header_len =
+        1 + (mavlink1 ? MAVLINK_CORE_HEADER_MAVLINK1_LEN : MAVLINK_CORE_HEADER_LEN);
+
+    if (_datagram_len < header_len) {
+        return FastParseResult::FALLBACK;
+    }
+
+    // Signed frames and unknown incompat flags are left to the parser.
+    if (!mavlink1 && data[2] != 0) {
+        return FastParseResult::FALLBACK;
+    }
+
+    const uint8_t payload_len = data[1];
+    const unsigned frame_len = header_len + payload_len + MAVLINK_NUM_CHECKSUM_BYTES;
+    if (_datagram_len < frame_len) {
+        return FastParseResult::FALLBACK;
+    }
+
+    if (_rx_status.signing != nullptr) {
+        // Whether unsigned frames are accepted is up to the signing callback.
+        return FastParseResult::FALLBACK;
+    }
+
+    const uint32_t msgid =
+        (mavlink1 ? data[5] : (data[7] | (data[8] << 8) | (static_cast<uint32_t>(data[9]) << 16)));
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(msgid);
+
+#ifdef MAVLINK_CHECK_MESSAGE_LENGTH
+    if (entry == nullptr || payload_len < entry->min_msg_len ||
+        payload_len > entry->max_msg_len) {
+        return FastParseResult::FALLBACK;
+    }
 #endif
 
+    const uint16_t checksum = X25Crc::accumulate(
+        X25Crc::calculate(&data[1], header_len - 1 + payload_len),
+        static_cast<uint8_t>(entry ? entry->crc_extra : 0));
+
+    const uint8_t ck_a = data[header_len + payload_len];
+    const uint8_t ck_b = data[header_len + payload_len + 1];
+    if (ck_a != (checksum & 0xFF) || ck_b != (checksum >> 8)) {
+        // Bad CRCs are counted and resynced on by the parser.
+        return FastParseResult::FALLBACK;
+    }
+
+    // From here on we need to leave everything exactly as if the parser had
+    // seen the frame byte by byte.
+    mavlink_message_t* rxmsg = &_rx_message;
+    mavlink_status_t* status = &_rx_status;
+    rxmsg->magic = data[0];
+    rxmsg->len = payload_len;
+    if (mavlink1) {
+        rxmsg->incompat_flags = 0;
+        rxmsg->compat_flags = 0;
+        rxmsg->seq = data[2];
+        rxmsg->sysid = data[3];
+        rxmsg->compid = data[4];
+        status->flags |= MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    } else {
+        rxmsg->incompat_flags = data[2];
+        rxmsg->compat_flags = data[3];
+        rxmsg->seq = data[4];
+        rxmsg->sysid = data[5];
+        rxmsg->compid = data[6];
+        status->flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    }
+    rxmsg->msgid = msgid;
+    memcpy(_MAV_PAYLOAD_NON_CONST(rxmsg), &data[header_len], payload_len);
+    // Zero-fill to cope with truncated payloads.
+    if (entry && payload_len < entry->max_msg_len) {
+        memset(&_MAV_PAYLOAD_NON_CONST(rxmsg)[payload_len], 0, entry->max_msg_len - payload_len);
+    }
+    rxmsg->checksum = checksum;
+    rxmsg->ck[0] = ck_a;
+    rxmsg->ck[1] = ck_b;
+
+    status->msg_received = MAVLINK_FRAMING_OK;
+    status->parse_state = MAVLINK_PARSE_STATE_IDLE;
+    status->packet_idx = payload_len;
+    status->current_rx_seq = rxmsg->seq;
+    if (status->packet_rx_success_count == 0) {
+        status->packet_rx_drop_count = 0;
+    }
+    status->packet_rx_success_count++;
+    // Byte by byte, the parser reports the parse errors pending before each
+    // byte as drops and then clears them. Any from before the frame are gone
+    // after its first byte, so there are none left for the last one.
+    status->parse_error = 0;
+
+    memcpy(&_last_message, rxmsg, sizeof(mavlink_message_t));
+    _last_frame = data;
+    _last_frame_len = frame_len;
+
+    _status.parse_state = status->parse_state;
+    _status.packet_idx = status->packet_idx;
+    _status.current_rx_seq = status->current_rx_seq + 1;
+    _status.packet_rx_success_count = status->packet_rx_success_count;
+    _status.packet_rx_drop_count = status->parse_error;
+    _status.flags = status->flags;
+
+    consume(frame_len);
+    return FastParseResult::MESSAGE;
+}
+
+void MAVLinkReceiver::consume(unsigned len)
+{
+    _datagram += len;
+    _datagram_len -= len;
+}
+
 } // namespace mavsdk
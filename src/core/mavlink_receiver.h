@@ -2,54 +2,64 @@
 
 #include "mavlink_include.h"
 #include "global_include.h"
+#include "traffic_counters.h"
 #include <cstdint>
 
 namespace mavsdk {
 
+// Each receiver has its own parser state instead of using one of the global
+// channels of the MAVLink C library, so the number of receivers, and thus
+// connections, is not limited.
 class MAVLinkReceiver {
 public:
-    explicit MAVLinkReceiver(uint8_t channel);
-
-    uint8_t get_channel() { return _channel; }
+    MAVLinkReceiver();
 
     mavlink_message_t& get_last_message() { return _last_message; }
 
     mavlink_status_t& get_status() { return _status; }
 
+    // The bytes of the last message as they were received, e.g. to forward
+    // it as is. Only valid until the next call of parse_message().
+    const uint8_t* get_last_frame() const { return _last_frame; }
+    unsigned get_last_frame_len() const { return _last_frame_len; }
+
+    // Counts the bytes, messages and errors received, optional.
+    void set_traffic_counters(TrafficCounters* traffic_counters)
+    {
+        _traffic_counters = traffic_counters;
+    }
+
     void set_new_datagram(char* datagram, unsigned datagram_len);
 
     bool parse_message();
 
-#if DROP_DEBUG == 1
-    void debug_drop_rate();
-    void print_line(
-        const char* index,
-        unsigned count,
-        unsigned count_total,
-        unsigned overall_bytes,
-        unsigned overall_bytes_total);
-#endif
-
 private:
-    uint8_t _channel;
+    enum class FastParseResult { MESSAGE, FALLBACK };
+
+    bool parse_char(uint8_t c);
+    bool parser_idle();
+    unsigned find_start_marker();
+    FastParseResult parse_contiguous_frame();
+    void consume(unsigned len);
+
+    // The message being parsed and the parser state, what the C library
+    // would otherwise keep per channel.
+    mavlink_message_t _rx_message = {};
+    mavlink_status_t _rx_status = {};
+
     mavlink_message_t _last_message = {};
     mavlink_status_t _status = {};
+
+    // Frames going through the byte-wise parser are collected here, as
+    // they might be spread over several datagrams.
+    uint8_t _frame[MAVLINK_MAX_PACKET_LEN] = {};
+    unsigned _frame_len = 0;
+    const uint8_t* _last_frame = nullptr;
+    unsigned _last_frame_len = 0;
     char* _datagram = nullptr;
     unsigned _datagram_len = 0;
 
-#if DROP_DEBUG == 1
-    unsigned _bytes_received = 0;
-
-    unsigned _bytes_sent_overall = 0;
-    // unsigned _bytes_at_gimbal_overall = 0;
-    unsigned _bytes_at_camera_overall = 0;
-    unsigned _bytes_at_sdk_overall = 0;
-
-    bool _first = true;
-    dl_time_t _last_time;
-
-    double _time_elapsed = 0.0;
-#endif
+    TrafficCounters* _traffic_counters = nullptr;
 };
 
 } // namespace mavsdk
@@ -0,0 +1,426 @@
+#include "mavlink_receiver.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// Builds streams of frames, the way an autopilot would send them, plus some
+// garbage in between.
+class StreamGenerator {
+public:
+    StreamGenerator(uint8_t channel, unsigned seed) : _channel(channel), _rng(seed) {}
+
+    std::vector<uint8_t> make_stream(unsigned num_frames, bool with_garbage)
+    {
+        std::vector<uint8_t> stream;
+        for (unsigned i = 0; i < num_frames; ++i) {
+            if (with_garbage && random(0, 9) == 0) {
+                add_garbage(stream);
+            }
+            add_frame(stream);
+        }
+        return stream;
+    }
+
+    void corrupt(std::vector<uint8_t>& stream, unsigned num_corruptions)
+    {
+        for (unsigned i = 0; i < num_corruptions && !stream.empty(); ++i) {
+            const unsigned pos = random(0, static_cast<unsigned>(stream.size()) - 1);
+            switch (random(0, 4)) {
+                case 0:
+                    // Flip a bit.
+                    stream[pos] ^= static_cast<uint8_t>(1 << random(0, 7));
+                    break;
+                case 1:
+                    // Drop a byte.
+                    stream.erase(stream.begin() + pos);
+                    break;
+                case 2:
+                    // Insert a start marker.
+                    stream.insert(
+                        stream.begin() + pos,
+                        random(0, 1) ? MAVLINK_STX : MAVLINK_STX_MAVLINK1);
+                    break;
+                case 3:
+                    // Set the signed flag (or any other incompat flag).
+                    if (stream[pos] == MAVLINK_STX && pos + 2 < stream.size()) {
+                        stream[pos + 2] = static_cast<uint8_t>(random(1, 255));
+                    }
+                    break;
+                default:
+                    // Overwrite a byte.
+                    stream[pos] = static_cast<uint8_t>(random(0, 255));
+                    break;
+            }
+        }
+    }
+
+    // Cut the stream into datagrams of random length.
+    std::vector<std::vector<uint8_t>> split(const std::vector<uint8_t>& stream)
+    {
+        std::vector<std::vector<uint8_t>> datagrams;
+        unsigned pos = 0;
+        while (pos < stream.size()) {
+            const unsigned len =
+                std::min(random(1, 400), static_cast<unsigned>(stream.size()) - pos);
+            datagrams.emplace_back(stream.begin() + pos, stream.begin() + pos + len);
+            pos += len;
+        }
+        return datagrams;
+    }
+
+    unsigned random(unsigned min, unsigned max)
+    {
+        return std::uniform_int_distribution<unsigned>(min, max)(_rng);
+    }
+
+private:
+    void add_garbage(std::vector<uint8_t>& stream)
+    {
+        const unsigned len = random(1, 40);
+        for (unsigned i = 0; i < len; ++i) {
+            stream.push_back(static_cast<uint8_t>(random(0, 255)));
+        }
+    }
+
+    void add_frame(std::vector<uint8_t>& stream)
+    {
+        // Every now and then send MAVLink 1.
+        mavlink_status_t* status = mavlink_get_channel_status(_channel);
+        if (random(0, 7) == 0) {
+            status->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        } else {
+            status->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        }
+
+        const uint8_t sysid = static_cast<uint8_t>(random(1, 3));
+        const uint8_t compid = static_cast<uint8_t>(random(1, 200));
+        const float value = static_cast<float>(random(0, 1000)) / 10.0f;
+
+        mavlink_message_t message;
+        switch (random(0, 3)) {
+            case 0:
+                mavlink_msg_heartbeat_pack_chan(
+                    sysid, compid, _channel, &message, 2, 12, 0, random(0, 1), 4);
+                break;
+            case 1:
+                mavlink_msg_attitude_pack_chan(
+                    sysid,
+                    compid,
+                    _channel,
+                    &message,
+                    random(0, 100000),
+                    value,
+                    -value,
+                    0.0f,
+                    value,
+                    value,
+                    0.0f);
+                break;
+            case 2:
+                mavlink_msg_global_position_int_pack_chan(
+                    sysid,
+                    compid,
+                    _channel,
+                    &message,
+                    random(0, 100000),
+                    473977418,
+                    85455939,
+                    488000,
+                    static_cast<int32_t>(random(0, 10000)),
+                    0,
+                    0,
+                    0,
+                    static_cast<uint16_t>(random(0, 35999)));
+                break;
+            default:
+                mavlink_msg_command_long_pack_chan(
+                    sysid,
+                    compid,
+                    _channel,
+                    &message,
+                    1,
+                    1,
+                    400,
+                    0,
+                    value,
+                    0.0f,
+                    0.0f,
+                    0.0f,
+                    0.0f,
+                    0.0f,
+                    0.0f);
+                break;
+        }
+
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t len = mavlink_msg_to_send_buffer(buffer, &message);
+        stream.insert(stream.end(), buffer, buffer + len);
+    }
+
+    const uint8_t _channel;
+    std::mt19937 _rng;
+};
+
+void reset_channel(uint8_t channel)
+{
+    *mavlink_get_channel_status(channel) = mavlink_status_t{};
+    *mavlink_get_channel_buffer(channel) = mavlink_message_t{};
+}
+
+void expect_messages_eq(const mavlink_message_t& lhs, const mavlink_message_t& rhs)
+{
+    EXPECT_EQ(lhs.checksum, rhs.checksum);
+    EXPECT_EQ(lhs.magic, rhs.magic);
+    EXPECT_EQ(lhs.len, rhs.len);
+    EXPECT_EQ(lhs.incompat_flags, rhs.incompat_flags);
+    EXPECT_EQ(lhs.compat_flags, rhs.compat_flags);
+    EXPECT_EQ(lhs.seq, rhs.seq);
+    EXPECT_EQ(lhs.sysid, rhs.sysid);
+    EXPECT_EQ(lhs.compid, rhs.compid);
+    EXPECT_EQ(lhs.msgid, rhs.msgid);
+    EXPECT_EQ(0, memcmp(lhs.payload64, rhs.payload64, sizeof(lhs.payload64)));
+    EXPECT_EQ(0, memcmp(lhs.ck, rhs.ck, sizeof(lhs.ck)));
+    EXPECT_EQ(0, memcmp(lhs.signature, rhs.signature, sizeof(lhs.signature)));
+}
+
+void expect_status_eq(const mavlink_status_t& lhs, const mavlink_status_t& rhs)
+{
+    EXPECT_EQ(lhs.msg_received, rhs.msg_received);
+    EXPECT_EQ(lhs.buffer_overrun, rhs.buffer_overrun);
+    EXPECT_EQ(lhs.parse_error, rhs.parse_error);
+    EXPECT_EQ(lhs.parse_state, rhs.parse_state);
+    EXPECT_EQ(lhs.packet_idx, rhs.packet_idx);
+    EXPECT_EQ(lhs.current_rx_seq, rhs.current_rx_seq);
+    EXPECT_EQ(lhs.current_tx_seq, rhs.current_tx_seq);
+    EXPECT_EQ(lhs.packet_rx_success_count, rhs.packet_rx_success_count);
+    EXPECT_EQ(lhs.packet_rx_drop_count, rhs.packet_rx_drop_count);
+    EXPECT_EQ(lhs.flags, rhs.flags);
+    EXPECT_EQ(lhs.signature_wait, rhs.signature_wait);
+}
+
+class MAVLinkReceiverTest : public ::testing::Test {
+protected:
+    void SetUp() override { reset_channel(_generator_channel); }
+
+    // Parse the datagrams with the receiver and with plain mavlink_parse_char
+    // on a channel of the C library and check that they agree on everything
+    // along the way.
+    unsigned compare_with_reference(std::vector<std::vector<uint8_t>>& datagrams)
+    {
+        reset_channel(_reference_channel);
+
+        MAVLinkReceiver receiver;
+        mavlink_message_t reference_message{};
+        mavlink_status_t reference_status{};
+        unsigned num_messages = 0;
+
+        for (auto& datagram : datagrams) {
+            std::vector<mavlink_message_t> reference_messages;
+            std::vector<mavlink_status_t> reference_statuses;
+            for (auto byte : datagram) {
+                if (mavlink_parse_char(
+                        _reference_channel, byte, &reference_message, &reference_status) == 1) {
+                    reference_messages.push_back(reference_message);
+                    reference_statuses.push_back(reference_status);
+                }
+            }
+
+            receiver.set_new_datagram(
+                reinterpret_cast<char*>(datagram.data()), static_cast<unsigned>(datagram.size()));
+
+            // The status is also what a caller sees with each message.
+            std::vector<mavlink_message_t> messages;
+            std::vector<mavlink_status_t> statuses;
+            while (receiver.parse_message()) {
+                messages.push_back(receiver.get_last_message());
+                statuses.push_back(receiver.get_status());
+            }
+
+            EXPECT_EQ(messages.size(), reference_messages.size());
+            for (unsigned i = 0; i < std::min(messages.size(), reference_messages.size()); ++i) {
+                expect_messages_eq(messages[i], reference_messages[i]);
+                expect_status_eq(statuses[i], reference_statuses[i]);
+            }
+
+            expect_messages_eq(receiver.get_last_message(), reference_message);
+            expect_status_eq(receiver.get_status(), reference_status);
+
+            if (HasFailure()) {
+                break;
+            }
+
+            num_messages += static_cast<unsigned>(messages.size());
+        }
+        return num_messages;
+    }
+
+    const uint8_t _generator_channel{MAVLINK_COMM_0};
+    const uint8_t _reference_channel{MAVLINK_COMM_1};
+};
+
+} // namespace
+
+TEST_F(MAVLinkReceiverTest, ParsesAllFramesInOneDatagram)
+{
+    StreamGenerator generator(_generator_channel, 1);
+    auto stream = generator.make_stream(100, true);
+
+    MAVLinkReceiver receiver;
+    receiver.set_new_datagram(
+        reinterpret_cast<char*>(stream.data()), static_cast<unsigned>(stream.size()));
+
+    unsigned num_messages = 0;
+    while (receiver.parse_message()) {
+        ++num_messages;
+    }
+    EXPECT_EQ(num_messages, 100);
+    EXPECT_EQ(receiver.get_status().packet_rx_success_count, 100);
+}
+
+TEST_F(MAVLinkReceiverTest, SameAsReferenceOnCleanStream)
+{
+    StreamGenerator generator(_generator_channel, 2);
+    auto stream = generator.make_stream(2000, false);
+    auto datagrams = generator.split(stream);
+
+    EXPECT_EQ(compare_with_reference(datagrams), 2000);
+}
+
+TEST_F(MAVLinkReceiverTest, SameAsReferenceOnCorruptedStreams)
+{
+    for (unsigned seed = 0; seed < 20; ++seed) {
+        StreamGenerator generator(_generator_channel, 100 + seed);
+        auto stream = generator.make_stream(500, true);
+        generator.corrupt(stream, generator.random(1, 200));
+        auto datagrams = generator.split(stream);
+
+        compare_with_reference(datagrams);
+        ASSERT_FALSE(HasFailure()) << "seed: " << seed;
+    }
+}
+
+TEST_F(MAVLinkReceiverTest, SameAsReferenceAfterBadCrcsAndSequenceGaps)
+{
+    StreamGenerator generator(_generator_channel, 4);
+    std::vector<uint8_t> stream;
+    for (unsigned i = 0; i < 200; ++i) {
+        auto frame = generator.make_stream(1, false);
+        if (i % 5 == 1) {
+            // Lost on the way, which leaves a gap in the sequence.
+            continue;
+        }
+        if (i % 7 == 3) {
+            // Bad CRC, with the next frame following right after it.
+            frame.back() ^= 0xff;
+        }
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    std::vector<std::vector<uint8_t>> datagrams{stream};
+
+    compare_with_reference(datagrams);
+}
+
+TEST_F(MAVLinkReceiverTest, SameAsReferenceOnRandomBytes)
+{
+    StreamGenerator generator(_generator_channel, 3);
+    std::vector<uint8_t> stream;
+    for (unsigned i = 0; i < 100000; ++i) {
+        // Plenty of start markers to get the parser going.
+        const unsigned byte =
+            (generator.random(0, 7) == 0 ? MAVLINK_STX : generator.random(0, 255));
+        stream.push_back(static_cast<uint8_t>(byte));
+    }
+    auto datagrams = generator.split(stream);
+
+    compare_with_reference(datagrams);
+}
+
+TEST_F(MAVLinkReceiverTest, ReceiversDontShareState)
+{
+    StreamGenerator generator(_generator_channel, 4);
+    auto stream = generator.make_stream(10, false);
+
+    // More receivers than the C library has channels, each fed half a frame.
+    std::vector<std::unique_ptr<MAVLinkReceiver>> receivers;
+    for (unsigned i = 0; i < 300; ++i) {
+        receivers.emplace_back(new MAVLinkReceiver());
+        receivers.back()->set_new_datagram(reinterpret_cast<char*>(stream.data()), 5);
+        EXPECT_FALSE(receivers.back()->parse_message());
+    }
+
+    for (auto& receiver : receivers) {
+        receiver->set_new_datagram(
+            reinterpret_cast<char*>(stream.data()) + 5, static_cast<unsigned>(stream.size()) - 5);
+        unsigned num_messages = 0;
+        while (receiver->parse_message()) {
+            ++num_messages;
+        }
+        EXPECT_EQ(num_messages, 10);
+    }
+}
+
+TEST_F(MAVLinkReceiverTest, KeepsFramesAsReceived)
+{
+    StreamGenerator generator(_generator_channel, 5);
+    auto stream = generator.make_stream(1000, false);
+    auto datagrams = generator.split(stream);
+
+    // Whether a frame is parsed in one go or split across datagrams, its
+    // bytes put back together give the stream again.
+    MAVLinkReceiver receiver;
+    std::vector<uint8_t> frames;
+    for (auto& datagram : datagrams) {
+        receiver.set_new_datagram(
+            reinterpret_cast<char*>(datagram.data()), static_cast<unsigned>(datagram.size()));
+        while (receiver.parse_message()) {
+            frames.insert(
+                frames.end(),
+                receiver.get_last_frame(),
+                receiver.get_last_frame() + receiver.get_last_frame_len());
+        }
+    }
+    EXPECT_EQ(frames, stream);
+}
+
+TEST_F(MAVLinkReceiverTest, CountsTraffic)
+{
+    StreamGenerator generator(_generator_channel, 6);
+    auto stream = generator.make_stream(100, false);
+    auto datagrams = generator.split(stream);
+
+    TrafficCounters counters;
+    MAVLinkReceiver receiver;
+    receiver.set_traffic_counters(&counters);
+    for (auto& datagram : datagrams) {
+        receiver.set_new_datagram(
+            reinterpret_cast<char*>(datagram.data()), static_cast<unsigned>(datagram.size()));
+        while (receiver.parse_message()) {}
+    }
+
+    auto stats = counters.stats();
+    EXPECT_EQ(stats.bytes_received, stream.size());
+    EXPECT_EQ(stats.messages_received, 100u);
+    EXPECT_EQ(stats.parse_errors, 0u);
+    EXPECT_EQ(stats.crc_errors, 0u);
+
+    // Garbage, then a frame with a broken checksum.
+    std::vector<uint8_t> broken = {0x11, 0x22, 0x33};
+    auto frame = generator.make_stream(1, false);
+    frame.back() ^= 0xff;
+    broken.insert(broken.end(), frame.begin(), frame.end());
+    receiver.set_new_datagram(
+        reinterpret_cast<char*>(broken.data()), static_cast<unsigned>(broken.size()));
+    EXPECT_FALSE(receiver.parse_message());
+
+    stats = counters.stats();
+    EXPECT_EQ(stats.bytes_received, stream.size() + broken.size());
+    EXPECT_EQ(stats.messages_received, 100u);
+    EXPECT_EQ(stats.parse_errors, 1u);
+    EXPECT_EQ(stats.crc_errors, 1u);
+}
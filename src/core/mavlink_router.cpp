@@ -0,0 +1,141 @@
+#include "mavlink_router.h"
+#include "connection.h"
+
+namespace mavsdk {
+
+void MAVLinkRouter::add_connection(std::shared_ptr<Connection> connection)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& routes = _connections[connection.get()];
+    if (!routes) {
+        routes.reset(new Routes());
+        routes->connection = connection;
+    }
+}
+
+void MAVLinkRouter::remove_connection(Connection* connection)
+{
+    // Released outside of the lock in case it is the last reference: the
+    // connection joins its receiver on destruction, which might be waiting
+    // for the lock in forward().
+    std::unique_ptr<Routes> removed;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _connections.find(connection);
+        if (it == _connections.end()) {
+            return;
+        }
+        removed = std::move(it->second);
+        _connections.erase(it);
+    }
+}
+
+void MAVLinkRouter::clear()
+{
+    std::map<Connection*, std::unique_ptr<Routes>> removed;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        removed.swap(_connections);
+    }
+}
+
+void MAVLinkRouter::forward(
+    Connection& from, const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len)
+{
+    std::vector<std::shared_ptr<Connection>> targets;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!find_targets(from, message, targets)) {
+            ++_num_without_route;
+            return;
+        }
+    }
+
+    for (const auto& connection : targets) {
+        if (connection->queue_forwarded(message, frame, frame_len)) {
+            ++_num_forwarded;
+        }
+    }
+}
+
+bool MAVLinkRouter::find_targets(
+    Connection& from,
+    const mavlink_message_t& message,
+    std::vector<std::shared_ptr<Connection>>& targets)
+{
+    auto from_it = _connections.find(&from);
+    if (from_it == _connections.end()) {
+        return true;
+    }
+
+    if (message.sysid != 0) {
+        from_it->second->system_ids.set(message.sysid);
+        from_it->second->components.set(key(message.sysid, message.compid));
+    }
+
+    const Target target = target_of(message);
+    const bool only_system_known =
+        target.system_id != 0 && target.component_id != 0 &&
+        !component_seen_anywhere(target.system_id, target.component_id);
+
+    for (const auto& it : _connections) {
+        if (it.first == &from) {
+            continue;
+        }
+        const Routes& routes = *it.second;
+
+        if (target.system_id == 0) {
+            targets.push_back(routes.connection);
+        } else if (routes.system_ids[target.system_id]) {
+            if (target.component_id == 0 || only_system_known ||
+                routes.components[key(target.system_id, target.component_id)]) {
+                targets.push_back(routes.connection);
+            }
+        }
+    }
+
+    return !targets.empty() || target.system_id == 0;
+}
+
+MAVLinkRouter::Stats MAVLinkRouter::stats() const
+{
+    Stats stats;
+    stats.num_forwarded = _num_forwarded;
+    stats.num_without_route = _num_without_route;
+    return stats;
+}
+
+MAVLinkRouter::Target MAVLinkRouter::target_of(const mavlink_message_t& message)
+{
+    Target target;
+
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(message.msgid);
+    if (entry == nullptr) {
+        return target;
+    }
+
+    // Trailing zeros of the payload are cut off when sending, so a target
+    // beyond the length is 0.
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(message.payload64);
+    if ((entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM) &&
+        entry->target_system_ofs < message.len) {
+        target.system_id = payload[entry->target_system_ofs];
+    }
+    if ((entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_COMPONENT) &&
+        entry->target_component_ofs < message.len) {
+        target.component_id = payload[entry->target_component_ofs];
+    }
+    return target;
+}
+
+bool MAVLinkRouter::component_seen_anywhere(uint8_t system_id, uint8_t component_id) const
+{
+    for (const auto& it : _connections) {
+        if (it.second->components[key(system_id, component_id)]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace mavsdk
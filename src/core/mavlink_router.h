@@ -0,0 +1,93 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mavsdk {
+
+class Connection;
+
+// Forwards messages between connections, like mavlink-router or the routing
+// of an autopilot does, so no separate router process is needed.
+//
+// Every connection which forwards learns from the traffic it receives which
+// systems and components are behind it. Messages without target and
+// broadcasts go to all other forwarding connections. Messages with a target
+// only go where the target has been seen, or, if its component has not been
+// seen anywhere yet, to where its system has been seen. The frames are sent
+// as they were received.
+//
+// Forwarded frames go through the send queue of the target connection in
+// its lowest class, so they are subject to its rate limit and can't hold up
+// our own messages. The router's lock is only held to pick the targets,
+// never while sending.
+class MAVLinkRouter {
+public:
+    struct Stats {
+        uint64_t num_forwarded{0};
+        uint64_t num_without_route{0};
+    };
+
+    MAVLinkRouter() = default;
+    ~MAVLinkRouter() = default;
+
+    // delete copy and move constructors and assign operators
+    MAVLinkRouter(MAVLinkRouter const&) = delete; // Copy construct
+    MAVLinkRouter(MAVLinkRouter&&) = delete; // Move construct
+    MAVLinkRouter& operator=(MAVLinkRouter const&) = delete; // Copy assign
+    MAVLinkRouter& operator=(MAVLinkRouter&&) = delete; // Move assign
+
+    void add_connection(std::shared_ptr<Connection> connection);
+    void remove_connection(Connection* connection);
+    void clear();
+
+    // Called for every message received on a forwarding connection. A
+    // message being forwarded while its target is removed can still be
+    // queued on it, but isn't sent once the connection is stopped.
+    void forward(
+        Connection& from,
+        const mavlink_message_t& message,
+        const uint8_t* frame,
+        unsigned frame_len);
+
+    Stats stats() const;
+
+    struct Target {
+        uint8_t system_id{0};
+        uint8_t component_id{0};
+    };
+    static Target target_of(const mavlink_message_t& message);
+
+private:
+    struct Routes {
+        std::shared_ptr<Connection> connection{};
+        std::bitset<256> system_ids{};
+        std::bitset<256 * 256> components{};
+    };
+
+    static unsigned key(uint8_t system_id, uint8_t component_id)
+    {
+        return (unsigned(system_id) << 8) | component_id;
+    }
+
+    // Learns the routes from the message and adds where it goes to targets.
+    // Returns false if it has a target but no route to it.
+    bool find_targets(
+        Connection& from,
+        const mavlink_message_t& message,
+        std::vector<std::shared_ptr<Connection>>& targets);
+    bool component_seen_anywhere(uint8_t system_id, uint8_t component_id) const;
+
+    mutable std::mutex _mutex{};
+    std::map<Connection*, std::unique_ptr<Routes>> _connections{};
+    std::atomic<uint64_t> _num_forwarded{0};
+    std::atomic<uint64_t> _num_without_route{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,228 @@
+#include "mavlink_router.h"
+#include "connection.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// Records the frames its send queue sends.
+class FakeConnection : public Connection {
+public:
+    FakeConnection() : Connection([](mavlink_message_t&) {}) {}
+    ~FakeConnection() { stop(); }
+
+    ConnectionResult start() override
+    {
+        start_send_queue();
+        return ConnectionResult::SUCCESS;
+    }
+
+    ConnectionResult stop() override
+    {
+        stop_send_queue();
+        return ConnectionResult::SUCCESS;
+    }
+
+    bool send_message(const mavlink_message_t&) override { return true; }
+
+    bool send_frame(const mavlink_message_t&, const uint8_t* frame, unsigned frame_len) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _frames.emplace_back(frame, frame + frame_len);
+        return true;
+    }
+
+    std::vector<std::vector<uint8_t>> frames()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _frames;
+    }
+
+    void clear_frames()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _frames.clear();
+    }
+
+    // delete copy and move constructors and assign operators
+    FakeConnection(FakeConnection const&) = delete; // Copy construct
+    FakeConnection(FakeConnection&&) = delete; // Move construct
+    FakeConnection& operator=(FakeConnection const&) = delete; // Copy assign
+    FakeConnection& operator=(FakeConnection&&) = delete; // Move assign
+
+private:
+    std::mutex _mutex{};
+    std::vector<std::vector<uint8_t>> _frames{};
+};
+
+struct Frame {
+    mavlink_message_t message{};
+    std::vector<uint8_t> bytes{};
+};
+
+Frame heartbeat(uint8_t system_id, uint8_t component_id)
+{
+    Frame frame;
+    mavlink_msg_heartbeat_pack(system_id, component_id, &frame.message, 0, 0, 0, 0, 0);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t len = mavlink_msg_to_send_buffer(buffer, &frame.message);
+    frame.bytes.assign(buffer, buffer + len);
+    return frame;
+}
+
+Frame command(uint8_t target_system_id, uint8_t target_component_id)
+{
+    Frame frame;
+    mavlink_msg_command_long_pack(
+        255,
+        190,
+        &frame.message,
+        target_system_id,
+        target_component_id,
+        400,
+        0,
+        1.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t len = mavlink_msg_to_send_buffer(buffer, &frame.message);
+    frame.bytes.assign(buffer, buffer + len);
+    return frame;
+}
+
+} // namespace
+
+class MAVLinkRouterTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        for (const auto& connection : {_gcs, _autopilot, _other}) {
+            connection->start();
+            _router.add_connection(connection);
+        }
+    }
+
+    // Forwards the frame and waits until everything forwarded so far has
+    // left the send queues.
+    void forward(FakeConnection& from, const Frame& frame)
+    {
+        _router.forward(
+            from, frame.message, frame.bytes.data(), static_cast<unsigned>(frame.bytes.size()));
+
+        for (unsigned i = 0; i < 1000; ++i) {
+            if (_num_frames_seen + num_frames() >= _router.stats().num_forwarded) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        FAIL() << "Forwarded frames not sent";
+    }
+
+    size_t num_frames()
+    {
+        return _gcs->frames().size() + _autopilot->frames().size() + _other->frames().size();
+    }
+
+    void clear_frames()
+    {
+        _num_frames_seen += num_frames();
+        _gcs->clear_frames();
+        _autopilot->clear_frames();
+        _other->clear_frames();
+    }
+
+    MAVLinkRouter _router{};
+    std::shared_ptr<FakeConnection> _gcs{std::make_shared<FakeConnection>()};
+    std::shared_ptr<FakeConnection> _autopilot{std::make_shared<FakeConnection>()};
+    std::shared_ptr<FakeConnection> _other{std::make_shared<FakeConnection>()};
+    size_t _num_frames_seen{0};
+};
+
+TEST_F(MAVLinkRouterTest, ForwardsBroadcastsToAllOthers)
+{
+    const Frame frame = heartbeat(1, 1);
+    forward(*_autopilot, frame);
+
+    EXPECT_EQ(_autopilot->frames().size(), 0u);
+    ASSERT_EQ(_gcs->frames().size(), 1u);
+    ASSERT_EQ(_other->frames().size(), 1u);
+    EXPECT_EQ(_gcs->frames()[0], frame.bytes);
+    EXPECT_EQ(_other->frames()[0], frame.bytes);
+
+    // Through the send queue, behind our own messages.
+    const auto stats = _gcs->send_queue_stats();
+    EXPECT_EQ(stats[static_cast<unsigned>(SendQueue::Priority::BULK)].num_sent, 1u);
+    EXPECT_EQ(stats[static_cast<unsigned>(SendQueue::Priority::CONTROL)].num_sent, 0u);
+
+    // Explicitly addressed to everyone.
+    forward(*_gcs, command(0, 0));
+    EXPECT_EQ(_autopilot->frames().size(), 1u);
+    EXPECT_EQ(_other->frames().size(), 2u);
+}
+
+TEST_F(MAVLinkRouterTest, ForwardsTargetedOnlyWhereTargetWasSeen)
+{
+    forward(*_autopilot, heartbeat(1, 1));
+    forward(*_other, heartbeat(2, 1));
+    clear_frames();
+
+    const Frame frame = command(1, 1);
+    forward(*_gcs, frame);
+    ASSERT_EQ(_autopilot->frames().size(), 1u);
+    EXPECT_EQ(_autopilot->frames()[0], frame.bytes);
+    EXPECT_EQ(_other->frames().size(), 0u);
+    EXPECT_EQ(_gcs->frames().size(), 0u);
+
+    // A component we haven't heard of yet is likely behind its system.
+    forward(*_gcs, command(2, 100));
+    EXPECT_EQ(_autopilot->frames().size(), 1u);
+    EXPECT_EQ(_other->frames().size(), 1u);
+
+    // But not once it has been seen elsewhere.
+    forward(*_autopilot, heartbeat(2, 100));
+    clear_frames();
+    forward(*_gcs, command(2, 100));
+    EXPECT_EQ(_autopilot->frames().size(), 1u);
+    EXPECT_EQ(_other->frames().size(), 0u);
+
+    // Nobody knows system 3.
+    clear_frames();
+    forward(*_gcs, command(3, 1));
+    EXPECT_EQ(_autopilot->frames().size(), 0u);
+    EXPECT_EQ(_other->frames().size(), 0u);
+    EXPECT_EQ(_router.stats().num_without_route, 1u);
+}
+
+TEST_F(MAVLinkRouterTest, DoesNotUseRemovedConnections)
+{
+    _router.remove_connection(_other.get());
+
+    forward(*_autopilot, heartbeat(1, 1));
+    EXPECT_EQ(_gcs->frames().size(), 1u);
+    EXPECT_EQ(_other->frames().size(), 0u);
+
+    // And doesn't forward what it receives.
+    forward(*_other, heartbeat(2, 1));
+    EXPECT_EQ(_gcs->frames().size(), 1u);
+    EXPECT_EQ(_autopilot->frames().size(), 0u);
+}
+
+TEST_F(MAVLinkRouterTest, DoesNotForwardToStoppedConnections)
+{
+    _other->stop();
+
+    forward(*_autopilot, heartbeat(1, 1));
+    EXPECT_EQ(_gcs->frames().size(), 1u);
+    EXPECT_EQ(_other->frames().size(), 0u);
+    EXPECT_EQ(_router.stats().num_forwarded, 1u);
+}
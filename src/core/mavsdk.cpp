@@ -14,9 +14,10 @@ std::string Mavsdk::version() const
     return _impl->version();
 }
 
-ConnectionResult Mavsdk::add_any_connection(const std::string& connection_url)
+ConnectionResult
+Mavsdk::add_any_connection(const std::string& connection_url, ForwardingOption forwarding_option)
 {
-    return _impl->add_any_connection(connection_url);
+    return _impl->add_any_connection(connection_url, forwarding_option);
 }
 
 ConnectionResult Mavsdk::add_udp_connection(int local_port)
@@ -24,9 +25,10 @@ ConnectionResult Mavsdk::add_udp_connection(int local_port)
     return Mavsdk::add_udp_connection(DEFAULT_UDP_BIND_IP, local_port);
 }
 
-ConnectionResult Mavsdk::add_udp_connection(const std::string& local_bind_ip, const int local_port)
+ConnectionResult Mavsdk::add_udp_connection(
+    const std::string& local_bind_ip, const int local_port, ForwardingOption forwarding_option)
 {
-    return _impl->add_udp_connection(local_bind_ip, local_port);
+    return _impl->add_udp_connection(local_bind_ip, local_port, forwarding_option);
 }
 
 ConnectionResult Mavsdk::setup_udp_remote(const std::string& remote_ip, int remote_port)
@@ -34,14 +36,30 @@ ConnectionResult Mavsdk::setup_udp_remote(const std::string& remote_ip, int remo
     return _impl->setup_udp_remote(remote_ip, remote_port);
 }
 
-ConnectionResult Mavsdk::add_tcp_connection(const std::string& remote_ip, const int remote_port)
+ConnectionResult Mavsdk::add_tcp_connection(
+    const std::string& remote_ip, const int remote_port, ForwardingOption forwarding_option)
 {
-    return _impl->add_tcp_connection(remote_ip, remote_port);
+    return _impl->add_tcp_connection(remote_ip, remote_port, forwarding_option);
 }
 
-ConnectionResult Mavsdk::add_serial_connection(const std::string& dev_path, const int baudrate)
+ConnectionResult Mavsdk::add_tcp_server_connection(
+    const std::string& local_ip, const int local_port, ForwardingOption forwarding_option)
 {
-    return _impl->add_serial_connection(dev_path, baudrate);
+    return _impl->add_tcp_server_connection(local_ip, local_port, forwarding_option);
+}
+
+ConnectionResult Mavsdk::add_serial_connection(
+    const std::string& dev_path,
+    const int baudrate,
+    bool low_latency,
+    ForwardingOption forwarding_option)
+{
+    return _impl->add_serial_connection(dev_path, baudrate, low_latency, forwarding_option);
+}
+
+bool Mavsdk::enable_io_reactor(unsigned num_threads)
+{
+    return _impl->enable_io_reactor(num_threads);
 }
 
 void Mavsdk::set_configuration(Configuration configuration)
@@ -49,6 +67,41 @@ void Mavsdk::set_configuration(Configuration configuration)
     _impl->set_configuration(configuration);
 }
 
+void Mavsdk::set_num_callback_threads(unsigned num_threads)
+{
+    _impl->set_num_callback_threads(num_threads);
+}
+
+void Mavsdk::set_send_rate_limit(double bytes_per_s)
+{
+    _impl->set_send_rate_limit(bytes_per_s);
+}
+
+std::vector<Mavsdk::ConnectionSendStats> Mavsdk::send_stats() const
+{
+    return _impl->send_stats();
+}
+
+std::vector<Mavsdk::ConnectionReceiveStats> Mavsdk::receive_stats() const
+{
+    return _impl->receive_stats();
+}
+
+std::vector<TrafficStats> Mavsdk::connection_traffic_stats() const
+{
+    return _impl->connection_traffic_stats();
+}
+
+void Mavsdk::enable_latency_tracing(bool enabled)
+{
+    _impl->enable_latency_tracing(enabled);
+}
+
+std::vector<Mavsdk::LatencyStats> Mavsdk::latency_stats() const
+{
+    return _impl->latency_stats();
+}
+
 std::vector<uint64_t> Mavsdk::system_uuids() const
 {
     return _impl->get_system_uuids();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <vector>
@@ -13,6 +14,17 @@ namespace mavsdk {
 class MavsdkImpl;
 class System;
 
+/**
+ * @brief Whether messages received on a connection are forwarded to other connections.
+ *
+ * Messages are forwarded between all connections added with forwarding on, e.g. from
+ * the serial link of an autopilot to several UDP ground stations, as a MAVLink router would.
+ */
+enum class ForwardingOption {
+    ForwardingOff = 0, /**< @brief Messages are only used by MAVSDK itself. */
+    ForwardingOn = 1 /**< @brief Messages are also forwarded to other forwarding connections. */
+};
+
 /**
  * @brief This is the main class of MAVSDK (a MAVLink API Library).
 
@@ -31,6 +43,10 @@ public:
     static constexpr auto DEFAULT_TCP_REMOTE_IP = "127.0.0.1";
     /** @brief Default TCP remote port. */
     static constexpr int DEFAULT_TCP_REMOTE_PORT = 5760;
+    /** @brief Default TCP server bind IP (accepts clients on any interface). */
+    static constexpr auto DEFAULT_TCP_SERVER_BIND_IP = "0.0.0.0";
+    /** @brief Default TCP server port. */
+    static constexpr int DEFAULT_TCP_SERVER_PORT = 5760;
     /** @brief Default serial baudrate. */
     static constexpr int DEFAULT_SERIAL_BAUDRATE = 57600;
 
@@ -62,12 +78,17 @@ public:
      * Connection URL format should be:
      * - UDP - udp://[Bind_host][:Bind_port]
      * - TCP - tcp://[Remote_host][:Remote_port]
+     * - TCP server - tcpin://[Bind_host][:Bind_port]
      * - Serial - serial://Dev_Node[:Baudrate]
      *
      * @param connection_url connection URL string.
+     * @param forwarding_option Whether to forward messages to and from other connections
+     * (defaults to off).
      * @return The result of adding the connection.
      */
-    ConnectionResult add_any_connection(const std::string& connection_url);
+    ConnectionResult add_any_connection(
+        const std::string& connection_url,
+        ForwardingOption forwarding_option = ForwardingOption::ForwardingOff);
 
     /**
      * @brief Adds a UDP connection to the specified port number.
@@ -87,10 +108,14 @@ public:
      *
      * @param local_ip The local UDP IP address to listen to.
      * @param local_port The local UDP port to listen to (defaults to 14540, the same as MAVROS).
+     * @param forwarding_option Whether to forward messages to and from other connections
+     * (defaults to off).
      * @return The result of adding the connection.
      */
-    ConnectionResult
-    add_udp_connection(const std::string& local_ip, int local_port = DEFAULT_UDP_PORT);
+    ConnectionResult add_udp_connection(
+        const std::string& local_ip,
+        int local_port = DEFAULT_UDP_PORT,
+        ForwardingOption forwarding_option = ForwardingOption::ForwardingOff);
 
     /**
      * @brief Sets up instance to send heartbeats to the specified remote interface and port number.
@@ -114,22 +139,76 @@ public:
      *
      * @param remote_ip Remote IP address to connect to.
      * @param remote_port The TCP port to connect to (defaults to 5760).
+     * @param forwarding_option Whether to forward messages to and from other connections
+     * (defaults to off).
      * @return The result of adding the connection.
      */
-    ConnectionResult
-    add_tcp_connection(const std::string& remote_ip, int remote_port = DEFAULT_TCP_REMOTE_PORT);
+    ConnectionResult add_tcp_connection(
+        const std::string& remote_ip,
+        int remote_port = DEFAULT_TCP_REMOTE_PORT,
+        ForwardingOption forwarding_option = ForwardingOption::ForwardingOff);
+
+    /**
+     * @brief Listens for TCP clients on the specified port and local interface.
+     *
+     * Any number of clients can connect, e.g. several ground stations. Messages are sent to
+     * all of them and messages from any of them are received. A client which can't keep up
+     * misses messages instead of slowing down the others.
+     *
+     * Not supported on Windows.
+     *
+     * @param local_ip The local IP address to listen on (use 0.0.0.0 for any interface).
+     * @param local_port The local TCP port to listen on (defaults to 5760).
+     * @param forwarding_option Whether to forward messages to and from other connections
+     * (defaults to off).
+     * @return The result of adding the connection.
+     */
+    ConnectionResult add_tcp_server_connection(
+        const std::string& local_ip = DEFAULT_TCP_SERVER_BIND_IP,
+        int local_port = DEFAULT_TCP_SERVER_PORT,
+        ForwardingOption forwarding_option = ForwardingOption::ForwardingOff);
 
     /**
      * @brief Adds a serial connection with a specific port (COM or UART dev node) and baudrate as
      * specified.
      *
+     * Baudrates which are not one of the standard ones (e.g. 1500000 or 2000000) are supported
+     * on Linux.
+     *
+     * In low latency mode the port is polled and read without blocking and, on Linux, the driver
+     * is asked to forward received bytes right away. This reduces the delay of incoming messages
+     * at the cost of some more wakeups, which is useful for fast links such as USB-serial
+     * adapters to a companion computer.
      *
      * @param dev_path COM or UART dev node name/path (e.g. "/dev/ttyS0", or "COM3" on Windows).
      * @param baudrate Baudrate of the serial port (defaults to 57600).
+     * @param low_latency Read the port in low latency mode (defaults to false, not supported on
+     * Windows).
+     * @param forwarding_option Whether to forward messages to and from other connections
+     * (defaults to off).
      * @return The result of adding the connection.
      */
-    ConnectionResult
-    add_serial_connection(const std::string& dev_path, int baudrate = DEFAULT_SERIAL_BAUDRATE);
+    ConnectionResult add_serial_connection(
+        const std::string& dev_path,
+        int baudrate = DEFAULT_SERIAL_BAUDRATE,
+        bool low_latency = false,
+        ForwardingOption forwarding_option = ForwardingOption::ForwardingOff);
+
+    /**
+     * @brief Service all connections from a shared I/O reactor.
+     *
+     * By default every connection runs its own receive thread. With the reactor
+     * enabled, connections added afterwards are instead serviced by a small pool of
+     * epoll threads which parse incoming data as soon as it is available. This is
+     * useful when a lot of connections are used in one process.
+     *
+     * This needs to be called before adding the connections and is only supported
+     * on Linux.
+     *
+     * @param num_threads Number of reactor threads the connections are spread across.
+     * @return `true` if the reactor is running.
+     */
+    bool enable_io_reactor(unsigned num_threads = 1);
 
     /**
      * @brief Possible configurations.
@@ -151,6 +230,137 @@ public:
      */
     void set_configuration(Configuration configuration);
 
+    /**
+     * @brief Set the number of threads used to call user callbacks.
+     *
+     * Callbacks of the same subscription are always called one at a time and in
+     * order, callbacks of different subscriptions can run in parallel on these threads.
+     * The default is 3 threads.
+     *
+     * This needs to be called before adding connections, systems which have
+     * already been discovered keep their threads.
+     *
+     * @param num_threads Number of callback threads per system (at least 1).
+     */
+    void set_num_callback_threads(unsigned num_threads);
+
+    /**
+     * @brief Limit the rate at which connections added afterwards send.
+     *
+     * Outgoing messages are queued per connection and sent by priority: heartbeats and
+     * setpoints first, then commands, then requests and all other messages, and bulk
+     * transfers such as FTP, log downloads, missions and RTCM corrections last. Sending
+     * never blocks the caller.
+     *
+     * By default serial connections are limited to what their baudrate allows, so that bulk
+     * transfers can't delay commands in the buffers of radios, and other connections are
+     * not limited.
+     *
+     * @param bytes_per_s Maximum rate in bytes per second, 0 for the default.
+     */
+    void set_send_rate_limit(double bytes_per_s);
+
+    /**
+     * @brief Statistics of one priority class of the send queue of a connection.
+     */
+    struct SendStats {
+        unsigned queue_depth; /**< @brief Messages waiting to be sent. */
+        uint64_t num_sent; /**< @brief Messages sent so far. */
+        uint64_t num_dropped; /**< @brief Messages dropped because the queue was full or the
+                                 connection was stopped. */
+        uint64_t num_failed; /**< @brief Messages the connection failed to send. */
+        double mean_latency_s; /**< @brief Average time messages waited to be sent. */
+        double max_latency_s; /**< @brief Longest time a message waited to be sent. */
+    };
+
+    /**
+     * @brief Statistics of the send queue of a connection.
+     */
+    struct ConnectionSendStats {
+        SendStats control; /**< @brief Heartbeats and setpoints. */
+        SendStats command; /**< @brief Commands, mode changes and param sets. */
+        SendStats telemetry; /**< @brief Requests and all other messages. */
+        SendStats bulk; /**< @brief File, log, mission and RTCM transfers. */
+    };
+
+    /**
+     * @brief Get the send queue statistics of all connections.
+     *
+     * @return One entry per connection, in the order the connections were added.
+     */
+    std::vector<ConnectionSendStats> send_stats() const;
+
+    /**
+     * @brief Statistics of the messages received on a connection.
+     *
+     * If a system is connected over several connections, e.g. a telemetry radio and LTE,
+     * every message is only processed once, when it arrives first. Later copies of it
+     * are dropped. The statistics show which connection delivers first, and are only
+     * counted while there is more than one connection.
+     */
+    struct ConnectionReceiveStats {
+        uint64_t num_first; /**< @brief Messages this connection delivered first. */
+        uint64_t num_duplicates; /**< @brief Messages dropped because another connection
+                                    had delivered them already. */
+    };
+
+    /**
+     * @brief Get the receive statistics of all connections.
+     *
+     * @return One entry per connection, in the order the connections were added.
+     */
+    std::vector<ConnectionReceiveStats> receive_stats() const;
+
+    /**
+     * @brief Get the statistics of the traffic on all connections.
+     *
+     * The traffic with each system is available with System::traffic_stats().
+     *
+     * @return One entry per connection, in the order the connections were added.
+     */
+    std::vector<TrafficStats> connection_traffic_stats() const;
+
+    /**
+     * @brief Enable or disable tracing the latency of incoming messages.
+     *
+     * While enabled, every incoming message is timestamped when it is received (by the
+     * kernel where available), when it is dispatched to the plugins, and when any callback
+     * it triggers is queued and started. Enabling it again starts over with empty statistics.
+     * When disabled, tracing has next to no overhead.
+     *
+     * @param enabled Whether to trace.
+     */
+    void enable_latency_tracing(bool enabled);
+
+    /**
+     * @brief Distribution of the latencies from receiving a message to one stage.
+     */
+    struct LatencyPercentiles {
+        uint64_t count; /**< @brief Number of latencies measured. */
+        double p50_s; /**< @brief Median latency. */
+        double p90_s; /**< @brief 90th percentile of the latency. */
+        double p99_s; /**< @brief 99th percentile of the latency. */
+        double max_s; /**< @brief Highest latency. */
+    };
+
+    /**
+     * @brief Latencies of the messages with one message ID, measured from when they were
+     * received.
+     */
+    struct LatencyStats {
+        uint32_t message_id; /**< @brief MAVLink message ID. */
+        LatencyPercentiles dispatched; /**< @brief Until handed to the plugins. */
+        LatencyPercentiles callback_queued; /**< @brief Until a user callback was queued. */
+        LatencyPercentiles callback_started; /**< @brief Until a user callback started. */
+    };
+
+    /**
+     * @brief Get the latencies traced since tracing was enabled.
+     *
+     * @return One entry per message ID, ordered by message ID.
+     */
+    std::vector<LatencyStats> latency_stats() const;
+
     /**
      * @brief Get vector of system UUIDs.
      *
@@ -5,6 +5,7 @@
 #include "connection.h"
 #include "global_include.h"
 #include "tcp_connection.h"
+#include "tcp_server_connection.h"
 #include "udp_connection.h"
 #include "system.h"
 #include "system_impl.h"
@@ -27,16 +28,37 @@ MavsdkImpl::MavsdkImpl() :
 
 MavsdkImpl::~MavsdkImpl()
 {
+    // No new systems from here on, and nothing new is dispatched to them.
+    _should_exit = true;
+
+    // Messages are dispatched to systems without holding _systems_mutex, so
+    // the receive threads have to be stopped before the systems go away.
+    std::vector<std::shared_ptr<Connection>> connections;
+    std::shared_ptr<IoReactor> io_reactor;
     {
-        std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
-        _should_exit = true;
+        std::lock_guard<std::mutex> lock(_connections_mutex);
+        // Nothing must be forwarded to connections on their way out.
+        _router.clear();
+        connections.swap(_connections);
+        _link_ids.clear();
+        io_reactor.swap(_io_reactor);
+    }
 
-        _systems.clear();
+    // Outside of the lock, because a message still being dispatched on a
+    // receive thread might need it to send something.
+    connections.clear();
+
+    // The connections have unregistered from the reactor by now.
+    if (io_reactor) {
+        io_reactor->stop();
     }
 
     {
-        std::lock_guard<std::mutex> lock(_connections_mutex);
-        _connections.clear();
+        std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
+        for (auto& slot : _system_slots) {
+            std::atomic_store(&slot, std::shared_ptr<System>());
+        }
+        _systems.clear();
     }
 }
 
@@ -68,7 +90,7 @@ std::string MavsdkImpl::version() const
     }
 }
 
-void MavsdkImpl::receive_message(mavlink_message_t& message)
+void MavsdkImpl::receive_message(mavlink_message_t& message, unsigned link_id)
 {
     // Don't ever create a system with sysid 0.
     if (message.sysid == 0) {
@@ -83,55 +105,138 @@ void MavsdkImpl::receive_message(mavlink_message_t& message)
         return;
     }
 
+    // The same message received over a redundant link.
+    if (!_duplicate_filter.accept(message, link_id)) {
+        return;
+    }
+
+    // Fast path: the system is known already, no locking required.
+    auto system = std::atomic_load(&_system_slots[message.sysid]);
+    if (system) {
+        system->system_impl()->add_new_component(message.compid);
+    } else {
+        system = system_for_new_sysid(message.sysid, message.compid);
+        if (!system) {
+            return;
+        }
+    }
+
+    if (_should_exit) {
+        // Don't process anything once the destructor has started, the
+        // systems are about to be destroyed.
+        return;
+    }
+
+    system->system_impl()->process_mavlink_message(message);
+}
+
+std::shared_ptr<System> MavsdkImpl::system_for_new_sysid(uint8_t system_id, uint8_t component_id)
+{
     std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
 
+    if (_should_exit) {
+        return nullptr;
+    }
+
+    // Another receive thread might have been faster.
+    auto it = _systems.find(system_id);
+    if (it != _systems.end()) {
+        it->second->system_impl()->add_new_component(component_id);
+        return it->second;
+    }
+
     // Change system id of null system
     if (_systems.find(0) != _systems.end()) {
         auto null_system = _systems[0];
         _systems.erase(0);
-        null_system->system_impl()->set_system_id(message.sysid);
-        _systems.insert(system_entry_t(message.sysid, null_system));
-    } else if (_is_single_system) {
+        std::atomic_store(&_system_slots[0], std::shared_ptr<System>());
+        null_system->system_impl()->set_system_id(system_id);
+        _systems.insert(system_entry_t(system_id, null_system));
+        std::atomic_store(&_system_slots[system_id], null_system);
+    } else if (_is_single_system && !_systems.empty()) {
         auto sys = _systems.begin();
-        if (sys->first != message.sysid) {
-            sys->second->system_impl()->set_system_id(message.sysid);
-            _systems.insert(system_entry_t(message.sysid, sys->second));
-            _systems.erase(sys->first);
-        }
+        auto single_system = sys->second;
+        single_system->system_impl()->set_system_id(system_id);
+        std::atomic_store(&_system_slots[sys->first], std::shared_ptr<System>());
+        _systems.erase(sys);
+        _systems.insert(system_entry_t(system_id, single_system));
+        std::atomic_store(&_system_slots[system_id], single_system);
     }
 
-    if (!does_system_exist(message.sysid)) {
-        make_system_with_component(message.sysid, message.compid);
+    if (!does_system_exist(system_id)) {
+        make_system_with_component(system_id, component_id);
     } else {
-        _systems.at(message.sysid)->system_impl()->add_new_component(message.compid);
+        _systems.at(system_id)->system_impl()->add_new_component(component_id);
     }
 
-    if (_should_exit) {
-        // Don't try to call at() if systems have already been destroyed
-        // in descructor.
-        return;
+    it = _systems.find(system_id);
+    if (it == _systems.end()) {
+        return nullptr;
     }
+    return it->second;
+}
+
+namespace {
+
+// Collects the results of all connections a message was queued on.
+struct PendingSend {
+    explicit PendingSend(SendQueue::sent_callback_t callback) : sent_callback(callback) {}
+
+    // One for every connection plus one until all have been queued.
+    std::atomic<unsigned> num_left{1};
+    std::atomic<bool> sent{false};
+    const SendQueue::sent_callback_t sent_callback;
 
-    if (_systems.find(message.sysid) != _systems.end()) {
-        _systems.at(message.sysid)->system_impl()->process_mavlink_message(message);
+    void done(bool success)
+    {
+        if (success) {
+            sent = true;
+        }
+        if (--num_left == 0) {
+            sent_callback(sent);
+        }
     }
-}
+};
 
-bool MavsdkImpl::send_message(mavlink_message_t& message)
+} // namespace
+
+bool MavsdkImpl::send_message(mavlink_message_t& message, SendQueue::sent_callback_t sent_callback)
 {
-    std::lock_guard<std::mutex> lock(_connections_mutex);
+    std::shared_ptr<PendingSend> pending{};
+    if (sent_callback) {
+        pending = std::make_shared<PendingSend>(sent_callback);
+    }
+
+    bool success = true;
+    {
+        std::lock_guard<std::mutex> lock(_connections_mutex);
 
-    for (auto it = _connections.begin(); it != _connections.end(); ++it) {
-        if (!(**it).send_message(message)) {
-            LogErr() << "send fail";
-            return false;
+        // This only queues the message, so one slow connection doesn't hold up
+        // the others or the caller.
+        for (auto it = _connections.begin(); it != _connections.end(); ++it) {
+            SendQueue::sent_callback_t connection_callback{};
+            if (pending) {
+                ++pending->num_left;
+                connection_callback = [pending](bool sent) { pending->done(sent); };
+            }
+            if (!(**it).queue_message(message, connection_callback)) {
+                LogErr() << "send fail";
+                success = false;
+                if (pending) {
+                    pending->done(false);
+                }
+            }
         }
     }
 
-    return true;
+    if (pending) {
+        pending->done(false);
+    }
+    return success;
 }
 
-ConnectionResult MavsdkImpl::add_any_connection(const std::string& connection_url)
+ConnectionResult MavsdkImpl::add_any_connection(
+    const std::string& connection_url, ForwardingOption forwarding_option)
 {
     CliArg cli_arg;
     if (!cli_arg.parse(connection_url)) {
@@ -148,7 +253,7 @@ ConnectionResult MavsdkImpl::add_any_connection(const std::string& connection_ur
             if (cli_arg.get_port()) {
                 port = cli_arg.get_port();
             }
-            return add_udp_connection(path, port);
+            return add_udp_connection(path, port, forwarding_option);
         }
 
         case CliArg::Protocol::TCP: {
@@ -160,7 +265,19 @@ ConnectionResult MavsdkImpl::add_any_connection(const std::string& connection_ur
             if (cli_arg.get_port()) {
                 port = cli_arg.get_port();
             }
-            return add_tcp_connection(path, port);
+            return add_tcp_connection(path, port, forwarding_option);
+        }
+
+        case CliArg::Protocol::TCP_SERVER: {
+            std::string path = Mavsdk::DEFAULT_TCP_SERVER_BIND_IP;
+            int port = Mavsdk::DEFAULT_TCP_SERVER_PORT;
+            if (!cli_arg.get_path().empty()) {
+                path = cli_arg.get_path();
+            }
+            if (cli_arg.get_port()) {
+                port = cli_arg.get_port();
+            }
+            return add_tcp_server_connection(path, port, forwarding_option);
         }
 
         case CliArg::Protocol::SERIAL: {
@@ -168,7 +285,8 @@ ConnectionResult MavsdkImpl::add_any_connection(const std::string& connection_ur
             if (cli_arg.get_baudrate()) {
                 baudrate = cli_arg.get_baudrate();
             }
-            return add_serial_connection(cli_arg.get_path(), baudrate);
+            return add_serial_connection(
+                cli_arg.get_path(), baudrate, false, forwarding_option);
         }
 
         default:
@@ -176,71 +294,165 @@ ConnectionResult MavsdkImpl::add_any_connection(const std::string& connection_ur
     }
 }
 
-ConnectionResult MavsdkImpl::add_udp_connection(const std::string& local_ip, const int local_port)
+ConnectionResult MavsdkImpl::add_udp_connection(
+    const std::string& local_ip, const int local_port, ForwardingOption forwarding_option)
 {
+    const unsigned link_id = _duplicate_filter.add_link();
     auto new_conn = std::make_shared<UdpConnection>(
-        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1), local_ip, local_port);
+        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1, link_id),
+        local_ip,
+        local_port);
     if (!new_conn) {
         return ConnectionResult::CONNECTION_ERROR;
     }
+    new_conn->set_io_reactor(io_reactor());
+    new_conn->set_send_rate_limit(_send_rate_limit_bytes_per_s);
+    set_forwarding(*new_conn, forwarding_option);
     ConnectionResult ret = new_conn->start();
     if (ret == ConnectionResult::SUCCESS) {
-        add_connection(new_conn);
+        add_connection(new_conn, link_id);
     }
     return ret;
 }
 
 ConnectionResult MavsdkImpl::setup_udp_remote(const std::string& remote_ip, int remote_port)
 {
+    const unsigned link_id = _duplicate_filter.add_link();
     auto new_conn = std::make_shared<UdpConnection>(
-        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1), "0.0.0.0", 0);
+        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1, link_id),
+        "0.0.0.0",
+        0);
     if (!new_conn) {
         return ConnectionResult::CONNECTION_ERROR;
     }
+    new_conn->set_io_reactor(io_reactor());
+    new_conn->set_send_rate_limit(_send_rate_limit_bytes_per_s);
     ConnectionResult ret = new_conn->start();
     _is_single_system = true;
     if (ret == ConnectionResult::SUCCESS) {
         new_conn->add_remote(remote_ip, remote_port);
-        add_connection(new_conn);
+        add_connection(new_conn, link_id);
         make_system_with_component(get_own_system_id(), get_own_component_id());
     }
     return ret;
 }
 
-ConnectionResult MavsdkImpl::add_tcp_connection(const std::string& remote_ip, int remote_port)
+ConnectionResult MavsdkImpl::add_tcp_connection(
+    const std::string& remote_ip, int remote_port, ForwardingOption forwarding_option)
 {
+    const unsigned link_id = _duplicate_filter.add_link();
     auto new_conn = std::make_shared<TcpConnection>(
-        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1),
+        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1, link_id),
         remote_ip,
         remote_port);
     if (!new_conn) {
         return ConnectionResult::CONNECTION_ERROR;
     }
+    new_conn->set_io_reactor(io_reactor());
+    new_conn->set_send_rate_limit(_send_rate_limit_bytes_per_s);
+    set_forwarding(*new_conn, forwarding_option);
     ConnectionResult ret = new_conn->start();
     if (ret == ConnectionResult::SUCCESS) {
-        add_connection(new_conn);
+        add_connection(new_conn, link_id);
     }
     return ret;
 }
 
-ConnectionResult MavsdkImpl::add_serial_connection(const std::string& dev_path, int baudrate)
+ConnectionResult MavsdkImpl::add_tcp_server_connection(
+    const std::string& local_ip, int local_port, ForwardingOption forwarding_option)
 {
+    const unsigned link_id = _duplicate_filter.add_link();
+    auto new_conn = std::make_shared<TcpServerConnection>(
+        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1, link_id),
+        local_ip,
+        local_port);
+    if (!new_conn) {
+        return ConnectionResult::CONNECTION_ERROR;
+    }
+    new_conn->set_send_rate_limit(_send_rate_limit_bytes_per_s);
+    set_forwarding(*new_conn, forwarding_option);
+    ConnectionResult ret = new_conn->start();
+    if (ret == ConnectionResult::SUCCESS) {
+        add_connection(new_conn, link_id);
+    }
+    return ret;
+}
+
+ConnectionResult MavsdkImpl::add_serial_connection(
+    const std::string& dev_path,
+    int baudrate,
+    bool low_latency,
+    ForwardingOption forwarding_option)
+{
+    const unsigned link_id = _duplicate_filter.add_link();
     auto new_conn = std::make_shared<SerialConnection>(
-        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1), dev_path, baudrate);
+        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1, link_id),
+        dev_path,
+        baudrate,
+        low_latency);
     if (!new_conn) {
         return ConnectionResult::CONNECTION_ERROR;
     }
+    new_conn->set_io_reactor(io_reactor());
+    // With 8N1 a byte takes 10 bits on the wire.
+    const double rate_limit_bytes_per_s = _send_rate_limit_bytes_per_s;
+    new_conn->set_send_rate_limit(
+        (rate_limit_bytes_per_s > 0.0) ? rate_limit_bytes_per_s : baudrate / 10.0);
+    set_forwarding(*new_conn, forwarding_option);
     ConnectionResult ret = new_conn->start();
     if (ret == ConnectionResult::SUCCESS) {
-        add_connection(new_conn);
+        add_connection(new_conn, link_id);
     }
     return ret;
 }
 
-void MavsdkImpl::add_connection(std::shared_ptr<Connection> new_connection)
+bool MavsdkImpl::enable_io_reactor(unsigned num_threads)
+{
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+
+    if (_io_reactor) {
+        LogWarn() << "I/O reactor already enabled";
+        return true;
+    }
+
+    auto new_reactor = std::make_shared<IoReactor>(num_threads);
+    if (!new_reactor->start()) {
+        return false;
+    }
+
+    LogDebug() << "I/O reactor enabled with " << num_threads << " thread(s)";
+    _io_reactor = new_reactor;
+    return true;
+}
+
+std::shared_ptr<IoReactor> MavsdkImpl::io_reactor()
+{
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+    return _io_reactor;
+}
+
+void MavsdkImpl::add_connection(std::shared_ptr<Connection> new_connection, unsigned link_id)
 {
     std::lock_guard<std::mutex> lock(_connections_mutex);
     _connections.push_back(new_connection);
+    _link_ids.push_back(link_id);
+    if (new_connection->is_forwarding()) {
+        _router.add_connection(new_connection);
+    }
+}
+
+void MavsdkImpl::set_forwarding(Connection& connection, ForwardingOption forwarding_option)
+{
+    if (forwarding_option != ForwardingOption::ForwardingOn) {
+        return;
+    }
+    connection.set_forward_callback(std::bind(
+        &MAVLinkRouter::forward,
+        &_router,
+        std::placeholders::_1,
+        std::placeholders::_2,
+        std::placeholders::_3,
+        std::placeholders::_4));
 }
 
 void MavsdkImpl::set_configuration(Mavsdk::Configuration configuration)
@@ -248,6 +460,114 @@ void MavsdkImpl::set_configuration(Mavsdk::Configuration configuration)
     _configuration = configuration;
 }
 
+void MavsdkImpl::set_num_callback_threads(unsigned num_threads)
+{
+    if (num_threads == 0) {
+        LogErr() << "At least one callback thread is needed";
+        return;
+    }
+    _num_callback_threads = num_threads;
+}
+
+unsigned MavsdkImpl::get_num_callback_threads() const
+{
+    return _num_callback_threads;
+}
+
+void MavsdkImpl::set_send_rate_limit(double bytes_per_s)
+{
+    _send_rate_limit_bytes_per_s = (bytes_per_s > 0.0) ? bytes_per_s : 0.0;
+}
+
+std::vector<Mavsdk::ConnectionSendStats> MavsdkImpl::send_stats()
+{
+    auto to_send_stats = [](const SendQueue::Stats& stats) {
+        Mavsdk::SendStats send_stats;
+        send_stats.queue_depth = unsigned(stats.queue_depth);
+        send_stats.num_sent = stats.num_sent;
+        send_stats.num_dropped = stats.num_dropped;
+        send_stats.num_failed = stats.num_failed;
+        send_stats.mean_latency_s = stats.mean_latency_s;
+        send_stats.max_latency_s = stats.max_latency_s;
+        return send_stats;
+    };
+
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+
+    std::vector<Mavsdk::ConnectionSendStats> result;
+    for (const auto& connection : _connections) {
+        const auto stats = connection->send_queue_stats();
+        Mavsdk::ConnectionSendStats connection_stats;
+        connection_stats.control =
+            to_send_stats(stats[static_cast<unsigned>(SendQueue::Priority::CONTROL)]);
+        connection_stats.command =
+            to_send_stats(stats[static_cast<unsigned>(SendQueue::Priority::COMMAND)]);
+        connection_stats.telemetry =
+            to_send_stats(stats[static_cast<unsigned>(SendQueue::Priority::TELEMETRY)]);
+        connection_stats.bulk =
+            to_send_stats(stats[static_cast<unsigned>(SendQueue::Priority::BULK)]);
+        result.push_back(connection_stats);
+    }
+    return result;
+}
+
+std::vector<Mavsdk::ConnectionReceiveStats> MavsdkImpl::receive_stats()
+{
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+
+    // Taken under the lock, so that it covers every link in _link_ids.
+    const auto link_stats = _duplicate_filter.link_stats();
+
+    std::vector<Mavsdk::ConnectionReceiveStats> result;
+    for (const unsigned link_id : _link_ids) {
+        Mavsdk::ConnectionReceiveStats connection_stats;
+        connection_stats.num_first = link_stats[link_id].num_first;
+        connection_stats.num_duplicates = link_stats[link_id].num_duplicates;
+        result.push_back(connection_stats);
+    }
+    return result;
+}
+
+std::vector<TrafficStats> MavsdkImpl::connection_traffic_stats()
+{
+    std::lock_guard<std::mutex> lock(_connections_mutex);
+
+    std::vector<TrafficStats> result;
+    for (const auto& connection : _connections) {
+        result.push_back(connection->traffic_stats());
+    }
+    return result;
+}
+
+void MavsdkImpl::enable_latency_tracing(bool enabled)
+{
+    _latency_tracer.set_enabled(enabled);
+}
+
+std::vector<Mavsdk::LatencyStats> MavsdkImpl::latency_stats()
+{
+    auto to_percentiles = [](const LatencyHistogram& histogram) {
+        Mavsdk::LatencyPercentiles percentiles;
+        percentiles.count = histogram.count();
+        percentiles.p50_s = histogram.percentile_s(50.0);
+        percentiles.p90_s = histogram.percentile_s(90.0);
+        percentiles.p99_s = histogram.percentile_s(99.0);
+        percentiles.max_s = histogram.max_s();
+        return percentiles;
+    };
+
+    std::vector<Mavsdk::LatencyStats> result;
+    for (const auto& latencies : _latency_tracer.latencies()) {
+        Mavsdk::LatencyStats stats;
+        stats.message_id = latencies.message_id;
+        stats.dispatched = to_percentiles(latencies.dispatched);
+        stats.callback_queued = to_percentiles(latencies.callback_queued);
+        stats.callback_started = to_percentiles(latencies.callback_started);
+        result.push_back(stats);
+    }
+    return result;
+}
+
 std::vector<uint64_t> MavsdkImpl::get_system_uuids() const
 {
     std::vector<uint64_t> uuids = {};
@@ -392,6 +712,7 @@ void MavsdkImpl::make_system_with_component(uint8_t system_id, uint8_t comp_id)
     auto new_system = std::make_shared<System>(*this, system_id, comp_id, _is_single_system);
 
     _systems.insert(system_entry_t(system_id, new_system));
+    std::atomic_store(&_system_slots[system_id], new_system);
 }
 
 bool MavsdkImpl::does_system_exist(uint8_t system_id)
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <array>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 #include <atomic>
 
 #include "connection.h"
+#include "duplicate_filter.h"
+#include "io_reactor.h"
+#include "latency_tracer.h"
+#include "mavlink_router.h"
 #include "mavsdk.h"
 #include "system.h"
 #include "mavlink_include.h"
@@ -19,19 +25,47 @@ public:
 
     std::string version() const;
 
-    void receive_message(mavlink_message_t& message);
-    bool send_message(mavlink_message_t& message);
+    void receive_message(mavlink_message_t& message, unsigned link_id);
+    // Queues the message on all connections and returns false if any of them
+    // refused it. Whether it actually went out is only known later:
+    // sent_callback is called once, from whichever thread finished last, with
+    // whether at least one connection sent it.
+    bool send_message(
+        mavlink_message_t& message, SendQueue::sent_callback_t sent_callback = nullptr);
 
-    ConnectionResult add_any_connection(const std::string& connection_url);
+    ConnectionResult
+    add_any_connection(const std::string& connection_url, ForwardingOption forwarding_option);
     ConnectionResult
     add_link_connection(const std::string& protocol, const std::string& ip, int port);
-    ConnectionResult add_udp_connection(const std::string& local_ip, int local_port_number);
-    ConnectionResult add_tcp_connection(const std::string& remote_ip, int remote_port);
-    ConnectionResult add_serial_connection(const std::string& dev_path, int baudrate);
+    ConnectionResult add_udp_connection(
+        const std::string& local_ip, int local_port_number, ForwardingOption forwarding_option);
+    ConnectionResult add_tcp_connection(
+        const std::string& remote_ip, int remote_port, ForwardingOption forwarding_option);
+    ConnectionResult add_tcp_server_connection(
+        const std::string& local_ip, int local_port, ForwardingOption forwarding_option);
+    ConnectionResult add_serial_connection(
+        const std::string& dev_path,
+        int baudrate,
+        bool low_latency,
+        ForwardingOption forwarding_option);
     ConnectionResult setup_udp_remote(const std::string& remote_ip, int remote_port);
 
+    bool enable_io_reactor(unsigned num_threads);
+
     void set_configuration(Mavsdk::Configuration configuration);
 
+    void set_num_callback_threads(unsigned num_threads);
+    unsigned get_num_callback_threads() const;
+
+    void set_send_rate_limit(double bytes_per_s);
+    std::vector<Mavsdk::ConnectionSendStats> send_stats();
+    std::vector<Mavsdk::ConnectionReceiveStats> receive_stats();
+    std::vector<TrafficStats> connection_traffic_stats();
+
+    LatencyTracer& latency_tracer() { return _latency_tracer; }
+    void enable_latency_tracing(bool enabled);
+    std::vector<Mavsdk::LatencyStats> latency_stats();
+
     std::vector<uint64_t> get_system_uuids() const;
     System& get_system();
     System& get_system(uint64_t uuid);
@@ -50,22 +84,38 @@ public:
     void notify_on_timeout(uint64_t uuid);
 
 private:
-    void add_connection(std::shared_ptr<Connection>);
+    void add_connection(std::shared_ptr<Connection>, unsigned link_id);
+    void set_forwarding(Connection& connection, ForwardingOption forwarding_option);
+    std::shared_ptr<IoReactor> io_reactor();
     void make_system_with_component(uint8_t system_id, uint8_t component_id);
     bool does_system_exist(uint8_t system_id);
+    std::shared_ptr<System> system_for_new_sysid(uint8_t system_id, uint8_t component_id);
 
     using system_entry_t = std::pair<uint8_t, std::shared_ptr<System>>;
 
     std::mutex _connections_mutex;
     std::vector<std::shared_ptr<Connection>> _connections;
+    // Link id of the duplicate filter for each of the connections.
+    std::vector<unsigned> _link_ids{};
+    DuplicateFilter _duplicate_filter{};
+    // Needs to outlive the systems, whose callbacks record into it.
+    LatencyTracer _latency_tracer{};
+    std::shared_ptr<IoReactor> _io_reactor{};
+    MAVLinkRouter _router{};
 
     mutable std::recursive_mutex _systems_mutex;
     std::map<uint8_t, std::shared_ptr<System>> _systems;
+    // Same systems as in _systems but indexed by system id so that incoming
+    // messages can find their system without locking. Only read and written
+    // with std::atomic_load/std::atomic_store, written with _systems_mutex held.
+    std::array<std::shared_ptr<System>, 256> _system_slots{};
 
     Mavsdk::event_callback_t _on_discover_callback;
     Mavsdk::event_callback_t _on_timeout_callback;
 
     std::atomic<Mavsdk::Configuration> _configuration{Mavsdk::Configuration::GroundStation};
+    std::atomic<unsigned> _num_callback_threads{3};
+    std::atomic<double> _send_rate_limit_bytes_per_s{0.0};
     bool _is_single_system{false};
 
     std::atomic<bool> _should_exit = {false};
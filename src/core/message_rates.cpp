@@ -0,0 +1,250 @@
+#include "message_rates.h"
+#include "log.h"
+#include <algorithm>
+
+namespace mavsdk {
+
+MessageRates::MessageRates(Time& time, set_rate_t set_rate) :
+    _time(time),
+    _set_rate(set_rate)
+{}
+
+void MessageRates::request(
+    uint16_t message_id,
+    double rate_hz,
+    const void* cookie,
+    result_callback_t callback,
+    uint8_t component_id)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    const uint32_t stream_key = key(message_id, component_id);
+    auto it = _streams.find(stream_key);
+    if (it == _streams.end()) {
+        it = _streams.emplace(stream_key, Stream{}).first;
+        it->second.streamed_by_default = _received_ids.contains(message_id);
+        _requested_ids.insert(message_id);
+    }
+    Stream& stream = it->second;
+    if (rate_hz < 0.0) {
+        stream.requests.erase(cookie);
+    } else {
+        stream.requests[cookie] = rate_hz;
+    }
+
+    update(lock, stream_key, stream, callback);
+}
+
+void MessageRates::release(const void* cookie)
+{
+    std::vector<uint32_t> stream_keys;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto& stream : _streams) {
+            if (stream.second.requests.find(cookie) != stream.second.requests.end()) {
+                stream_keys.push_back(stream.first);
+            }
+        }
+    }
+
+    for (const auto stream_key : stream_keys) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _streams.find(stream_key);
+        if (it == _streams.end() || it->second.requests.erase(cookie) == 0) {
+            continue;
+        }
+        update(lock, stream_key, it->second, nullptr);
+    }
+}
+
+void MessageRates::resend()
+{
+    std::vector<uint32_t> stream_keys;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto& stream : _streams) {
+            stream_keys.push_back(stream.first);
+        }
+    }
+
+    for (const auto stream_key : stream_keys) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _streams.find(stream_key);
+        if (it == _streams.end()) {
+            continue;
+        }
+        it->second.sent_rate_hz = NAN;
+        update(lock, stream_key, it->second, nullptr);
+    }
+}
+
+void MessageRates::on_message(uint32_t message_id, uint8_t component_id)
+{
+    if (message_id > UINT16_MAX) {
+        return;
+    }
+
+    if (!_received_ids.contains(uint16_t(message_id))) {
+        _received_ids.insert(uint16_t(message_id));
+    }
+    if (!_requested_ids.contains(uint16_t(message_id))) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _streams.find(key(uint16_t(message_id), component_id));
+    if (it == _streams.end()) {
+        return;
+    }
+    Stream& stream = it->second;
+
+    const dl_time_t now = _time.steady_time();
+    stream.last_received = now;
+
+    if (!stream.measuring) {
+        stream.measuring = true;
+        stream.window_start = now;
+        stream.num_in_window = 0;
+        return;
+    }
+
+    ++stream.num_in_window;
+    const double elapsed_s = _time.elapsed_since_s(stream.window_start);
+    if (elapsed_s >= 1.0) {
+        stream.measured_rate_hz = stream.num_in_window / elapsed_s;
+        stream.window_start = now;
+        stream.num_in_window = 0;
+    }
+}
+
+std::vector<MessageRates::Rate> MessageRates::rates()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<Rate> result;
+    result.reserve(_streams.size());
+
+    for (const auto& it : _streams) {
+        const Stream& stream = it.second;
+
+        Rate rate;
+        rate.message_id = uint16_t(it.first >> 8);
+        rate.component_id = uint8_t(it.first & 0xff);
+        rate.num_consumers = unsigned(stream.requests.size());
+        rate.requested_rate_hz = stream.sent_rate_hz;
+        rate.accepted = !stream.in_flight && stream.result == MAVLinkCommands::Result::SUCCESS;
+
+        // A stream that stopped doesn't update its measurement anymore.
+        if (stream.measuring) {
+            const double timeout_s = std::max(
+                2.0, stream.measured_rate_hz > 0.0 ? 3.0 / stream.measured_rate_hz : 0.0);
+            if (_time.elapsed_since_s(stream.last_received) <= timeout_s) {
+                rate.measured_rate_hz = stream.measured_rate_hz;
+            }
+        }
+
+        result.push_back(rate);
+    }
+
+    return result;
+}
+
+double MessageRates::combined_rate_hz(const Stream& stream)
+{
+    if (stream.requests.empty()) {
+        // Stopping a stream the system sends anyway would take it away from
+        // everyone else listening, e.g. a ground station.
+        return stream.streamed_by_default ? 0.0 : -1.0;
+    }
+
+    double rate_hz = 0.0;
+    for (const auto& request : stream.requests) {
+        rate_hz = std::max(rate_hz, request.second);
+    }
+    return rate_hz;
+}
+
+void MessageRates::update(
+    std::unique_lock<std::mutex>& lock,
+    uint32_t stream_key,
+    Stream& stream,
+    result_callback_t callback)
+{
+    const double rate_hz = combined_rate_hz(stream);
+
+    if (rate_hz == stream.sent_rate_hz) {
+        if (stream.in_flight) {
+            // Whatever the command in flight results in applies to this request, too.
+            if (callback) {
+                stream.waiting->push_back(callback);
+            }
+            return;
+        }
+        if (stream.result == MAVLinkCommands::Result::SUCCESS) {
+            lock.unlock();
+            if (callback) {
+                callback(MAVLinkCommands::Result::SUCCESS, NAN);
+            }
+            return;
+        }
+        // Otherwise the last attempt failed and we try again.
+    }
+
+    stream.sent_rate_hz = rate_hz;
+    stream.in_flight = true;
+    stream.waiting = std::make_shared<callbacks_t>();
+    if (callback) {
+        stream.waiting->push_back(callback);
+    }
+    auto callbacks = stream.waiting;
+
+    lock.unlock();
+
+    const uint16_t message_id = uint16_t(stream_key >> 8);
+    const uint8_t component_id = uint8_t(stream_key & 0xff);
+
+    LogDebug() << "Setting rate of message " << message_id << " to " << rate_hz << " Hz";
+
+    _set_rate(
+        message_id,
+        rate_hz,
+        component_id,
+        [this, stream_key, rate_hz, callbacks](MAVLinkCommands::Result result, float progress) {
+            receive_result(stream_key, rate_hz, callbacks, result, progress);
+        });
+}
+
+void MessageRates::receive_result(
+    uint32_t stream_key,
+    double rate_hz,
+    std::shared_ptr<callbacks_t> callbacks,
+    MAVLinkCommands::Result result,
+    float progress)
+{
+    if (result == MAVLinkCommands::Result::IN_PROGRESS) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _streams.find(stream_key);
+        // If another rate has been sent in the meantime, that is what counts.
+        if (it != _streams.end() && it->second.waiting == callbacks) {
+            it->second.in_flight = false;
+            it->second.result = result;
+            it->second.waiting.reset();
+        }
+    }
+
+    if (result != MAVLinkCommands::Result::SUCCESS) {
+        LogWarn() << "Setting rate of message " << (stream_key >> 8) << " to " << rate_hz
+                  << " Hz failed";
+    }
+
+    for (const auto& callback : *callbacks) {
+        callback(result, progress);
+    }
+}
+
+} // namespace mavsdk
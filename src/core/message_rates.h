@@ -0,0 +1,156 @@
+#pragma once
+
+#include "global_include.h"
+#include "mavlink_commands.h"
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mavsdk {
+
+// Decides at which rate a system streams each message.
+//
+// Every consumer (usually a plugin, identified by a cookie) requests the rate
+// it needs for a message, and the stream is set to the highest rate any
+// consumer requested. When consumers lower or release their requests, the
+// stream is lowered accordingly. Once nobody needs it anymore, it goes back to
+// its default rate, or is stopped if it was only streamed because of us. A
+// command is only sent if the resulting rate actually changes.
+//
+// The rate at which a message actually arrives is measured as well, so that
+// it can be reported next to the rate that was requested.
+class MessageRates {
+public:
+    typedef MAVLinkCommands::command_result_callback_t result_callback_t;
+
+    // Sends MAV_CMD_SET_MESSAGE_INTERVAL: rate_hz > 0 for a rate, 0 for the
+    // default rate and < 0 to stop the stream.
+    typedef std::function<void(
+        uint16_t message_id, double rate_hz, uint8_t component_id, result_callback_t callback)>
+        set_rate_t;
+
+    struct Rate {
+        uint16_t message_id{0};
+        uint8_t component_id{0};
+        unsigned num_consumers{0};
+        // Rate the stream was set to, same meaning as for set_rate_t.
+        double requested_rate_hz{0.0};
+        // Whether the system accepted the requested rate.
+        bool accepted{false};
+        // Rate at which the message arrived recently.
+        double measured_rate_hz{0.0};
+    };
+
+    MessageRates(Time& time, set_rate_t set_rate);
+    ~MessageRates() = default;
+
+    // delete copy and move constructors and assign operators
+    MessageRates(MessageRates const&) = delete; // Copy construct
+    MessageRates(MessageRates&&) = delete; // Move construct
+    MessageRates& operator=(MessageRates const&) = delete; // Copy assign
+    MessageRates& operator=(MessageRates&&) = delete; // Move assign
+
+    // Requests a rate for a consumer, replacing its previous request for the
+    // message: rate_hz > 0 for at least that rate, 0 for the default rate,
+    // < 0 if the consumer doesn't need the message anymore.
+    void request(
+        uint16_t message_id,
+        double rate_hz,
+        const void* cookie,
+        result_callback_t callback,
+        uint8_t component_id);
+
+    // Releases all requests of a consumer.
+    void release(const void* cookie);
+
+    // Sends all rates again, e.g. after the system was rebooted.
+    void resend();
+
+    // Needs to be called for every message received from the system.
+    void on_message(uint32_t message_id, uint8_t component_id);
+
+    std::vector<Rate> rates();
+
+private:
+    typedef std::vector<result_callback_t> callbacks_t;
+
+    // Set of message ids which can be checked without taking the lock.
+    class MessageIdSet {
+    public:
+        bool contains(uint16_t message_id) const
+        {
+            return (_bits[message_id / 64].load(std::memory_order_relaxed) >>
+                    (message_id % 64)) &
+                   1;
+        }
+
+        void insert(uint16_t message_id)
+        {
+            _bits[message_id / 64].fetch_or(
+                uint64_t(1) << (message_id % 64), std::memory_order_relaxed);
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, 1024> _bits{};
+    };
+
+    struct Stream {
+        std::map<const void*, double> requests{};
+        // Whether the message arrived before anybody requested a rate for it.
+        bool streamed_by_default{false};
+
+        // What was last sent, NAN before anything was sent.
+        double sent_rate_hz{NAN};
+        bool in_flight{false};
+        MAVLinkCommands::Result result{MAVLinkCommands::Result::SUCCESS};
+        // Callbacks waiting for the command in flight.
+        std::shared_ptr<callbacks_t> waiting{};
+
+        bool measuring{false};
+        dl_time_t window_start{};
+        unsigned num_in_window{0};
+        dl_time_t last_received{};
+        double measured_rate_hz{0.0};
+    };
+
+    static uint32_t key(uint16_t message_id, uint8_t component_id)
+    {
+        return (uint32_t(message_id) << 8) | component_id;
+    }
+
+    static double combined_rate_hz(const Stream& stream);
+
+    // Sends the combined rate if it changed or was not accepted, and calls or
+    // queues the callback. The lock might be unlocked on return.
+    void update(
+        std::unique_lock<std::mutex>& lock,
+        uint32_t stream_key,
+        Stream& stream,
+        result_callback_t callback);
+
+    void receive_result(
+        uint32_t stream_key,
+        double rate_hz,
+        std::shared_ptr<callbacks_t> callbacks,
+        MAVLinkCommands::Result result,
+        float progress);
+
+    std::mutex _mutex{};
+    std::map<uint32_t, Stream> _streams{};
+
+    // Messages which arrived at all, and which have a stream, so on_message
+    // costs next to nothing for all the messages nobody requested.
+    MessageIdSet _received_ids{};
+    MessageIdSet _requested_ids{};
+
+    Time& _time;
+    set_rate_t _set_rate;
+};
+
+} // namespace mavsdk
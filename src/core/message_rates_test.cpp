@@ -0,0 +1,231 @@
+#include "message_rates.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+#ifdef FAKE_TIME
+#define Time FakeTime
+#endif
+
+using namespace mavsdk;
+
+namespace {
+
+typedef MAVLinkCommands::Result Result;
+
+struct SentRate {
+    uint16_t message_id;
+    double rate_hz;
+    MessageRates::result_callback_t callback;
+};
+
+const uint16_t message_id = 33;
+const uint8_t component_id = 1;
+
+} // namespace
+
+class MessageRatesTest : public ::testing::Test {
+protected:
+    MessageRatesTest() :
+        _rates(
+            _time,
+            [this](
+                uint16_t id, double rate_hz, uint8_t, MessageRates::result_callback_t callback) {
+                _sent.push_back(SentRate{id, rate_hz, callback});
+            })
+    {}
+
+    void ack_all(Result result = Result::SUCCESS)
+    {
+        auto sent = _sent;
+        _sent.clear();
+        for (auto& rate : sent) {
+            rate.callback(result, NAN);
+        }
+    }
+
+    Time _time{};
+    std::vector<SentRate> _sent{};
+    MessageRates _rates;
+};
+
+TEST_F(MessageRatesTest, SendsHighestRequest)
+{
+    int a, b;
+
+    _rates.request(message_id, 5.0, &a, nullptr, component_id);
+    ASSERT_EQ(_sent.size(), 1u);
+    EXPECT_EQ(_sent[0].message_id, message_id);
+    EXPECT_EQ(_sent[0].rate_hz, 5.0);
+    ack_all();
+
+    _rates.request(message_id, 10.0, &b, nullptr, component_id);
+    ASSERT_EQ(_sent.size(), 1u);
+    EXPECT_EQ(_sent[0].rate_hz, 10.0);
+    ack_all();
+
+    // Lower than what b wants, nothing to do.
+    _rates.request(message_id, 2.0, &a, nullptr, component_id);
+    EXPECT_EQ(_sent.size(), 0u);
+
+    // Back to what a wants when b leaves.
+    _rates.release(&b);
+    ASSERT_EQ(_sent.size(), 1u);
+    EXPECT_EQ(_sent[0].rate_hz, 2.0);
+    ack_all();
+
+    // And stopped once nobody wants it.
+    _rates.request(message_id, -1.0, &a, nullptr, component_id);
+    ASSERT_EQ(_sent.size(), 1u);
+    EXPECT_LT(_sent[0].rate_hz, 0.0);
+    ack_all();
+
+    auto rates = _rates.rates();
+    ASSERT_EQ(rates.size(), 1u);
+    EXPECT_EQ(rates[0].num_consumers, 0u);
+    EXPECT_LT(rates[0].requested_rate_hz, 0.0);
+    EXPECT_TRUE(rates[0].accepted);
+}
+
+TEST_F(MessageRatesTest, DefaultRateIsKeptWhileRequested)
+{
+    int a, b;
+
+    _rates.request(message_id, 0.0, &a, nullptr, component_id);
+    ASSERT_EQ(_sent.size(), 1u);
+    EXPECT_EQ(_sent[0].rate_hz, 0.0);
+    ack_all();
+
+    _rates.request(message_id, 0.0, &b, nullptr, component_id);
+    EXPECT_EQ(_sent.size(), 0u);
+
+    _rates.release(&a);
+    EXPECT_EQ(_sent.size(), 0u);
+}
+
+TEST_F(MessageRatesTest, ReleasesToDefaultRateIfStreamedAnyway)
+{
+    int a;
+
+    // The system streams it before anybody asked for it.
+    _rates.on_message(message_id, component_id);
+
+    _rates.request(message_id, 10.0, &a, nullptr, component_id);
+    ASSERT_EQ(_sent.size(), 1u);
+    EXPECT_EQ(_sent[0].rate_hz, 10.0);
+    ack_all();
+
+    // Back to the default instead of stopping it for everyone.
+    _rates.release(&a);
+    ASSERT_EQ(_sent.size(), 1u);
+    EXPECT_EQ(_sent[0].rate_hz, 0.0);
+    ack_all();
+
+    // Others are still stopped once not needed.
+    _rates.request(message_id + 1, 10.0, &a, nullptr, component_id);
+    ack_all();
+    _rates.release(&a);
+    ASSERT_EQ(_sent.size(), 1u);
+    EXPECT_LT(_sent[0].rate_hz, 0.0);
+}
+
+TEST_F(MessageRatesTest, CallbacksWaitForCommandInFlight)
+{
+    int a, b;
+    std::vector<Result> results_a;
+    std::vector<Result> results_b;
+
+    _rates.request(
+        message_id,
+        5.0,
+        &a,
+        [&results_a](Result result, float) { results_a.push_back(result); },
+        component_id);
+    _rates.request(
+        message_id,
+        5.0,
+        &b,
+        [&results_b](Result result, float) { results_b.push_back(result); },
+        component_id);
+
+    // Only one command for both.
+    ASSERT_EQ(_sent.size(), 1u);
+    EXPECT_EQ(results_a.size(), 0u);
+    EXPECT_EQ(results_b.size(), 0u);
+
+    ack_all();
+    ASSERT_EQ(results_a.size(), 1u);
+    ASSERT_EQ(results_b.size(), 1u);
+    EXPECT_EQ(results_a[0], Result::SUCCESS);
+    EXPECT_EQ(results_b[0], Result::SUCCESS);
+
+    // Nothing changes, answered right away.
+    _rates.request(
+        message_id,
+        5.0,
+        &b,
+        [&results_b](Result result, float) { results_b.push_back(result); },
+        component_id);
+    EXPECT_EQ(_sent.size(), 0u);
+    ASSERT_EQ(results_b.size(), 2u);
+    EXPECT_EQ(results_b[1], Result::SUCCESS);
+}
+
+TEST_F(MessageRatesTest, RetriesAfterFailure)
+{
+    int a;
+
+    _rates.request(message_id, 5.0, &a, nullptr, component_id);
+    ack_all(Result::TIMEOUT);
+
+    auto rates = _rates.rates();
+    ASSERT_EQ(rates.size(), 1u);
+    EXPECT_FALSE(rates[0].accepted);
+
+    _rates.request(message_id, 5.0, &a, nullptr, component_id);
+    ASSERT_EQ(_sent.size(), 1u);
+    EXPECT_EQ(_sent[0].rate_hz, 5.0);
+    ack_all();
+
+    rates = _rates.rates();
+    EXPECT_TRUE(rates[0].accepted);
+}
+
+TEST_F(MessageRatesTest, Resends)
+{
+    int a;
+
+    _rates.request(message_id, 5.0, &a, nullptr, component_id);
+    _rates.request(message_id + 1, 2.0, &a, nullptr, component_id);
+    ack_all();
+
+    _rates.resend();
+    ASSERT_EQ(_sent.size(), 2u);
+    EXPECT_EQ(_sent[0].rate_hz, 5.0);
+    EXPECT_EQ(_sent[1].rate_hz, 2.0);
+}
+
+TEST_F(MessageRatesTest, MeasuresRate)
+{
+    int a;
+
+    _rates.request(message_id, 10.0, &a, nullptr, component_id);
+    ack_all();
+
+    for (unsigned i = 0; i <= 20; ++i) {
+        _rates.on_message(message_id, component_id);
+        // Other messages and components don't count.
+        _rates.on_message(message_id + 1, component_id);
+        _rates.on_message(message_id, component_id + 1);
+        _time.sleep_for(std::chrono::milliseconds(200));
+    }
+
+    auto rates = _rates.rates();
+    ASSERT_EQ(rates.size(), 1u);
+    EXPECT_EQ(rates[0].requested_rate_hz, 10.0);
+    EXPECT_NEAR(rates[0].measured_rate_hz, 5.0, 0.5);
+
+    // Nothing arrives anymore.
+    _time.sleep_for(std::chrono::seconds(3));
+    rates = _rates.rates();
+    EXPECT_EQ(rates[0].measured_rate_hz, 0.0);
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include "plugin_impl_base.h"
+#include "system_impl.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#if defined(LINUX)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace mavsdk {
+namespace testing {
+
+// Listens for the TCP connection of Mavsdk like a simulator does, sends
+// heartbeats and answers the request for the autopilot capabilities. Every
+// other COMMAND_LONG goes to the command handler, everything else to the
+// message handler.
+//
+// Everything is sent from the vehicle thread, also the replies of the
+// handlers.
+class FakeVehicle {
+public:
+    static constexpr uint8_t system_id = 1;
+    static constexpr uint8_t channel = MAVLINK_COMM_NUM_BUFFERS - 1;
+
+    typedef std::function<void(FakeVehicle&, const mavlink_command_long_t&)> command_handler_t;
+    typedef std::function<void(FakeVehicle&, const mavlink_message_t&)> message_handler_t;
+
+    FakeVehicle()
+    {
+        _listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        addr.sin_port = htons(0);
+        bind(_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(_listen_fd, 1);
+
+        socklen_t addr_len = sizeof(addr);
+        getsockname(_listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+        _port = ntohs(addr.sin_port);
+
+        _thread = std::thread(&FakeVehicle::run, this);
+    }
+
+    ~FakeVehicle()
+    {
+        _should_exit = true;
+        _thread.join();
+        if (_fd >= 0) {
+            close(_fd);
+        }
+        close(_listen_fd);
+    }
+
+    int port() const { return _port; }
+
+    void set_command_handler(command_handler_t handler)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _command_handler = handler;
+    }
+
+    void set_message_handler(message_handler_t handler)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _message_handler = handler;
+    }
+
+    void send_ack(
+        uint16_t command,
+        uint8_t result,
+        uint8_t progress = 0,
+        uint8_t component_id = MAV_COMP_ID_AUTOPILOT1)
+    {
+        mavlink_message_t message;
+        mavlink_msg_command_ack_pack_chan(
+            system_id, component_id, channel, &message, command, result, progress, 0, 0, 0);
+        send(message);
+    }
+
+    void send(const mavlink_message_t& message)
+    {
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const auto len = mavlink_msg_to_send_buffer(buffer, &message);
+        ::send(_fd, buffer, len, MSG_NOSIGNAL);
+    }
+
+    // delete copy and move constructors and assign operators
+    FakeVehicle(FakeVehicle const&) = delete; // Copy construct
+    FakeVehicle(FakeVehicle&&) = delete; // Move construct
+    FakeVehicle& operator=(FakeVehicle const&) = delete; // Copy assign
+    FakeVehicle& operator=(FakeVehicle&&) = delete; // Move assign
+
+private:
+    void run()
+    {
+        while (!_should_exit && _fd < 0) {
+            pollfd fds[1] = {{_listen_fd, POLLIN, 0}};
+            if (poll(fds, 1, 10) > 0) {
+                _fd = accept(_listen_fd, nullptr, nullptr);
+            }
+        }
+
+        auto last_heartbeat = std::chrono::steady_clock::time_point{};
+        while (!_should_exit) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now - last_heartbeat > std::chrono::milliseconds(100)) {
+                send_heartbeat();
+                last_heartbeat = now;
+            }
+
+            pollfd fds[1] = {{_fd, POLLIN, 0}};
+            if (poll(fds, 1, 10) <= 0) {
+                continue;
+            }
+            uint8_t buffer[2048];
+            const auto len = recv(_fd, buffer, sizeof(buffer), 0);
+            if (len <= 0) {
+                break;
+            }
+            for (ssize_t i = 0; i < len; ++i) {
+                mavlink_message_t message;
+                mavlink_status_t status;
+                if (mavlink_frame_char_buffer(
+                        &_rx_message, &_rx_status, buffer[i], &message, &status) ==
+                    MAVLINK_FRAMING_OK) {
+                    handle(message);
+                }
+            }
+        }
+    }
+
+    void handle(const mavlink_message_t& message)
+    {
+        if (message.msgid != MAVLINK_MSG_ID_COMMAND_LONG) {
+            message_handler_t handler;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                handler = _message_handler;
+            }
+            if (handler) {
+                handler(*this, message);
+            }
+            return;
+        }
+
+        mavlink_command_long_t command;
+        mavlink_msg_command_long_decode(&message, &command);
+
+        if (command.command == MAV_CMD_REQUEST_AUTOPILOT_CAPABILITIES) {
+            send_ack(command.command, MAV_RESULT_ACCEPTED);
+            send_autopilot_version();
+            return;
+        }
+
+        command_handler_t handler;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            handler = _command_handler;
+        }
+        if (handler) {
+            handler(*this, command);
+        } else {
+            send_ack(command.command, MAV_RESULT_ACCEPTED);
+        }
+    }
+
+    void send_heartbeat()
+    {
+        mavlink_message_t message;
+        mavlink_msg_heartbeat_pack_chan(
+            system_id,
+            MAV_COMP_ID_AUTOPILOT1,
+            channel,
+            &message,
+            MAV_TYPE_QUADROTOR,
+            MAV_AUTOPILOT_PX4,
+            0,
+            0,
+            0);
+        send(message);
+    }
+
+    void send_autopilot_version()
+    {
+        mavlink_message_t message;
+        mavlink_msg_autopilot_version_pack_chan(
+            system_id,
+            MAV_COMP_ID_AUTOPILOT1,
+            channel,
+            &message,
+            0,
+            0,
+            0,
+            0,
+            0,
+            nullptr,
+            nullptr,
+            nullptr,
+            0,
+            0,
+            42,
+            nullptr);
+        send(message);
+    }
+
+    int _listen_fd{-1};
+    int _fd{-1};
+    int _port{0};
+    std::atomic<bool> _should_exit{false};
+    mavlink_message_t _rx_message{};
+    mavlink_status_t _rx_status{};
+    std::mutex _mutex{};
+    command_handler_t _command_handler{};
+    message_handler_t _message_handler{};
+    std::thread _thread{};
+};
+
+// Only there to get to the SystemImpl of a System.
+class SystemImplAccess : public PluginImplBase {
+public:
+    explicit SystemImplAccess(System& system) : PluginImplBase(system) {}
+
+    void init() override {}
+    void deinit() override {}
+    void enable() override {}
+    void disable() override {}
+
+    SystemImpl& system_impl() { return *_parent; }
+};
+
+} // namespace testing
+} // namespace mavsdk
+
+#endif
@@ -0,0 +1,205 @@
+#include "param_cache.h"
+#include "log.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace mavsdk {
+
+namespace {
+
+const char* const file_header = "mavsdk-param-cache 1";
+
+uint32_t float_bits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float float_from_bits(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+void ParamCache::clear()
+{
+    _entries.clear();
+    _received.clear();
+    _indices.clear();
+    _num_received = 0;
+}
+
+void ParamCache::reset(uint16_t count)
+{
+    clear();
+    _entries.resize(count);
+    _received.resize(count, false);
+}
+
+ParamCache::Update ParamCache::update(
+    uint16_t index, uint16_t count, const std::string& name, float value, uint8_t type)
+{
+    if (index >= count) {
+        auto it = _indices.find(name);
+        if (it == _indices.end()) {
+            return Update::IGNORED;
+        }
+        index = it->second;
+    } else if (count != _entries.size()) {
+        if (!_entries.empty()) {
+            LogDebug() << "Param count changed from " << _entries.size() << " to " << count;
+        }
+        reset(count);
+    }
+
+    Entry& entry = _entries[index];
+
+    if (!_received[index]) {
+        _received[index] = true;
+        ++_num_received;
+        entry.name = name;
+        entry.value = value;
+        entry.type = type;
+        _indices[name] = index;
+        return Update::NEW;
+    }
+
+    if (entry.name != name) {
+        // Same index but a different param, the old name is gone.
+        _indices.erase(entry.name);
+        entry.name = name;
+        _indices[name] = index;
+    } else if (float_bits(entry.value) == float_bits(value) && entry.type == type) {
+        return Update::UNCHANGED;
+    }
+
+    entry.value = value;
+    entry.type = type;
+    return Update::CHANGED;
+}
+
+bool ParamCache::get(const std::string& name, Entry& entry) const
+{
+    auto it = _indices.find(name);
+    if (it == _indices.end()) {
+        return false;
+    }
+    entry = _entries[it->second];
+    return true;
+}
+
+std::vector<uint16_t> ParamCache::missing_indices(size_t max_num) const
+{
+    std::vector<uint16_t> missing;
+    for (size_t i = 0; i < _received.size() && missing.size() < max_num; ++i) {
+        if (!_received[i]) {
+            missing.push_back(static_cast<uint16_t>(i));
+        }
+    }
+    return missing;
+}
+
+std::vector<ParamCache::Entry> ParamCache::entries() const
+{
+    std::vector<Entry> result;
+    result.reserve(_num_received);
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        if (_received[i]) {
+            result.push_back(_entries[i]);
+        }
+    }
+    return result;
+}
+
+bool ParamCache::save(const std::string& path) const
+{
+    if (!is_complete()) {
+        return false;
+    }
+
+    std::ofstream file(path, std::fstream::trunc);
+    if (!file) {
+        LogWarn() << "Could not write param cache " << path;
+        return false;
+    }
+
+    file << file_header << '\n' << _entries.size() << '\n';
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        file << i << ' ' << _entries[i].name << ' ' << int(_entries[i].type) << ' ' << std::hex
+             << float_bits(_entries[i].value) << std::dec << '\n';
+    }
+
+    return bool(file);
+}
+
+bool ParamCache::load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != file_header) {
+        LogWarn() << "Ignoring param cache with unknown format: " << path;
+        return false;
+    }
+
+    unsigned long count = 0;
+    if (!std::getline(file, line) || (count = std::strtoul(line.c_str(), nullptr, 10)) == 0 ||
+        count > UINT16_MAX) {
+        LogWarn() << "Ignoring broken param cache: " << path;
+        return false;
+    }
+
+    std::vector<Entry> entries(count);
+    std::vector<bool> received(count, false);
+    size_t num_received = 0;
+
+    while (std::getline(file, line)) {
+        std::istringstream line_stream(line);
+        unsigned long index;
+        std::string name;
+        unsigned type;
+        uint32_t bits;
+        if (!(line_stream >> index >> name >> type >> std::hex >> bits) || index >= count ||
+            received[index]) {
+            LogWarn() << "Ignoring broken param cache: " << path;
+            return false;
+        }
+        entries[index].name = name;
+        entries[index].value = float_from_bits(bits);
+        entries[index].type = static_cast<uint8_t>(type);
+        received[index] = true;
+        ++num_received;
+    }
+
+    if (num_received != count) {
+        LogWarn() << "Ignoring incomplete param cache: " << path;
+        return false;
+    }
+
+    clear();
+    _entries = std::move(entries);
+    _received = std::move(received);
+    _num_received = num_received;
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        _indices[_entries[i].name] = static_cast<uint16_t>(i);
+    }
+    return true;
+}
+
+std::string ParamCache::filename(uint64_t uuid, uint32_t hash)
+{
+    std::ostringstream stream;
+    stream << "params-" << uuid << "-" << std::hex << hash << ".txt";
+    return stream.str();
+}
+
+} // namespace mavsdk
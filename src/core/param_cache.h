@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mavsdk {
+
+// Index-addressed copy of the parameter set of an autopilot.
+//
+// Values are kept the way they arrive in PARAM_VALUE: the 4 bytes of the
+// param_value field together with the MAV_PARAM_TYPE. The cache knows how
+// many params there are from param_count, so it can tell which indices are
+// still missing after a PARAM_REQUEST_LIST.
+//
+// Not thread-safe, the owner needs to lock.
+class ParamCache {
+public:
+    struct Entry {
+        std::string name{};
+        float value{0.0f};
+        uint8_t type{0};
+    };
+
+    enum class Update {
+        NEW, // First time we see this index.
+        CHANGED, // Known param with a different value or type.
+        UNCHANGED, // Known param with the same value.
+        IGNORED // Index invalid and name unknown.
+    };
+
+    ParamCache() = default;
+    ~ParamCache() = default;
+
+    // delete copy and move constructors and assign operators
+    ParamCache(ParamCache const&) = delete; // Copy construct
+    ParamCache(ParamCache&&) = delete; // Move construct
+    ParamCache& operator=(ParamCache const&) = delete; // Copy assign
+    ParamCache& operator=(ParamCache&&) = delete; // Move assign
+
+    void clear();
+
+    // If index is not valid (e.g. 65535 as in PARAM_VALUE sent after a
+    // PARAM_SET by some autopilots), the param is looked up by name instead.
+    // A different count means the param set changed and resets the cache.
+    Update
+    update(uint16_t index, uint16_t count, const std::string& name, float value, uint8_t type);
+
+    bool get(const std::string& name, Entry& entry) const;
+
+    size_t count() const { return _entries.size(); }
+    size_t num_received() const { return _num_received; }
+    bool is_complete() const { return !_entries.empty() && _num_received == _entries.size(); }
+
+    // Up to max_num of the indices which have not been received yet.
+    std::vector<uint16_t> missing_indices(size_t max_num) const;
+
+    // All received entries in index order.
+    std::vector<Entry> entries() const;
+
+    // The file only contains complete caches, load() returns false and
+    // leaves the cache untouched if the file is missing, broken or
+    // incomplete.
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    // File name of the cache of a system with a given param hash, e.g. the
+    // value of _HASH_CHECK on PX4.
+    static std::string filename(uint64_t uuid, uint32_t hash);
+
+private:
+    void reset(uint16_t count);
+
+    std::vector<Entry> _entries{};
+    std::vector<bool> _received{};
+    std::unordered_map<std::string, uint16_t> _indices{};
+    size_t _num_received{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,138 @@
+#include "param_cache.h"
+#include "mavlink_include.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+using namespace mavsdk;
+
+namespace {
+
+const std::string cache_path = "param_cache_test.txt";
+
+void fill(ParamCache& cache, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; ++i) {
+        cache.update(
+            i, count, "PARAM_" + std::to_string(i), float(i) * 0.5f, MAV_PARAM_TYPE_REAL32);
+    }
+}
+
+} // namespace
+
+TEST(ParamCache, TracksMissingIndices)
+{
+    ParamCache cache;
+    EXPECT_FALSE(cache.is_complete());
+
+    EXPECT_EQ(cache.update(0, 4, "A", 1.0f, MAV_PARAM_TYPE_REAL32), ParamCache::Update::NEW);
+    EXPECT_EQ(cache.update(3, 4, "D", 4.0f, MAV_PARAM_TYPE_REAL32), ParamCache::Update::NEW);
+
+    EXPECT_EQ(cache.count(), 4u);
+    EXPECT_EQ(cache.num_received(), 2u);
+    EXPECT_FALSE(cache.is_complete());
+    EXPECT_EQ(cache.missing_indices(10), (std::vector<uint16_t>{1, 2}));
+    EXPECT_EQ(cache.missing_indices(1), (std::vector<uint16_t>{1}));
+
+    cache.update(1, 4, "B", 2.0f, MAV_PARAM_TYPE_REAL32);
+    cache.update(2, 4, "C", 3.0f, MAV_PARAM_TYPE_REAL32);
+    EXPECT_TRUE(cache.is_complete());
+    EXPECT_TRUE(cache.missing_indices(10).empty());
+
+    auto entries = cache.entries();
+    ASSERT_EQ(entries.size(), 4u);
+    EXPECT_EQ(entries[0].name, "A");
+    EXPECT_EQ(entries[3].name, "D");
+}
+
+TEST(ParamCache, UpdatesKnownParams)
+{
+    ParamCache cache;
+    fill(cache, 3);
+
+    EXPECT_EQ(
+        cache.update(1, 3, "PARAM_1", 0.5f, MAV_PARAM_TYPE_REAL32), ParamCache::Update::UNCHANGED);
+    EXPECT_EQ(
+        cache.update(1, 3, "PARAM_1", 7.0f, MAV_PARAM_TYPE_REAL32), ParamCache::Update::CHANGED);
+
+    // Without a valid index the param is found by name.
+    EXPECT_EQ(
+        cache.update(65535, 3, "PARAM_2", 8.0f, MAV_PARAM_TYPE_REAL32),
+        ParamCache::Update::CHANGED);
+    EXPECT_EQ(
+        cache.update(65535, 3, "UNKNOWN", 8.0f, MAV_PARAM_TYPE_REAL32),
+        ParamCache::Update::IGNORED);
+
+    ParamCache::Entry entry;
+    ASSERT_TRUE(cache.get("PARAM_1", entry));
+    EXPECT_EQ(entry.value, 7.0f);
+    ASSERT_TRUE(cache.get("PARAM_2", entry));
+    EXPECT_EQ(entry.value, 8.0f);
+    EXPECT_FALSE(cache.get("UNKNOWN", entry));
+}
+
+TEST(ParamCache, DifferentCountResets)
+{
+    ParamCache cache;
+    fill(cache, 3);
+    EXPECT_TRUE(cache.is_complete());
+
+    cache.update(0, 5, "PARAM_0", 0.0f, MAV_PARAM_TYPE_REAL32);
+    EXPECT_EQ(cache.count(), 5u);
+    EXPECT_EQ(cache.num_received(), 1u);
+
+    ParamCache::Entry entry;
+    EXPECT_FALSE(cache.get("PARAM_1", entry));
+}
+
+TEST(ParamCache, SavesAndLoads)
+{
+    ParamCache cache;
+    fill(cache, 20);
+    cache.update(5, 20, "INT_PARAM", 0.0f, MAV_PARAM_TYPE_INT32);
+    ASSERT_TRUE(cache.save(cache_path));
+
+    ParamCache loaded;
+    ASSERT_TRUE(loaded.load(cache_path));
+    EXPECT_TRUE(loaded.is_complete());
+    EXPECT_EQ(loaded.count(), 20u);
+
+    ParamCache::Entry entry;
+    ASSERT_TRUE(loaded.get("PARAM_7", entry));
+    EXPECT_EQ(entry.value, 3.5f);
+    EXPECT_EQ(entry.type, MAV_PARAM_TYPE_REAL32);
+    ASSERT_TRUE(loaded.get("INT_PARAM", entry));
+    EXPECT_EQ(entry.type, MAV_PARAM_TYPE_INT32);
+
+    std::remove(cache_path.c_str());
+}
+
+TEST(ParamCache, DoesNotSaveOrLoadIncomplete)
+{
+    ParamCache cache;
+    cache.update(0, 2, "A", 1.0f, MAV_PARAM_TYPE_REAL32);
+    EXPECT_FALSE(cache.save(cache_path));
+
+    {
+        std::ofstream file(cache_path, std::fstream::trunc);
+        file << "mavsdk-param-cache 1\n2\n0 A 9 3f800000\n";
+    }
+
+    ParamCache loaded;
+    loaded.update(0, 1, "B", 2.0f, MAV_PARAM_TYPE_REAL32);
+    EXPECT_FALSE(loaded.load(cache_path));
+    EXPECT_FALSE(loaded.load("does_not_exist.txt"));
+
+    // Still the old content.
+    ParamCache::Entry entry;
+    EXPECT_TRUE(loaded.get("B", entry));
+
+    std::remove(cache_path.c_str());
+}
+
+TEST(ParamCache, FilenameContainsUuidAndHash)
+{
+    EXPECT_EQ(ParamCache::filename(1234, 0xabcd), "params-1234-abcd.txt");
+    EXPECT_NE(ParamCache::filename(1234, 1), ParamCache::filename(1234, 2));
+    EXPECT_NE(ParamCache::filename(1, 1), ParamCache::filename(2, 1));
+}
@@ -0,0 +1,278 @@
+#include "send_queue.h"
+#include "log.h"
+#include <algorithm>
+#include <vector>
+
+namespace mavsdk {
+
+constexpr unsigned SendQueue::num_priorities;
+
+SendQueue::SendQueue(send_t send, size_t max_depth) :
+    _send(send),
+    _max_depth(std::max(max_depth, size_t(1)))
+{}
+
+SendQueue::~SendQueue()
+{
+    stop();
+}
+
+bool SendQueue::start()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_thread.joinable()) {
+        return false;
+    }
+    _should_stop = false;
+    _tokens = _burst_bytes;
+    _last_refill = Clock::now();
+    _thread = std::thread(&SendQueue::run, this);
+    return true;
+}
+
+void SendQueue::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_thread.joinable()) {
+            return;
+        }
+        _should_stop = true;
+    }
+    _cv.notify_all();
+    _thread.join();
+
+    std::vector<sent_callback_t> dropped;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& queue_class : _classes) {
+            queue_class.num_dropped += queue_class.entries.size();
+            for (auto& entry : queue_class.entries) {
+                if (entry.sent_callback) {
+                    dropped.push_back(std::move(entry.sent_callback));
+                }
+            }
+            queue_class.entries.clear();
+        }
+    }
+
+    for (const auto& sent_callback : dropped) {
+        sent_callback(false);
+    }
+}
+
+bool SendQueue::is_running() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _thread.joinable() && !_should_stop;
+}
+
+void SendQueue::set_rate_limit(double bytes_per_s, double burst_bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _bytes_per_s = std::max(bytes_per_s, 0.0);
+    if (burst_bytes <= 0.0) {
+        burst_bytes = _bytes_per_s / 10.0;
+    }
+    // A burst smaller than a message would only add latency.
+    _burst_bytes = std::max(burst_bytes, double(MAVLINK_MAX_PACKET_LEN));
+    _tokens = std::min(_tokens, _burst_bytes);
+    _cv.notify_all();
+}
+
+bool SendQueue::push(const mavlink_message_t& message, sent_callback_t sent_callback)
+{
+    return enqueue(
+        Entry{message, Clock::now(), std::move(sent_callback), nullptr},
+        priority_of(message.msgid));
+}
+
+bool SendQueue::push_forwarded(const mavlink_message_t& message, frame_t frame)
+{
+    return enqueue(Entry{message, Clock::now(), nullptr, std::move(frame)}, Priority::BULK);
+}
+
+bool SendQueue::enqueue(Entry entry, Priority priority)
+{
+    sent_callback_t dropped{};
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Class& queue_class = _classes[static_cast<unsigned>(priority)];
+
+        if (queue_class.entries.size() >= _max_depth) {
+            ++queue_class.num_dropped;
+            if (priority == Priority::COMMAND || priority == Priority::BULK) {
+                return false;
+            }
+            dropped = std::move(queue_class.entries.front().sent_callback);
+            queue_class.entries.pop_front();
+        }
+        queue_class.entries.push_back(std::move(entry));
+    }
+
+    _cv.notify_one();
+
+    if (dropped) {
+        dropped(false);
+    }
+    return true;
+}
+
+std::array<SendQueue::Stats, SendQueue::num_priorities> SendQueue::stats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::array<Stats, num_priorities> result;
+    for (unsigned i = 0; i < num_priorities; ++i) {
+        const Class& queue_class = _classes[i];
+        result[i].queue_depth = queue_class.entries.size();
+        result[i].num_sent = queue_class.num_sent;
+        result[i].num_dropped = queue_class.num_dropped;
+        result[i].num_failed = queue_class.num_failed;
+        result[i].mean_latency_s = (queue_class.num_sent > 0) ?
+                                       queue_class.latency_sum_s / queue_class.num_sent :
+                                       0.0;
+        result[i].max_latency_s = queue_class.max_latency_s;
+    }
+    return result;
+}
+
+SendQueue::Priority SendQueue::priority_of(uint32_t message_id)
+{
+    switch (message_id) {
+        case MAVLINK_MSG_ID_HEARTBEAT:
+        case MAVLINK_MSG_ID_MANUAL_CONTROL:
+        case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
+        case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
+        case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
+        case MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT:
+        case MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET:
+        case MAVLINK_MSG_ID_FOLLOW_TARGET:
+            return Priority::CONTROL;
+
+        case MAVLINK_MSG_ID_COMMAND_LONG:
+        case MAVLINK_MSG_ID_COMMAND_INT:
+        case MAVLINK_MSG_ID_COMMAND_ACK:
+        case MAVLINK_MSG_ID_SET_MODE:
+        case MAVLINK_MSG_ID_PARAM_SET:
+        case MAVLINK_MSG_ID_PARAM_EXT_SET:
+        case MAVLINK_MSG_ID_MISSION_SET_CURRENT:
+        case MAVLINK_MSG_ID_MISSION_CLEAR_ALL:
+            return Priority::COMMAND;
+
+        case MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
+        case MAVLINK_MSG_ID_LOG_REQUEST_LIST:
+        case MAVLINK_MSG_ID_LOG_REQUEST_DATA:
+        case MAVLINK_MSG_ID_LOG_ERASE:
+        case MAVLINK_MSG_ID_LOG_REQUEST_END:
+        case MAVLINK_MSG_ID_SERIAL_CONTROL:
+        case MAVLINK_MSG_ID_GPS_INJECT_DATA:
+        case MAVLINK_MSG_ID_GPS_RTCM_DATA:
+        case MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE:
+        case MAVLINK_MSG_ID_ENCAPSULATED_DATA:
+        case MAVLINK_MSG_ID_MISSION_COUNT:
+        case MAVLINK_MSG_ID_MISSION_ITEM:
+        case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+        case MAVLINK_MSG_ID_MISSION_REQUEST:
+        case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+        case MAVLINK_MSG_ID_MISSION_ACK:
+            return Priority::BULK;
+
+        default:
+            return Priority::TELEMETRY;
+    }
+}
+
+size_t SendQueue::wire_size(const mavlink_message_t& message)
+{
+    if (message.magic == MAVLINK_STX_MAVLINK1) {
+        return message.len + MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + MAVLINK_NUM_CHECKSUM_BYTES;
+    }
+    size_t size = message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    if (message.incompat_flags & MAVLINK_IFLAG_SIGNED) {
+        size += MAVLINK_SIGNATURE_BLOCK_LEN;
+    }
+    return size;
+}
+
+size_t SendQueue::wire_size(const Entry& entry)
+{
+    return entry.frame ? entry.frame->size() : wire_size(entry.message);
+}
+
+SendQueue::Class* SendQueue::next_class()
+{
+    for (auto& queue_class : _classes) {
+        if (!queue_class.entries.empty()) {
+            return &queue_class;
+        }
+    }
+    return nullptr;
+}
+
+bool SendQueue::take_tokens(std::unique_lock<std::mutex>& lock, size_t bytes)
+{
+    if (_bytes_per_s <= 0.0) {
+        return true;
+    }
+
+    const auto now = Clock::now();
+    const double elapsed_s = std::chrono::duration<double>(now - _last_refill).count();
+    _tokens = std::min(_tokens + elapsed_s * _bytes_per_s, _burst_bytes);
+    _last_refill = now;
+
+    if (_tokens > 0.0) {
+        _tokens -= double(bytes);
+        return true;
+    }
+
+    // Wait until there is something in the bucket again, unless a message
+    // of a higher class or a new limit comes in before.
+    _cv.wait_for(lock, std::chrono::duration<double>(-_tokens / _bytes_per_s + 1e-4));
+    return false;
+}
+
+void SendQueue::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_should_stop) {
+        Class* queue_class = next_class();
+        if (queue_class == nullptr) {
+            _cv.wait(lock);
+            continue;
+        }
+
+        if (!take_tokens(lock, wire_size(queue_class->entries.front()))) {
+            continue;
+        }
+
+        Entry entry = std::move(queue_class->entries.front());
+        queue_class->entries.pop_front();
+
+        lock.unlock();
+        const bool success =
+            entry.frame ?
+                _send(
+                    entry.message,
+                    entry.frame->data(),
+                    static_cast<unsigned>(entry.frame->size())) :
+                _send(entry.message, nullptr, 0);
+        const double latency_s =
+            std::chrono::duration<double>(Clock::now() - entry.queued).count();
+        if (entry.sent_callback) {
+            entry.sent_callback(success);
+        }
+        lock.lock();
+
+        if (!success) {
+            ++queue_class->num_failed;
+            continue;
+        }
+        ++queue_class->num_sent;
+        queue_class->latency_sum_s += latency_s;
+        queue_class->max_latency_s = std::max(queue_class->max_latency_s, latency_s);
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mavsdk {
+
+// Outgoing messages of one connection.
+//
+// Messages are queued without blocking the caller and sent by a thread of
+// the queue, highest priority class first. Optionally the bytes sent are
+// limited by a token bucket, so that a slow link is not saturated by bulk
+// transfers and heartbeats or commands can still get through.
+//
+// If a class is full, the oldest control or telemetry message is dropped
+// because a newer one supersedes it, while new commands and bulk messages
+// are refused so that their senders can retry.
+class SendQueue {
+public:
+    enum class Priority {
+        CONTROL = 0, // Heartbeats and setpoints.
+        COMMAND, // Commands, mode changes and param sets.
+        TELEMETRY, // Requests and everything else.
+        BULK // File, log, mission and RTCM transfers.
+    };
+    static constexpr unsigned num_priorities = 4;
+
+    struct Stats {
+        size_t queue_depth{0};
+        uint64_t num_sent{0};
+        // Refused or dropped because the class was full or the queue stopped.
+        uint64_t num_dropped{0};
+        // Handed to the connection, which failed to send them.
+        uint64_t num_failed{0};
+        double mean_latency_s{0.0};
+        double max_latency_s{0.0};
+    };
+
+    // The frame is the message as it was received if it is forwarded,
+    // otherwise nullptr.
+    typedef std::function<bool(
+        const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len)>
+        send_t;
+    typedef std::function<void(bool success)> sent_callback_t;
+    typedef std::shared_ptr<const std::vector<uint8_t>> frame_t;
+
+    explicit SendQueue(send_t send, size_t max_depth = 256);
+    ~SendQueue();
+
+    // delete copy and move constructors and assign operators
+    SendQueue(SendQueue const&) = delete; // Copy construct
+    SendQueue(SendQueue&&) = delete; // Move construct
+    SendQueue& operator=(SendQueue const&) = delete; // Copy assign
+    SendQueue& operator=(SendQueue&&) = delete; // Move assign
+
+    bool start();
+    // Messages which have not been sent yet are dropped.
+    void stop();
+    bool is_running() const;
+
+    // Limits the bytes sent per second, 0 for no limit. Up to burst_bytes can
+    // be sent at once after a pause, by default a tenth of a second's worth.
+    void set_rate_limit(double bytes_per_s, double burst_bytes = 0.0);
+
+    // Returns false if the message was refused because its class is full.
+    // Otherwise sent_callback is called once from the thread of the queue
+    // when the message has been sent, or with false if sending failed or the
+    // message was dropped.
+    bool push(const mavlink_message_t& message, sent_callback_t sent_callback = nullptr);
+
+    // Queues a message received on another connection to be sent as it was
+    // received. Forwarded messages always go into the bulk class, so they
+    // can't hold up our own messages, and are refused if it is full.
+    bool push_forwarded(const mavlink_message_t& message, frame_t frame);
+
+    std::array<Stats, num_priorities> stats() const;
+
+    static Priority priority_of(uint32_t message_id);
+    static size_t wire_size(const mavlink_message_t& message);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        mavlink_message_t message;
+        Clock::time_point queued;
+        sent_callback_t sent_callback;
+        frame_t frame;
+    };
+
+    struct Class {
+        std::deque<Entry> entries{};
+        uint64_t num_sent{0};
+        uint64_t num_dropped{0};
+        uint64_t num_failed{0};
+        double latency_sum_s{0.0};
+        double max_latency_s{0.0};
+    };
+
+    bool enqueue(Entry entry, Priority priority);
+    static size_t wire_size(const Entry& entry);
+    void run();
+    Class* next_class();
+    bool take_tokens(std::unique_lock<std::mutex>& lock, size_t bytes);
+
+    send_t _send;
+    const size_t _max_depth;
+
+    mutable std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::array<Class, num_priorities> _classes{};
+
+    double _bytes_per_s{0.0};
+    double _burst_bytes{0.0};
+    // Can go negative when a message larger than what is left was sent.
+    double _tokens{0.0};
+    Clock::time_point _last_refill{};
+
+    bool _should_stop{false};
+    std::thread _thread{};
+};
+
+} // namespace mavsdk
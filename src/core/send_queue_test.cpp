@@ -0,0 +1,306 @@
+#include "send_queue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t make_message(uint32_t message_id, uint8_t seq = 0, uint8_t len = 20)
+{
+    mavlink_message_t message{};
+    message.magic = MAVLINK_STX;
+    message.msgid = message_id;
+    message.seq = seq;
+    message.len = len;
+    return message;
+}
+
+// Records what was sent and can hold the sending thread.
+class Sink {
+public:
+    SendQueue::send_t send()
+    {
+        return [this](const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _sent.push_back(message);
+            _frames.emplace_back(frame, frame + frame_len);
+            _cv.notify_all();
+            _cv.wait(lock, [this]() { return !_blocked; });
+            return true;
+        };
+    }
+
+    void block()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _blocked = true;
+    }
+
+    void unblock()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _blocked = false;
+        }
+        _cv.notify_all();
+    }
+
+    bool wait_for(size_t num_sent)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        return _cv.wait_for(
+            lock, std::chrono::seconds(5), [this, num_sent]() { return _sent.size() >= num_sent; });
+    }
+
+    std::vector<mavlink_message_t> sent()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _sent;
+    }
+
+    // Empty for messages which were not forwarded.
+    std::vector<std::vector<uint8_t>> frames()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _frames;
+    }
+
+private:
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    bool _blocked{false};
+    std::vector<mavlink_message_t> _sent{};
+    std::vector<std::vector<uint8_t>> _frames{};
+};
+
+} // namespace
+
+TEST(SendQueue, Classifies)
+{
+    EXPECT_EQ(SendQueue::priority_of(MAVLINK_MSG_ID_HEARTBEAT), SendQueue::Priority::CONTROL);
+    EXPECT_EQ(SendQueue::priority_of(MAVLINK_MSG_ID_COMMAND_LONG), SendQueue::Priority::COMMAND);
+    EXPECT_EQ(
+        SendQueue::priority_of(MAVLINK_MSG_ID_PARAM_REQUEST_READ), SendQueue::Priority::TELEMETRY);
+    EXPECT_EQ(
+        SendQueue::priority_of(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL), SendQueue::Priority::BULK);
+}
+
+TEST(SendQueue, SendsHigherPriorityFirst)
+{
+    Sink sink;
+    SendQueue queue(sink.send());
+    ASSERT_TRUE(queue.start());
+
+    // Hold the thread in the first send so that the rest piles up.
+    sink.block();
+    queue.push(make_message(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, 0));
+    ASSERT_TRUE(sink.wait_for(1));
+
+    queue.push(make_message(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, 1));
+    queue.push(make_message(MAVLINK_MSG_ID_PARAM_REQUEST_READ, 2));
+    queue.push(make_message(MAVLINK_MSG_ID_COMMAND_LONG, 3));
+    queue.push(make_message(MAVLINK_MSG_ID_HEARTBEAT, 4));
+    sink.unblock();
+
+    ASSERT_TRUE(sink.wait_for(5));
+    const auto sent = sink.sent();
+    EXPECT_EQ(sent[0].seq, 0);
+    EXPECT_EQ(sent[1].seq, 4);
+    EXPECT_EQ(sent[2].seq, 3);
+    EXPECT_EQ(sent[3].seq, 2);
+    EXPECT_EQ(sent[4].seq, 1);
+
+    queue.stop();
+}
+
+TEST(SendQueue, LimitsRate)
+{
+    Sink sink;
+    SendQueue queue(sink.send());
+    // 10 messages of 100 bytes per second, and bursts of 3.
+    queue.set_rate_limit(1000.0, 300.0);
+    ASSERT_TRUE(queue.start());
+
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < 8; ++i) {
+        queue.push(make_message(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, uint8_t(i), 88));
+    }
+    ASSERT_TRUE(sink.wait_for(8));
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // The burst goes right away, the rest at 10 per second.
+    EXPECT_GT(elapsed_s, 0.35);
+    EXPECT_LT(elapsed_s, 1.0);
+
+    queue.stop();
+}
+
+TEST(SendQueue, DropsWhenFull)
+{
+    Sink sink;
+    SendQueue queue(sink.send(), 2);
+
+    // Not started yet, so everything stays queued.
+    for (uint8_t i = 0; i < 3; ++i) {
+        EXPECT_TRUE(queue.push(make_message(MAVLINK_MSG_ID_PARAM_REQUEST_READ, i)));
+    }
+    EXPECT_TRUE(queue.push(make_message(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, 10)));
+    EXPECT_TRUE(queue.push(make_message(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, 11)));
+    EXPECT_FALSE(queue.push(make_message(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, 12)));
+
+    auto stats = queue.stats();
+    const auto& telemetry = stats[static_cast<unsigned>(SendQueue::Priority::TELEMETRY)];
+    const auto& bulk = stats[static_cast<unsigned>(SendQueue::Priority::BULK)];
+    EXPECT_EQ(telemetry.queue_depth, 2u);
+    EXPECT_EQ(telemetry.num_dropped, 1u);
+    EXPECT_EQ(bulk.queue_depth, 2u);
+    EXPECT_EQ(bulk.num_dropped, 1u);
+
+    ASSERT_TRUE(queue.start());
+    ASSERT_TRUE(sink.wait_for(4));
+
+    // The oldest telemetry message was dropped, the newest bulk one.
+    const auto sent = sink.sent();
+    EXPECT_EQ(sent[0].seq, 1);
+    EXPECT_EQ(sent[1].seq, 2);
+    EXPECT_EQ(sent[2].seq, 10);
+    EXPECT_EQ(sent[3].seq, 11);
+
+    queue.stop();
+
+    stats = queue.stats();
+    EXPECT_EQ(stats[static_cast<unsigned>(SendQueue::Priority::TELEMETRY)].num_sent, 2u);
+    EXPECT_EQ(stats[static_cast<unsigned>(SendQueue::Priority::BULK)].num_sent, 2u);
+    EXPECT_GT(stats[static_cast<unsigned>(SendQueue::Priority::BULK)].max_latency_s, 0.0);
+}
+
+TEST(SendQueue, ReportsSendResults)
+{
+    std::mutex mutex;
+    std::vector<std::pair<uint8_t, bool>> results;
+    auto sent_callback = [&mutex, &results](uint8_t seq) {
+        return [&mutex, &results, seq](bool success) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.emplace_back(seq, success);
+        };
+    };
+
+    // Odd ones fail to send.
+    SendQueue queue(
+        [](const mavlink_message_t& message, const uint8_t*, unsigned) {
+            return message.seq % 2 == 0;
+        },
+        2);
+
+    // The oldest is dropped to make room for the third.
+    for (uint8_t i = 0; i < 3; ++i) {
+        EXPECT_TRUE(
+            queue.push(make_message(MAVLINK_MSG_ID_PARAM_REQUEST_READ, i), sent_callback(i)));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ASSERT_EQ(results.size(), 1u);
+        EXPECT_EQ(results[0], std::make_pair(uint8_t(0), false));
+    }
+
+    ASSERT_TRUE(queue.start());
+    for (unsigned i = 0; i < 500; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (results.size() == 3) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    queue.stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[1], std::make_pair(uint8_t(1), false));
+    EXPECT_EQ(results[2], std::make_pair(uint8_t(2), true));
+
+    const auto stats = queue.stats()[static_cast<unsigned>(SendQueue::Priority::TELEMETRY)];
+    EXPECT_EQ(stats.num_sent, 1u);
+    EXPECT_EQ(stats.num_dropped, 1u);
+    EXPECT_EQ(stats.num_failed, 1u);
+}
+
+TEST(SendQueue, ReportsMessagesDroppedOnStop)
+{
+    Sink sink;
+    SendQueue queue(sink.send());
+    std::mutex mutex;
+    std::vector<bool> results;
+    auto sent_callback = [&mutex, &results](bool success) {
+        std::lock_guard<std::mutex> lock(mutex);
+        results.push_back(success);
+    };
+
+    // The first one is being sent while the second one waits.
+    sink.block();
+    ASSERT_TRUE(queue.start());
+    EXPECT_TRUE(queue.push(make_message(MAVLINK_MSG_ID_PARAM_REQUEST_READ, 0), sent_callback));
+    ASSERT_TRUE(sink.wait_for(1));
+    EXPECT_TRUE(queue.push(make_message(MAVLINK_MSG_ID_PARAM_REQUEST_READ, 1), sent_callback));
+
+    std::thread unblocker([&sink]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        sink.unblock();
+    });
+    queue.stop();
+    unblocker.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_TRUE(results[0]);
+    EXPECT_FALSE(results[1]);
+}
+
+TEST(SendQueue, ForwardsFramesAfterOwnMessages)
+{
+    Sink sink;
+    SendQueue queue(sink.send());
+
+    // A heartbeat being forwarded must not get ahead of our own telemetry.
+    const std::vector<uint8_t> frame{0xfd, 9, 0, 0, 1, 1, 1, 0, 0, 0};
+    EXPECT_TRUE(queue.push_forwarded(
+        make_message(MAVLINK_MSG_ID_HEARTBEAT, 0),
+        std::make_shared<const std::vector<uint8_t>>(frame)));
+    EXPECT_TRUE(queue.push(make_message(MAVLINK_MSG_ID_PARAM_REQUEST_READ, 1)));
+
+    ASSERT_TRUE(queue.start());
+    ASSERT_TRUE(sink.wait_for(2));
+    queue.stop();
+
+    const auto sent = sink.sent();
+    EXPECT_EQ(sent[0].seq, 1);
+    EXPECT_EQ(sent[1].seq, 0);
+    const auto frames = sink.frames();
+    EXPECT_TRUE(frames[0].empty());
+    EXPECT_EQ(frames[1], frame);
+
+    const auto stats = queue.stats();
+    EXPECT_EQ(stats[static_cast<unsigned>(SendQueue::Priority::BULK)].num_sent, 1u);
+    EXPECT_EQ(stats[static_cast<unsigned>(SendQueue::Priority::CONTROL)].num_sent, 0u);
+}
+
+TEST(SendQueue, WireSize)
+{
+    auto message = make_message(MAVLINK_MSG_ID_HEARTBEAT, 0, 9);
+    EXPECT_EQ(SendQueue::wire_size(message), 21u);
+
+    message.incompat_flags = MAVLINK_IFLAG_SIGNED;
+    EXPECT_EQ(SendQueue::wire_size(message), 34u);
+
+    message.magic = MAVLINK_STX_MAVLINK1;
+    EXPECT_EQ(SendQueue::wire_size(message), 17u);
+}
@@ -0,0 +1,37 @@
+#include "serial_baudrate.h"
+#include "global_include.h"
+
+#if defined(LINUX)
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace mavsdk {
+
+bool set_arbitrary_baudrate(int fd, int baudrate)
+{
+#if defined(LINUX)
+    if (baudrate <= 0) {
+        return false;
+    }
+
+    struct termios2 tc2;
+    if (ioctl(fd, TCGETS2, &tc2) != 0) {
+        return false;
+    }
+
+    // The input speed bits are shifted by IBSHIFT.
+    tc2.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+    tc2.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    tc2.c_ispeed = static_cast<speed_t>(baudrate);
+    tc2.c_ospeed = static_cast<speed_t>(baudrate);
+
+    return ioctl(fd, TCSETS2, &tc2) == 0;
+#else
+    UNUSED(fd);
+    UNUSED(baudrate);
+    return false;
+#endif
+}
+
+} // namespace mavsdk
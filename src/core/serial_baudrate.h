@@ -0,0 +1,13 @@
+#pragma once
+
+namespace mavsdk {
+
+// Sets input and output speed of a serial port to any baudrate, also ones
+// without a Bxxx define, using termios2 and BOTHER.
+//
+// This lives in its own file because the kernel's termios definitions
+// needed for it clash with the ones of <termios.h>. Only implemented on
+// Linux, elsewhere it fails.
+bool set_arbitrary_baudrate(int fd, int baudrate);
+
+} // namespace mavsdk
@@ -1,13 +1,20 @@
 #include "serial_connection.h"
+#include "serial_baudrate.h"
 #include "global_include.h"
 #include "log.h"
 
 #if defined(APPLE) || defined(LINUX)
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <termios.h>
 #endif
 
+#if defined(LINUX)
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#endif
+
 namespace mavsdk {
 
 #ifndef WINDOWS
@@ -44,10 +51,14 @@ std::string GetLastErrorStdStr()
 #endif
 
 SerialConnection::SerialConnection(
-    Connection::receiver_callback_t receiver_callback, const std::string& path, int baudrate) :
+    Connection::receiver_callback_t receiver_callback,
+    const std::string& path,
+    int baudrate,
+    bool low_latency) :
     Connection(receiver_callback),
     _serial_node(path),
-    _baudrate(baudrate)
+    _baudrate(baudrate),
+    _low_latency(low_latency)
 {}
 
 SerialConnection::~SerialConnection()
@@ -58,16 +69,32 @@ SerialConnection::~SerialConnection()
 
 ConnectionResult SerialConnection::start()
 {
-    if (!start_mavlink_receiver()) {
-        return ConnectionResult::CONNECTIONS_EXHAUSTED;
-    }
+    start_mavlink_receiver();
+
+    // Large enough to take what a fast link delivers while we were busy
+    // with a single read.
+    _read_buffer.resize(_low_latency ? 65536 : 2048);
 
     ConnectionResult ret = setup_port();
     if (ret != ConnectionResult::SUCCESS) {
         return ret;
     }
 
-    start_recv_thread();
+    if (_io_reactor) {
+#if defined(LINUX)
+        // The reactor only calls us once data is there, so we must never block.
+        if (!IoReactor::set_non_blocking(_fd) ||
+            !_io_reactor->add(_fd, std::bind(&SerialConnection::receive_available, this))) {
+            return ConnectionResult::CONNECTION_ERROR;
+        }
+#else
+        return ConnectionResult::NOT_IMPLEMENTED;
+#endif
+    } else {
+        start_recv_thread();
+    }
+
+    start_send_queue();
 
     return ConnectionResult::SUCCESS;
 }
@@ -82,8 +109,8 @@ ConnectionResult SerialConnection::setup_port()
         return ConnectionResult::CONNECTION_ERROR;
     }
     // We need to clear the O_NONBLOCK again because we can block while reading
-    // as we do it in a separate thread.
-    if (fcntl(_fd, F_SETFL, 0) == -1) {
+    // as we do it in a separate thread. In low latency mode we poll instead.
+    if (!_low_latency && fcntl(_fd, F_SETFL, 0) == -1) {
         LogErr() << "fcntl failed: " << GET_ERROR();
         return ConnectionResult::CONNECTION_ERROR;
     }
@@ -121,8 +148,14 @@ ConnectionResult SerialConnection::setup_port()
     tc.c_cflag &= ~(CSIZE | PARENB | CRTSCTS);
     tc.c_cflag |= CS8;
 
-    tc.c_cc[VMIN] = 0; // We are ok with 0 bytes.
-    tc.c_cc[VTIME] = 10; // Timeout after 1 second.
+    if (_low_latency) {
+        // Reads return whatever is there right away, poll() does the waiting.
+        tc.c_cc[VMIN] = 0;
+        tc.c_cc[VTIME] = 0;
+    } else {
+        tc.c_cc[VMIN] = 0; // We are ok with 0 bytes.
+        tc.c_cc[VTIME] = 10; // Timeout after 1 second.
+    }
 #endif
 
 #if defined(LINUX) || defined(APPLE)
@@ -130,30 +163,43 @@ ConnectionResult SerialConnection::setup_port()
 
 #if defined(LINUX)
     const int baudrate_or_define = define_from_baudrate(_baudrate);
+    // Baudrates without a define are set using termios2 further down.
+    const bool arbitrary_baudrate = (baudrate_or_define == -1);
 #elif defined(APPLE)
     const int baudrate_or_define = _baudrate;
+    const bool arbitrary_baudrate = false;
 #endif
 
-    if (baudrate_or_define == -1) {
-        return ConnectionResult::BAUDRATE_UNKNOWN;
+    if (!arbitrary_baudrate) {
+        if (cfsetispeed(&tc, baudrate_or_define) != 0) {
+            LogErr() << "cfsetispeed failed: " << GET_ERROR();
+            close(_fd);
+            return ConnectionResult::CONNECTION_ERROR;
+        }
+
+        if (cfsetospeed(&tc, baudrate_or_define) != 0) {
+            LogErr() << "cfsetospeed failed: " << GET_ERROR();
+            close(_fd);
+            return ConnectionResult::CONNECTION_ERROR;
+        }
     }
 
-    if (cfsetispeed(&tc, baudrate_or_define) != 0) {
-        LogErr() << "cfsetispeed failed: " << GET_ERROR();
+    if (tcsetattr(_fd, TCSANOW, &tc) != 0) {
+        LogErr() << "tcsetattr failed: " << GET_ERROR();
         close(_fd);
         return ConnectionResult::CONNECTION_ERROR;
     }
 
-    if (cfsetospeed(&tc, baudrate_or_define) != 0) {
-        LogErr() << "cfsetospeed failed: " << GET_ERROR();
+    if (arbitrary_baudrate && !set_arbitrary_baudrate(_fd, _baudrate)) {
+        LogErr() << "Setting baudrate " << _baudrate << " failed: " << GET_ERROR();
         close(_fd);
-        return ConnectionResult::CONNECTION_ERROR;
+        return ConnectionResult::BAUDRATE_UNKNOWN;
     }
+#endif
 
-    if (tcsetattr(_fd, TCSANOW, &tc) != 0) {
-        LogErr() << "tcsetattr failed: " << GET_ERROR();
-        close(_fd);
-        return ConnectionResult::CONNECTION_ERROR;
+#if defined(LINUX)
+    if (_low_latency) {
+        enable_low_latency();
     }
 #endif
 
@@ -204,12 +250,28 @@ ConnectionResult SerialConnection::setup_port()
 
 void SerialConnection::start_recv_thread()
 {
+#if defined(LINUX) || defined(APPLE)
+    if (_low_latency) {
+        _recv_thread = new std::thread(&SerialConnection::poll_and_receive, this);
+        return;
+    }
+#endif
     _recv_thread = new std::thread(&SerialConnection::receive, this);
 }
 
 ConnectionResult SerialConnection::stop()
 {
     _should_exit = true;
+
+    stop_send_queue();
+
+#if defined(LINUX)
+    if (_io_reactor) {
+        // Once removed, the reactor won't call us anymore.
+        _io_reactor->remove(_fd);
+    }
+#endif
+
 #if defined(LINUX) || defined(APPLE)
     close(_fd);
 #elif defined(WINDOWS)
@@ -244,11 +306,36 @@ bool SerialConnection::send_message(const mavlink_message_t& message)
     uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
     uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
 
-    int send_len;
+    return send_frame(message, buffer, buffer_len);
+}
+
+bool SerialConnection::send_frame(
+    const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len)
+{
+    // Forwarded frames and our own messages are written from different
+    // threads and must not end up interleaved.
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const int buffer_len = static_cast<int>(frame_len);
+    int send_len = 0;
 #if defined(LINUX) || defined(APPLE)
-    send_len = static_cast<int>(write(_fd, buffer, buffer_len));
+    // The port is non-blocking in low latency mode or with the I/O reactor,
+    // so we might have to wait until the driver has room for the rest.
+    while (send_len < buffer_len) {
+        const ssize_t ret = write(_fd, frame + send_len, buffer_len - send_len);
+        if (ret > 0) {
+            send_len += static_cast<int>(ret);
+        } else if (ret < 0 && (errno == EAGAIN || errno == EINTR)) {
+            pollfd fds[1] = {{_fd, POLLOUT, 0}};
+            if (poll(fds, 1, 100) <= 0 && _should_exit) {
+                break;
+            }
+        } else {
+            break;
+        }
+    }
 #else
-    if (!WriteFile(_handle, buffer, buffer_len, LPDWORD(&send_len), NULL)) {
+    if (!WriteFile(_handle, frame, frame_len, LPDWORD(&send_len), NULL)) {
         LogErr() << "WriteFile failure: " << GET_ERROR();
         return false;
     }
@@ -259,6 +346,7 @@ bool SerialConnection::send_message(const mavlink_message_t& message)
         return false;
     }
 
+    _traffic_counters.add_message_sent(message, frame_len);
     return true;
 }
 
@@ -283,11 +371,58 @@ void SerialConnection::receive()
         if (recv_len > static_cast<int>(sizeof(buffer)) || recv_len == 0) {
             continue;
         }
-        _mavlink_receiver->set_new_datagram(buffer, recv_len);
-        // Parse all mavlink messages in one data packet. Once exhausted, we'll exit while.
-        while (_mavlink_receiver->parse_message()) {
-            receive_message(_mavlink_receiver->get_last_message());
+        process_data(buffer, recv_len);
+    }
+}
+
+void SerialConnection::poll_and_receive()
+{
+#if defined(LINUX) || defined(APPLE)
+    while (!_should_exit) {
+        pollfd fds[1] = {{_fd, POLLIN, 0}};
+        // The timeout is only there to notice that we should exit.
+        const int ret = poll(fds, 1, 100);
+        if (ret < 0 && errno != EINTR) {
+            LogErr() << "poll failure: " << GET_ERROR();
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        if (ret <= 0) {
+            continue;
         }
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            // E.g. a USB adapter was unplugged, don't spin.
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        receive_available();
+    }
+#endif
+}
+
+void SerialConnection::receive_available()
+{
+#if defined(LINUX) || defined(APPLE)
+    // We are called by the I/O reactor or after poll(), so drain the port
+    // without blocking.
+    while (!_should_exit) {
+        const int recv_len =
+            static_cast<int>(read(_fd, _read_buffer.data(), _read_buffer.size()));
+        if (recv_len <= 0) {
+            // Nothing left to read (EAGAIN), or the port is closing.
+            return;
+        }
+        process_data(_read_buffer.data(), recv_len);
+    }
+#endif
+}
+
+void SerialConnection::process_data(char* buffer, int buffer_len)
+{
+    LatencyTracer::stamp_receive_time();
+    _mavlink_receiver->set_new_datagram(buffer, buffer_len);
+    // Parse all mavlink messages in one data packet. Once exhausted, we'll exit while.
+    while (_mavlink_receiver->parse_message()) {
+        receive_message(*_mavlink_receiver);
     }
 }
 
@@ -331,10 +466,23 @@ int SerialConnection::define_from_baudrate(int baudrate)
             return B3500000;
         case 4000000:
             return B4000000;
-        default: {
-            LogErr() << "Unknown baudrate";
+        default:
             return -1;
-        }
+    }
+}
+
+void SerialConnection::enable_low_latency()
+{
+    struct serial_struct serial_info;
+    if (ioctl(_fd, TIOCGSERIAL, &serial_info) != 0) {
+        // Not every driver supports this, e.g. pseudo terminals don't.
+        LogDebug() << "Low latency not supported by " << _serial_node << ": " << GET_ERROR();
+        return;
+    }
+
+    serial_info.flags |= ASYNC_LOW_LATENCY;
+    if (ioctl(_fd, TIOCSSERIAL, &serial_info) != 0) {
+        LogWarn() << "Enabling low latency failed: " << GET_ERROR();
     }
 }
 #endif
@@ -2,6 +2,8 @@
 
 #include <mutex>
 #include <atomic>
+#include <string>
+#include <vector>
 #include "connection.h"
 
 #if defined(WINDOWS)
@@ -10,15 +12,25 @@
 
 namespace mavsdk {
 
+// Connection over a serial port.
+//
+// In low latency mode the port is read without blocking: the receive thread
+// waits in poll() and then drains everything that is available into a large
+// buffer, and on Linux the driver is asked to hand over data right away
+// (ASYNC_LOW_LATENCY) instead of batching it.
 class SerialConnection : public Connection {
 public:
     explicit SerialConnection(
-        Connection::receiver_callback_t receiver_callback, const std::string& path, int baudrate);
+        Connection::receiver_callback_t receiver_callback,
+        const std::string& path,
+        int baudrate,
+        bool low_latency = false);
     ConnectionResult start();
     ConnectionResult stop();
     ~SerialConnection();
 
     bool send_message(const mavlink_message_t& message);
+    bool send_frame(const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len);
 
     // Non-copyable
     SerialConnection(const SerialConnection&) = delete;
@@ -28,13 +40,20 @@ private:
     ConnectionResult setup_port();
     void start_recv_thread();
     void receive();
+    void poll_and_receive();
+    void receive_available();
+    void process_data(char* buffer, int buffer_len);
 
 #if defined(LINUX)
     static int define_from_baudrate(int baudrate);
+    void enable_low_latency();
 #endif
 
     std::string _serial_node;
     int _baudrate;
+    const bool _low_latency;
+
+    std::vector<char> _read_buffer{};
 
     std::mutex _mutex = {};
 #if !defined(WINDOWS)
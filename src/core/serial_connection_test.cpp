@@ -0,0 +1,150 @@
+#include "serial_connection.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#if defined(LINUX)
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace mavsdk;
+
+namespace {
+
+// A pseudo terminal stands in for the serial port. We talk to the connection
+// through the master side while it opens the slave side.
+class Pty {
+public:
+    Pty()
+    {
+        _master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (_master_fd < 0 || grantpt(_master_fd) != 0 || unlockpt(_master_fd) != 0) {
+            return;
+        }
+        const char* name = ptsname(_master_fd);
+        if (name != nullptr) {
+            _slave_path = name;
+        }
+    }
+
+    ~Pty()
+    {
+        if (_master_fd >= 0) {
+            close(_master_fd);
+        }
+    }
+
+    // delete copy and move constructors and assign operators
+    Pty(Pty const&) = delete; // Copy construct
+    Pty(Pty&&) = delete; // Move construct
+    Pty& operator=(Pty const&) = delete; // Copy assign
+    Pty& operator=(Pty&&) = delete; // Move assign
+
+    bool is_open() const { return !_slave_path.empty(); }
+    const std::string& slave_path() const { return _slave_path; }
+
+    bool write_message(const mavlink_message_t& message)
+    {
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t len = mavlink_msg_to_send_buffer(buffer, &message);
+        return write(_master_fd, buffer, len) == len;
+    }
+
+    std::vector<uint8_t> read_bytes(size_t num_bytes)
+    {
+        std::vector<uint8_t> result;
+        while (result.size() < num_bytes) {
+            pollfd fds[1] = {{_master_fd, POLLIN, 0}};
+            if (poll(fds, 1, 1000) <= 0) {
+                break;
+            }
+            uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+            const ssize_t len = read(_master_fd, buffer, sizeof(buffer));
+            if (len <= 0) {
+                break;
+            }
+            result.insert(result.end(), buffer, buffer + len);
+        }
+        return result;
+    }
+
+private:
+    int _master_fd{-1};
+    std::string _slave_path{};
+};
+
+bool wait_for(const std::atomic<unsigned>& counter, unsigned value)
+{
+    for (unsigned i = 0; i < 100; ++i) {
+        if (counter >= value) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+void receives_and_sends(bool low_latency)
+{
+    Pty pty;
+    ASSERT_TRUE(pty.is_open());
+
+    std::atomic<unsigned> num_received{0};
+    SerialConnection connection(
+        [&num_received](mavlink_message_t& message) {
+            if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+                ++num_received;
+            }
+        },
+        pty.slave_path(),
+        115200,
+        low_latency);
+    ASSERT_EQ(connection.start(), ConnectionResult::SUCCESS);
+
+    mavlink_message_t message{};
+    mavlink_msg_heartbeat_pack(1, 1, &message, 0, 0, 0, 0, 0);
+    for (unsigned i = 0; i < 10; ++i) {
+        ASSERT_TRUE(pty.write_message(message));
+    }
+    EXPECT_TRUE(wait_for(num_received, 10));
+
+    mavlink_msg_heartbeat_pack(2, 1, &message, 0, 0, 0, 0, 0);
+    uint8_t expected[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t expected_len = mavlink_msg_to_send_buffer(expected, &message);
+    EXPECT_TRUE(connection.send_message(message));
+
+    const auto sent = pty.read_bytes(expected_len);
+    ASSERT_EQ(sent.size(), expected_len);
+    EXPECT_TRUE(std::equal(sent.begin(), sent.end(), expected));
+
+    connection.stop();
+}
+
+} // namespace
+
+TEST(SerialConnection, ReceivesAndSends)
+{
+    receives_and_sends(false);
+}
+
+TEST(SerialConnection, ReceivesAndSendsWithLowLatency)
+{
+    receives_and_sends(true);
+}
+
+TEST(SerialConnection, AcceptsNonStandardBaudrate)
+{
+    Pty pty;
+    ASSERT_TRUE(pty.is_open());
+
+    SerialConnection connection([](mavlink_message_t&) {}, pty.slave_path(), 1234567);
+    EXPECT_EQ(connection.start(), ConnectionResult::SUCCESS);
+    connection.stop();
+}
+
+#endif
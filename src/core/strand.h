@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include "callback_task.h"
+#include "delivery_queue.h"
+#include "thread_pool.h"
+
+namespace mavsdk {
+
+// Runs tasks on a ThreadPool one at a time and in the order they were posted.
+//
+// Tasks of different strands still run in parallel on the pool's workers, so
+// the pool can be made larger without the callbacks of e.g. one subscription
+// being reordered or running concurrently.
+//
+// This is a DeliveryQueue of tasks which delivers each one by running it, so
+// a strand can also go away while one of its tasks is still queued.
+class Strand {
+public:
+    Strand() { _queue.set_callback([](CallbackTask task) { task(); }); }
+    ~Strand() = default;
+
+    // delete copy and move constructors and assign operators
+    Strand(Strand const&) = delete; // Copy construct
+    Strand(Strand&&) = delete; // Move construct
+    Strand& operator=(Strand const&) = delete; // Copy assign
+    Strand& operator=(Strand&&) = delete; // Move assign
+
+    template<typename F> void post(ThreadPool& thread_pool, F&& func)
+    {
+        CallbackTask task;
+        task.emplace(std::forward<F>(func));
+        _queue.deliver(thread_pool, std::move(task));
+    }
+
+    // Number of tasks which have been posted but have not started yet.
+    size_t num_pending() const { return _queue.stats().queue_depth; }
+
+private:
+    DeliveryQueue<CallbackTask> _queue{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,137 @@
+#include "strand.h"
+#include "thread_pool.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+TEST(Strand, RunsInOrder)
+{
+    ThreadPool thread_pool(4);
+    thread_pool.start();
+
+    const unsigned num_strands = 4;
+    const unsigned num_tasks = 1000;
+
+    std::array<Strand, num_strands> strands;
+    std::array<std::vector<unsigned>, num_strands> received;
+    std::array<std::atomic<unsigned>, num_strands> num_running{};
+    std::atomic<bool> overlapped{false};
+    std::atomic<unsigned> num_done{0};
+
+    for (unsigned i = 0; i < num_tasks; ++i) {
+        for (unsigned s = 0; s < num_strands; ++s) {
+            strands[s].post(thread_pool, [&, s, i]() {
+                if (num_running[s].fetch_add(1) != 0) {
+                    overlapped = true;
+                }
+                received[s].push_back(i);
+                num_running[s].fetch_sub(1);
+                ++num_done;
+            });
+        }
+    }
+
+    for (unsigned i = 0; i < 200 && num_done < num_strands * num_tasks; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    thread_pool.stop();
+
+    EXPECT_FALSE(overlapped);
+    for (unsigned s = 0; s < num_strands; ++s) {
+        ASSERT_EQ(received[s].size(), num_tasks);
+        for (unsigned i = 0; i < num_tasks; ++i) {
+            EXPECT_EQ(received[s][i], i);
+        }
+    }
+}
+
+TEST(Strand, DifferentStrandsRunInParallel)
+{
+    ThreadPool thread_pool(2);
+    thread_pool.start();
+
+    Strand strand_a;
+    Strand strand_b;
+
+    // Each task waits for the other one to be running, which only works if
+    // they run at the same time.
+    std::atomic<bool> a_running{false};
+    std::atomic<bool> b_running{false};
+    std::atomic<bool> a_saw_b{false};
+    std::atomic<bool> b_saw_a{false};
+
+    auto wait_for = [](std::atomic<bool>& flag) {
+        for (unsigned i = 0; i < 100 && !flag; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return flag.load();
+    };
+
+    strand_a.post(thread_pool, [&]() {
+        a_running = true;
+        a_saw_b = wait_for(b_running);
+    });
+    strand_b.post(thread_pool, [&]() {
+        b_running = true;
+        b_saw_a = wait_for(a_running);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    thread_pool.stop();
+
+    EXPECT_TRUE(a_saw_b);
+    EXPECT_TRUE(b_saw_a);
+}
+
+TEST(Strand, SameStrandWaits)
+{
+    ThreadPool thread_pool(2);
+    thread_pool.start();
+
+    Strand strand;
+    std::atomic<bool> first_done{false};
+    std::atomic<bool> second_saw_first{false};
+    std::atomic<bool> second_done{false};
+
+    strand.post(thread_pool, [&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        first_done = true;
+    });
+    strand.post(thread_pool, [&]() {
+        second_saw_first = first_done.load();
+        second_done = true;
+    });
+
+    for (unsigned i = 0; i < 100 && !second_done; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    thread_pool.stop();
+
+    EXPECT_TRUE(second_saw_first);
+    EXPECT_EQ(strand.num_pending(), 0u);
+}
+
+TEST(Strand, OutlivedByQueuedTask)
+{
+    ThreadPool thread_pool(1);
+
+    std::atomic<unsigned> num_called{0};
+    {
+        Strand strand;
+        strand.post(thread_pool, [&num_called]() { ++num_called; });
+        strand.post(thread_pool, [&num_called]() { ++num_called; });
+    }
+
+    thread_pool.start();
+    for (unsigned i = 0; i < 100 && num_called < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    thread_pool.stop();
+
+    EXPECT_EQ(num_called, 2u);
+}
@@ -52,6 +52,11 @@ uint64_t System::get_uuid() const
     return _system_impl->get_uuid();
 }
 
+TrafficStats System::traffic_stats() const
+{
+    return _system_impl->traffic_stats();
+}
+
 void System::register_component_discovered_callback(discover_callback_t callback) const
 {
     return _system_impl->register_component_discovered_callback(callback);
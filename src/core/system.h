@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <functional>
+#include "traffic_stats.h"
 
 namespace mavsdk {
 
@@ -97,6 +98,15 @@ public:
      */
     void register_component_discovered_callback(discover_callback_t callback) const;
 
+    /**
+     * @brief Get the statistics of the traffic with this system.
+     *
+     * Messages which arrive more than once over redundant connections are only counted once.
+     *
+     * @return Snapshot of the counters.
+     */
+    TrafficStats traffic_stats() const;
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
@@ -22,7 +22,17 @@ SystemImpl::SystemImpl(MavsdkImpl& parent, uint8_t system_id, uint8_t comp_id, b
     _params(*this),
     _commands(*this),
     _timeout_handler(_time),
-    _call_every_handler(_time)
+    _call_every_handler(_time),
+    _message_rates(
+        _time,
+        [this](
+            uint16_t message_id,
+            double rate_hz,
+            uint8_t component_id,
+            MessageRates::result_callback_t callback) {
+            set_msg_rate_async(message_id, rate_hz, callback, component_id);
+        }),
+    _thread_pool(parent.get_num_callback_threads())
 {
     if (connected) {
         _always_connected = true;
@@ -56,6 +66,7 @@ SystemImpl::SystemImpl(MavsdkImpl& parent, uint8_t system_id, uint8_t comp_id, b
 SystemImpl::~SystemImpl()
 {
     _should_exit = true;
+    wake_up_system_thread();
     unregister_all_mavlink_message_handlers(this);
 
     unregister_timeout_handler(_autopilot_version_timed_out_cookie);
@@ -80,48 +91,24 @@ bool SystemImpl::is_connected() const
 void SystemImpl::register_mavlink_message_handler(
     uint16_t msg_id, mavlink_message_handler_t callback, const void* cookie)
 {
-    std::lock_guard<std::mutex> lock(_mavlink_handler_table_mutex);
-
-    MAVLinkHandlerTableEntry entry = {msg_id, callback, cookie};
-    _mavlink_handler_table.push_back(entry);
-    // Push back can move the std::vector and therefore invalidate the iterator.
-    _iterator_invalidated = true;
+    _mavlink_handler_table.register_handler(msg_id, callback, cookie);
 }
 
 void SystemImpl::unregister_mavlink_message_handler(uint16_t msg_id, const void* cookie)
 {
-    std::lock_guard<std::mutex> lock(_mavlink_handler_table_mutex);
-
-    for (auto it = _mavlink_handler_table.begin(); it != _mavlink_handler_table.end();
-         /* no ++it */) {
-        if (it->msg_id == msg_id && it->cookie == cookie) {
-            it = _mavlink_handler_table.erase(it);
-            _iterator_invalidated = true;
-        } else {
-            ++it;
-        }
-    }
+    _mavlink_handler_table.unregister_handler(msg_id, cookie);
 }
 
 void SystemImpl::unregister_all_mavlink_message_handlers(const void* cookie)
 {
-    std::lock_guard<std::mutex> lock(_mavlink_handler_table_mutex);
-
-    for (auto it = _mavlink_handler_table.begin(); it != _mavlink_handler_table.end();
-         /* no ++it */) {
-        if (it->cookie == cookie) {
-            it = _mavlink_handler_table.erase(it);
-            _iterator_invalidated = true;
-        } else {
-            ++it;
-        }
-    }
+    _mavlink_handler_table.unregister_all(cookie);
 }
 
 void SystemImpl::register_timeout_handler(
     std::function<void()> callback, double duration_s, void** cookie)
 {
     _timeout_handler.add(callback, duration_s, cookie);
+    wake_up_system_thread();
 }
 
 void SystemImpl::refresh_timeout_handler(const void* cookie)
@@ -132,10 +119,18 @@ void SystemImpl::refresh_timeout_handler(const void* cookie)
 void SystemImpl::unregister_timeout_handler(const void* cookie)
 {
     _timeout_handler.remove(cookie);
+    // Usually this means that the current param or command is done and the
+    // next one can be sent.
+    wake_up_system_thread();
 }
 
 void SystemImpl::process_mavlink_message(mavlink_message_t& message)
 {
+    _traffic_counters.add_message_received(message, TrafficCounters::frame_len(message));
+
+    // Callbacks queued while the handlers run are traced, if enabled.
+    LatencyTracer::Dispatch dispatch(_parent.latency_tracer(), message);
+
     // This is a low level interface where incoming messages can be tampered
     // with or even dropped.
     if (_incoming_messages_intercept_callback) {
@@ -146,33 +141,10 @@ void SystemImpl::process_mavlink_message(mavlink_message_t& message)
         }
     }
 
-    _mavlink_handler_table_mutex.lock();
+    _message_rates.on_message(message.msgid, message.compid);
 
-#if MESSAGE_DEBUGGING == 1
-    bool forwarded = false;
-#endif
-    for (auto it = _mavlink_handler_table.begin(); it != _mavlink_handler_table.end(); /* ++it */) {
-        if (it->msg_id == message.msgid) {
-#if MESSAGE_DEBUGGING == 1
-            LogDebug() << "Forwarding msg " << int(message.msgid) << " to " << size_t(it->cookie);
-            forwarded = true;
-#endif
-            _mavlink_handler_table_mutex.unlock();
-            it->callback(message);
-            _mavlink_handler_table_mutex.lock();
-        }
-
-        if (_iterator_invalidated) {
-            // Someone messed with the map while we were doing the callback.
-            // We need to start over. This means that we might call something twice but that's
-            // probably better than to drop the message.
-            it = _mavlink_handler_table.begin();
-            _iterator_invalidated = false;
-        } else {
-            ++it;
-        }
-    }
-    _mavlink_handler_table_mutex.unlock();
+    const bool forwarded = _mavlink_handler_table.dispatch(message);
+    UNUSED(forwarded);
 
 #if MESSAGE_DEBUGGING == 1
     if (!forwarded) {
@@ -184,16 +156,19 @@ void SystemImpl::process_mavlink_message(mavlink_message_t& message)
 void SystemImpl::add_call_every(std::function<void()> callback, float interval_s, void** cookie)
 {
     _call_every_handler.add(callback, interval_s, cookie);
+    wake_up_system_thread();
 }
 
 void SystemImpl::change_call_every(float interval_s, const void* cookie)
 {
     _call_every_handler.change(interval_s, cookie);
+    wake_up_system_thread();
 }
 
 void SystemImpl::reset_call_every(const void* cookie)
 {
     _call_every_handler.reset(cookie);
+    wake_up_system_thread();
 }
 
 void SystemImpl::remove_call_every(const void* cookie)
@@ -326,19 +301,43 @@ void SystemImpl::system_thread()
             last_time = _time.steady_time();
         }
 
+        {
+            // Anything queued from now on needs another pass.
+            std::lock_guard<std::mutex> lock(_system_thread_mutex);
+            _system_thread_woken_up = false;
+        }
+
         _call_every_handler.run_once();
         _timeout_handler.run_once();
         _params.do_work();
         _commands.do_work();
 
-        if (_connected) {
-            // Work fairly fast if we're connected.
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        } else {
-            // Be less aggressive when unconnected.
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // Sleep until the next heartbeat, call_every or timeout is due, or
+        // until someone queues new work.
+        dl_time_t next_deadline = last_time;
+        _time.shift_steady_time_by(next_deadline, SystemImpl::_HEARTBEAT_SEND_INTERVAL_S);
+
+        dl_time_t deadline{};
+        if (_call_every_handler.next_deadline(deadline) && deadline < next_deadline) {
+            next_deadline = deadline;
+        }
+        if (_timeout_handler.next_deadline(deadline) && deadline < next_deadline) {
+            next_deadline = deadline;
         }
+
+        std::unique_lock<std::mutex> lock(_system_thread_mutex);
+        _system_thread_cv.wait_until(
+            lock, next_deadline, [this]() { return _system_thread_woken_up || _should_exit; });
+    }
+}
+
+void SystemImpl::wake_up_system_thread()
+{
+    {
+        std::lock_guard<std::mutex> lock(_system_thread_mutex);
+        _system_thread_woken_up = true;
     }
+    _system_thread_cv.notify_one();
 }
 
 std::string SystemImpl::component_name(uint8_t component_id)
@@ -390,6 +389,17 @@ void SystemImpl::add_new_component(uint8_t component_id)
         return;
     }
 
+    // This is called for every incoming message, so check the bitmap first
+    // and only lock when a component shows up for the first time.
+    const uint64_t bit = uint64_t(1) << (component_id % 64);
+    auto& known_components = _known_components[component_id / 64];
+    if (known_components.load(std::memory_order_acquire) & bit) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> components_lock(_components_mutex);
+    known_components.fetch_or(bit, std::memory_order_release);
+
     auto res_pair = _components.insert(component_id);
     if (res_pair.second) {
         std::lock_guard<std::mutex> lock(_component_discovered_callback_mutex);
@@ -485,7 +495,7 @@ void SystemImpl::send_heartbeat()
     send_message(message);
 }
 
-bool SystemImpl::send_message(mavlink_message_t& message)
+bool SystemImpl::send_message(mavlink_message_t& message, SendQueue::sent_callback_t sent_callback)
 {
     // This is a low level interface where incoming messages can be tampered
     // with or even dropped.
@@ -496,6 +506,9 @@ bool SystemImpl::send_message(mavlink_message_t& message)
             // a potential loss would happen later and we would not be informed
             // about it.
             LogDebug() << "Dropped outgoing message: " << int(message.msgid);
+            if (sent_callback) {
+                sent_callback(true);
+            }
             return true;
         }
     }
@@ -503,7 +516,11 @@ bool SystemImpl::send_message(mavlink_message_t& message)
 #if MESSAGE_DEBUGGING == 1
     LogDebug() << "Sending msg " << size_t(message.msgid);
 #endif
-    return _parent.send_message(message);
+    if (!_parent.send_message(message, sent_callback)) {
+        return false;
+    }
+    _traffic_counters.add_message_sent(message, TrafficCounters::frame_len(message));
+    return true;
 }
 
 void SystemImpl::request_autopilot_version()
@@ -578,6 +595,9 @@ void SystemImpl::set_connected()
         // If not yet connected there is nothing to do/
     }
     if (enable_needed) {
+        // The system might have been rebooted and forgotten the rates.
+        _message_rates.resend();
+
         std::lock_guard<std::mutex> lock(_plugin_impls_mutex);
         for (auto plugin_impl : _plugin_impls) {
             plugin_impl->enable();
@@ -875,6 +895,24 @@ void SystemImpl::cancel_all_param(const void* cookie)
     _params.cancel_all_param(cookie);
 }
 
+std::pair<MAVLinkParameters::Result, std::map<std::string, MAVLinkParameters::ParamValue>>
+SystemImpl::get_all_params()
+{
+    return _params.get_all_params();
+}
+
+void SystemImpl::set_param_cache_directory(const std::string& path)
+{
+    _params.set_cache_directory(path);
+}
+
+std::map<std::string, MAVLinkParameters::Result> SystemImpl::set_params(
+    const std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>>& params,
+    unsigned window)
+{
+    return _params.set_params(params, window);
+}
+
 std::pair<MAVLinkCommands::Result, MAVLinkCommands::CommandLong>
 SystemImpl::make_command_flight_mode(FlightMode flight_mode, uint8_t component_id)
 {
@@ -1069,7 +1107,9 @@ MAVLinkCommands::Result SystemImpl::send_command(MAVLinkCommands::CommandInt& co
 }
 
 void SystemImpl::send_command_async(
-    MAVLinkCommands::CommandLong& command, const command_result_callback_t callback)
+    MAVLinkCommands::CommandLong& command,
+    const command_result_callback_t callback,
+    const MAVLinkCommands::command_progress_callback_t progress_callback)
 {
     if (_system_id == 0 && _components.size() == 0) {
         if (callback) {
@@ -1079,11 +1119,13 @@ void SystemImpl::send_command_async(
     }
     command.target_system_id = get_system_id();
 
-    _commands.queue_command_async(command, callback);
+    _commands.queue_command_async(command, callback, progress_callback);
 }
 
 void SystemImpl::send_command_async(
-    MAVLinkCommands::CommandInt& command, const command_result_callback_t callback)
+    MAVLinkCommands::CommandInt& command,
+    const command_result_callback_t callback,
+    const MAVLinkCommands::command_progress_callback_t progress_callback)
 {
     if (_system_id == 0 && _components.size() == 0) {
         if (callback) {
@@ -1093,7 +1135,7 @@ void SystemImpl::send_command_async(
     }
     command.target_system_id = get_system_id();
 
-    _commands.queue_command_async(command, callback);
+    _commands.queue_command_async(command, callback, progress_callback);
 }
 
 MAVLinkCommands::Result
@@ -1122,6 +1164,42 @@ void SystemImpl::set_msg_rate_async(
     }
 }
 
+MAVLinkCommands::Result SystemImpl::request_msg_rate(
+    uint16_t message_id, double rate_hz, const void* cookie, uint8_t component_id)
+{
+    auto prom = std::make_shared<std::promise<MAVLinkCommands::Result>>();
+    auto fut = prom->get_future();
+
+    request_msg_rate_async(
+        message_id,
+        rate_hz,
+        cookie,
+        [prom](MAVLinkCommands::Result result, float) { prom->set_value(result); },
+        component_id);
+
+    return fut.get();
+}
+
+void SystemImpl::request_msg_rate_async(
+    uint16_t message_id,
+    double rate_hz,
+    const void* cookie,
+    command_result_callback_t callback,
+    uint8_t component_id)
+{
+    _message_rates.request(message_id, rate_hz, cookie, callback, component_id);
+}
+
+void SystemImpl::release_msg_rates(const void* cookie)
+{
+    _message_rates.release(cookie);
+}
+
+std::vector<MessageRates::Rate> SystemImpl::get_msg_rates()
+{
+    return _message_rates.rates();
+}
+
 std::pair<MAVLinkCommands::Result, MAVLinkCommands::CommandLong>
 SystemImpl::make_command_msg_rate(uint16_t message_id, double rate_hz, uint8_t component_id)
 {
@@ -1179,11 +1257,6 @@ void SystemImpl::unregister_plugin(PluginImplBase* plugin_impl)
     }
 }
 
-void SystemImpl::call_user_callback(const std::function<void()>& func)
-{
-    _thread_pool.enqueue(func);
-}
-
 void SystemImpl::param_changed(const std::string& name)
 {
     std::lock_guard<std::mutex> lock(_param_changed_callbacks_mutex);
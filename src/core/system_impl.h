@@ -1,12 +1,18 @@
 #pragma once
 
 #include "global_include.h"
+#include "latency_tracer.h"
 #include "mavlink_include.h"
 #include "mavlink_parameters.h"
 #include "mavlink_commands.h"
+#include "mavlink_message_handler_table.h"
+#include "message_rates.h"
+#include "send_queue.h"
 #include "timeout_handler.h"
+#include "traffic_counters.h"
 #include "call_every_handler.h"
 #include "thread_pool.h"
+#include "strand.h"
 #include "system.h"
 #include <cstdint>
 #include <functional>
@@ -16,7 +22,9 @@
 #include <map>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <future>
+#include <utility>
 
 namespace mavsdk {
 
@@ -45,7 +53,7 @@ public:
 
     void process_mavlink_message(mavlink_message_t& message);
 
-    typedef std::function<void(const mavlink_message_t&)> mavlink_message_handler_t;
+    typedef MAVLinkMessageHandlerTable::callback_t mavlink_message_handler_t;
 
     void register_mavlink_message_handler(
         uint16_t msg_id, mavlink_message_handler_t callback, const void* cookie);
@@ -62,7 +70,11 @@ public:
     void reset_call_every(const void* cookie);
     void remove_call_every(const void* cookie);
 
-    bool send_message(mavlink_message_t& message);
+    // Only queues the message: false means it could not even be queued, e.g.
+    // because the queue of a connection is full. Whether it went out is
+    // reported to sent_callback later, see MavsdkImpl::send_message.
+    bool send_message(
+        mavlink_message_t& message, SendQueue::sent_callback_t sent_callback = nullptr);
 
     static FlightMode to_flight_mode_from_custom_mode(uint32_t custom_mode);
 
@@ -72,9 +84,13 @@ public:
     MAVLinkCommands::Result send_command(MAVLinkCommands::CommandInt& command);
 
     void send_command_async(
-        MAVLinkCommands::CommandLong& command, const command_result_callback_t callback);
+        MAVLinkCommands::CommandLong& command,
+        const command_result_callback_t callback,
+        const MAVLinkCommands::command_progress_callback_t progress_callback = nullptr);
     void send_command_async(
-        MAVLinkCommands::CommandInt& command, const command_result_callback_t callback);
+        MAVLinkCommands::CommandInt& command,
+        const command_result_callback_t callback,
+        const MAVLinkCommands::command_progress_callback_t progress_callback = nullptr);
 
     MAVLinkCommands::Result set_msg_rate(
         uint16_t message_id, double rate_hz, uint8_t component_id = MAV_COMP_ID_AUTOPILOT1);
@@ -85,6 +101,27 @@ public:
         command_result_callback_t callback,
         uint8_t component_id = MAV_COMP_ID_AUTOPILOT1);
 
+    // Requests a message rate on behalf of a consumer identified by cookie.
+    // The stream is set to the highest rate requested by any consumer, and
+    // rate_hz < 0 withdraws the request.
+    MAVLinkCommands::Result request_msg_rate(
+        uint16_t message_id,
+        double rate_hz,
+        const void* cookie,
+        uint8_t component_id = MAV_COMP_ID_AUTOPILOT1);
+
+    void request_msg_rate_async(
+        uint16_t message_id,
+        double rate_hz,
+        const void* cookie,
+        command_result_callback_t callback,
+        uint8_t component_id = MAV_COMP_ID_AUTOPILOT1);
+
+    // Withdraws all message rate requests of a consumer.
+    void release_msg_rates(const void* cookie);
+
+    std::vector<MessageRates::Rate> get_msg_rates();
+
     // Adds unique component ids
     void add_new_component(uint8_t component_id);
     size_t total_components() const;
@@ -101,6 +138,8 @@ public:
     bool has_gimbal() const;
 
     uint64_t get_uuid() const;
+
+    TrafficStats traffic_stats() const { return _traffic_counters.stats(); }
     uint8_t get_system_id() const;
 
     void set_system_id(uint8_t system_id);
@@ -182,6 +221,14 @@ public:
 
     void cancel_all_param(const void* cookie);
 
+    std::pair<MAVLinkParameters::Result, std::map<std::string, MAVLinkParameters::ParamValue>>
+    get_all_params();
+    void set_param_cache_directory(const std::string& path);
+
+    std::map<std::string, MAVLinkParameters::Result> set_params(
+        const std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>>& params,
+        unsigned window);
+
     void param_changed(const std::string& name);
 
     typedef std::function<void(const std::string& name)> param_changed_callback_t;
@@ -196,10 +243,35 @@ public:
     void register_plugin(PluginImplBase* plugin_impl);
     void unregister_plugin(PluginImplBase* plugin_impl);
 
-    void call_user_callback(const std::function<void()>& func);
+    // Calls func on one of the user callback threads. Callables which fit
+    // into a CallbackTask are queued without allocating.
+    template<typename F> void call_user_callback(F&& func)
+    {
+        if (LatencyTracer::is_dispatching()) {
+            _thread_pool.enqueue(LatencyTracer::Traced<F>(std::forward<F>(func)));
+            return;
+        }
+        _thread_pool.enqueue(std::forward<F>(func));
+    }
+
+    // Like above but runs func only after everything posted to the same
+    // strand before has finished, e.g. to keep the updates of a subscription
+    // in order.
+    template<typename F> void call_user_callback(Strand& strand, F&& func)
+    {
+        if (LatencyTracer::is_dispatching()) {
+            strand.post(_thread_pool, LatencyTracer::Traced<F>(std::forward<F>(func)));
+            return;
+        }
+        strand.post(_thread_pool, std::forward<F>(func));
+    }
 
     void send_autopilot_version_request();
 
+    // Makes the system thread do another pass right away, e.g. because a
+    // param or command has been queued.
+    void wake_up_system_thread();
+
     void intercept_incoming_messages(std::function<bool(mavlink_message_t&)> callback);
     void intercept_outgoing_messages(std::function<bool(mavlink_message_t&)> callback);
 
@@ -249,14 +321,7 @@ private:
     std::mutex _component_discovered_callback_mutex{};
     discover_callback_t _component_discovered_callback{nullptr};
 
-    struct MAVLinkHandlerTableEntry {
-        uint16_t msg_id;
-        mavlink_message_handler_t callback;
-        const void* cookie; // This is the identification to unregister.
-    };
-
-    std::mutex _mavlink_handler_table_mutex{};
-    std::vector<MAVLinkHandlerTableEntry> _mavlink_handler_table{};
+    MAVLinkMessageHandlerTable _mavlink_handler_table{};
 
     std::atomic<uint8_t> _system_id;
 
@@ -276,6 +341,9 @@ private:
 
     std::thread* _system_thread{nullptr};
     std::atomic<bool> _should_exit{false};
+    std::mutex _system_thread_mutex{};
+    std::condition_variable _system_thread_cv{};
+    bool _system_thread_woken_up{false};
 
     static constexpr double _HEARTBEAT_TIMEOUT_S = 3.0;
 
@@ -297,15 +365,20 @@ private:
 
     Time _time{};
 
+    MessageRates _message_rates;
+
+    TrafficCounters _traffic_counters{};
+
     std::mutex _plugin_impls_mutex{};
     std::vector<PluginImplBase*> _plugin_impls{};
 
     // We used set to maintain unique component ids
     std::unordered_set<uint8_t> _components{};
+    std::mutex _components_mutex{};
+    // One bit per component id that has been added to _components already.
+    std::atomic<uint64_t> _known_components[4]{};
 
-    ThreadPool _thread_pool{3};
-
-    bool _iterator_invalidated{false};
+    ThreadPool _thread_pool;
 
     std::mutex _param_changed_callbacks_mutex{};
     std::map<const void*, param_changed_callback_t> _param_changed_callbacks{};
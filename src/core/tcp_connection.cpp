@@ -11,6 +11,7 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#include <poll.h>
 #include <unistd.h> // for close()
 #endif
 
@@ -24,6 +25,34 @@
 
 namespace mavsdk {
 
+static void close_socket(int fd)
+{
+#ifndef WINDOWS
+    // This should interrupt a recv/recvfrom call.
+    shutdown(fd, SHUT_RDWR);
+
+    // But on Mac, closing is also needed to stop blocking recv/recvfrom.
+    close(fd);
+#else
+    shutdown(fd, SD_BOTH);
+
+    closesocket(fd);
+#endif
+}
+
+#ifndef WINDOWS
+// Whether a non-blocking call should just be tried again later.
+static bool should_retry(int error)
+{
+#if EWOULDBLOCK != EAGAIN
+    if (error == EWOULDBLOCK) {
+        return true;
+    }
+#endif
+    return error == EAGAIN || error == EINTR;
+}
+#endif
+
 /* change to remote_ip and remote_port */
 TcpConnection::TcpConnection(
     Connection::receiver_callback_t receiver_callback,
@@ -43,16 +72,23 @@ TcpConnection::~TcpConnection()
 
 ConnectionResult TcpConnection::start()
 {
-    if (!start_mavlink_receiver()) {
-        return ConnectionResult::CONNECTIONS_EXHAUSTED;
-    }
+    start_mavlink_receiver();
 
     ConnectionResult ret = setup_port();
     if (ret != ConnectionResult::SUCCESS) {
         return ret;
     }
 
-    start_recv_thread();
+    if (_io_reactor) {
+        if (!IoReactor::set_non_blocking(_socket_fd) ||
+            !_io_reactor->add(_socket_fd, std::bind(&TcpConnection::receive_available, this))) {
+            return ConnectionResult::SOCKET_ERROR;
+        }
+    } else {
+        start_recv_thread();
+    }
+
+    start_send_queue();
 
     return ConnectionResult::SUCCESS;
 }
@@ -68,9 +104,9 @@ ConnectionResult TcpConnection::setup_port()
     }
 #endif
 
-    _socket_fd = socket(AF_INET, SOCK_STREAM, 0);
+    const int socket_fd = socket(AF_INET, SOCK_STREAM, 0);
 
-    if (_socket_fd < 0) {
+    if (socket_fd < 0) {
         LogErr() << "socket error" << GET_ERROR(errno);
         _is_ok = false;
         return ConnectionResult::SOCKET_ERROR;
@@ -81,19 +117,33 @@ ConnectionResult TcpConnection::setup_port()
     remote_addr.sin_port = htons(_remote_port_number);
     remote_addr.sin_addr.s_addr = inet_addr(_remote_ip.c_str());
 
-    if (connect(_socket_fd, reinterpret_cast<sockaddr*>(&remote_addr), sizeof(struct sockaddr_in)) <
+    if (connect(socket_fd, reinterpret_cast<sockaddr*>(&remote_addr), sizeof(struct sockaddr_in)) <
         0) {
         LogErr() << "connect error: " << GET_ERROR(errno);
+        close_socket(socket_fd);
         _is_ok = false;
         return ConnectionResult::SOCKET_CONNECTION_ERROR;
     }
 
+    // The send queue might be writing to the old socket right now, and
+    // stop() must not miss a socket which was connected in the meantime.
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_should_exit) {
+        close_socket(socket_fd);
+        return ConnectionResult::SOCKET_CONNECTION_ERROR;
+    }
+    if (_socket_fd >= 0) {
+        close_socket(_socket_fd);
+    }
+    _socket_fd = socket_fd;
+
     _is_ok = true;
     return ConnectionResult::SUCCESS;
 }
 
 void TcpConnection::start_recv_thread()
 {
+    std::lock_guard<std::mutex> lock(_recv_thread_mutex);
     _recv_thread = new std::thread(&TcpConnection::receive, this);
 }
 
@@ -101,25 +151,45 @@ ConnectionResult TcpConnection::stop()
 {
     _should_exit = true;
 
-#ifndef WINDOWS
-    // This should interrupt a recv/recvfrom call.
-    shutdown(_socket_fd, SHUT_RDWR);
+    stop_send_queue();
 
-    // But on Mac, closing is also needed to stop blocking recv/recvfrom.
-    close(_socket_fd);
-#else
-    shutdown(_socket_fd, SD_BOTH);
+    // With _should_exit set, a reconnect thread can't add or replace the
+    // socket anymore once it has let go of _mutex.
+    int socket_fd;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        socket_fd = _socket_fd;
+    }
+
+    // Once removed, the reactor won't call us anymore. This waits for a
+    // callback which is still running and might be sending a reply, so it
+    // must not be done with _mutex held.
+    if (_io_reactor && socket_fd >= 0) {
+        _io_reactor->remove(socket_fd);
+    }
 
-    closesocket(_socket_fd);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_socket_fd >= 0) {
+            close_socket(_socket_fd);
+            _socket_fd = -1;
+        }
+    }
 
+#ifdef WINDOWS
     WSACleanup();
 #endif
 
-    if (_recv_thread) {
-        _recv_thread->join();
-        delete _recv_thread;
+    std::thread* recv_thread;
+    {
+        std::lock_guard<std::mutex> lock(_recv_thread_mutex);
+        recv_thread = _recv_thread;
         _recv_thread = nullptr;
     }
+    if (recv_thread) {
+        recv_thread->join();
+        delete recv_thread;
+    }
 
     // We need to stop this after stopping the receive thread, otherwise
     // it can happen that we interfere with the parsing of a message.
@@ -129,6 +199,18 @@ ConnectionResult TcpConnection::stop()
 }
 
 bool TcpConnection::send_message(const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    // TODO: remove this assert again
+    assert(buffer_len <= MAVLINK_MAX_PACKET_LEN);
+
+    return send_frame(message, buffer, buffer_len);
+}
+
+bool TcpConnection::send_frame(
+    const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len)
 {
     if (_remote_ip.empty()) {
         LogErr() << "Remote IP unknown";
@@ -147,25 +229,53 @@ bool TcpConnection::send_message(const mavlink_message_t& message)
 
     dest_addr.sin_port = htons(_remote_port_number);
 
-    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
-
-    // TODO: remove this assert again
-    assert(buffer_len <= MAVLINK_MAX_PACKET_LEN);
-
-    const auto send_len = sendto(
-        _socket_fd,
-        reinterpret_cast<char*>(buffer),
-        buffer_len,
-        0,
-        reinterpret_cast<const sockaddr*>(&dest_addr),
-        sizeof(dest_addr));
+    // A reconnect must not swap the socket while we are writing to it.
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    unsigned send_len = 0;
+    while (send_len < frame_len) {
+        const auto ret = sendto(
+            _socket_fd,
+            reinterpret_cast<const char*>(frame + send_len),
+            frame_len - send_len,
+            0,
+            reinterpret_cast<const sockaddr*>(&dest_addr),
+            sizeof(dest_addr));
+
+        if (ret > 0) {
+            send_len += static_cast<unsigned>(ret);
+            continue;
+        }
+#ifndef WINDOWS
+        // The socket is non-blocking with the I/O reactor. Leaving half a
+        // frame on the stream would corrupt it, so wait for room instead.
+        if (ret < 0 && should_retry(errno)) {
+            pollfd fds[1] = {{_socket_fd, POLLOUT, 0}};
+            if (poll(fds, 1, 100) <= 0 && _should_exit) {
+                break;
+            }
+            continue;
+        }
+#endif
+        break;
+    }
 
-    if (send_len != buffer_len) {
+    if (send_len != frame_len) {
         LogErr() << "sendto failure: " << GET_ERROR(errno);
+        if (!_should_exit) {
+            // The stream is broken now. Shutting it down wakes up the receive
+            // side, which takes care of reconnecting.
+#ifndef WINDOWS
+            shutdown(_socket_fd, SHUT_RDWR);
+#else
+            shutdown(_socket_fd, SD_BOTH);
+#endif
+        }
         _is_ok = false;
         return false;
     }
+
+    _traffic_counters.add_message_sent(message, frame_len);
     return true;
 }
 
@@ -199,12 +309,82 @@ void TcpConnection::receive()
             continue;
         }
 
-        _mavlink_receiver->set_new_datagram(buffer, static_cast<int>(recv_len));
+        process_data(buffer, static_cast<unsigned>(recv_len));
+    }
+}
+
+void TcpConnection::receive_available()
+{
+    // Enough for MTU 1500 bytes.
+    char buffer[2048];
+
+    // We are called by the I/O reactor, so drain the socket without blocking.
+    while (!_should_exit) {
+        const auto recv_len = recv(_socket_fd, buffer, sizeof(buffer), 0);
+
+#ifndef WINDOWS
+        if (recv_len < 0 && should_retry(errno)) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // All read, wait to be called again.
+            return;
+        }
+#endif
+
+        if (recv_len <= 0) {
+            // The connection is gone. We can't block the reactor while we try
+            // to reconnect, so we hand that off to a thread until we're back.
+            _io_reactor->remove(_socket_fd);
+            _is_ok = false;
 
-        // Parse all mavlink messages in one data packet. Once exhausted, we'll exit while.
-        while (_mavlink_receiver->parse_message()) {
-            receive_message(_mavlink_receiver->get_last_message());
+            // Once _should_exit is set, stop() joins whatever thread it finds,
+            // so no new one must be started after that.
+            std::lock_guard<std::mutex> lock(_recv_thread_mutex);
+            if (_should_exit) {
+                return;
+            }
+            if (_recv_thread) {
+                // The previous reconnect thread is done since it added us again.
+                _recv_thread->join();
+                delete _recv_thread;
+            }
+            _recv_thread = new std::thread(&TcpConnection::reconnect, this);
+            return;
         }
+
+        process_data(buffer, static_cast<unsigned>(recv_len));
+    }
+}
+
+void TcpConnection::reconnect()
+{
+    while (!_should_exit && !_is_ok) {
+        LogErr() << "TCP receive error, trying to reconnect...";
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        // This replaces the broken socket once connected again.
+        setup_port();
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_should_exit) {
+        return;
+    }
+
+    if (!IoReactor::set_non_blocking(_socket_fd) ||
+        !_io_reactor->add(_socket_fd, std::bind(&TcpConnection::receive_available, this))) {
+        LogErr() << "Could not add reconnected TCP socket to I/O reactor";
+    }
+}
+
+void TcpConnection::process_data(char* buffer, unsigned buffer_len)
+{
+    LatencyTracer::stamp_receive_time();
+    _mavlink_receiver->set_new_datagram(buffer, buffer_len);
+
+    // Parse all mavlink messages in one data packet. Once exhausted, we'll exit while.
+    while (_mavlink_receiver->parse_message()) {
+        receive_message(*_mavlink_receiver);
     }
 }
 
@@ -26,6 +26,7 @@ public:
     ConnectionResult stop();
 
     bool send_message(const mavlink_message_t& message);
+    bool send_frame(const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len);
 
     // Non-copyable
     TcpConnection(const TcpConnection&) = delete;
@@ -36,13 +37,20 @@ private:
     void start_recv_thread();
     int resolve_address(const std::string& ip_address, int port, struct sockaddr_in* addr);
     void receive();
+    void receive_available();
+    void reconnect();
+    void process_data(char* buffer, unsigned buffer_len);
 
     std::string _remote_ip = {};
     int _remote_port_number;
 
+    // Held while the socket is written to, replaced or closed.
     std::mutex _mutex = {};
-    int _socket_fd = -1;
+    std::atomic<int> _socket_fd{-1};
 
+    // Held while the receive or reconnect thread is started, joined or
+    // replaced, which happens on the reactor thread as well.
+    std::mutex _recv_thread_mutex = {};
     std::thread* _recv_thread = nullptr;
     std::atomic_bool _should_exit;
     std::atomic_bool _is_ok{false};
@@ -0,0 +1,463 @@
+#include "tcp_server_connection.h"
+#include "global_include.h"
+#include "log.h"
+
+#ifndef WINDOWS
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <utility>
+
+#define GET_ERROR(_x) strerror(_x)
+
+namespace mavsdk {
+
+namespace {
+
+#ifndef WINDOWS
+// Without it, writing to a client which went away would raise SIGPIPE.
+#if defined(MSG_NOSIGNAL)
+const int send_flags = MSG_NOSIGNAL;
+#else
+const int send_flags = 0;
+#endif
+
+// Upper limit of messages written per syscall.
+const size_t max_iovecs = 64;
+
+bool set_non_blocking(int fd)
+{
+    const int flags = fcntl(fd, F_GETFL, 0);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+#endif
+
+} // namespace
+
+TcpServerConnection::TcpServerConnection(
+    Connection::receiver_callback_t receiver_callback,
+    const std::string& local_ip,
+    int local_port,
+    size_t max_buffered_bytes) :
+    Connection(receiver_callback),
+    _local_ip(local_ip),
+    _local_port_number(local_port),
+    _max_buffered_bytes(max_buffered_bytes)
+{}
+
+TcpServerConnection::~TcpServerConnection()
+{
+    // If no one explicitly called stop before, we should at least do it.
+    stop();
+}
+
+ConnectionResult TcpServerConnection::start()
+{
+#ifndef WINDOWS
+    ConnectionResult ret = setup_port();
+    if (ret != ConnectionResult::SUCCESS) {
+        return ret;
+    }
+
+    _should_exit = false;
+    _server_thread = new std::thread(&TcpServerConnection::run, this);
+
+    start_send_queue();
+
+    return ConnectionResult::SUCCESS;
+#else
+    return ConnectionResult::NOT_IMPLEMENTED;
+#endif
+}
+
+ConnectionResult TcpServerConnection::setup_port()
+{
+#ifndef WINDOWS
+    if (pipe(_wakeup_fds) != 0 || !set_non_blocking(_wakeup_fds[0]) ||
+        !set_non_blocking(_wakeup_fds[1])) {
+        LogErr() << "pipe error: " << GET_ERROR(errno);
+        return ConnectionResult::SOCKET_ERROR;
+    }
+
+    _listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_listen_fd < 0) {
+        LogErr() << "socket error: " << GET_ERROR(errno);
+        return ConnectionResult::SOCKET_ERROR;
+    }
+
+    // Otherwise a restart has to wait until the old clients' sockets are gone.
+    const int reuse = 1;
+    setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    inet_pton(AF_INET, _local_ip.c_str(), &(addr.sin_addr));
+    addr.sin_port = htons(_local_port_number);
+
+    if (bind(_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        LogErr() << "bind error: " << GET_ERROR(errno);
+        return ConnectionResult::BIND_ERROR;
+    }
+
+    if (listen(_listen_fd, 16) != 0 || !set_non_blocking(_listen_fd)) {
+        LogErr() << "listen error: " << GET_ERROR(errno);
+        return ConnectionResult::SOCKET_ERROR;
+    }
+
+    if (_local_port_number == 0) {
+        // Find out which port we were given.
+        socklen_t addr_len = sizeof(addr);
+        if (getsockname(_listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) != 0) {
+            LogErr() << "getsockname error: " << GET_ERROR(errno);
+            return ConnectionResult::BIND_ERROR;
+        }
+        _local_port_number = ntohs(addr.sin_port);
+    }
+
+    return ConnectionResult::SUCCESS;
+#else
+    return ConnectionResult::NOT_IMPLEMENTED;
+#endif
+}
+
+ConnectionResult TcpServerConnection::stop()
+{
+#ifndef WINDOWS
+    _should_exit = true;
+
+    stop_send_queue();
+
+    if (_server_thread) {
+        wake_up();
+        _server_thread->join();
+        delete _server_thread;
+        _server_thread = nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_clients_mutex);
+        for (auto& client : _clients) {
+            close(client.first);
+        }
+        _clients.clear();
+    }
+
+    for (int* fd : {&_listen_fd, &_wakeup_fds[0], &_wakeup_fds[1]}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+#endif
+
+    return ConnectionResult::SUCCESS;
+}
+
+bool TcpServerConnection::send_message(const mavlink_message_t& message)
+{
+#ifndef WINDOWS
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    return send_frame(message, buffer, buffer_len);
+#else
+    UNUSED(message);
+    return false;
+#endif
+}
+
+bool TcpServerConnection::send_frame(
+    const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len)
+{
+#ifndef WINDOWS
+    const packet_t packet = std::make_shared<const std::vector<uint8_t>>(frame, frame + frame_len);
+
+    bool queued = false;
+    bool needs_wakeup = false;
+    {
+        std::lock_guard<std::mutex> lock(_clients_mutex);
+
+        for (auto& it : _clients) {
+            Client& client = *it.second;
+            if (client.closed) {
+                continue;
+            }
+            if (client.bytes_buffered + packet->size() > _max_buffered_bytes) {
+                ++client.messages_dropped;
+                continue;
+            }
+
+            const bool was_idle = client.output.empty();
+            client.output.push_back(packet);
+            client.bytes_buffered += packet->size();
+            queued = true;
+            _traffic_counters.add_bytes_sent(frame_len);
+
+            // If nothing was waiting, the socket most likely takes it right
+            // away and we don't need to go through the server thread.
+            if (was_idle) {
+                flush(client);
+            }
+            if (!client.output.empty() || client.closed) {
+                needs_wakeup = true;
+            }
+        }
+    }
+
+    if (needs_wakeup) {
+        wake_up();
+    }
+
+    // One message, however many clients it went to.
+    if (queued) {
+        _traffic_counters.add_message_sent(message, 0);
+    }
+
+    // Without any client, there is no one to send to.
+    return queued;
+#else
+    UNUSED(message);
+    UNUSED(frame);
+    UNUSED(frame_len);
+    return false;
+#endif
+}
+
+std::vector<TcpServerConnection::ClientStats> TcpServerConnection::client_stats() const
+{
+    std::lock_guard<std::mutex> lock(_clients_mutex);
+
+    std::vector<ClientStats> result;
+    for (const auto& it : _clients) {
+        const Client& client = *it.second;
+        ClientStats stats;
+        stats.address = client.address;
+        stats.bytes_buffered = client.bytes_buffered;
+        stats.bytes_sent = client.bytes_sent;
+        stats.bytes_received = client.bytes_received;
+        stats.messages_dropped = client.messages_dropped;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+void TcpServerConnection::run()
+{
+#ifndef WINDOWS
+    std::vector<pollfd> fds;
+
+    while (!_should_exit) {
+        fds.clear();
+        fds.push_back(pollfd{_wakeup_fds[0], POLLIN, 0});
+        fds.push_back(pollfd{_listen_fd, POLLIN, 0});
+        {
+            std::lock_guard<std::mutex> lock(_clients_mutex);
+            for (const auto& it : _clients) {
+                const short events = it.second->output.empty() ? POLLIN : (POLLIN | POLLOUT);
+                fds.push_back(pollfd{it.first, events, 0});
+            }
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno != EINTR) {
+                LogErr() << "poll error: " << GET_ERROR(errno);
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char dummy[64];
+            while (read(_wakeup_fds[0], dummy, sizeof(dummy)) > 0) {}
+        }
+
+        if (fds[1].revents & POLLIN) {
+            accept_clients();
+        }
+
+        for (size_t i = 2; i < fds.size(); ++i) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            Client& client = *_clients.at(fds[i].fd);
+
+            if (fds[i].revents & POLLOUT) {
+                std::lock_guard<std::mutex> lock(_clients_mutex);
+                flush(client);
+            }
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                receive_from(client);
+            }
+        }
+
+        remove_closed_clients();
+    }
+#endif
+}
+
+void TcpServerConnection::accept_clients()
+{
+#ifndef WINDOWS
+    while (true) {
+        struct sockaddr_in addr {};
+        socklen_t addr_len = sizeof(addr);
+        const int fd = accept(_listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EINTR) {
+                LogErr() << "accept error: " << GET_ERROR(errno);
+            }
+            return;
+        }
+
+        if (!set_non_blocking(fd)) {
+            LogErr() << "Could not make client socket non-blocking: " << GET_ERROR(errno);
+            close(fd);
+            continue;
+        }
+
+        // Messages are small and latency matters more than packing them.
+        const int no_delay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+#if defined(SO_NOSIGPIPE)
+        const int no_sigpipe = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+
+        std::unique_ptr<Client> client(new Client());
+        client->fd = fd;
+        client->receiver.set_traffic_counters(&_traffic_counters);
+        char ip[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+        client->address = std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
+
+        LogInfo() << "New TCP client " << client->address;
+
+        std::lock_guard<std::mutex> lock(_clients_mutex);
+        _clients[fd] = std::move(client);
+    }
+#endif
+}
+
+void TcpServerConnection::receive_from(Client& client)
+{
+#ifndef WINDOWS
+    // Enough for MTU 1500 bytes.
+    char buffer[2048];
+
+    // Limited so that a client sending a lot can't starve the others.
+    for (unsigned i = 0; i < 16 && !_should_exit; ++i) {
+        const auto recv_len = recv(client.fd, buffer, sizeof(buffer), 0);
+
+        if (recv_len < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return;
+        }
+
+        if (recv_len <= 0) {
+            LogInfo() << "TCP client " << client.address << " disconnected";
+            std::lock_guard<std::mutex> lock(_clients_mutex);
+            client.closed = true;
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_clients_mutex);
+            client.bytes_received += static_cast<uint64_t>(recv_len);
+        }
+
+        LatencyTracer::stamp_receive_time();
+        client.receiver.set_new_datagram(buffer, static_cast<unsigned>(recv_len));
+        while (client.receiver.parse_message()) {
+            receive_message(client.receiver);
+        }
+    }
+#else
+    UNUSED(client);
+#endif
+}
+
+void TcpServerConnection::flush(Client& client)
+{
+#ifndef WINDOWS
+    // Called with _clients_mutex held.
+    while (!client.output.empty() && !client.closed) {
+        struct iovec iovecs[max_iovecs];
+        size_t num_iovecs = 0;
+        for (auto it = client.output.begin();
+             it != client.output.end() && num_iovecs < max_iovecs;
+             ++it, ++num_iovecs) {
+            const size_t offset = (num_iovecs == 0) ? client.output_offset : 0;
+            iovecs[num_iovecs].iov_base = const_cast<uint8_t*>((*it)->data()) + offset;
+            iovecs[num_iovecs].iov_len = (*it)->size() - offset;
+        }
+
+        // Like writev, but with flags.
+        struct msghdr header {};
+        header.msg_iov = iovecs;
+        header.msg_iovlen = num_iovecs;
+        const auto sent = sendmsg(client.fd, &header, send_flags);
+
+        if (sent < 0) {
+            if (errno != EAGAIN && errno != EINTR) {
+                LogWarn() << "Sending to TCP client " << client.address
+                          << " failed: " << GET_ERROR(errno);
+                client.closed = true;
+            }
+            return;
+        }
+
+        client.bytes_sent += static_cast<uint64_t>(sent);
+        client.bytes_buffered -= static_cast<size_t>(sent);
+
+        size_t remaining = static_cast<size_t>(sent);
+        while (remaining > 0) {
+            const size_t left_in_front = client.output.front()->size() - client.output_offset;
+            if (remaining < left_in_front) {
+                client.output_offset += remaining;
+                // The socket is full, wait for POLLOUT.
+                return;
+            }
+            remaining -= left_in_front;
+            client.output.pop_front();
+            client.output_offset = 0;
+        }
+    }
+#else
+    UNUSED(client);
+#endif
+}
+
+void TcpServerConnection::remove_closed_clients()
+{
+#ifndef WINDOWS
+    std::lock_guard<std::mutex> lock(_clients_mutex);
+    for (auto it = _clients.begin(); it != _clients.end(); /* manual */) {
+        if (it->second->closed) {
+            close(it->first);
+            it = _clients.erase(it);
+        } else {
+            ++it;
+        }
+    }
+#endif
+}
+
+void TcpServerConnection::wake_up()
+{
+#ifndef WINDOWS
+    const char dummy = 0;
+    // If the pipe is full, the server thread is going to wake up anyway.
+    const auto ret = write(_wakeup_fds[1], &dummy, 1);
+    UNUSED(ret);
+#endif
+}
+
+} // namespace mavsdk
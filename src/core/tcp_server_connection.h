@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "connection.h"
+
+namespace mavsdk {
+
+// Listens on a TCP port and talks MAVLink to every client that connects, e.g.
+// several ground stations behind one companion computer.
+//
+// Accepting, receiving and sending for all clients is done by one thread
+// polling all sockets. Outgoing messages are serialized once and appended to
+// the output buffer of each client. Whatever a client's socket doesn't take
+// right away is written with the next POLLOUT, several messages per syscall,
+// so a slow client only fills up its own buffer. Once that is full, further
+// messages to this client are dropped until it has caught up.
+//
+// The server uses its own thread even if an I/O reactor is set, as it needs
+// to wait for sockets to become writable as well. Not available on Windows.
+class TcpServerConnection : public Connection {
+public:
+    explicit TcpServerConnection(
+        Connection::receiver_callback_t receiver_callback,
+        const std::string& local_ip,
+        int local_port,
+        size_t max_buffered_bytes = 256 * 1024);
+    ~TcpServerConnection();
+    ConnectionResult start();
+    ConnectionResult stop();
+
+    bool send_message(const mavlink_message_t& message);
+    bool send_frame(const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len);
+
+    // The port listened on, also when 0 was given to let the system pick one.
+    int local_port() const { return _local_port_number; }
+
+    struct ClientStats {
+        std::string address{};
+        size_t bytes_buffered{0};
+        uint64_t bytes_sent{0};
+        uint64_t bytes_received{0};
+        uint64_t messages_dropped{0};
+    };
+
+    std::vector<ClientStats> client_stats() const;
+
+    // Non-copyable
+    TcpServerConnection(const TcpServerConnection&) = delete;
+    const TcpServerConnection& operator=(const TcpServerConnection&) = delete;
+
+private:
+    typedef std::shared_ptr<const std::vector<uint8_t>> packet_t;
+
+    struct Client {
+        int fd{-1};
+        std::string address{};
+        // Only used by the server thread.
+        MAVLinkReceiver receiver{};
+
+        // Guarded by _clients_mutex.
+        std::deque<packet_t> output{};
+        size_t output_offset{0};
+        size_t bytes_buffered{0};
+        uint64_t bytes_sent{0};
+        uint64_t bytes_received{0};
+        uint64_t messages_dropped{0};
+        bool closed{false};
+    };
+
+    ConnectionResult setup_port();
+    void run();
+    void accept_clients();
+    void receive_from(Client& client);
+    void flush(Client& client);
+    void remove_closed_clients();
+    void wake_up();
+
+    std::string _local_ip;
+    int _local_port_number;
+    const size_t _max_buffered_bytes;
+
+    // Clients are added and removed by the server thread only, so it can
+    // read the map without taking the mutex.
+    mutable std::mutex _clients_mutex{};
+    std::map<int, std::unique_ptr<Client>> _clients{};
+
+    int _listen_fd{-1};
+    // Written to when the server thread needs to pick up new output.
+    int _wakeup_fds[2]{-1, -1};
+
+    std::thread* _server_thread{nullptr};
+    std::atomic_bool _should_exit{false};
+};
+
+} // namespace mavsdk
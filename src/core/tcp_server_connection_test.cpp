@@ -0,0 +1,180 @@
+#include "tcp_server_connection.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#if defined(LINUX)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace mavsdk;
+
+namespace {
+
+int connect_client(int port, int receive_buffer_size = 0)
+{
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (receive_buffer_size > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer_size, sizeof(receive_buffer_size));
+    }
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    addr.sin_port = htons(port);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool wait_for_clients(const TcpServerConnection& connection, size_t num_clients)
+{
+    for (unsigned i = 0; i < 100; ++i) {
+        if (connection.client_stats().size() == num_clients) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+size_t read_bytes(int fd, size_t num_bytes, int timeout_ms = 1000)
+{
+    size_t num_read = 0;
+    while (num_read < num_bytes) {
+        pollfd fds[1] = {{fd, POLLIN, 0}};
+        if (poll(fds, 1, timeout_ms) <= 0) {
+            break;
+        }
+        char buffer[4096];
+        const auto len = recv(fd, buffer, sizeof(buffer), 0);
+        if (len <= 0) {
+            break;
+        }
+        num_read += static_cast<size_t>(len);
+    }
+    return num_read;
+}
+
+mavlink_message_t heartbeat(uint8_t system_id)
+{
+    mavlink_message_t message{};
+    mavlink_msg_heartbeat_pack(system_id, 1, &message, 0, 0, 0, 0, 0);
+    return message;
+}
+
+size_t wire_length(const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    return mavlink_msg_to_send_buffer(buffer, &message);
+}
+
+} // namespace
+
+TEST(TcpServerConnection, TalksToSeveralClients)
+{
+    std::atomic<unsigned> num_received{0};
+    TcpServerConnection connection(
+        [&num_received](mavlink_message_t&) { ++num_received; }, "127.0.0.1", 0);
+    ASSERT_EQ(connection.start(), ConnectionResult::SUCCESS);
+    ASSERT_GT(connection.local_port(), 0);
+
+    // Nobody to send to yet.
+    EXPECT_FALSE(connection.send_message(heartbeat(1)));
+
+    std::vector<int> fds;
+    for (unsigned i = 0; i < 3; ++i) {
+        fds.push_back(connect_client(connection.local_port()));
+        ASSERT_GE(fds.back(), 0);
+    }
+    ASSERT_TRUE(wait_for_clients(connection, 3));
+
+    const auto message = heartbeat(1);
+    EXPECT_TRUE(connection.send_message(message));
+    for (const int fd : fds) {
+        EXPECT_EQ(read_bytes(fd, wire_length(message)), wire_length(message));
+    }
+
+    // One message sent, but the bytes of every copy.
+    const auto traffic = connection.traffic_stats();
+    EXPECT_EQ(traffic.messages_sent, 1u);
+    EXPECT_EQ(traffic.bytes_sent, 3 * wire_length(message));
+
+    // Every client is parsed on its own, so interleaved writes don't mix.
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const auto len = mavlink_msg_to_send_buffer(buffer, &message);
+    for (const int fd : fds) {
+        EXPECT_EQ(send(fd, buffer, 5, 0), 5);
+    }
+    for (const int fd : fds) {
+        EXPECT_EQ(send(fd, buffer + 5, len - 5, 0), len - 5);
+    }
+    for (unsigned i = 0; i < 100 && num_received < 3; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(num_received, 3u);
+
+    for (const int fd : fds) {
+        close(fd);
+    }
+    EXPECT_TRUE(wait_for_clients(connection, 0));
+
+    connection.stop();
+}
+
+TEST(TcpServerConnection, SlowClientDoesNotStallOthers)
+{
+    TcpServerConnection connection([](mavlink_message_t&) {}, "127.0.0.1", 0, 4096);
+    ASSERT_EQ(connection.start(), ConnectionResult::SUCCESS);
+
+    // This one never reads.
+    const int slow_fd = connect_client(connection.local_port(), 4096);
+    const int fast_fd = connect_client(connection.local_port());
+    ASSERT_GE(slow_fd, 0);
+    ASSERT_GE(fast_fd, 0);
+    ASSERT_TRUE(wait_for_clients(connection, 2));
+
+    const auto message = heartbeat(1);
+    const unsigned num_messages = 200000;
+    const size_t expected_bytes = num_messages * wire_length(message);
+
+    size_t fast_bytes = 0;
+    std::thread reader([&]() { fast_bytes = read_bytes(fast_fd, expected_bytes); });
+
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < num_messages; ++i) {
+        connection.send_message(message);
+        if (i % 100 == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    reader.join();
+
+    // Sending never blocked on the slow client.
+    EXPECT_LT(elapsed_s, 5.0);
+    EXPECT_EQ(fast_bytes, expected_bytes);
+
+    uint64_t slow_dropped = 0;
+    uint64_t fast_dropped = 0;
+    for (const auto& stats : connection.client_stats()) {
+        EXPECT_LE(stats.bytes_buffered, 4096u);
+        (stats.bytes_sent == expected_bytes ? fast_dropped : slow_dropped) +=
+            stats.messages_dropped;
+    }
+    EXPECT_GT(slow_dropped, 0u);
+    EXPECT_EQ(fast_dropped, 0u);
+
+    close(slow_fd);
+    close(fast_fd);
+    connection.stop();
+}
+
+#endif
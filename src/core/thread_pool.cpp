@@ -2,7 +2,28 @@
 
 namespace mavsdk {
 
-ThreadPool::ThreadPool(unsigned num_threads) : _num_threads(num_threads) {}
+namespace {
+
+size_t round_up_to_power_of_two(size_t value)
+{
+    size_t result = 2;
+    while (result < value) {
+        result *= 2;
+    }
+    return result;
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned num_threads, size_t queue_size) :
+    _num_threads(num_threads),
+    _mask(round_up_to_power_of_two(queue_size) - 1),
+    _slots(new Slot[_mask + 1])
+{
+    for (size_t i = 0; i <= _mask; ++i) {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
 
 ThreadPool::~ThreadPool()
 {
@@ -23,8 +44,12 @@ bool ThreadPool::start()
 
 bool ThreadPool::stop()
 {
-    _work_queue.stop();
-    _should_stop = true;
+    {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _should_stop = true;
+    }
+    _wake_up_cv.notify_all();
+
     for (auto it = _threads.begin(); it != _threads.end(); /* ++it */) {
         it->get()->join();
         it = _threads.erase(it);
@@ -32,18 +57,111 @@ bool ThreadPool::stop()
     return true;
 }
 
-void ThreadPool::enqueue(std::function<void()> func)
+ThreadPool::Slot* ThreadPool::claim_slot(size_t& pos)
+{
+    pos = _enqueue_pos.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = _slots[pos & _mask];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                return &slot;
+            }
+        } else if (diff < 0) {
+            // Full, the slot has not been read since the last round.
+            return nullptr;
+        } else {
+            pos = _enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool ThreadPool::try_dequeue(CallbackTask& task)
+{
+    size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = _slots[pos & _mask];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                // Move the task out to free the slot before it runs.
+                task = std::move(slot.task);
+                slot.sequence.store(pos + _mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            break;
+        } else {
+            pos = _dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    if (_overflow_size.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    // A slot which was claimed but is not written yet may be followed by
+    // tasks enqueued before the overflowing ones, so wait for it first.
+    if (pos != _enqueue_pos.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_overflow_mutex);
+    if (_overflow.empty()) {
+        return false;
+    }
+    task = std::move(_overflow.front());
+    _overflow.pop_front();
+    _overflow_size.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+bool ThreadPool::has_work() const
 {
-    _work_queue.enqueue(std::move(func));
+    const size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+    const size_t sequence = _slots[pos & _mask].sequence.load(std::memory_order_acquire);
+    return sequence == pos + 1 || _overflow_size.load(std::memory_order_acquire) > 0;
+}
+
+void ThreadPool::enqueue_overflow(CallbackTask&& task)
+{
+    std::lock_guard<std::mutex> lock(_overflow_mutex);
+    _overflow.push_back(std::move(task));
+    _overflow_size.fetch_add(1, std::memory_order_release);
+    ++_num_overflowed;
+}
+
+void ThreadPool::wake_up_worker()
+{
+    // Pairs with the fence in worker(): either the worker sees the new task
+    // before going to sleep or we see that it is (about to be) sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_num_sleeping.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    { std::lock_guard<std::mutex> lock(_sleep_mutex); }
+    _wake_up_cv.notify_one();
 }
 
 void ThreadPool::worker()
 {
+    CallbackTask task;
+
     while (!_should_stop) {
-        auto func = _work_queue.dequeue();
-        if (func) {
-            func();
+        if (try_dequeue(task)) {
+            task();
+            task.reset();
+            continue;
         }
+
+        std::unique_lock<std::mutex> lock(_sleep_mutex);
+        _num_sleeping.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        _wake_up_cv.wait(lock, [this]() { return _should_stop || has_work(); });
+        _num_sleeping.fetch_sub(1, std::memory_order_relaxed);
     }
 }
 
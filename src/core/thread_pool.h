@@ -1,19 +1,34 @@
 #pragma once
 
 #include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <vector>
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <utility>
+#include "callback_task.h"
 #include "global_include.h"
-#include "safe_queue.h"
 
 namespace mavsdk {
 
+// Runs tasks on a fixed number of worker threads.
+//
+// Tasks are stored in place in a bounded multi-producer multi-consumer ring,
+// so enqueueing a callable that fits into a CallbackTask neither allocates
+// nor takes a lock while the workers are busy. The mutex is only needed to
+// wake up a worker which went to sleep because there was nothing to do.
+//
+// If the ring is full, tasks go to an unbounded overflow queue instead of
+// blocking the caller. Until that queue has drained, new tasks go there as
+// well, so that a single worker runs the tasks of each thread in order.
 class ThreadPool {
 public:
-    ThreadPool(unsigned num_threads);
+    explicit ThreadPool(unsigned num_threads, size_t queue_size = 256);
     ~ThreadPool();
 
     // delete copy and move constructors and assign operators
@@ -24,15 +39,60 @@ public:
 
     bool start();
     bool stop();
-    void enqueue(std::function<void()> func);
+
+    template<typename F> void enqueue(F&& func)
+    {
+        size_t pos = 0;
+        Slot* slot = nullptr;
+        if (_overflow_size.load(std::memory_order_acquire) == 0) {
+            slot = claim_slot(pos);
+        }
+        if (slot != nullptr) {
+            slot->task.emplace(std::forward<F>(func));
+            slot->sequence.store(pos + 1, std::memory_order_release);
+        } else {
+            CallbackTask task;
+            task.emplace(std::forward<F>(func));
+            enqueue_overflow(std::move(task));
+        }
+        wake_up_worker();
+    }
+
+    // Number of tasks which did not fit into the ring.
+    uint64_t num_overflowed() const { return _num_overflowed; }
 
 private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        CallbackTask task{};
+    };
+
+    Slot* claim_slot(size_t& pos);
+    bool try_dequeue(CallbackTask& task);
+    bool has_work() const;
+    void enqueue_overflow(CallbackTask&& task);
+    void wake_up_worker();
     void worker();
 
     std::atomic<bool> _should_stop{false};
     const unsigned _num_threads;
     std::vector<std::shared_ptr<std::thread>> _threads{};
-    SafeQueue<std::function<void()>> _work_queue{};
+
+    // Bounded MPMC ring as described by Dmitry Vyukov: each slot's sequence
+    // says whether it is free to be written or ready to be read at a position.
+    const size_t _mask;
+    std::unique_ptr<Slot[]> _slots;
+    std::atomic<size_t> _enqueue_pos{0};
+    std::atomic<size_t> _dequeue_pos{0};
+
+    std::mutex _overflow_mutex{};
+    std::deque<CallbackTask> _overflow{};
+    std::atomic<size_t> _overflow_size{0};
+    std::atomic<uint64_t> _num_overflowed{0};
+
+    std::mutex _sleep_mutex{};
+    std::condition_variable _wake_up_cv{};
+    std::atomic<unsigned> _num_sleeping{0};
 };
 
 } // namespace mavsdk
@@ -1,6 +1,13 @@
 #include "thread_pool.h"
 #include <gtest/gtest.h>
 #include <atomic>
+#include <cstdlib>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
 
 // We don't (yet) use fake time for this
 // because the threads actually need to run.
@@ -11,6 +18,36 @@
 using namespace mavsdk;
 using namespace std::placeholders;
 
+// Count heap allocations of a thread while enabled for it, to check that
+// queueing callbacks does not allocate. This replaces operator new for the
+// whole test runner, so other threads and tests must not be counted.
+static thread_local bool count_allocations = false;
+static thread_local unsigned num_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    if (count_allocations) {
+        ++num_allocations;
+    }
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        std::abort();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
 static std::atomic<bool> task_one_ran{false};
 
 static Time our_time;
@@ -88,3 +125,125 @@ TEST(ThreadPool, ManyTasks)
         EXPECT_EQ(tasks[i], i);
     }
 }
+
+namespace {
+
+// Something like a telemetry struct that is passed to a callback.
+struct Sample {
+    double latitude_deg;
+    double longitude_deg;
+    float absolute_altitude_m;
+    float relative_altitude_m;
+};
+
+bool wait_for(const std::atomic<unsigned>& counter, unsigned value)
+{
+    for (unsigned i = 0; i < 500 && counter < value; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return counter == value;
+}
+
+} // namespace
+
+TEST(ThreadPool, NoAllocationPerCallback)
+{
+    ThreadPool tp(3);
+    ASSERT_TRUE(tp.start());
+
+    std::atomic<unsigned> num_called{0};
+    std::function<void(Sample)> callback = [&num_called](Sample sample) {
+        if (sample.latitude_deg > 0.0) {
+            ++num_called;
+        }
+    };
+
+    // This is what plugins queue for every telemetry update.
+    const unsigned num_callbacks = 1000;
+    num_allocations = 0;
+    count_allocations = true;
+    for (unsigned i = 0; i < num_callbacks; ++i) {
+        Sample sample{47.3, 8.5, 500.0f, 10.0f};
+        tp.enqueue([callback, sample]() { callback(sample); });
+        if (i % 100 == 0) {
+            // Don't fill up the ring.
+            wait_for(num_called, i + 1);
+        }
+    }
+    EXPECT_TRUE(wait_for(num_called, num_callbacks));
+    count_allocations = false;
+
+    EXPECT_EQ(num_allocations, 0u);
+    EXPECT_EQ(tp.num_overflowed(), 0u);
+}
+
+TEST(ThreadPool, OverflowsWhenFull)
+{
+    ThreadPool tp(1, 4);
+    ASSERT_TRUE(tp.start());
+
+    // Block the only worker so that the ring fills up.
+    std::atomic<bool> blocked{true};
+    tp.enqueue([&blocked]() {
+        while (blocked) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    std::atomic<unsigned> num_called{0};
+    const unsigned num_tasks = 20;
+    for (unsigned i = 0; i < num_tasks; ++i) {
+        tp.enqueue([&num_called]() { ++num_called; });
+    }
+    EXPECT_GT(tp.num_overflowed(), 0u);
+
+    blocked = false;
+    EXPECT_TRUE(wait_for(num_called, num_tasks));
+}
+
+TEST(ThreadPool, KeepsOrderWhenOverflowing)
+{
+    ThreadPool tp(1, 4);
+    ASSERT_TRUE(tp.start());
+
+    std::mutex mutex;
+    std::vector<unsigned> order;
+    const unsigned num_tasks = 1000;
+    for (unsigned i = 0; i < num_tasks; ++i) {
+        tp.enqueue([&mutex, &order, i]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(i);
+        });
+    }
+
+    for (unsigned i = 0; i < 1000; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (order.size() == num_tasks) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(order.size(), num_tasks);
+    for (unsigned i = 0; i < num_tasks; ++i) {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TEST(ThreadPool, LargeCallable)
+{
+    ThreadPool tp(2);
+    ASSERT_TRUE(tp.start());
+
+    // Too big to be stored in place, it needs to go on the heap.
+    char large[CallbackTask::capacity * 2]{};
+    large[sizeof(large) - 1] = 42;
+
+    std::atomic<unsigned> result{0};
+    tp.enqueue([large, &result]() { result = static_cast<unsigned>(large[sizeof(large) - 1]); });
+
+    EXPECT_TRUE(wait_for(result, 42));
+}
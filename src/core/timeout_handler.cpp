@@ -8,16 +8,16 @@ TimeoutHandler::~TimeoutHandler() {}
 
 void TimeoutHandler::add(std::function<void()> callback, double duration_s, void** cookie)
 {
-    auto new_timeout = std::make_shared<Timeout>();
-    new_timeout->callback = callback;
-    new_timeout->time = _time.steady_time_in_future(duration_s);
-    new_timeout->duration_s = duration_s;
+    Timeout new_timeout{};
+    new_timeout.callback = callback;
+    new_timeout.duration_s = duration_s;
 
-    void* new_cookie = static_cast<void*>(new_timeout.get());
+    void* new_cookie = nullptr;
 
     {
         std::lock_guard<std::mutex> lock(_timeouts_mutex);
-        _timeouts.insert(std::pair<void*, std::shared_ptr<Timeout>>(new_cookie, new_timeout));
+        new_cookie = reinterpret_cast<void*>(++_last_cookie);
+        _timeouts.push(new_cookie, _time.steady_time_in_future(duration_s), new_timeout);
     }
 
     if (cookie != nullptr) {
@@ -29,10 +29,9 @@ void TimeoutHandler::refresh(const void* cookie)
 {
     std::lock_guard<std::mutex> lock(_timeouts_mutex);
 
-    auto it = _timeouts.find(const_cast<void*>(cookie));
-    if (it != _timeouts.end()) {
-        dl_time_t future_time = _time.steady_time_in_future(it->second->duration_s);
-        it->second->time = future_time;
+    auto timeout = _timeouts.find(cookie);
+    if (timeout != nullptr) {
+        _timeouts.reschedule(cookie, _time.steady_time_in_future(timeout->duration_s));
     }
 }
 
@@ -40,46 +39,40 @@ void TimeoutHandler::remove(const void* cookie)
 {
     std::lock_guard<std::mutex> lock(_timeouts_mutex);
 
-    auto it = _timeouts.find(const_cast<void*>(cookie));
-    if (it != _timeouts.end()) {
-        _timeouts.erase(const_cast<void*>(cookie));
-        _iterator_invalidated = true;
-    }
+    _timeouts.remove(cookie);
 }
 
 void TimeoutHandler::run_once()
 {
-    _timeouts_mutex.lock();
-
-    dl_time_t now = _time.steady_time();
+    std::unique_lock<std::mutex> lock(_timeouts_mutex);
 
-    for (auto it = _timeouts.begin(); it != _timeouts.end(); /* no ++it */) {
-        // If time is passed, call timeout callback.
-        if (it->second->time < now) {
-            if (it->second->callback) {
-                // Get a copy for the callback because we will remove it.
-                std::function<void()> callback = it->second->callback;
+    const dl_time_t now = _time.steady_time();
 
-                // Self-destruct before calling to avoid locking issues.
-                _timeouts.erase(it++);
+    while (!_timeouts.empty() && _timeouts.top_deadline() <= now) {
+        // Get a copy for the callback because we will remove it.
+        std::function<void()> callback = _timeouts.top_value().callback;
 
-                // Unlock while we callback because it might in turn want to add timeouts.
-                _timeouts_mutex.unlock();
-                callback();
-                _timeouts_mutex.lock();
-            }
+        // Self-destruct before calling to avoid locking issues.
+        _timeouts.pop();
 
-        } else {
-            ++it;
+        if (callback) {
+            // Unlock while we callback because it might in turn want to add timeouts.
+            lock.unlock();
+            callback();
+            lock.lock();
         }
+    }
+}
 
-        // We start over if anyone has messed with this while we called the callback.
-        if (_iterator_invalidated) {
-            _iterator_invalidated = false;
-            it = _timeouts.begin();
-        }
+bool TimeoutHandler::next_deadline(dl_time_t& deadline)
+{
+    std::lock_guard<std::mutex> lock(_timeouts_mutex);
+
+    if (_timeouts.empty()) {
+        return false;
     }
-    _timeouts_mutex.unlock();
+    deadline = _timeouts.top_deadline();
+    return true;
 }
 
 } // namespace mavsdk
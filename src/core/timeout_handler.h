@@ -1,9 +1,9 @@
 #pragma once
 
 #include <mutex>
-#include <memory>
+#include <cstdint>
 #include <functional>
-#include <map>
+#include "deadline_heap.h"
 #include "global_include.h"
 
 namespace mavsdk {
@@ -25,16 +25,22 @@ public:
 
     void run_once();
 
+    // Earliest time at which run_once has something to do, returns false
+    // if there are no timeouts.
+    bool next_deadline(dl_time_t& deadline);
+
 private:
     struct Timeout {
         std::function<void()> callback{};
-        dl_time_t time{};
         double duration_s{0.0};
     };
 
-    std::map<void*, std::shared_ptr<Timeout>> _timeouts{};
+    DeadlineHeap<Timeout> _timeouts{};
     std::mutex _timeouts_mutex{};
-    bool _iterator_invalidated{false};
+
+    // Cookies are never reused, so removing a timeout that has already
+    // fired can't remove a newer one by accident.
+    uintptr_t _last_cookie{0};
 
     Time& _time;
 };
@@ -169,3 +169,51 @@ TEST(TimeoutHandler, NextTimeoutRemovedDuringCallback)
     time.sleep_for(std::chrono::milliseconds(1000));
     th.run_once();
 }
+
+TEST(TimeoutHandler, NextDeadline)
+{
+    Time time{};
+    TimeoutHandler th(time);
+
+    dl_time_t deadline{};
+    EXPECT_FALSE(th.next_deadline(deadline));
+
+    void* cookie1 = nullptr;
+    void* cookie2 = nullptr;
+    th.add([]() {}, 0.5, &cookie1);
+    th.add([]() {}, 0.2, &cookie2);
+
+    ASSERT_TRUE(th.next_deadline(deadline));
+    EXPECT_EQ(deadline, time.steady_time_in_future(0.2));
+
+    th.remove(cookie2);
+    ASSERT_TRUE(th.next_deadline(deadline));
+    EXPECT_EQ(deadline, time.steady_time_in_future(0.5));
+
+    time.sleep_for(std::chrono::milliseconds(100));
+    th.refresh(cookie1);
+    ASSERT_TRUE(th.next_deadline(deadline));
+    EXPECT_EQ(deadline, time.steady_time_in_future(0.5));
+}
+
+TEST(TimeoutHandler, StaleCookieDoesNotRemoveNewTimeout)
+{
+    Time time{};
+    TimeoutHandler th(time);
+
+    void* cookie1 = nullptr;
+    th.add([]() {}, 0.1, &cookie1);
+    time.sleep_for(std::chrono::milliseconds(200));
+    th.run_once();
+
+    bool timeout_happened = false;
+    void* cookie2 = nullptr;
+    th.add([&timeout_happened]() { timeout_happened = true; }, 0.1, &cookie2);
+    EXPECT_NE(cookie1, cookie2);
+
+    // Removing the timeout that already happened must not affect the new one.
+    th.remove(cookie1);
+    time.sleep_for(std::chrono::milliseconds(200));
+    th.run_once();
+    EXPECT_TRUE(timeout_happened);
+}
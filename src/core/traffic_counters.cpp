@@ -0,0 +1,173 @@
+#include "traffic_counters.h"
+
+namespace mavsdk {
+
+TrafficCounters::~TrafficCounters()
+{
+    clear(_message_counts);
+    clear(_senders);
+}
+
+void TrafficCounters::add_bytes_received(unsigned num_bytes)
+{
+    _bytes_received.fetch_add(num_bytes, std::memory_order_relaxed);
+}
+
+void TrafficCounters::add_message_received(const mavlink_message_t& message, unsigned num_bytes)
+{
+    _bytes_received.fetch_add(num_bytes, std::memory_order_relaxed);
+    _messages_received.fetch_add(1, std::memory_order_relaxed);
+    MessageCount* count = message_count(message.msgid);
+    if (count != nullptr) {
+        count->num_received.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Sender& sender = block(_senders, message.sysid)[message.compid];
+    sender.num_received.fetch_add(1, std::memory_order_relaxed);
+
+    // Several connections can count into the same counters, e.g. those of a
+    // system, so the sequence is only carried on if nobody else did meanwhile.
+    uint16_t last = sender.last_sequence.load(std::memory_order_relaxed);
+    uint8_t gap;
+    do {
+        gap = 0;
+        if (last != 0) {
+            gap = static_cast<uint8_t>(message.seq - last - 1);
+            if (gap >= 256 - 16) {
+                // A bit late, so it was counted as lost already. The sequence
+                // carries on after the newest one.
+                return;
+            }
+            // Anything further back means the sender has restarted.
+            if (gap >= 128) {
+                gap = 0;
+            }
+        }
+    } while (!sender.last_sequence.compare_exchange_weak(
+        last, static_cast<uint16_t>(0x100 | message.seq), std::memory_order_relaxed));
+
+    if (gap > 0) {
+        sender.num_lost.fetch_add(gap, std::memory_order_relaxed);
+        _messages_lost.fetch_add(gap, std::memory_order_relaxed);
+    }
+}
+
+void TrafficCounters::add_bytes_sent(unsigned num_bytes)
+{
+    _bytes_sent.fetch_add(num_bytes, std::memory_order_relaxed);
+}
+
+void TrafficCounters::add_message_sent(const mavlink_message_t& message, unsigned num_bytes)
+{
+    _bytes_sent.fetch_add(num_bytes, std::memory_order_relaxed);
+    _messages_sent.fetch_add(1, std::memory_order_relaxed);
+    MessageCount* count = message_count(message.msgid);
+    if (count != nullptr) {
+        count->num_sent.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TrafficCounters::add_parse_error()
+{
+    _parse_errors.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TrafficCounters::add_crc_error()
+{
+    _crc_errors.fetch_add(1, std::memory_order_relaxed);
+}
+
+TrafficStats TrafficCounters::stats() const
+{
+    TrafficStats stats{};
+
+    stats.bytes_received = _bytes_received.load(std::memory_order_relaxed);
+    stats.bytes_sent = _bytes_sent.load(std::memory_order_relaxed);
+    stats.messages_received = _messages_received.load(std::memory_order_relaxed);
+    stats.messages_sent = _messages_sent.load(std::memory_order_relaxed);
+    stats.parse_errors = _parse_errors.load(std::memory_order_relaxed);
+    stats.crc_errors = _crc_errors.load(std::memory_order_relaxed);
+    stats.messages_lost = _messages_lost.load(std::memory_order_relaxed);
+
+    // The tables are in order already.
+    for (unsigned high = 0; high < 256; ++high) {
+        const Block<MessageCount>* counts = _message_counts[high].load(std::memory_order_acquire);
+        if (counts == nullptr) {
+            continue;
+        }
+        for (unsigned low = 0; low < 256; ++low) {
+            const uint64_t num_received =
+                (*counts)[low].num_received.load(std::memory_order_relaxed);
+            const uint64_t num_sent = (*counts)[low].num_sent.load(std::memory_order_relaxed);
+            if (num_received > 0 || num_sent > 0) {
+                stats.message_counts.push_back({(high << 8) | low, num_received, num_sent});
+            }
+        }
+    }
+
+    for (unsigned system_id = 0; system_id < 256; ++system_id) {
+        const Block<Sender>* senders = _senders[system_id].load(std::memory_order_acquire);
+        if (senders == nullptr) {
+            continue;
+        }
+        for (unsigned component_id = 0; component_id < 256; ++component_id) {
+            const Sender& sender = (*senders)[component_id];
+            const uint64_t num_received = sender.num_received.load(std::memory_order_relaxed);
+            if (num_received > 0) {
+                stats.senders.push_back({static_cast<uint8_t>(system_id),
+                                         static_cast<uint8_t>(component_id),
+                                         num_received,
+                                         sender.num_lost.load(std::memory_order_relaxed)});
+            }
+        }
+    }
+
+    return stats;
+}
+
+template<typename T>
+TrafficCounters::Block<T>& TrafficCounters::block(Table<T>& table, unsigned index)
+{
+    Block<T>* existing = table[index].load(std::memory_order_acquire);
+    if (existing != nullptr) {
+        return *existing;
+    }
+
+    // Someone else might be allocating it at the same time, then theirs is
+    // used.
+    Block<T>* created = new Block<T>();
+    if (table[index].compare_exchange_strong(existing, created, std::memory_order_acq_rel)) {
+        return *created;
+    }
+    delete created;
+    return *existing;
+}
+
+template<typename T> void TrafficCounters::clear(Table<T>& table)
+{
+    for (auto& entry : table) {
+        delete entry.load();
+    }
+}
+
+TrafficCounters::MessageCount* TrafficCounters::message_count(uint32_t message_id)
+{
+    if (message_id >= 256 * 256) {
+        return nullptr;
+    }
+    return &block(_message_counts, message_id >> 8)[message_id & 0xff];
+}
+
+unsigned TrafficCounters::frame_len(const mavlink_message_t& message)
+{
+    if (message.magic == MAVLINK_STX_MAVLINK1) {
+        return MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + message.len + MAVLINK_NUM_CHECKSUM_BYTES;
+    }
+    unsigned len = MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len;
+    if (message.incompat_flags & MAVLINK_IFLAG_SIGNED) {
+        len += MAVLINK_SIGNATURE_BLOCK_LEN;
+    }
+    return len;
+}
+
+} // namespace mavsdk
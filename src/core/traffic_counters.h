@@ -0,0 +1,77 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include "traffic_stats.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace mavsdk {
+
+// Counts the traffic of a connection or a system, see TrafficStats.
+//
+// Everything is counted with relaxed atomics, without any locks. The counts
+// by message ID and by sender are kept in fixed tables indexed by message ID
+// and by system and component ID. Their blocks of 256 entries are allocated
+// when first used. Message IDs from 65536 up are only counted in the totals.
+class TrafficCounters {
+public:
+    TrafficCounters() = default;
+    ~TrafficCounters();
+
+    // delete copy and move constructors and assign operators
+    TrafficCounters(TrafficCounters const&) = delete; // Copy construct
+    TrafficCounters(TrafficCounters&&) = delete; // Move construct
+    TrafficCounters& operator=(TrafficCounters const&) = delete; // Copy assign
+    TrafficCounters& operator=(TrafficCounters&&) = delete; // Move assign
+
+    void add_bytes_received(unsigned num_bytes);
+    // The bytes can be counted here, or separately with add_bytes_received().
+    void add_message_received(const mavlink_message_t& message, unsigned num_bytes);
+    // The bytes can be counted here, or separately with add_bytes_sent(), e.g.
+    // if one message goes out more than once to several remotes.
+    void add_bytes_sent(unsigned num_bytes);
+    void add_message_sent(const mavlink_message_t& message, unsigned num_bytes);
+    void add_parse_error();
+    void add_crc_error();
+
+    TrafficStats stats() const;
+
+    // Length of the message on the wire.
+    static unsigned frame_len(const mavlink_message_t& message);
+
+private:
+    struct MessageCount {
+        std::atomic<uint64_t> num_received{0};
+        std::atomic<uint64_t> num_sent{0};
+    };
+
+    struct Sender {
+        std::atomic<uint64_t> num_received{0};
+        std::atomic<uint64_t> num_lost{0};
+        // 0x100 | the last sequence number, 0 before the first message.
+        std::atomic<uint16_t> last_sequence{0};
+    };
+
+    template<typename T> using Block = std::array<T, 256>;
+    template<typename T> using Table = std::array<std::atomic<Block<T>*>, 256>;
+
+    template<typename T> static Block<T>& block(Table<T>& table, unsigned index);
+    template<typename T> static void clear(Table<T>& table);
+
+    MessageCount* message_count(uint32_t message_id);
+
+    std::atomic<uint64_t> _bytes_received{0};
+    std::atomic<uint64_t> _bytes_sent{0};
+    std::atomic<uint64_t> _messages_received{0};
+    std::atomic<uint64_t> _messages_sent{0};
+    std::atomic<uint64_t> _parse_errors{0};
+    std::atomic<uint64_t> _crc_errors{0};
+    std::atomic<uint64_t> _messages_lost{0};
+    // By message id >> 8, then the low byte.
+    Table<MessageCount> _message_counts{};
+    // By system id, then component id.
+    Table<Sender> _senders{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,75 @@
+#include "traffic_counters.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t heartbeat(uint8_t system_id, uint8_t component_id, uint8_t sequence)
+{
+    mavlink_message_t message{};
+    mavlink_msg_heartbeat_pack(system_id, component_id, &message, 0, 0, 0, 0, 0);
+    message.seq = sequence;
+    return message;
+}
+
+} // namespace
+
+TEST(TrafficCounters, CountsMessagesAndBytes)
+{
+    TrafficCounters counters;
+
+    const auto message = heartbeat(1, 1, 0);
+    const unsigned len = TrafficCounters::frame_len(message);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    EXPECT_EQ(len, mavlink_msg_to_send_buffer(buffer, &message));
+
+    counters.add_message_received(message, len);
+    counters.add_bytes_received(7);
+    counters.add_message_sent(message, len);
+    counters.add_message_sent(message, len);
+
+    mavlink_message_t command{};
+    mavlink_msg_command_long_pack(
+        255, 190, &command, 1, 1, 400, 0, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    counters.add_message_sent(command, TrafficCounters::frame_len(command));
+
+    const auto stats = counters.stats();
+    EXPECT_EQ(stats.bytes_received, len + 7);
+    EXPECT_EQ(stats.bytes_sent, 2 * len + TrafficCounters::frame_len(command));
+    EXPECT_EQ(stats.messages_received, 1u);
+    EXPECT_EQ(stats.messages_sent, 3u);
+
+    ASSERT_EQ(stats.message_counts.size(), 2u);
+    EXPECT_EQ(stats.message_counts[0].message_id, uint32_t(MAVLINK_MSG_ID_HEARTBEAT));
+    EXPECT_EQ(stats.message_counts[0].num_received, 1u);
+    EXPECT_EQ(stats.message_counts[0].num_sent, 2u);
+    EXPECT_EQ(stats.message_counts[1].message_id, uint32_t(MAVLINK_MSG_ID_COMMAND_LONG));
+    EXPECT_EQ(stats.message_counts[1].num_received, 0u);
+    EXPECT_EQ(stats.message_counts[1].num_sent, 1u);
+}
+
+TEST(TrafficCounters, CountsSequenceGapsPerSender)
+{
+    TrafficCounters counters;
+
+    // The autopilot loses 3 messages, wrapping around.
+    for (const uint8_t sequence : {253, 254, 255, 3, 4}) {
+        counters.add_message_received(heartbeat(1, 1, sequence), 0);
+    }
+    // The camera has its own sequence and doesn't lose anything, apart from
+    // one message out of order, which isn't a loss.
+    for (const uint8_t sequence : {10, 11, 12, 14, 13, 15}) {
+        counters.add_message_received(heartbeat(1, 100, sequence), 0);
+    }
+
+    const auto stats = counters.stats();
+    ASSERT_EQ(stats.senders.size(), 2u);
+    EXPECT_EQ(stats.senders[0].component_id, 1);
+    EXPECT_EQ(stats.senders[0].num_received, 5u);
+    EXPECT_EQ(stats.senders[0].num_lost, 3u);
+    EXPECT_EQ(stats.senders[1].component_id, 100);
+    EXPECT_EQ(stats.senders[1].num_received, 6u);
+    EXPECT_EQ(stats.senders[1].num_lost, 1u);
+    EXPECT_EQ(stats.messages_lost, 4u);
+}
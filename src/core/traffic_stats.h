@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace mavsdk {
+
+/**
+ * @brief Snapshot of the MAVLink traffic of a connection or a system.
+ *
+ * All counters start at 0 when the connection or system is created and are counted all the
+ * time, e.g. to size radio links or to spot overloaded ones.
+ */
+struct TrafficStats {
+    /**
+     * @brief Number of messages of one message ID.
+     */
+    struct MessageCount {
+        uint32_t message_id; /**< @brief MAVLink message ID. */
+        uint64_t num_received; /**< @brief Messages received with this ID. */
+        uint64_t num_sent; /**< @brief Messages sent with this ID. */
+    };
+
+    /**
+     * @brief Messages received from one component, identified by system and component ID.
+     */
+    struct SenderStats {
+        uint8_t system_id; /**< @brief System ID of the sender. */
+        uint8_t component_id; /**< @brief Component ID of the sender. */
+        uint64_t num_received; /**< @brief Messages received from this sender. */
+        uint64_t num_lost; /**< @brief Messages missing according to the sequence numbers. */
+    };
+
+    uint64_t bytes_received; /**< @brief Bytes received, including any that couldn't be
+                                parsed. */
+    uint64_t bytes_sent; /**< @brief Bytes sent. */
+    uint64_t messages_received; /**< @brief Messages received. */
+    uint64_t messages_sent; /**< @brief Messages sent. */
+    uint64_t parse_errors; /**< @brief Times bytes had to be skipped to find the start of the
+                              next message. */
+    uint64_t crc_errors; /**< @brief Messages dropped because of a bad checksum or
+                            signature. */
+    uint64_t messages_lost; /**< @brief Messages missing according to the sequence numbers, of
+                               all senders. */
+    std::vector<MessageCount> message_counts; /**< @brief Counts by message ID, ordered by
+                                                 message ID. */
+    std::vector<SenderStats> senders; /**< @brief Counts by sender, ordered by system and
+                                         component ID. */
+};
+
+} // namespace mavsdk
@@ -18,6 +18,7 @@
 #endif
 
 #include <cassert>
+#include <cstring>
 #include <algorithm>
 
 #ifdef WINDOWS
@@ -45,16 +46,23 @@ UdpConnection::~UdpConnection()
 
 ConnectionResult UdpConnection::start()
 {
-    if (!start_mavlink_receiver()) {
-        return ConnectionResult::CONNECTIONS_EXHAUSTED;
-    }
+    start_mavlink_receiver();
 
     ConnectionResult ret = setup_port();
     if (ret != ConnectionResult::SUCCESS) {
         return ret;
     }
 
-    start_recv_thread();
+    if (_io_reactor) {
+        if (!IoReactor::set_non_blocking(_socket_fd) ||
+            !_io_reactor->add(_socket_fd, std::bind(&UdpConnection::receive_available, this))) {
+            return ConnectionResult::SOCKET_ERROR;
+        }
+    } else {
+        start_recv_thread();
+    }
+
+    start_send_queue();
 
     return ConnectionResult::SUCCESS;
 }
@@ -86,6 +94,16 @@ ConnectionResult UdpConnection::setup_port()
         return ConnectionResult::BIND_ERROR;
     }
 
+    if (_local_port_number == 0) {
+        // Find out which port we were given.
+        socklen_t addr_len = sizeof(addr);
+        if (getsockname(_socket_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) != 0) {
+            LogErr() << "getsockname error: " << GET_ERROR(errno);
+            return ConnectionResult::BIND_ERROR;
+        }
+        _local_port_number = ntohs(addr.sin_port);
+    }
+
     return ConnectionResult::SUCCESS;
 }
 
@@ -98,6 +116,13 @@ ConnectionResult UdpConnection::stop()
 {
     _should_exit = true;
 
+    stop_send_queue();
+
+    if (_io_reactor) {
+        // Once removed, the reactor won't call us anymore.
+        _io_reactor->remove(_socket_fd);
+    }
+
 #ifndef WINDOWS
     // This should interrupt a recv/recvfrom call.
     shutdown(_socket_fd, SHUT_RDWR);
@@ -127,13 +152,15 @@ ConnectionResult UdpConnection::stop()
 
 bool UdpConnection::send_message(const mavlink_message_t& message)
 {
-    std::lock_guard<std::mutex> lock(_remote_mutex);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
 
-    if (_remotes.size() == 0) {
-        LogErr() << "No known remotes";
-        return false;
-    }
+    return send_frame(message, buffer, buffer_len);
+}
 
+bool UdpConnection::send_frame(
+    const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len)
+{
     // Some messages have a target system set which allows to send it only
     // on the matching link.
     const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(message.msgid);
@@ -142,34 +169,97 @@ bool UdpConnection::send_message(const mavlink_message_t& message)
              reinterpret_cast<const uint8_t*>(message.payload64)[entry->target_system_ofs] :
              0);
 
-    bool send_successful = true;
-    for (auto& remote : _remotes) {
-        if (target_system_id != 0 && remote.system_id != target_system_id) {
-            continue;
+    std::lock_guard<std::mutex> send_lock(_send_mutex);
+
+    // Take a copy so the receive thread can add remotes while we send.
+    _send_addrs.clear();
+    {
+        std::lock_guard<std::mutex> lock(_remote_mutex);
+
+        if (_remotes.size() == 0) {
+            LogErr() << "No known remotes";
+            return false;
         }
 
-        struct sockaddr_in dest_addr {};
-        dest_addr.sin_family = AF_INET;
+        for (const auto& remote : _remotes) {
+            if (target_system_id != 0 && remote.second.system_id != target_system_id) {
+                continue;
+            }
+            _send_addrs.push_back(remote.second.addr);
+        }
+    }
+
+    bool send_successful = true;
+    bool sent_to_any = false;
+
+#if defined(LINUX)
+    // The same frame goes to all matching remotes with one sendmmsg call.
+    struct iovec iov {};
+    iov.iov_base = const_cast<uint8_t*>(frame);
+    iov.iov_len = frame_len;
+
+    _send_msgs.clear();
+    for (auto& addr : _send_addrs) {
+        struct mmsghdr msg {};
+        msg.msg_hdr.msg_name = &addr;
+        msg.msg_hdr.msg_namelen = sizeof(addr);
+        msg.msg_hdr.msg_iov = &iov;
+        msg.msg_hdr.msg_iovlen = 1;
+        _send_msgs.push_back(msg);
+    }
 
-        inet_pton(AF_INET, remote.ip.c_str(), &dest_addr.sin_addr.s_addr);
-        dest_addr.sin_port = htons(remote.port_number);
+    unsigned num_sent = 0;
+    while (num_sent < _send_msgs.size()) {
+        const unsigned num_left = static_cast<unsigned>(_send_msgs.size()) - num_sent;
+        const int ret = sendmmsg(_socket_fd, &_send_msgs[num_sent], num_left, 0);
+        ++_send_syscalls;
 
-        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-        uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+        if (ret < 0) {
+            LogErr() << "sendmmsg failure: " << GET_ERROR(errno);
+            // Skip the one that failed and carry on with the others.
+            send_successful = false;
+            ++num_sent;
+            continue;
+        }
 
+        for (int i = 0; i < ret; ++i) {
+            if (_send_msgs[num_sent + i].msg_len != frame_len) {
+                LogErr() << "sendmmsg failure: only sent " << _send_msgs[num_sent + i].msg_len
+                         << " of " << frame_len << " bytes";
+                send_successful = false;
+                continue;
+            }
+            _traffic_counters.add_bytes_sent(frame_len);
+            sent_to_any = true;
+        }
+        _send_datagrams += ret;
+        num_sent += ret;
+    }
+#else
+    for (const auto& addr : _send_addrs) {
         const auto send_len = sendto(
             _socket_fd,
-            reinterpret_cast<char*>(buffer),
-            buffer_len,
+            reinterpret_cast<const char*>(frame),
+            frame_len,
             0,
-            reinterpret_cast<const sockaddr*>(&dest_addr),
-            sizeof(dest_addr));
+            reinterpret_cast<const sockaddr*>(&addr),
+            sizeof(addr));
+        ++_send_syscalls;
 
-        if (send_len != buffer_len) {
+        if (send_len < 0 || static_cast<unsigned>(send_len) != frame_len) {
             LogErr() << "sendto failure: " << GET_ERROR(errno);
             send_successful = false;
             continue;
         }
+        ++_send_datagrams;
+        _traffic_counters.add_bytes_sent(frame_len);
+        sent_to_any = true;
+    }
+#endif
+
+    // One message, however many remotes it went to.
+    if (sent_to_any) {
+        _traffic_counters.add_message_sent(message, 0);
     }
 
     return send_successful;
@@ -177,105 +267,207 @@ bool UdpConnection::send_message(const mavlink_message_t& message)
 
 void UdpConnection::add_remote(const std::string& remote_ip, const int remote_port)
 {
-    add_remote_with_remote_sysid(remote_ip, remote_port, 0);
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    if (inet_pton(AF_INET, remote_ip.c_str(), &addr.sin_addr.s_addr) != 1) {
+        LogErr() << "Invalid remote IP: " << remote_ip;
+        return;
+    }
+    addr.sin_port = htons(remote_port);
+
+    add_remote_with_remote_sysid(addr, 0);
+}
+
+uint64_t UdpConnection::remote_key(const struct sockaddr_in& addr)
+{
+    return (static_cast<uint64_t>(addr.sin_addr.s_addr) << 16) | addr.sin_port;
 }
 
 void UdpConnection::add_remote_with_remote_sysid(
-    const std::string& remote_ip, const int remote_port, const uint8_t remote_sysid)
+    const struct sockaddr_in& addr, const uint8_t remote_sysid)
 {
     std::lock_guard<std::mutex> lock(_remote_mutex);
-    Remote new_remote;
-    new_remote.ip = remote_ip;
-    new_remote.port_number = remote_port;
-    new_remote.system_id = remote_sysid;
 
-    auto existing_remote =
-        std::find_if(_remotes.begin(), _remotes.end(), [&new_remote](Remote& remote) {
-            return (remote.ip == new_remote.ip && remote.port_number == new_remote.port_number);
-        });
+    auto existing_remote = _remotes.find(remote_key(addr));
 
     if (existing_remote == _remotes.end()) {
-        LogInfo() << "New system on: " << new_remote.ip << ":" << new_remote.port_number;
-        _remotes.push_back(new_remote);
-    } else if (existing_remote->system_id != new_remote.system_id) {
-        LogWarn() << "System on: " << new_remote.ip << ":" << new_remote.port_number
-                  << " changed system ID (" << int(existing_remote->system_id) << " to "
-                  << int(new_remote.system_id) << ")";
-        existing_remote->system_id = new_remote.system_id;
+        LogInfo() << "New system on: " << inet_ntoa(addr.sin_addr) << ":" << ntohs(addr.sin_port);
+        Remote new_remote;
+        new_remote.addr = addr;
+        new_remote.system_id = remote_sysid;
+        _remotes[remote_key(addr)] = new_remote;
+    } else if (existing_remote->second.system_id != remote_sysid) {
+        LogWarn() << "System on: " << inet_ntoa(addr.sin_addr) << ":" << ntohs(addr.sin_port)
+                  << " changed system ID (" << int(existing_remote->second.system_id) << " to "
+                  << int(remote_sysid) << ")";
+        existing_remote->second.system_id = remote_sysid;
     }
 }
 
+UdpConnection::BatchStats UdpConnection::batch_stats() const
+{
+    BatchStats stats;
+    stats.recv_syscalls = _recv_syscalls;
+    stats.recv_datagrams = _recv_datagrams;
+    stats.send_syscalls = _send_syscalls;
+    stats.send_datagrams = _send_datagrams;
+    return stats;
+}
+
+double UdpConnection::BatchStats::datagrams_per_recv_syscall() const
+{
+    return (recv_syscalls > 0 ? static_cast<double>(recv_datagrams) / recv_syscalls : 0.0);
+}
+
+double UdpConnection::BatchStats::datagrams_per_send_syscall() const
+{
+    return (send_syscalls > 0 ? static_cast<double>(send_datagrams) / send_syscalls : 0.0);
+}
+
 void UdpConnection::receive()
 {
-    // Enough for MTU 1500 bytes.
-    char buffer[2048];
+    while (!_should_exit) {
+        // Errors and empty reads happen on shutdown/close of the socket,
+        // therefore we just check _should_exit again.
+        receive_batch(true);
+    }
+}
 
+void UdpConnection::receive_available()
+{
+    // We are called by the I/O reactor, so drain the socket without blocking.
     while (!_should_exit) {
-        struct sockaddr_in src_addr = {};
-        socklen_t src_addr_len = sizeof(src_addr);
-        const auto recv_len = recvfrom(
-            _socket_fd,
-            buffer,
-            sizeof(buffer),
-            0,
-            reinterpret_cast<struct sockaddr*>(&src_addr),
-            &src_addr_len);
+        if (receive_batch(false) <= 0) {
+            // Nothing left to read (EAGAIN), or the socket is shutting down.
+            return;
+        }
+    }
+}
 
-        if (recv_len == 0) {
-            // This can happen when shutdown is called on the socket,
-            // therefore we check _should_exit again.
-            continue;
+int UdpConnection::receive_batch(bool blocking)
+{
+#if defined(LINUX)
+    // Enough for MTU 1500 bytes.
+    static constexpr unsigned buffer_size = 2048;
+    static constexpr unsigned batch_size = 16;
+
+    char buffers[batch_size][buffer_size];
+    struct iovec iovs[batch_size];
+    struct sockaddr_in src_addrs[batch_size];
+    struct mmsghdr msgs[batch_size];
+    char controls[batch_size][CMSG_SPACE(sizeof(struct timespec))];
+
+    const bool tracing = LatencyTracer::is_tracing();
+    if (tracing && !_timestamping) {
+        const int enable = 1;
+        if (setsockopt(_socket_fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) != 0) {
+            LogWarn() << "Could not enable receive timestamps: " << GET_ERROR(errno);
+        }
+        _timestamping = true;
+    }
+
+    for (unsigned i = 0; i < batch_size; ++i) {
+        iovs[i].iov_base = buffers[i];
+        iovs[i].iov_len = buffer_size;
+        msgs[i] = {};
+        msgs[i].msg_hdr.msg_name = &src_addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(src_addrs[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        if (tracing) {
+            msgs[i].msg_hdr.msg_control = controls[i];
+            msgs[i].msg_hdr.msg_controllen = sizeof(controls[i]);
         }
+    }
+
+    // When blocking, wait for the first datagram and then take whatever
+    // else is already queued.
+    const int num_received =
+        recvmmsg(_socket_fd, msgs, batch_size, blocking ? MSG_WAITFORONE : MSG_DONTWAIT, nullptr);
+
+    if (num_received <= 0) {
+        return num_received;
+    }
+
+    ++_recv_syscalls;
+    _recv_datagrams += num_received;
 
-        if (recv_len < 0) {
-            // This happens on destruction when close(_socket_fd) is called,
-            // therefore be quiet.
-            // LogErr() << "recvfrom error: " << GET_ERROR(errno);
+    for (int i = 0; i < num_received; ++i) {
+        if (msgs[i].msg_len == 0) {
             continue;
         }
+        if (tracing) {
+            LatencyTracer::stamp_receive_time(kernel_receive_time_ns(msgs[i].msg_hdr));
+        }
+        process_datagram(buffers[i], msgs[i].msg_len, src_addrs[i]);
+    }
 
-        _mavlink_receiver->set_new_datagram(buffer, static_cast<int>(recv_len));
-
-        bool saved_remote = false;
-
-        // Parse all mavlink messages in one datagram. Once exhausted, we'll exit while.
-        while (_mavlink_receiver->parse_message()) {
-            const uint8_t sysid = _mavlink_receiver->get_last_message().sysid;
-
-            // FIXME: We ignore messages from QGC (255) for now.
-            if (!saved_remote && sysid != 0 && sysid != 255) {
-                saved_remote = true;
-                {
-                    std::lock_guard<std::mutex> lock(_remote_mutex);
-                    Remote new_remote;
-                    new_remote.ip = inet_ntoa(src_addr.sin_addr);
-                    new_remote.port_number = ntohs(src_addr.sin_port);
-                    new_remote.system_id = sysid;
-
-                    auto existing_remote = std::find_if(
-                        _remotes.begin(), _remotes.end(), [&new_remote](Remote& remote) {
-                            return (
-                                remote.ip == new_remote.ip &&
-                                remote.port_number == new_remote.port_number);
-                        });
-
-                    if (existing_remote == _remotes.end()) {
-                        LogInfo() << "New system on: " << new_remote.ip << ":"
-                                  << new_remote.port_number;
-                        _remotes.push_back(new_remote);
-                    } else if (existing_remote->system_id != new_remote.system_id) {
-                        LogWarn() << "System on: " << new_remote.ip << ":" << new_remote.port_number
-                                  << " changed system ID (" << int(existing_remote->system_id)
-                                  << " to " << int(new_remote.system_id) << ")";
-                        existing_remote->system_id = new_remote.system_id;
-                    }
-                }
-                add_remote_with_remote_sysid(
-                    inet_ntoa(src_addr.sin_addr), ntohs(src_addr.sin_port), sysid);
-            }
+    // A partial batch means the socket is drained.
+    return (static_cast<unsigned>(num_received) < batch_size ? 0 : num_received);
+#else
+    UNUSED(blocking);
+
+    // Enough for MTU 1500 bytes.
+    char buffer[2048];
+
+    struct sockaddr_in src_addr = {};
+    socklen_t src_addr_len = sizeof(src_addr);
+    const auto recv_len = recvfrom(
+        _socket_fd,
+        buffer,
+        sizeof(buffer),
+        0,
+        reinterpret_cast<struct sockaddr*>(&src_addr),
+        &src_addr_len);
+
+    if (recv_len <= 0) {
+        return static_cast<int>(recv_len);
+    }
+
+    ++_recv_syscalls;
+    ++_recv_datagrams;
+
+    LatencyTracer::stamp_receive_time();
+    process_datagram(buffer, static_cast<unsigned>(recv_len), src_addr);
+    return 1;
+#endif
+}
+
+#if defined(LINUX)
+int64_t UdpConnection::kernel_receive_time_ns(const struct msghdr& msg_hdr)
+{
+    // Without a timestamp, e.g. right after enabling them, we take our own.
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg_hdr); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(const_cast<struct msghdr*>(&msg_hdr), cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec time;
+            memcpy(&time, CMSG_DATA(cmsg), sizeof(time));
+            return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+        }
+    }
+    return 0;
+}
+#endif
+
+void UdpConnection::process_datagram(
+    char* buffer, unsigned buffer_len, const struct sockaddr_in& src_addr)
+{
+    _mavlink_receiver->set_new_datagram(buffer, buffer_len);
 
-            receive_message(_mavlink_receiver->get_last_message());
+    bool saved_remote = false;
+
+    // Parse all mavlink messages in one datagram. Once exhausted, we'll exit while.
+    while (_mavlink_receiver->parse_message()) {
+        const uint8_t sysid = _mavlink_receiver->get_last_message().sysid;
+
+        // FIXME: We ignore messages from QGC (255) for now, unless we forward
+        //        to it.
+        if (!saved_remote && sysid != 0 && (sysid != 255 || is_forwarding())) {
+            saved_remote = true;
+            add_remote_with_remote_sysid(src_addr, sysid);
         }
+
+        receive_message(*_mavlink_receiver);
     }
 }
 
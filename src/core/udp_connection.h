@@ -4,9 +4,17 @@
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <unordered_map>
 #include <vector>
 #include <cstdint>
 #include "connection.h"
+#ifndef WINDOWS
+#include <netinet/in.h>
+#include <sys/socket.h>
+#else
+#include <winsock2.h>
+#undef SOCKET_ERROR // conflicts with ConnectionResult::SOCKET_ERROR
+#endif
 
 namespace mavsdk {
 
@@ -21,9 +29,27 @@ public:
     ConnectionResult stop();
 
     bool send_message(const mavlink_message_t& message);
+    bool send_frame(const mavlink_message_t& message, const uint8_t* frame, unsigned frame_len);
 
     void add_remote(const std::string& remote_ip, const int remote_port);
 
+    // The port bound to, also when 0 was given to let the system pick one.
+    int local_port() const { return _local_port_number; }
+
+    // Counters of the receive and send path. On Linux several datagrams are
+    // moved per syscall using recvmmsg/sendmmsg, elsewhere it is always one.
+    struct BatchStats {
+        uint64_t recv_syscalls{0};
+        uint64_t recv_datagrams{0};
+        uint64_t send_syscalls{0};
+        uint64_t send_datagrams{0};
+
+        double datagrams_per_recv_syscall() const;
+        double datagrams_per_send_syscall() const;
+    };
+
+    BatchStats batch_stats() const;
+
     // Non-copyable
     UdpConnection(const UdpConnection&) = delete;
     const UdpConnection& operator=(const UdpConnection&) = delete;
@@ -33,26 +59,44 @@ private:
     void start_recv_thread();
 
     void receive();
+    void receive_available();
+    int receive_batch(bool blocking);
+    void process_datagram(char* buffer, unsigned buffer_len, const struct sockaddr_in& src_addr);
+#if defined(LINUX)
+    static int64_t kernel_receive_time_ns(const struct msghdr& msg_hdr);
+#endif
 
-    void add_remote_with_remote_sysid(
-        const std::string& remote_ip, const int remote_port, const uint8_t remote_sysid);
+    void add_remote_with_remote_sysid(const struct sockaddr_in& addr, const uint8_t remote_sysid);
 
     std::string _local_ip;
     int _local_port_number;
 
+    // Remotes are kept resolved, keyed by address and port, so that neither
+    // receiving nor sending has to deal with strings.
+    static uint64_t remote_key(const struct sockaddr_in& addr);
+
     std::mutex _remote_mutex{};
     struct Remote {
-        std::string ip{};
-        int port_number{0};
-
-        bool operator==(const UdpConnection::Remote& other)
-        {
-            return ip == other.ip && port_number == other.port_number;
-        }
-
+        struct sockaddr_in addr {};
         uint8_t system_id{0};
     };
-    std::vector<Remote> _remotes{};
+    std::unordered_map<uint64_t, Remote> _remotes{};
+
+    // Serializes senders and guards their scratch space, so that
+    // _remote_mutex is not held during the send syscalls.
+    std::mutex _send_mutex{};
+    std::vector<struct sockaddr_in> _send_addrs{};
+#if defined(LINUX)
+    std::vector<struct mmsghdr> _send_msgs{};
+#endif
+
+    std::atomic<uint64_t> _recv_syscalls{0};
+    std::atomic<uint64_t> _recv_datagrams{0};
+    std::atomic<uint64_t> _send_syscalls{0};
+    std::atomic<uint64_t> _send_datagrams{0};
+
+    // Whether the kernel timestamps datagrams, turned on once tracing is.
+    std::atomic_bool _timestamping{false};
 
     int _socket_fd{-1};
     std::thread* _recv_thread{nullptr};
@@ -0,0 +1,137 @@
+#include "udp_connection.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+#if defined(LINUX)
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace mavsdk;
+
+namespace {
+
+// Binds to a port picked by the system, so tests can run in parallel.
+int open_socket(int& port)
+{
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    socklen_t addr_len = sizeof(addr);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) != 0) {
+        close(fd);
+        return -1;
+    }
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+void send_to_local(int fd, int local_port, unsigned num_datagrams)
+{
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    addr.sin_port = htons(local_port);
+
+    const char data[] = "not mavlink";
+    for (unsigned i = 0; i < num_datagrams; ++i) {
+        sendto(fd, data, sizeof(data), 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    }
+}
+
+bool wait_for_datagrams(const UdpConnection& connection, uint64_t num_datagrams)
+{
+    for (unsigned i = 0; i < 100; ++i) {
+        if (connection.batch_stats().recv_datagrams >= num_datagrams) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(UdpConnection, ReceivesSeveralDatagramsPerSyscall)
+{
+    UdpConnection connection([](mavlink_message_t&) {}, "127.0.0.1", 0);
+    ASSERT_EQ(connection.start(), ConnectionResult::SUCCESS);
+
+    int port = 0;
+    const int fd = open_socket(port);
+    ASSERT_GE(fd, 0);
+
+    // Sending a burst while the receive thread is busy or asleep queues them
+    // up in the socket so that they are picked up together.
+    send_to_local(fd, connection.local_port(), 64);
+
+    EXPECT_TRUE(wait_for_datagrams(connection, 64));
+    const auto stats = connection.batch_stats();
+    EXPECT_EQ(stats.recv_datagrams, 64u);
+    EXPECT_LE(stats.recv_syscalls, stats.recv_datagrams);
+    EXPECT_GE(stats.datagrams_per_recv_syscall(), 1.0);
+
+    close(fd);
+    connection.stop();
+}
+
+TEST(UdpConnection, ReceivesWithIoReactor)
+{
+    auto io_reactor = std::make_shared<IoReactor>(1);
+    ASSERT_TRUE(io_reactor->start());
+
+    UdpConnection connection([](mavlink_message_t&) {}, "127.0.0.1", 0);
+    connection.set_io_reactor(io_reactor);
+    ASSERT_EQ(connection.start(), ConnectionResult::SUCCESS);
+
+    int port = 0;
+    const int fd = open_socket(port);
+    ASSERT_GE(fd, 0);
+    send_to_local(fd, connection.local_port(), 40);
+
+    EXPECT_TRUE(wait_for_datagrams(connection, 40));
+    EXPECT_EQ(connection.batch_stats().recv_datagrams, 40u);
+
+    close(fd);
+    connection.stop();
+    io_reactor->stop();
+}
+
+TEST(UdpConnection, SendsToAllRemotesInOneSyscall)
+{
+    UdpConnection connection([](mavlink_message_t&) {}, "127.0.0.1", 0);
+    ASSERT_EQ(connection.start(), ConnectionResult::SUCCESS);
+
+    int remote_port_1 = 0;
+    int remote_port_2 = 0;
+    const int remote_fd_1 = open_socket(remote_port_1);
+    const int remote_fd_2 = open_socket(remote_port_2);
+    ASSERT_GE(remote_fd_1, 0);
+    ASSERT_GE(remote_fd_2, 0);
+
+    connection.add_remote("127.0.0.1", remote_port_1);
+    connection.add_remote("127.0.0.1", remote_port_2);
+    // Adding the same remote again must not duplicate it.
+    connection.add_remote("127.0.0.1", remote_port_2);
+
+    mavlink_message_t message{};
+    mavlink_msg_heartbeat_pack(1, 1, &message, 0, 0, 0, 0, 0);
+    EXPECT_TRUE(connection.send_message(message));
+
+    const auto stats = connection.batch_stats();
+    EXPECT_EQ(stats.send_datagrams, 2u);
+    EXPECT_EQ(stats.send_syscalls, 1u);
+
+    char buffer[MAVLINK_MAX_PACKET_LEN];
+    EXPECT_GE(recv(remote_fd_1, buffer, sizeof(buffer), 0), 0);
+    EXPECT_GE(recv(remote_fd_2, buffer, sizeof(buffer), 0), 0);
+
+    close(remote_fd_1);
+    close(remote_fd_2);
+    connection.stop();
+}
+
+#endif
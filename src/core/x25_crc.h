@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mavsdk {
+
+// CRC-16/MCRF4XX, the X.25 checksum used by MAVLink (polynomial 0x1021
+// reflected, initial value 0xFFFF, no final xor).
+//
+// Instead of updating the checksum bit by bit for every byte like the stock
+// crc_accumulate, this uses lookup tables, and for longer buffers processes
+// eight bytes per step (slice-by-8).
+class X25Crc {
+public:
+    static constexpr uint16_t INIT = 0xFFFF;
+
+    X25Crc() = default;
+    explicit X25Crc(uint16_t crc) : _crc(crc) {}
+
+    void add(const uint8_t* data, size_t len) { _crc = accumulate(_crc, data, len); }
+    void add(uint8_t data) { _crc = accumulate(_crc, data); }
+
+    uint16_t get() const { return _crc; }
+
+    // Checksum of a whole buffer, starting from INIT.
+    static uint16_t calculate(const uint8_t* data, size_t len)
+    {
+        return accumulate(INIT, data, len);
+    }
+
+    static uint16_t accumulate(uint16_t crc, const uint8_t* data, size_t len);
+
+    static uint16_t accumulate(uint16_t crc, uint8_t data)
+    {
+        return static_cast<uint16_t>((crc >> 8) ^ table[0][(crc ^ data) & 0xFF]);
+    }
+
+    // table[0] is the usual byte-wise table, table[n] advances a byte by n
+    // more bytes of zeros.
+    static const uint16_t table[8][256];
+
+private:
+    uint16_t _crc{INIT};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,78 @@
+#include "x25_crc.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// The bit-wise update as done by the stock MAVLink crc_accumulate.
+uint16_t reference_crc(const uint8_t* data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t tmp = data[i] ^ static_cast<uint8_t>(crc & 0xFF);
+        tmp ^= static_cast<uint8_t>(tmp << 4);
+        crc = static_cast<uint16_t>((crc >> 8) ^ (tmp << 8) ^ (tmp << 3) ^ (tmp >> 4));
+    }
+    return crc;
+}
+
+std::vector<uint8_t> random_bytes(std::mt19937& rng, size_t len)
+{
+    std::uniform_int_distribution<unsigned> dist(0, 255);
+    std::vector<uint8_t> data(len);
+    for (auto& byte : data) {
+        byte = static_cast<uint8_t>(dist(rng));
+    }
+    return data;
+}
+
+} // namespace
+
+TEST(X25Crc, CheckValue)
+{
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    EXPECT_EQ(X25Crc::calculate(check, sizeof(check)), 0x6F91);
+}
+
+TEST(X25Crc, Empty)
+{
+    EXPECT_EQ(X25Crc::calculate(nullptr, 0), X25Crc::INIT);
+    EXPECT_EQ(X25Crc().get(), X25Crc::INIT);
+}
+
+TEST(X25Crc, SameAsReferenceForAllLengthsAndAlignments)
+{
+    std::mt19937 rng(42);
+    const auto data = random_bytes(rng, 300);
+
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t len = 0; len + offset <= data.size(); ++len) {
+            ASSERT_EQ(
+                X25Crc::calculate(&data[offset], len), reference_crc(&data[offset], len))
+                << "offset: " << offset << ", len: " << len;
+        }
+    }
+}
+
+TEST(X25Crc, IncrementalSameAsWhole)
+{
+    std::mt19937 rng(7);
+    const auto data = random_bytes(rng, 280);
+    const uint16_t expected = reference_crc(data.data(), data.size());
+
+    for (size_t split = 0; split <= data.size(); ++split) {
+        X25Crc crc;
+        crc.add(data.data(), split);
+        crc.add(data.data() + split, data.size() - split);
+        ASSERT_EQ(crc.get(), expected) << "split: " << split;
+    }
+
+    X25Crc crc;
+    for (auto byte : data) {
+        crc.add(byte);
+    }
+    EXPECT_EQ(crc.get(), expected);
+}
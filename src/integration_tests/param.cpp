@@ -117,3 +117,65 @@ TEST_F(SitlTest, ParamHappy)
         EXPECT_FLOAT_EQ(get_result3.second, get_result1.second);
     }
 }
+
+TEST_F(SitlTest, ParamGetAll)
+{
+    Mavsdk dc;
+
+    ConnectionResult ret = dc.add_udp_connection();
+    ASSERT_EQ(ret, ConnectionResult::SUCCESS);
+
+    // Wait for system to connect via heartbeat.
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+
+    auto& system = dc.system();
+    ASSERT_TRUE(system.has_autopilot());
+
+    auto param = std::make_shared<Param>(system);
+
+    const auto all_params = param->get_all_params();
+    ASSERT_EQ(all_params.first, Param::Result::SUCCESS);
+    EXPECT_GT(all_params.second.int_params.size(), 0u);
+    EXPECT_GT(all_params.second.float_params.size(), 0u);
+
+    bool found_hitl = false;
+    for (const auto& int_param : all_params.second.int_params) {
+        if (int_param.name == "SYS_HITL") {
+            found_hitl = true;
+        }
+    }
+    EXPECT_TRUE(found_hitl);
+
+    // The second time it comes from the cache.
+    const auto all_params_again = param->get_all_params();
+    ASSERT_EQ(all_params_again.first, Param::Result::SUCCESS);
+    EXPECT_EQ(all_params_again.second.int_params.size(), all_params.second.int_params.size());
+}
+
+TEST_F(SitlTest, ParamSetMany)
+{
+    Mavsdk dc;
+
+    ConnectionResult ret = dc.add_udp_connection();
+    ASSERT_EQ(ret, ConnectionResult::SUCCESS);
+
+    // Wait for system to connect via heartbeat.
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+
+    auto& system = dc.system();
+    ASSERT_TRUE(system.has_autopilot());
+
+    auto param = std::make_shared<Param>(system);
+
+    // Set everything to what it is already.
+    const auto all_params = param->get_all_params();
+    ASSERT_EQ(all_params.first, Param::Result::SUCCESS);
+
+    const auto results = param->set_params(all_params.second, 20);
+    EXPECT_EQ(
+        results.size(),
+        all_params.second.int_params.size() + all_params.second.float_params.size());
+    for (const auto& result : results) {
+        EXPECT_EQ(result.second, Param::Result::SUCCESS) << result.first;
+    }
+}
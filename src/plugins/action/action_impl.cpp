@@ -31,6 +31,7 @@ void ActionImpl::init()
 void ActionImpl::deinit()
 {
     _parent->unregister_all_mavlink_message_handlers(this);
+    _parent->release_msg_rates(this);
 }
 
 void ActionImpl::enable()
@@ -39,9 +40,10 @@ void ActionImpl::enable()
     // We use the async call here because we should not block in the init call because
     // we won't receive an answer anyway in init because the receive loop is not
     // called while we are being created here.
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_EXTENDED_SYS_STATE,
         1.0,
+        this,
         nullptr,
         MAVLinkCommands::DEFAULT_COMPONENT_ID_AUTOPILOT);
 
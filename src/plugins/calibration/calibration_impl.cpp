@@ -60,7 +60,13 @@ void CalibrationImpl::calibrate_gyro_async(const Calibration::calibration_callba
     command.params.param1 = 1.0f; // Gyro
     command.target_component_id = MAV_COMP_ID_AUTOPILOT1;
     _parent->send_command_async(
-        command, std::bind(&CalibrationImpl::command_result_callback, this, _1, _2));
+        command,
+        std::bind(&CalibrationImpl::command_result_callback, this, _1, _2),
+        std::bind(
+            &CalibrationImpl::command_result_callback,
+            this,
+            MAVLinkCommands::Result::IN_PROGRESS,
+            _1));
 }
 
 void CalibrationImpl::call_user_callback(
@@ -70,6 +76,7 @@ void CalibrationImpl::call_user_callback(
 {
     if (callback) {
         _parent->call_user_callback(
+            _calibration_strand,
             [callback, result, progress_data]() { callback(result, progress_data); });
     }
 }
@@ -99,7 +106,13 @@ void CalibrationImpl::calibrate_accelerometer_async(
     command.params.param5 = 1.0f; // Accel
     command.target_component_id = MAV_COMP_ID_AUTOPILOT1;
     _parent->send_command_async(
-        command, std::bind(&CalibrationImpl::command_result_callback, this, _1, _2));
+        command,
+        std::bind(&CalibrationImpl::command_result_callback, this, _1, _2),
+        std::bind(
+            &CalibrationImpl::command_result_callback,
+            this,
+            MAVLinkCommands::Result::IN_PROGRESS,
+            _1));
 }
 
 void CalibrationImpl::calibrate_magnetometer_async(
@@ -127,7 +140,13 @@ void CalibrationImpl::calibrate_magnetometer_async(
     command.params.param2 = 1.0f; // Mag
     command.target_component_id = MAV_COMP_ID_AUTOPILOT1;
     _parent->send_command_async(
-        command, std::bind(&CalibrationImpl::command_result_callback, this, _1, _2));
+        command,
+        std::bind(&CalibrationImpl::command_result_callback, this, _1, _2),
+        std::bind(
+            &CalibrationImpl::command_result_callback,
+            this,
+            MAVLinkCommands::Result::IN_PROGRESS,
+            _1));
 }
 
 void CalibrationImpl::calibrate_gimbal_accelerometer_async(
@@ -155,7 +174,13 @@ void CalibrationImpl::calibrate_gimbal_accelerometer_async(
     command.params.param5 = 1.0f; // Accel
     command.target_component_id = MAV_COMP_ID_GIMBAL;
     _parent->send_command_async(
-        command, std::bind(&CalibrationImpl::command_result_callback, this, _1, _2));
+        command,
+        std::bind(&CalibrationImpl::command_result_callback, this, _1, _2),
+        std::bind(
+            &CalibrationImpl::command_result_callback,
+            this,
+            MAVLinkCommands::Result::IN_PROGRESS,
+            _1));
 }
 
 void CalibrationImpl::cancel_calibration()
@@ -4,6 +4,7 @@
 #include "calibration_statustext_parser.h"
 #include "mavlink_include.h"
 #include "plugin_impl_base.h"
+#include "strand.h"
 #include "system.h"
 
 namespace mavsdk {
@@ -67,6 +68,8 @@ private:
     } _state{State::NONE};
 
     Calibration::calibration_callback_t _calibration_callback{nullptr};
+    // Keeps progress and result updates in order.
+    Strand _calibration_strand{};
 };
 
 } // namespace mavsdk
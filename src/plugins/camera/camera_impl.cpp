@@ -830,6 +830,7 @@ void CameraImpl::process_camera_image_captured(const mavlink_message_t& message)
 
             const auto temp_callback = _capture_info.callback;
             _parent->call_user_callback(
+                _capture_info.strand,
                 [temp_callback, capture_info]() { temp_callback(capture_info); });
         }
     }
@@ -1008,7 +1009,8 @@ void CameraImpl::notify_video_stream_info()
     if (_video_stream_info.subscription_callback) {
         const auto temp_callback = _video_stream_info.subscription_callback;
         const auto temp_info = _video_stream_info.info;
-        _parent->call_user_callback([temp_callback, temp_info]() { temp_callback(temp_info); });
+        _parent->call_user_callback(
+            _video_stream_info.strand, [temp_callback, temp_info]() { temp_callback(temp_info); });
     }
 }
 
@@ -1030,7 +1032,8 @@ void CameraImpl::check_status()
         if (_status.subscription_callback) {
             const auto temp_callback = _status.subscription_callback;
             const auto temp_data = _status.data;
-            _parent->call_user_callback([temp_callback, temp_data]() { temp_callback(temp_data); });
+            _parent->call_user_callback(
+                _status.strand, [temp_callback, temp_data]() { temp_callback(temp_data); });
         }
 
         _status.received_camera_capture_status = false;
@@ -1123,7 +1126,7 @@ void CameraImpl::notify_mode(const Camera::Mode mode)
         return;
     }
 
-    _parent->call_user_callback([mode, temp_callback]() { temp_callback(mode); });
+    _parent->call_user_callback(_mode.strand, [mode, temp_callback]() { temp_callback(mode); });
 }
 
 void CameraImpl::receive_get_mode_command_result(MAVLinkCommands::Result command_result)
@@ -1440,9 +1443,13 @@ void CameraImpl::notify_current_settings()
 
     // We create a function object in order to move be able to move the settings into it.
     // FIXME: Use C++14 where this is not necessary anymore.
-    _parent->call_user_callback(std::bind(
-        [temp_callback](const std::vector<Camera::Setting>& settings) { temp_callback(settings); },
-        std::move(current_settings)));
+    _parent->call_user_callback(
+        _subscribe_current_settings.strand,
+        std::bind(
+            [temp_callback](const std::vector<Camera::Setting>& settings) {
+                temp_callback(settings);
+            },
+            std::move(current_settings)));
 }
 
 void CameraImpl::notify_possible_setting_options()
@@ -1479,11 +1486,13 @@ void CameraImpl::notify_possible_setting_options()
 
     // We create a function object in order to move be able to move the settings into it.
     // FIXME: Use C++14 where this is not necessary anymore.
-    _parent->call_user_callback(std::bind(
-        [temp_callback](const std::vector<Camera::SettingOptions>& options) {
-            temp_callback(options);
-        },
-        std::move(possible_setting_options)));
+    _parent->call_user_callback(
+        _subscribe_possible_setting_options.strand,
+        std::bind(
+            [temp_callback](const std::vector<Camera::SettingOptions>& options) {
+                temp_callback(options);
+            },
+            std::move(possible_setting_options)));
 }
 
 void CameraImpl::refresh_params()
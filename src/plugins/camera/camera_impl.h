@@ -4,6 +4,7 @@
 #include "mavlink_include.h"
 #include "plugins/camera/camera.h"
 #include "plugin_impl_base.h"
+#include "strand.h"
 #include "system.h"
 
 namespace mavsdk {
@@ -176,6 +177,7 @@ private:
 
         Camera::subscribe_status_callback_t subscription_callback{nullptr};
         void* call_every_cookie{nullptr};
+        Strand strand{};
     } _status{};
 
     static constexpr double DEFAULT_TIMEOUT_S = 3.0;
@@ -186,6 +188,7 @@ private:
         void* timeout_cookie{nullptr};
 
         Camera::subscribe_mode_callback_t subscription_callback{nullptr};
+        Strand strand{};
     } _mode{};
 
     struct {
@@ -196,6 +199,7 @@ private:
     struct {
         std::mutex mutex{};
         Camera::capture_info_callback_t callback{nullptr};
+        Strand strand{};
     } _capture_info{};
 
     struct {
@@ -207,6 +211,7 @@ private:
 
         Camera::subscribe_video_stream_info_callback_t subscription_callback{nullptr};
         void* call_every_cookie{nullptr};
+        Strand strand{};
     } _video_stream_info{};
 
     struct {
@@ -217,11 +222,13 @@ private:
     struct {
         std::mutex mutex{};
         Camera::subscribe_current_settings_callback_t callback{nullptr};
+        Strand strand{};
     } _subscribe_current_settings{};
 
     struct {
         std::mutex mutex{};
         Camera::subscribe_possible_setting_options_callback_t callback{nullptr};
+        Strand strand{};
     } _subscribe_possible_setting_options{};
 };
 
@@ -0,0 +1,70 @@
+#include "crc32.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// Bit by bit, polynomial 0xedb88320, without pre and post inversion as used
+// by the FTP protocol.
+uint32_t reference_crc32(const uint8_t* data, size_t len, uint32_t crc = 0)
+{
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        for (unsigned bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320 : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+std::vector<uint8_t> random_bytes(size_t len)
+{
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<unsigned> dist(0, 255);
+    std::vector<uint8_t> data(len);
+    for (auto& byte : data) {
+        byte = static_cast<uint8_t>(dist(rng));
+    }
+    return data;
+}
+
+} // namespace
+
+TEST(Crc32, CheckValue)
+{
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    Crc32 crc;
+    crc.add(check, sizeof(check));
+    EXPECT_EQ(static_cast<uint32_t>(crc.get()), 0x2dfd2d88u);
+}
+
+TEST(Crc32, SameAsReferenceForAllLengthsAndAlignments)
+{
+    const auto data = random_bytes(200);
+
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t len = 0; len + offset <= data.size(); ++len) {
+            Crc32 crc;
+            ASSERT_EQ(
+                crc.add(&data[offset], static_cast<uint32_t>(len)),
+                reference_crc32(&data[offset], len))
+                << "offset: " << offset << ", len: " << len;
+        }
+    }
+}
+
+TEST(Crc32, IncrementalSameAsWhole)
+{
+    const auto data = random_bytes(1000);
+    const uint32_t expected = reference_crc32(data.data(), data.size());
+
+    for (size_t split = 0; split <= data.size(); split += 7) {
+        Crc32 crc;
+        crc.add(data.data(), static_cast<uint32_t>(split));
+        crc.add(data.data() + split, static_cast<uint32_t>(data.size() - split));
+        ASSERT_EQ(static_cast<uint32_t>(crc.get()), expected) << "split: " << split;
+    }
+}
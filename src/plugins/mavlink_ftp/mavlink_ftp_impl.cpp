@@ -1,8 +1,10 @@
+#include <algorithm>
 #include <functional>
 #include <iostream>
 
 #include <dirent.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -1123,12 +1125,39 @@ MavlinkFTP::Result MavlinkFTPImpl::calc_local_file_crc32(const std::string& path
         return MavlinkFTP::Result::FILE_IO_ERROR;
     }
 
-    // Read whole file in buffer size chunks
     Crc32 checksum;
-    char buffer[18392];
+
+    // Map the whole file if we can, that saves copying it through a buffer.
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0 &&
+        static_cast<uint64_t>(file_stat.st_size) <= SIZE_MAX) {
+        const size_t file_size = static_cast<size_t>(file_stat.st_size);
+        void* mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            madvise(mapped, file_size, MADV_SEQUENTIAL);
+
+            const uint8_t* data = static_cast<const uint8_t*>(mapped);
+            size_t remaining = file_size;
+            while (remaining > 0) {
+                const uint32_t chunk =
+                    static_cast<uint32_t>(std::min<size_t>(remaining, UINT32_MAX));
+                checksum.add(data, chunk);
+                data += chunk;
+                remaining -= chunk;
+            }
+
+            munmap(mapped, file_size);
+            close(fd);
+            csum = checksum.get();
+            return MavlinkFTP::Result::SUCCESS;
+        }
+    }
+
+    // Otherwise read whole file in large chunks.
+    std::vector<uint8_t> buffer(256 * 1024);
     ssize_t bytes_read;
     do {
-        bytes_read = ::read(fd, buffer, sizeof(buffer));
+        bytes_read = ::read(fd, buffer.data(), buffer.size());
 
         if (bytes_read < 0) {
             int r_errno = errno;
@@ -1137,8 +1166,8 @@ MavlinkFTP::Result MavlinkFTPImpl::calc_local_file_crc32(const std::string& path
             return MavlinkFTP::Result::FILE_IO_ERROR;
         }
 
-        checksum.add((uint8_t*)buffer, bytes_read);
-    } while (bytes_read == sizeof(buffer));
+        checksum.add(buffer.data(), static_cast<uint32_t>(bytes_read));
+    } while (bytes_read > 0);
 
     close(fd);
 
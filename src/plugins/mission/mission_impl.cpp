@@ -1279,10 +1279,11 @@ void MissionImpl::report_progress()
 
     if (should_report) {
         std::lock_guard<std::recursive_mutex> lock(_mission_data.mutex);
-        _parent->call_user_callback([temp_callback, current, total]() {
-            LogDebug() << "current: " << current << ", total: " << total;
-            temp_callback(current, total);
-        });
+        _parent->call_user_callback(
+            _mission_data.progress_strand, [temp_callback, current, total]() {
+                LogDebug() << "current: " << current << ", total: " << total;
+                temp_callback(current, total);
+            });
     }
 }
 
@@ -8,6 +8,7 @@
 #include "mavlink_include.h"
 #include "plugins/mission/mission.h"
 #include "plugin_impl_base.h"
+#include "strand.h"
 #include "system.h"
 
 namespace mavsdk {
@@ -129,6 +130,7 @@ private:
         Mission::result_callback_t result_callback{nullptr};
         Mission::mission_items_and_result_callback_t mission_items_and_result_callback{nullptr};
         Mission::progress_callback_t progress_callback{nullptr};
+        Strand progress_strand{};
         int last_current_reported_mission_item{-1};
         int last_total_reported_mission_item{-1};
     } _mission_data{};
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "plugin_base.h"
 
@@ -90,6 +92,65 @@ public:
      */
     Result set_param_float(const std::string& name, float value);
 
+    /**
+     * @brief Type for an int parameter.
+     */
+    struct IntParam {
+        std::string name; /**< @brief Name of the parameter. */
+        int32_t value; /**< @brief Value of the parameter. */
+    };
+
+    /**
+     * @brief Type for a float parameter.
+     */
+    struct FloatParam {
+        std::string name; /**< @brief Name of the parameter. */
+        float value; /**< @brief Value of the parameter. */
+    };
+
+    /**
+     * @brief Type collecting all parameters of a system.
+     */
+    struct AllParams {
+        std::vector<IntParam> int_params{}; /**< @brief All int parameters, sorted by name. */
+        std::vector<FloatParam> float_params{}; /**< @brief All float parameters, sorted by name. */
+    };
+
+    /**
+     * @brief Get all parameters of the autopilot.
+     *
+     * The first call downloads the complete parameter set, re-requesting any parameters which
+     * got lost. Later calls are answered from a cache which is kept up to date with the
+     * parameter values the autopilot sends.
+     *
+     * @return a pair of the result of the request and all params (if successful).
+     */
+    std::pair<Result, AllParams> get_all_params();
+
+    /**
+     * @brief Set a directory to keep the parameters in between sessions.
+     *
+     * If the autopilot reports a hash of its parameter set (as PX4 does), parameters are stored
+     * per system and hash, and `get_all_params()` uses the stored parameters instead of
+     * downloading them again as long as the hash matches. The directory needs to exist.
+     *
+     * @param path Directory to use, an empty string disables the cache (default).
+     */
+    void set_cache_directory(const std::string& path);
+
+    /**
+     * @brief Set many parameters at once, e.g. to load a vehicle configuration.
+     *
+     * Instead of waiting for the confirmation of each parameter before sending the next one, up
+     * to `window` parameters are sent at a time. Parameters which are not confirmed are sent
+     * again.
+     *
+     * @param params Parameters to set.
+     * @param window Maximum number of parameters waiting for their confirmation.
+     * @return result of the request for each parameter by name.
+     */
+    std::map<std::string, Result> set_params(const AllParams& params, unsigned window = 10);
+
     /**
      * @brief Copy Constructor (object is not copyable).
      */
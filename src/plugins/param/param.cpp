@@ -27,6 +27,21 @@ Param::Result Param::set_param_float(const std::string& name, float value)
     return _impl->set_param_float(name, value);
 }
 
+std::pair<Param::Result, Param::AllParams> Param::get_all_params()
+{
+    return _impl->get_all_params();
+}
+
+void Param::set_cache_directory(const std::string& path)
+{
+    _impl->set_cache_directory(path);
+}
+
+std::map<std::string, Param::Result> Param::set_params(const AllParams& params, unsigned window)
+{
+    return _impl->set_params(params, window);
+}
+
 std::string Param::result_str(Result result)
 {
     switch (result) {
@@ -47,6 +47,52 @@ Param::Result ParamImpl::set_param_float(const std::string& name, float value)
     return result_from_mavlink_parameters_result(result);
 }
 
+std::pair<Param::Result, Param::AllParams> ParamImpl::get_all_params()
+{
+    auto result = _parent->get_all_params();
+
+    Param::AllParams all_params{};
+    for (const auto& param : result.second) {
+        if (param.second.is_int32()) {
+            all_params.int_params.push_back(Param::IntParam{param.first, param.second.get_int32()});
+        } else if (param.second.is_float()) {
+            all_params.float_params.push_back(
+                Param::FloatParam{param.first, param.second.get_float()});
+        }
+    }
+
+    return std::make_pair<>(result_from_mavlink_parameters_result(result.first), all_params);
+}
+
+void ParamImpl::set_cache_directory(const std::string& path)
+{
+    _parent->set_param_cache_directory(path);
+}
+
+std::map<std::string, Param::Result>
+ParamImpl::set_params(const Param::AllParams& params, unsigned window)
+{
+    std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> values;
+    values.reserve(params.int_params.size() + params.float_params.size());
+
+    for (const auto& int_param : params.int_params) {
+        MAVLinkParameters::ParamValue value;
+        value.set_int32(int_param.value);
+        values.push_back(std::make_pair(int_param.name, value));
+    }
+    for (const auto& float_param : params.float_params) {
+        MAVLinkParameters::ParamValue value;
+        value.set_float(float_param.value);
+        values.push_back(std::make_pair(float_param.name, value));
+    }
+
+    std::map<std::string, Param::Result> results;
+    for (const auto& result : _parent->set_params(values, window)) {
+        results[result.first] = result_from_mavlink_parameters_result(result.second);
+    }
+    return results;
+}
+
 Param::Result ParamImpl::result_from_mavlink_parameters_result(MAVLinkParameters::Result result)
 {
     switch (result) {
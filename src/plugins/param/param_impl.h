@@ -27,6 +27,13 @@ public:
 
     Param::Result set_param_float(const std::string& name, float value);
 
+    std::pair<Param::Result, Param::AllParams> get_all_params();
+
+    void set_cache_directory(const std::string& path);
+
+    std::map<std::string, Param::Result>
+    set_params(const Param::AllParams& params, unsigned window);
+
 private:
     static Param::Result result_from_mavlink_parameters_result(MAVLinkParameters::Result result);
 };
@@ -1197,6 +1197,79 @@ public:
      */
     void unix_epoch_time_async(unix_epoch_time_callback_t callback);
 
+    /**
+     * @brief Subscriptions which can be configured using `set_delivery_policy()`.
+     */
+    enum class Subscription {
+        POSITION_VELOCITY_NED, /**< @brief Subscription of `position_velocity_ned_async()`. */
+        POSITION, /**< @brief Subscription of `position_async()`. */
+        HOME_POSITION, /**< @brief Subscription of `home_position_async()`. */
+        IN_AIR, /**< @brief Subscription of `in_air_async()`. */
+        STATUS_TEXT, /**< @brief Subscription of `status_text_async()`. */
+        ARMED, /**< @brief Subscription of `armed_async()`. */
+        ATTITUDE_QUATERNION, /**< @brief Subscription of `attitude_quaternion_async()`. */
+        ATTITUDE_EULER_ANGLE, /**< @brief Subscription of `attitude_euler_angle_async()`. */
+        ATTITUDE_ANGULAR_VELOCITY_BODY, /**< @brief Subscription of
+                                           `attitude_angular_velocity_body_async()`. */
+        CAMERA_ATTITUDE_QUATERNION, /**< @brief Subscription of
+                                       `camera_attitude_quaternion_async()`. */
+        CAMERA_ATTITUDE_EULER_ANGLE, /**< @brief Subscription of
+                                        `camera_attitude_euler_angle_async()`. */
+        GROUND_SPEED_NED, /**< @brief Subscription of `ground_speed_ned_async()`. */
+        IMU_READING_NED, /**< @brief Subscription of `imu_reading_ned_async()`. */
+        GPS_INFO, /**< @brief Subscription of `gps_info_async()`. */
+        BATTERY, /**< @brief Subscription of `battery_async()`. */
+        FLIGHT_MODE, /**< @brief Subscription of `flight_mode_async()`. */
+        HEALTH, /**< @brief Subscription of `health_async()`. */
+        HEALTH_ALL_OK, /**< @brief Subscription of `health_all_ok_async()`. */
+        LANDED_STATE, /**< @brief Subscription of `landed_state_async()`. */
+        RC_STATUS, /**< @brief Subscription of `rc_status_async()`. */
+        UNIX_EPOCH_TIME, /**< @brief Subscription of `unix_epoch_time_async()`. */
+        ACTUATOR_CONTROL_TARGET, /**< @brief Subscription of `actuator_control_target_async()`. */
+        ACTUATOR_OUTPUT_STATUS, /**< @brief Subscription of `actuator_output_status_async()`. */
+        ODOMETRY /**< @brief Subscription of `odometry_async()`. */
+    };
+
+    /**
+     * @brief How updates are delivered to a subscriber which is slower than the updates.
+     *
+     * Updates of a subscription are always delivered one at a time and in order.
+     */
+    enum class DeliveryPolicy {
+        ALL, /**< @brief Queue and deliver every update (default). */
+        LATEST, /**< @brief Only deliver the newest update, drop older ones which are pending. */
+        LAST_N /**< @brief Deliver the newest N updates, drop older ones which are pending. */
+    };
+
+    /**
+     * @brief Delivery statistics of a subscription.
+     */
+    struct SubscriptionStats {
+        size_t queue_depth; /**< @brief Number of updates waiting to be delivered. */
+        uint64_t num_delivered; /**< @brief Number of updates delivered so far. */
+        uint64_t num_dropped; /**< @brief Number of updates dropped because of the policy. */
+    };
+
+    /**
+     * @brief Set the delivery policy of a subscription.
+     *
+     * The policy applies to the current and to future callbacks of the subscription.
+     *
+     * @param subscription The subscription to configure.
+     * @param policy How updates are queued for the callback.
+     * @param depth Maximum number of pending updates for `DeliveryPolicy::LAST_N`.
+     */
+    void set_delivery_policy(
+        Subscription subscription, DeliveryPolicy policy, unsigned depth = 1);
+
+    /**
+     * @brief Get the delivery statistics of a subscription.
+     *
+     * @param subscription The subscription to get the statistics for.
+     * @return Queue depth and delivered/dropped counters.
+     */
+    SubscriptionStats subscription_stats(Subscription subscription) const;
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
@@ -383,6 +383,17 @@ void Telemetry::odometry_async(odometry_callback_t callback)
     return _impl->odometry_async(callback);
 }
 
+void Telemetry::set_delivery_policy(
+    Subscription subscription, DeliveryPolicy policy, unsigned depth)
+{
+    _impl->set_delivery_policy(subscription, policy, depth);
+}
+
+Telemetry::SubscriptionStats Telemetry::subscription_stats(Subscription subscription) const
+{
+    return _impl->subscription_stats(subscription);
+}
+
 std::string Telemetry::flight_mode_str(FlightMode flight_mode)
 {
     switch (flight_mode) {
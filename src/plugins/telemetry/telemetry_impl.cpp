@@ -102,6 +102,7 @@ void TelemetryImpl::deinit()
     _parent->unregister_timeout_handler(_unix_epoch_timeout_cookie);
     _parent->unregister_param_changed_handler(this);
     _parent->unregister_all_mavlink_message_handlers(this);
+    _parent->release_msg_rates(this);
 }
 
 void TelemetryImpl::enable()
@@ -175,7 +176,7 @@ void TelemetryImpl::disable() {}
 Telemetry::Result TelemetryImpl::set_rate_position_velocity_ned(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_LOCAL_POSITION_NED, rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_LOCAL_POSITION_NED, rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_position(double rate_hz)
@@ -184,31 +185,31 @@ Telemetry::Result TelemetryImpl::set_rate_position(double rate_hz)
     double max_rate_hz = std::max(_position_rate_hz, _ground_speed_ned_rate_hz);
 
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, max_rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, max_rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_home_position(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_HOME_POSITION, rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_HOME_POSITION, rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_in_air(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_EXTENDED_SYS_STATE, rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_EXTENDED_SYS_STATE, rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_attitude(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_ATTITUDE_QUATERNION, rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_ATTITUDE_QUATERNION, rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_camera_attitude(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_MOUNT_ORIENTATION, rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_MOUNT_ORIENTATION, rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_ground_speed_ned(double rate_hz)
@@ -217,57 +218,58 @@ Telemetry::Result TelemetryImpl::set_rate_ground_speed_ned(double rate_hz)
     double max_rate_hz = std::max(_position_rate_hz, _ground_speed_ned_rate_hz);
 
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, max_rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, max_rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_imu_reading_ned(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_HIGHRES_IMU, rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_HIGHRES_IMU, rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_gps_info(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_GPS_RAW_INT, rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_GPS_RAW_INT, rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_battery(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_SYS_STATUS, rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_SYS_STATUS, rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_rc_status(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_RC_CHANNELS, rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_RC_CHANNELS, rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_actuator_control_target(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET, rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET, rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_actuator_output_status(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_ACTUATOR_OUTPUT_STATUS, rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_ACTUATOR_OUTPUT_STATUS, rate_hz, this));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_odometry(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_ODOMETRY, rate_hz));
+        _parent->request_msg_rate(MAVLINK_MSG_ID_ODOMETRY, rate_hz, this));
 }
 
 void TelemetryImpl::set_rate_position_velocity_ned_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_LOCAL_POSITION_NED,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
@@ -276,43 +278,48 @@ void TelemetryImpl::set_rate_position_async(double rate_hz, Telemetry::result_ca
     _position_rate_hz = rate_hz;
     double max_rate_hz = std::max(_position_rate_hz, _ground_speed_ned_rate_hz);
 
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
         max_rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
 void TelemetryImpl::set_rate_home_position_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_HOME_POSITION,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
 void TelemetryImpl::set_rate_in_air_async(double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_EXTENDED_SYS_STATE,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
 void TelemetryImpl::set_rate_attitude_async(double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
 void TelemetryImpl::set_rate_camera_attitude_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_MOUNT_ORIENTATION,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
@@ -322,77 +329,86 @@ void TelemetryImpl::set_rate_ground_speed_ned_async(
     _ground_speed_ned_rate_hz = rate_hz;
     double max_rate_hz = std::max(_position_rate_hz, _ground_speed_ned_rate_hz);
 
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
         max_rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
 void TelemetryImpl::set_rate_imu_reading_ned_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_HIGHRES_IMU,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
 void TelemetryImpl::set_rate_gps_info_async(double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_GPS_RAW_INT,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
 void TelemetryImpl::set_rate_battery_async(double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_SYS_STATUS,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
 void TelemetryImpl::set_rate_rc_status_async(double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_RC_CHANNELS,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
 void TelemetryImpl::set_rate_unix_epoch_time_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_UTM_GLOBAL_POSITION,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
 void TelemetryImpl::set_rate_actuator_control_target_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
 void TelemetryImpl::set_rate_actuator_output_status_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_ACTUATOR_OUTPUT_STATUS,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
 void TelemetryImpl::set_rate_odometry_async(double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    _parent->request_msg_rate_async(
         MAVLINK_MSG_ID_ODOMETRY,
         rate_hz,
+        this,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
@@ -436,10 +452,8 @@ void TelemetryImpl::process_position_velocity_ned(const mavlink_message_t& messa
                                                               local_position.vy,
                                                               local_position.vz}));
 
-    if (_position_velocity_ned_subscription) {
-        auto callback = _position_velocity_ned_subscription;
-        auto arg = get_position_velocity_ned();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_position_velocity_ned_subscription.is_subscribed()) {
+        _position_velocity_ned_subscription.deliver(*_parent, get_position_velocity_ned());
     }
 }
 
@@ -455,16 +469,12 @@ void TelemetryImpl::process_global_position_int(const mavlink_message_t& message
                           global_position_int.vy * 1e-2f,
                           global_position_int.vz * 1e-2f});
 
-    if (_position_subscription) {
-        auto callback = _position_subscription;
-        auto arg = get_position();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_position_subscription.is_subscribed()) {
+        _position_subscription.deliver(*_parent, get_position());
     }
 
-    if (_ground_speed_ned_subscription) {
-        auto callback = _ground_speed_ned_subscription;
-        auto arg = get_ground_speed_ned();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_ground_speed_ned_subscription.is_subscribed()) {
+        _ground_speed_ned_subscription.deliver(*_parent, get_ground_speed_ned());
     }
 }
 
@@ -480,10 +490,8 @@ void TelemetryImpl::process_home_position(const mavlink_message_t& message)
 
     set_health_home_position(true);
 
-    if (_home_position_subscription) {
-        auto callback = _home_position_subscription;
-        auto arg = get_home_position();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_home_position_subscription.is_subscribed()) {
+        _home_position_subscription.deliver(*_parent, get_home_position());
     }
 }
 
@@ -505,22 +513,17 @@ void TelemetryImpl::process_attitude_quaternion(const mavlink_message_t& message
 
     set_attitude_angular_velocity_body(angular_velocity_body);
 
-    if (_attitude_quaternion_subscription) {
-        auto callback = _attitude_quaternion_subscription;
-        auto arg = get_attitude_quaternion();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_attitude_quaternion_subscription.is_subscribed()) {
+        _attitude_quaternion_subscription.deliver(*_parent, get_attitude_quaternion());
     }
 
-    if (_attitude_euler_angle_subscription) {
-        auto callback = _attitude_euler_angle_subscription;
-        auto arg = get_attitude_euler_angle();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_attitude_euler_angle_subscription.is_subscribed()) {
+        _attitude_euler_angle_subscription.deliver(*_parent, get_attitude_euler_angle());
     }
 
-    if (_attitude_angular_velocity_body_subscription) {
-        auto callback = _attitude_angular_velocity_body_subscription;
-        auto arg = get_attitude_angular_velocity_body();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_attitude_angular_velocity_body_subscription.is_subscribed()) {
+        _attitude_angular_velocity_body_subscription.deliver(
+            *_parent, get_attitude_angular_velocity_body());
     }
 }
 
@@ -534,16 +537,14 @@ void TelemetryImpl::process_mount_orientation(const mavlink_message_t& message)
 
     set_camera_attitude_euler_angle(euler_angle);
 
-    if (_camera_attitude_quaternion_subscription) {
-        auto callback = _camera_attitude_quaternion_subscription;
-        auto arg = get_camera_attitude_quaternion();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_camera_attitude_quaternion_subscription.is_subscribed()) {
+        _camera_attitude_quaternion_subscription.deliver(
+            *_parent, get_camera_attitude_quaternion());
     }
 
-    if (_camera_attitude_euler_angle_subscription) {
-        auto callback = _camera_attitude_euler_angle_subscription;
-        auto arg = get_camera_attitude_euler_angle();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_camera_attitude_euler_angle_subscription.is_subscribed()) {
+        _camera_attitude_euler_angle_subscription.deliver(
+            *_parent, get_camera_attitude_euler_angle());
     }
 }
 
@@ -562,10 +563,8 @@ void TelemetryImpl::process_imu_reading_ned(const mavlink_message_t& message)
                                                   highres_imu.zmag,
                                                   highres_imu.temperature}));
 
-    if (_imu_reading_ned_subscription) {
-        auto callback = _imu_reading_ned_subscription;
-        auto arg = get_imu_reading_ned();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_imu_reading_ned_subscription.is_subscribed()) {
+        _imu_reading_ned_subscription.deliver(*_parent, get_imu_reading_ned());
     }
 }
 
@@ -584,10 +583,8 @@ void TelemetryImpl::process_gps_raw_int(const mavlink_message_t& message)
     // Local is not different from global for now until things like flow are in place.
     set_health_local_position(gps_ok);
 
-    if (_gps_info_subscription) {
-        auto callback = _gps_info_subscription;
-        auto arg = get_gps_info();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_gps_info_subscription.is_subscribed()) {
+        _gps_info_subscription.deliver(*_parent, get_gps_info());
     }
 
     _parent->refresh_timeout_handler(_gps_raw_timeout_cookie);
@@ -601,10 +598,8 @@ void TelemetryImpl::process_extended_sys_state(const mavlink_message_t& message)
     Telemetry::LandedState landed_state = to_landed_state(extended_sys_state);
     set_landed_state(landed_state);
 
-    if (_landed_state_subscription) {
-        auto callback = _landed_state_subscription;
-        auto arg = get_landed_state();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_landed_state_subscription.is_subscribed()) {
+        _landed_state_subscription.deliver(*_parent, get_landed_state());
     }
 
     if (extended_sys_state.landed_state == MAV_LANDED_STATE_IN_AIR ||
@@ -616,10 +611,8 @@ void TelemetryImpl::process_extended_sys_state(const mavlink_message_t& message)
     }
     // If landed_state is undefined, we use what we have received last.
 
-    if (_in_air_subscription) {
-        auto callback = _in_air_subscription;
-        auto arg = in_air();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_in_air_subscription.is_subscribed()) {
+        _in_air_subscription.deliver(*_parent, in_air());
     }
 }
 
@@ -632,10 +625,8 @@ void TelemetryImpl::process_sys_status(const mavlink_message_t& message)
          // FIXME: it is strange calling it percent when the range goes from 0 to 1.
          sys_status.battery_remaining * 1e-2f}));
 
-    if (_battery_subscription) {
-        auto callback = _battery_subscription;
-        auto arg = get_battery();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_battery_subscription.is_subscribed()) {
+        _battery_subscription.deliver(*_parent, get_battery());
     }
 }
 
@@ -650,30 +641,23 @@ void TelemetryImpl::process_heartbeat(const mavlink_message_t& message)
 
     set_armed(((heartbeat.base_mode & MAV_MODE_FLAG_SAFETY_ARMED) ? true : false));
 
-    if (_armed_subscription) {
-        auto callback = _armed_subscription;
-        auto arg = armed();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_armed_subscription.is_subscribed()) {
+        _armed_subscription.deliver(*_parent, armed());
     }
 
-    if (_flight_mode_subscription) {
-        auto callback = _flight_mode_subscription;
+    if (_flight_mode_subscription.is_subscribed()) {
         // The flight mode is already parsed in SystemImpl, so we can take it
         // from there.  This assumes that SystemImpl gets called first because
         // it's earlier in the callback list.
-        auto arg = telemetry_flight_mode_from_flight_mode(_parent->get_flight_mode());
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+        _flight_mode_subscription.deliver(
+            *_parent, telemetry_flight_mode_from_flight_mode(_parent->get_flight_mode()));
     }
 
-    if (_health_subscription) {
-        auto callback = _health_subscription;
-        auto arg = get_health();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_health_subscription.is_subscribed()) {
+        _health_subscription.deliver(*_parent, get_health());
     }
-    if (_health_all_ok_subscription) {
-        auto callback = _health_all_ok_subscription;
-        auto arg = get_health_all_ok();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_health_all_ok_subscription.is_subscribed()) {
+        _health_all_ok_subscription.deliver(*_parent, get_health_all_ok());
     }
 }
 
@@ -709,8 +693,8 @@ void TelemetryImpl::process_statustext(const mavlink_message_t& message)
 
     set_status_text({type, text});
 
-    if (_status_text_subscription) {
-        _status_text_subscription(get_status_text());
+    if (_status_text_subscription.is_subscribed()) {
+        _status_text_subscription.deliver(*_parent, get_status_text());
     }
 }
 
@@ -722,10 +706,8 @@ void TelemetryImpl::process_rc_channels(const mavlink_message_t& message)
     bool rc_ok = (rc_channels.chancount > 0);
     set_rc_status(rc_ok, rc_channels.rssi);
 
-    if (_rc_status_subscription) {
-        auto callback = _rc_status_subscription;
-        auto arg = get_rc_status();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_rc_status_subscription.is_subscribed()) {
+        _rc_status_subscription.deliver(*_parent, get_rc_status());
     }
 
     _parent->refresh_timeout_handler(_rc_channels_timeout_cookie);
@@ -738,10 +720,8 @@ void TelemetryImpl::process_unix_epoch_time(const mavlink_message_t& message)
 
     set_unix_epoch_time_us(utm_global_position.time);
 
-    if (_unix_epoch_time_subscription) {
-        auto callback = _unix_epoch_time_subscription;
-        auto arg = get_unix_epoch_time_us();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_unix_epoch_time_subscription.is_subscribed()) {
+        _unix_epoch_time_subscription.deliver(*_parent, get_unix_epoch_time_us());
     }
 
     _parent->refresh_timeout_handler(_unix_epoch_timeout_cookie);
@@ -757,10 +737,8 @@ void TelemetryImpl::process_actuator_control_target(const mavlink_message_t& mes
 
     set_actuator_control_target(group, controls);
 
-    if (_actuator_control_target_subscription) {
-        auto callback = _actuator_control_target_subscription;
-        auto arg = get_actuator_control_target();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_actuator_control_target_subscription.is_subscribed()) {
+        _actuator_control_target_subscription.deliver(*_parent, get_actuator_control_target());
     }
 }
 
@@ -774,10 +752,8 @@ void TelemetryImpl::process_actuator_output_status(const mavlink_message_t& mess
 
     set_actuator_output_status(active, actuators);
 
-    if (_actuator_output_status_subscription) {
-        auto callback = _actuator_output_status_subscription;
-        auto arg = get_actuator_output_status();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_actuator_output_status_subscription.is_subscribed()) {
+        _actuator_output_status_subscription.deliver(*_parent, get_actuator_output_status());
     }
 }
 
@@ -812,10 +788,8 @@ void TelemetryImpl::process_odometry(const mavlink_message_t& message)
 
     set_odometry(odometry);
 
-    if (_odometry_subscription) {
-        auto callback = _odometry_subscription;
-        auto arg = get_odometry();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_odometry_subscription.is_subscribed()) {
+        _odometry_subscription.deliver(*_parent, get_odometry());
     }
 }
 
@@ -1267,127 +1241,223 @@ void TelemetryImpl::set_odometry(Telemetry::Odometry& odometry)
 void TelemetryImpl::position_velocity_ned_async(
     Telemetry::position_velocity_ned_callback_t& callback)
 {
-    _position_velocity_ned_subscription = callback;
+    _position_velocity_ned_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::position_async(Telemetry::position_callback_t& callback)
 {
-    _position_subscription = callback;
+    _position_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::home_position_async(Telemetry::position_callback_t& callback)
 {
-    _home_position_subscription = callback;
+    _home_position_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::in_air_async(Telemetry::in_air_callback_t& callback)
 {
-    _in_air_subscription = callback;
+    _in_air_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::status_text_async(Telemetry::status_text_callback_t& callback)
 {
-    _status_text_subscription = callback;
+    _status_text_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::armed_async(Telemetry::armed_callback_t& callback)
 {
-    _armed_subscription = callback;
+    _armed_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::attitude_quaternion_async(Telemetry::attitude_quaternion_callback_t& callback)
 {
-    _attitude_quaternion_subscription = callback;
+    _attitude_quaternion_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::attitude_euler_angle_async(Telemetry::attitude_euler_angle_callback_t& callback)
 {
-    _attitude_euler_angle_subscription = callback;
+    _attitude_euler_angle_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::attitude_angular_velocity_body_async(
     Telemetry::attitude_angular_velocity_body_callback_t& callback)
 {
-    _attitude_angular_velocity_body_subscription = callback;
+    _attitude_angular_velocity_body_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::camera_attitude_quaternion_async(
     Telemetry::attitude_quaternion_callback_t& callback)
 {
-    _camera_attitude_quaternion_subscription = callback;
+    _camera_attitude_quaternion_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::camera_attitude_euler_angle_async(
     Telemetry::attitude_euler_angle_callback_t& callback)
 {
-    _camera_attitude_euler_angle_subscription = callback;
+    _camera_attitude_euler_angle_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::ground_speed_ned_async(Telemetry::ground_speed_ned_callback_t& callback)
 {
-    _ground_speed_ned_subscription = callback;
+    _ground_speed_ned_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::imu_reading_ned_async(Telemetry::imu_reading_ned_callback_t& callback)
 {
-    _imu_reading_ned_subscription = callback;
+    _imu_reading_ned_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::gps_info_async(Telemetry::gps_info_callback_t& callback)
 {
-    _gps_info_subscription = callback;
+    _gps_info_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::battery_async(Telemetry::battery_callback_t& callback)
 {
-    _battery_subscription = callback;
+    _battery_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::flight_mode_async(Telemetry::flight_mode_callback_t& callback)
 {
-    _flight_mode_subscription = callback;
+    _flight_mode_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::health_async(Telemetry::health_callback_t& callback)
 {
-    _health_subscription = callback;
+    _health_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::health_all_ok_async(Telemetry::health_all_ok_callback_t& callback)
 {
-    _health_all_ok_subscription = callback;
+    _health_all_ok_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::landed_state_async(Telemetry::landed_state_callback_t& callback)
 {
-    _landed_state_subscription = callback;
+    _landed_state_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::rc_status_async(Telemetry::rc_status_callback_t& callback)
 {
-    _rc_status_subscription = callback;
+    _rc_status_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::unix_epoch_time_async(Telemetry::unix_epoch_time_callback_t& callback)
 {
-    _unix_epoch_time_subscription = callback;
+    _unix_epoch_time_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::actuator_control_target_async(
     Telemetry::actuator_control_target_callback_t& callback)
 {
-    _actuator_control_target_subscription = callback;
+    _actuator_control_target_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::actuator_output_status_async(
     Telemetry::actuator_output_status_callback_t& callback)
 {
-    _actuator_output_status_subscription = callback;
+    _actuator_output_status_subscription.set_callback(callback);
 }
 
 void TelemetryImpl::odometry_async(Telemetry::odometry_callback_t& callback)
 {
-    _odometry_subscription = callback;
+    _odometry_subscription.set_callback(callback);
+}
+
+void TelemetryImpl::set_delivery_policy(
+    Telemetry::Subscription subscription, Telemetry::DeliveryPolicy policy, unsigned depth)
+{
+    DeliveryQueueBase* queue = delivery_queue(subscription);
+    if (queue == nullptr) {
+        LogErr() << "Unknown telemetry subscription";
+        return;
+    }
+
+    switch (policy) {
+        case Telemetry::DeliveryPolicy::ALL:
+            queue->set_policy(DeliveryQueueBase::Policy::ALL, depth);
+            break;
+        case Telemetry::DeliveryPolicy::LATEST:
+            queue->set_policy(DeliveryQueueBase::Policy::LATEST, depth);
+            break;
+        case Telemetry::DeliveryPolicy::LAST_N:
+            queue->set_policy(DeliveryQueueBase::Policy::LAST_N, depth);
+            break;
+    }
+}
+
+Telemetry::SubscriptionStats
+TelemetryImpl::subscription_stats(Telemetry::Subscription subscription) const
+{
+    const DeliveryQueueBase* queue = delivery_queue(subscription);
+    if (queue == nullptr) {
+        return Telemetry::SubscriptionStats{0, 0, 0};
+    }
+
+    const auto stats = queue->stats();
+    return Telemetry::SubscriptionStats{stats.queue_depth, stats.num_delivered, stats.num_dropped};
+}
+
+DeliveryQueueBase* TelemetryImpl::delivery_queue(Telemetry::Subscription subscription)
+{
+    return const_cast<DeliveryQueueBase*>(
+        static_cast<const TelemetryImpl*>(this)->delivery_queue(subscription));
+}
+
+const DeliveryQueueBase*
+TelemetryImpl::delivery_queue(Telemetry::Subscription subscription) const
+{
+    switch (subscription) {
+        case Telemetry::Subscription::POSITION_VELOCITY_NED:
+            return &_position_velocity_ned_subscription;
+        case Telemetry::Subscription::POSITION:
+            return &_position_subscription;
+        case Telemetry::Subscription::HOME_POSITION:
+            return &_home_position_subscription;
+        case Telemetry::Subscription::IN_AIR:
+            return &_in_air_subscription;
+        case Telemetry::Subscription::STATUS_TEXT:
+            return &_status_text_subscription;
+        case Telemetry::Subscription::ARMED:
+            return &_armed_subscription;
+        case Telemetry::Subscription::ATTITUDE_QUATERNION:
+            return &_attitude_quaternion_subscription;
+        case Telemetry::Subscription::ATTITUDE_EULER_ANGLE:
+            return &_attitude_euler_angle_subscription;
+        case Telemetry::Subscription::ATTITUDE_ANGULAR_VELOCITY_BODY:
+            return &_attitude_angular_velocity_body_subscription;
+        case Telemetry::Subscription::CAMERA_ATTITUDE_QUATERNION:
+            return &_camera_attitude_quaternion_subscription;
+        case Telemetry::Subscription::CAMERA_ATTITUDE_EULER_ANGLE:
+            return &_camera_attitude_euler_angle_subscription;
+        case Telemetry::Subscription::GROUND_SPEED_NED:
+            return &_ground_speed_ned_subscription;
+        case Telemetry::Subscription::IMU_READING_NED:
+            return &_imu_reading_ned_subscription;
+        case Telemetry::Subscription::GPS_INFO:
+            return &_gps_info_subscription;
+        case Telemetry::Subscription::BATTERY:
+            return &_battery_subscription;
+        case Telemetry::Subscription::FLIGHT_MODE:
+            return &_flight_mode_subscription;
+        case Telemetry::Subscription::HEALTH:
+            return &_health_subscription;
+        case Telemetry::Subscription::HEALTH_ALL_OK:
+            return &_health_all_ok_subscription;
+        case Telemetry::Subscription::LANDED_STATE:
+            return &_landed_state_subscription;
+        case Telemetry::Subscription::RC_STATUS:
+            return &_rc_status_subscription;
+        case Telemetry::Subscription::UNIX_EPOCH_TIME:
+            return &_unix_epoch_time_subscription;
+        case Telemetry::Subscription::ACTUATOR_CONTROL_TARGET:
+            return &_actuator_control_target_subscription;
+        case Telemetry::Subscription::ACTUATOR_OUTPUT_STATUS:
+            return &_actuator_output_status_subscription;
+        case Telemetry::Subscription::ODOMETRY:
+            return &_odometry_subscription;
+    }
+    return nullptr;
 }
 
 void TelemetryImpl::process_parameter_update(const std::string& name)
@@ -5,6 +5,7 @@
 
 #include "plugins/telemetry/telemetry.h"
 #include "mavlink_include.h"
+#include "delivery_queue.h"
 #include "plugin_impl_base.h"
 #include "system.h"
 
@@ -112,10 +113,17 @@ public:
     void actuator_output_status_async(Telemetry::actuator_output_status_callback_t& callback);
     void odometry_async(Telemetry::odometry_callback_t& callback);
 
+    void set_delivery_policy(
+        Telemetry::Subscription subscription, Telemetry::DeliveryPolicy policy, unsigned depth);
+    Telemetry::SubscriptionStats subscription_stats(Telemetry::Subscription subscription) const;
+
     TelemetryImpl(const TelemetryImpl&) = delete;
     TelemetryImpl& operator=(const TelemetryImpl&) = delete;
 
 private:
+    DeliveryQueueBase* delivery_queue(Telemetry::Subscription subscription);
+    const DeliveryQueueBase* delivery_queue(Telemetry::Subscription subscription) const;
+
     void set_position_velocity_ned(Telemetry::PositionVelocityNED position_velocity_ned);
     void set_position(Telemetry::Position position);
     void set_home_position(Telemetry::Position home_position);
@@ -248,31 +256,30 @@ private:
 
     std::atomic<bool> _hitl_enabled{false};
 
-    Telemetry::position_velocity_ned_callback_t _position_velocity_ned_subscription{nullptr};
-    Telemetry::position_callback_t _position_subscription{nullptr};
-    Telemetry::position_callback_t _home_position_subscription{nullptr};
-    Telemetry::in_air_callback_t _in_air_subscription{nullptr};
-    Telemetry::status_text_callback_t _status_text_subscription{nullptr};
-    Telemetry::armed_callback_t _armed_subscription{nullptr};
-    Telemetry::attitude_quaternion_callback_t _attitude_quaternion_subscription{nullptr};
-    Telemetry::attitude_angular_velocity_body_callback_t
-        _attitude_angular_velocity_body_subscription{nullptr};
-    Telemetry::attitude_euler_angle_callback_t _attitude_euler_angle_subscription{nullptr};
-    Telemetry::attitude_quaternion_callback_t _camera_attitude_quaternion_subscription{nullptr};
-    Telemetry::attitude_euler_angle_callback_t _camera_attitude_euler_angle_subscription{nullptr};
-    Telemetry::ground_speed_ned_callback_t _ground_speed_ned_subscription{nullptr};
-    Telemetry::imu_reading_ned_callback_t _imu_reading_ned_subscription{nullptr};
-    Telemetry::gps_info_callback_t _gps_info_subscription{nullptr};
-    Telemetry::battery_callback_t _battery_subscription{nullptr};
-    Telemetry::flight_mode_callback_t _flight_mode_subscription{nullptr};
-    Telemetry::health_callback_t _health_subscription{nullptr};
-    Telemetry::health_all_ok_callback_t _health_all_ok_subscription{nullptr};
-    Telemetry::landed_state_callback_t _landed_state_subscription{nullptr};
-    Telemetry::rc_status_callback_t _rc_status_subscription{nullptr};
-    Telemetry::unix_epoch_time_callback_t _unix_epoch_time_subscription{nullptr};
-    Telemetry::actuator_control_target_callback_t _actuator_control_target_subscription{nullptr};
-    Telemetry::actuator_output_status_callback_t _actuator_output_status_subscription{nullptr};
-    Telemetry::odometry_callback_t _odometry_subscription{nullptr};
+    DeliveryQueue<Telemetry::PositionVelocityNED> _position_velocity_ned_subscription{};
+    DeliveryQueue<Telemetry::Position> _position_subscription{};
+    DeliveryQueue<Telemetry::Position> _home_position_subscription{};
+    DeliveryQueue<bool> _in_air_subscription{};
+    DeliveryQueue<Telemetry::StatusText> _status_text_subscription{};
+    DeliveryQueue<bool> _armed_subscription{};
+    DeliveryQueue<Telemetry::Quaternion> _attitude_quaternion_subscription{};
+    DeliveryQueue<Telemetry::AngularVelocityBody> _attitude_angular_velocity_body_subscription{};
+    DeliveryQueue<Telemetry::EulerAngle> _attitude_euler_angle_subscription{};
+    DeliveryQueue<Telemetry::Quaternion> _camera_attitude_quaternion_subscription{};
+    DeliveryQueue<Telemetry::EulerAngle> _camera_attitude_euler_angle_subscription{};
+    DeliveryQueue<Telemetry::GroundSpeedNED> _ground_speed_ned_subscription{};
+    DeliveryQueue<Telemetry::IMUReadingNED> _imu_reading_ned_subscription{};
+    DeliveryQueue<Telemetry::GPSInfo> _gps_info_subscription{};
+    DeliveryQueue<Telemetry::Battery> _battery_subscription{};
+    DeliveryQueue<Telemetry::FlightMode> _flight_mode_subscription{};
+    DeliveryQueue<Telemetry::Health> _health_subscription{};
+    DeliveryQueue<bool> _health_all_ok_subscription{};
+    DeliveryQueue<Telemetry::LandedState> _landed_state_subscription{};
+    DeliveryQueue<Telemetry::RCStatus> _rc_status_subscription{};
+    DeliveryQueue<uint64_t> _unix_epoch_time_subscription{};
+    DeliveryQueue<Telemetry::ActuatorControlTarget> _actuator_control_target_subscription{};
+    DeliveryQueue<Telemetry::ActuatorOutputStatus> _actuator_output_status_subscription{};
+    DeliveryQueue<Telemetry::Odometry> _odometry_subscription{};
 
     // The ground speed and position are coupled to the same message, therefore, we just use
     // the faster between the two.